@@ -0,0 +1,130 @@
+#include "counters.h"
+#include "../include/AbstractField.h"
+#include "../include/FixedField.h"
+#include "../include/KernelCost.h"
+
+namespace {
+    std::size_t bytes(const KernelCost &cost, std::size_t cells) {
+        return static_cast<std::size_t>(cost.bytesPerCell) * cells;
+    }
+}
+
+static void BM_FieldFill(benchmark::State &state) {
+    const auto n = static_cast<int>(state.range(0));
+    Field field(n, n);
+    AllocationCounter counter;
+    for (auto _ : state) {
+        field.fill(complex(1.0, 0.5));
+        benchmark::DoNotOptimize(field.data());
+        benchmark::ClobberMemory();
+    }
+    reportThroughput(state, field.size(), bytes(kernelCost::fieldFill, field.size()), counter);
+}
+BENCHMARK(BM_FieldFill)->RangeMultiplier(2)->Range(minimumGridSize, maximumGridSize);
+
+static void BM_FieldAddScalar(benchmark::State &state) {
+    const auto n = static_cast<int>(state.range(0));
+    Field field(n, n);
+    field.fill(complex(1.0, 0.5));
+    AllocationCounter counter;
+    for (auto _ : state) {
+        Field result = field + complex(2.0, 0.0);
+        benchmark::DoNotOptimize(result.data());
+    }
+    reportThroughput(state, field.size(), bytes(kernelCost::fieldAddScalar, field.size()), counter);
+}
+BENCHMARK(BM_FieldAddScalar)->RangeMultiplier(2)->Range(minimumGridSize, maximumGridSize);
+
+static void BM_FieldAdd(benchmark::State &state) {
+    const auto n = static_cast<int>(state.range(0));
+    Field a(n, n);
+    Field b(n, n);
+    a.fill(complex(1.0, 0.5));
+    b.fill(complex(0.5, 1.0));
+    AllocationCounter counter;
+    for (auto _ : state) {
+        Field result = a + b;
+        benchmark::DoNotOptimize(result.data());
+    }
+    reportThroughput(state, a.size(), bytes(kernelCost::fieldAddField, a.size()), counter);
+}
+BENCHMARK(BM_FieldAdd)->RangeMultiplier(2)->Range(minimumGridSize, maximumGridSize);
+
+static void BM_FieldSubtract(benchmark::State &state) {
+    const auto n = static_cast<int>(state.range(0));
+    Field a(n, n);
+    Field b(n, n);
+    a.fill(complex(1.0, 0.5));
+    b.fill(complex(0.5, 1.0));
+    AllocationCounter counter;
+    for (auto _ : state) {
+        Field result = a - b;
+        benchmark::DoNotOptimize(result.data());
+    }
+    reportThroughput(state, a.size(), bytes(kernelCost::fieldAddField, a.size()), counter);
+}
+BENCHMARK(BM_FieldSubtract)->RangeMultiplier(2)->Range(minimumGridSize, maximumGridSize);
+
+static void BM_FieldMultiply(benchmark::State &state) {
+    const auto n = static_cast<int>(state.range(0));
+    Field a(n, n);
+    Field b(n, n);
+    a.fill(complex(1.0, 0.5));
+    b.fill(complex(0.5, 1.0));
+    AllocationCounter counter;
+    for (auto _ : state) {
+        Field result = a * b;
+        benchmark::DoNotOptimize(result.data());
+    }
+    reportThroughput(state, a.size(), bytes(kernelCost::fieldMultiplyField, a.size()), counter);
+}
+BENCHMARK(BM_FieldMultiply)->RangeMultiplier(2)->Range(minimumGridSize, maximumGridSize);
+
+static void BM_RealFieldMultiply(benchmark::State &state) {
+    const auto n = static_cast<int>(state.range(0));
+    RealField a(n, n);
+    RealField b(n, n);
+    a.fill(1.5);
+    b.fill(0.5);
+    AllocationCounter counter;
+    for (auto _ : state) {
+        RealField result = a * b;
+        benchmark::DoNotOptimize(result.data());
+    }
+    reportThroughput(state, a.size(), bytes(kernelCost::realMultiplyField, a.size()), counter);
+}
+BENCHMARK(BM_RealFieldMultiply)->RangeMultiplier(2)->Range(minimumGridSize, maximumGridSize);
+
+// Small grids of the ensemble studies, where the fixed-size field avoids the allocation and runtime bounds
+static void BM_SmallFieldMultiply(benchmark::State &state) {
+    const auto n = static_cast<int>(state.range(0));
+    Field a(n, n);
+    Field b(n, n);
+    a.fill(complex(1.0, 0.5));
+    b.fill(complex(0.5, 1.0));
+    AllocationCounter counter;
+    for (auto _ : state) {
+        Field result = a * b;
+        benchmark::DoNotOptimize(result.data());
+    }
+    reportThroughput(state, a.size(), bytes(kernelCost::fieldMultiplyField, a.size()), counter);
+}
+BENCHMARK(BM_SmallFieldMultiply)->Arg(32)->Arg(64)->Arg(128);
+
+template<std::size_t N>
+static void BM_FixedFieldMultiply(benchmark::State &state) {
+    FixedField<complex, N, N> a;
+    FixedField<complex, N, N> b;
+    a.fill(complex(1.0, 0.5));
+    b.fill(complex(0.5, 1.0));
+    AllocationCounter counter;
+    for (auto _ : state) {
+        FixedField<complex, N, N> result = a * b;
+        benchmark::DoNotOptimize(result.data());
+        benchmark::ClobberMemory();
+    }
+    reportThroughput(state, a.size(), bytes(kernelCost::fieldMultiplyField, a.size()), counter);
+}
+BENCHMARK_TEMPLATE(BM_FixedFieldMultiply, 32);
+BENCHMARK_TEMPLATE(BM_FixedFieldMultiply, 64);
+BENCHMARK_TEMPLATE(BM_FixedFieldMultiply, 128);
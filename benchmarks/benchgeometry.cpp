@@ -0,0 +1,46 @@
+#include "counters.h"
+#include "../include/Geometry.h"
+
+namespace {
+    /**
+     * @brief Geometry keeps eight bit-packed masks of the grid; construction and setGeometry write all of them.
+     */
+    constexpr std::size_t geometryMasks = 8;
+
+    Mask ring(int n) {
+        Mask mask(n, n);
+        for (int x = 1; x < n - 1; x++) {
+            for (int y = 1; y < n - 1; y++) {
+                bool hole = x > n / 3 && x < 2 * n / 3 && y > n / 3 && y < 2 * n / 3;
+                mask(x, y) = !hole;
+            }
+        }
+        return mask;
+    }
+}
+
+static void BM_GeometryConstruction(benchmark::State &state) {
+    const auto n = static_cast<int>(state.range(0));
+    const auto cells = static_cast<std::size_t>(n) * n;
+    AllocationCounter counter;
+    for (auto _ : state) {
+        Geometry geometry(n, n);
+        benchmark::DoNotOptimize(&geometry);
+    }
+    reportThroughput(state, cells, geometryMasks * cells / 8, counter);
+}
+BENCHMARK(BM_GeometryConstruction)->RangeMultiplier(2)->Range(minimumGridSize, maximumGridSize);
+
+static void BM_GeometrySetGeometry(benchmark::State &state) {
+    const auto n = static_cast<int>(state.range(0));
+    const auto cells = static_cast<std::size_t>(n) * n;
+    Geometry geometry(n, n);
+    Mask mask = ring(n);
+    AllocationCounter counter;
+    for (auto _ : state) {
+        geometry.setGeometry(mask);
+        benchmark::DoNotOptimize(&geometry);
+    }
+    reportThroughput(state, cells, geometryMasks * cells / 8, counter);
+}
+BENCHMARK(BM_GeometrySetGeometry)->RangeMultiplier(2)->Range(minimumGridSize, maximumGridSize);
@@ -0,0 +1,52 @@
+#include "counters.h"
+#include "../include/AbstractField.h"
+
+namespace {
+    Mask checkerboard(int n) {
+        Mask mask(n, n);
+        for (int x = 0; x < n; x++) {
+            for (int y = 0; y < n; y++) {
+                mask(x, y) = (x + y) % 2 == 0;
+            }
+        }
+        return mask;
+    }
+}
+
+static void BM_MaskFill(benchmark::State &state) {
+    const auto n = static_cast<int>(state.range(0));
+    Mask mask(n, n);
+    AllocationCounter counter;
+    for (auto _ : state) {
+        mask.fill(true);
+        benchmark::ClobberMemory();
+    }
+    // Masks are bit-packed
+    reportThroughput(state, mask.size(), mask.size() / 8, counter);
+}
+BENCHMARK(BM_MaskFill)->RangeMultiplier(2)->Range(minimumGridSize, maximumGridSize);
+
+static void BM_MaskNot(benchmark::State &state) {
+    const auto n = static_cast<int>(state.range(0));
+    Mask mask = checkerboard(n);
+    AllocationCounter counter;
+    for (auto _ : state) {
+        Mask result = !mask;
+        benchmark::DoNotOptimize(&result);
+    }
+    reportThroughput(state, mask.size(), 2 * mask.size() / 8, counter);
+}
+BENCHMARK(BM_MaskNot)->RangeMultiplier(2)->Range(minimumGridSize, maximumGridSize);
+
+static void BM_MaskOr(benchmark::State &state) {
+    const auto n = static_cast<int>(state.range(0));
+    Mask a = checkerboard(n);
+    Mask b = !a;
+    AllocationCounter counter;
+    for (auto _ : state) {
+        Mask result = a || b;
+        benchmark::DoNotOptimize(&result);
+    }
+    reportThroughput(state, a.size(), 3 * a.size() / 8, counter);
+}
+BENCHMARK(BM_MaskOr)->RangeMultiplier(2)->Range(minimumGridSize, maximumGridSize);
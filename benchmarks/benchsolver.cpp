@@ -0,0 +1,74 @@
+#include "counters.h"
+#include "../include/FixedField.h"
+#include "../include/KernelCost.h"
+#include "../include/Solver.h"
+
+static void BM_SolverStep(benchmark::State &state) {
+    const auto n = static_cast<int>(state.range(0));
+    Geometry geometry(n, n);
+    Superconductor superconductor(n, n);
+    Solver solver(superconductor, geometry, SolverParameters());
+    solver.initialize();
+
+    AllocationCounter counter;
+    for (auto _ : state) {
+        solver.step(0.1, 0.0);
+    }
+    const auto cells = static_cast<std::size_t>(n) * n;
+    reportThroughput(state, cells, static_cast<std::size_t>(kernelCost::solverStep.bytesPerCell) * cells, counter);
+}
+BENCHMARK(BM_SolverStep)->RangeMultiplier(2)->Range(minimumGridSize, maximumGridSize)->Unit(benchmark::kMillisecond);
+
+static void BM_SmallSolverStep(benchmark::State &state) {
+    const auto n = static_cast<int>(state.range(0));
+    Geometry geometry(n, n);
+    Superconductor superconductor(n, n);
+    Solver solver(superconductor, geometry, SolverParameters());
+    solver.initialize();
+
+    AllocationCounter counter;
+    for (auto _ : state) {
+        solver.step(0.1, 0.0);
+    }
+    const auto cells = static_cast<std::size_t>(n) * n;
+    reportThroughput(state, cells, static_cast<std::size_t>(kernelCost::solverStep.bytesPerCell) * cells, counter);
+}
+BENCHMARK(BM_SmallSolverStep)->Arg(32)->Arg(64)->Arg(128);
+
+template<std::size_t N>
+static void BM_FixedSolverStep(benchmark::State &state) {
+    Geometry geometry(N, N);
+    BasicSuperconductor<double, complex, FixedGrid<N, N>> superconductor(N, N);
+    BasicSolver<double, complex, FixedGrid<N, N>> solver(superconductor, geometry, SolverParameters());
+    solver.initialize();
+
+    AllocationCounter counter;
+    for (auto _ : state) {
+        solver.step(0.1, 0.0);
+    }
+    reportThroughput(state, N * N, static_cast<std::size_t>(kernelCost::solverStep.bytesPerCell) * N * N, counter);
+}
+BENCHMARK_TEMPLATE(BM_FixedSolverStep, 32);
+BENCHMARK_TEMPLATE(BM_FixedSolverStep, 64);
+BENCHMARK_TEMPLATE(BM_FixedSolverStep, 128);
+
+static void BM_SolverAdvance(benchmark::State &state) {
+    const auto n = static_cast<int>(state.range(0));
+    const auto block = static_cast<int>(state.range(1));
+    Geometry geometry(n, n);
+    Superconductor superconductor(n, n);
+    SolverParameters parameters;
+    parameters.screening = false;
+    parameters.temporalBlocking = block;
+    Solver solver(superconductor, geometry, parameters);
+    solver.initialize();
+
+    AllocationCounter counter;
+    for (auto _ : state) {
+        solver.advance(0.1, 0.0, 8);
+    }
+    const auto cells = static_cast<std::size_t>(n) * n * 8;
+    reportThroughput(state, cells, static_cast<std::size_t>(kernelCost::orderParameter.bytesPerCell) * cells / block,
+                     counter);
+}
+BENCHMARK(BM_SolverAdvance)->ArgsProduct({{512, 2048, 4096}, {1, 4, 8}})->Unit(benchmark::kMillisecond);
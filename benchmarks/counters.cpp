@@ -0,0 +1,89 @@
+#include "counters.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+    std::atomic<std::size_t> allocationCount(0);
+
+    void *allocateCounted(std::size_t size, std::size_t alignment) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        size = size == 0 ? 1 : size;
+        // aligned_alloc needs a multiple of the alignment
+        void *pointer = alignment <= alignof(std::max_align_t)
+                        ? std::malloc(size)
+                        : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        if (pointer == nullptr) {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+}
+
+void *operator new(std::size_t size) {
+    return allocateCounted(size, alignof(std::max_align_t));
+}
+
+void *operator new[](std::size_t size) {
+    return allocateCounted(size, alignof(std::max_align_t));
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    return allocateCounted(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocateCounted(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+AllocationCounter::AllocationCounter() : _start(total()) {
+}
+
+std::size_t AllocationCounter::allocations() const {
+    return total() - _start;
+}
+
+std::size_t AllocationCounter::total() {
+    return allocationCount.load(std::memory_order_relaxed);
+}
+
+void reportThroughput(benchmark::State &state, std::size_t cells, std::size_t bytes, const AllocationCounter &counter) {
+    const auto iterations = static_cast<double>(state.iterations());
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+    state.counters["cells/s"] = benchmark::Counter(iterations * static_cast<double>(cells),
+                                                   benchmark::Counter::kIsRate);
+    state.counters["allocs/op"] = benchmark::Counter(static_cast<double>(counter.allocations()),
+                                                     benchmark::Counter::kAvgIterations);
+}
@@ -0,0 +1,49 @@
+#ifndef CPP_CONSTRICTION_SQUID_COUNTERS_H
+#define CPP_CONSTRICTION_SQUID_COUNTERS_H
+
+#include <benchmark/benchmark.h>
+#include <cstddef>
+
+/**
+ * @brief Counts heap allocations made through every form of the global operator new. Field storage comes from the
+ * plain one, through the arena. Linking counters.cpp replaces the global allocation functions for the whole executable.
+ */
+class AllocationCounter {
+public:
+    /**
+     * @brief Starts counting from the current number of allocations.
+     */
+    AllocationCounter();
+
+    /**
+     * @brief Accesses the number of allocations since construction.
+     * @return The number of allocations.
+     */
+    std::size_t allocations() const;
+
+    /**
+     * @brief Accesses the total number of allocations made by the process so far.
+     * @return The number of allocations.
+     */
+    static std::size_t total();
+
+private:
+    std::size_t _start;
+};
+
+/**
+ * @brief Reports the throughput counters shared by all benchmarks: bytes/s, cells/s and allocations per iteration.
+ * @param state The benchmark state, after the timing loop.
+ * @param cells The number of cells processed per iteration.
+ * @param bytes The number of bytes moved per iteration.
+ * @param counter Counter started right before the timing loop.
+ */
+void reportThroughput(benchmark::State& state, std::size_t cells, std::size_t bytes, const AllocationCounter& counter);
+
+/**
+ * @brief Grid sizes, as the edge length of a square grid.
+ */
+constexpr long minimumGridSize = 64;
+constexpr long maximumGridSize = 8192;
+
+#endif //CPP_CONSTRICTION_SQUID_COUNTERS_H
@@ -0,0 +1,238 @@
+#include "../include/Geometry.h"
+#include "../include/Solver.h"
+#include "../include/Superconductor.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * Performance regression gate. Runs a fixed set of workloads, each in its own child process so that its peak RSS can
+ * be measured in isolation, and compares throughput and memory against a baseline file.
+ *
+ * Usage: Run_perf_gate --baseline <file> [--update] [--tolerance <fraction>] [--rss-tolerance <fraction>]
+ */
+
+namespace {
+    struct Workload {
+        const char *name;
+        int repetitions;
+
+        /**
+         * @brief Runs the workload once and returns the number of cells processed.
+         */
+        std::function<double()> run;
+    };
+
+    struct Measurement {
+        double cellsPerSecond = 0.0;
+        double peakRssKilobytes = 0.0;
+    };
+
+    constexpr int geometrySize = 1024;
+    constexpr int solverSize = 128;
+    constexpr int solverSteps = 1000;
+
+    std::vector<Workload> workloads() {
+        return {
+                {"geometry_square", 5, []() {
+                    Geometry geometry(geometrySize, geometrySize);
+                    return static_cast<double>(geometry.width()) * geometry.height();
+                }},
+                {"geometry_squid", 5, []() {
+                    static const Mask squid = Geometry::squidMask(geometrySize, geometrySize);
+                    static Geometry geometry(geometrySize, geometrySize);
+                    geometry.setGeometry(squid);
+                    return static_cast<double>(geometrySize) * geometrySize;
+                }},
+                {"solver_1000_steps", 3, []() {
+                    Geometry geometry(solverSize, solverSize);
+                    Superconductor superconductor(solverSize, solverSize);
+                    Solver solver(superconductor, geometry, SolverParameters());
+                    solver.initialize();
+                    for (int n = 0; n < solverSteps; n++) {
+                        solver.step(0.1, 0.0);
+                    }
+                    return static_cast<double>(solverSize) * solverSize * solverSteps;
+                }},
+        };
+    }
+
+    /**
+     * @brief Best throughput over the repetitions, measured in the calling process.
+     */
+    double bestThroughput(const Workload &workload) {
+        double best = 0.0;
+        for (int i = 0; i < workload.repetitions; i++) {
+            auto start = std::chrono::steady_clock::now();
+            double cells = workload.run();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = std::max(best, cells / elapsed.count());
+        }
+        return best;
+    }
+
+    Measurement measure(const Workload &workload) {
+        int channel[2];
+        if (pipe(channel) != 0) {
+            throw std::runtime_error("pipe() failed.");
+        }
+        pid_t child = fork();
+        if (child < 0) {
+            throw std::runtime_error("fork() failed.");
+        }
+        if (child == 0) {
+            close(channel[0]);
+            double throughput = bestThroughput(workload);
+            ssize_t written = write(channel[1], &throughput, sizeof(throughput));
+            _exit(written == sizeof(throughput) ? 0 : 1);
+        }
+
+        close(channel[1]);
+        Measurement measurement;
+        ssize_t received = read(channel[0], &measurement.cellsPerSecond, sizeof(double));
+        close(channel[0]);
+        int status = 0;
+        rusage usage{};
+        wait4(child, &status, 0, &usage);
+        if (received != sizeof(double) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            throw std::runtime_error(std::string("Workload ") + workload.name + " failed.");
+        }
+#ifdef __APPLE__
+        measurement.peakRssKilobytes = static_cast<double>(usage.ru_maxrss) / 1024.0;
+#else
+        measurement.peakRssKilobytes = static_cast<double>(usage.ru_maxrss);
+#endif
+        return measurement;
+    }
+
+    std::map<std::string, Measurement> readBaseline(const std::string &path) {
+        std::map<std::string, Measurement> baseline;
+        std::ifstream file(path);
+        std::string line;
+        while (std::getline(file, line)) {
+            line = line.substr(0, line.find('#'));
+            std::istringstream stream(line);
+            std::string name;
+            Measurement measurement;
+            if (stream >> name >> measurement.cellsPerSecond >> measurement.peakRssKilobytes) {
+                baseline[name] = measurement;
+            }
+        }
+        return baseline;
+    }
+
+    void writeBaseline(const std::string &path, const std::map<std::string, Measurement> &measurements) {
+        std::ofstream file(path);
+        file << "# Baseline of Run_perf_gate, only meaningful on the machine that produced it.\n"
+             << "# Regenerate with: cmake --build <build dir> --target perf_gate_update\n"
+             << "# workload cells_per_s peak_rss_kb\n";
+        for (const auto &[name, measurement] : measurements) {
+            file << name << ' ' << std::setprecision(4) << measurement.cellsPerSecond << ' '
+                 << std::setprecision(0) << std::fixed << measurement.peakRssKilobytes << std::defaultfloat << '\n';
+        }
+    }
+
+    std::string percentChange(double before, double after) {
+        std::ostringstream text;
+        text << std::showpos << std::fixed << std::setprecision(1) << 100.0 * (after / before - 1.0) << '%';
+        return text.str();
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    std::string baselinePath;
+    bool update = false;
+    double tolerance = 0.15;
+    double rssTolerance = 0.10;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--baseline" && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (argument == "--update") {
+            update = true;
+        } else if (argument == "--tolerance" && i + 1 < argc) {
+            tolerance = std::atof(argv[++i]);
+        } else if (argument == "--rss-tolerance" && i + 1 < argc) {
+            rssTolerance = std::atof(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " --baseline <file> [--update] [--tolerance <fraction>] [--rss-tolerance <fraction>]"
+                      << std::endl;
+            return 2;
+        }
+    }
+    if (baselinePath.empty()) {
+        std::cerr << "--baseline is required." << std::endl;
+        return 2;
+    }
+
+#ifdef _OPENMP
+    // Thread scheduling noise would swamp the tolerance
+    omp_set_num_threads(1);
+#endif
+
+    std::map<std::string, Measurement> baseline = readBaseline(baselinePath);
+    std::map<std::string, Measurement> measurements;
+    bool passed = true;
+
+    std::cout << std::left << std::setw(20) << "workload" << std::setw(40) << "cells/s (baseline -> now)"
+              << std::setw(36) << "peak RSS kB (baseline -> now)" << "result" << std::endl;
+    for (const Workload &workload : workloads()) {
+        Measurement now = measure(workload);
+        measurements[workload.name] = now;
+
+        std::ostringstream throughput;
+        std::ostringstream memory;
+        std::string result;
+        auto reference = baseline.find(workload.name);
+        if (reference == baseline.end()) {
+            throughput << "- -> " << std::setprecision(4) << now.cellsPerSecond;
+            memory << "- -> " << std::fixed << std::setprecision(0) << now.peakRssKilobytes;
+            result = update ? "NEW" : "FAIL (no baseline)";
+            passed = passed && update;
+        } else {
+            const Measurement &before = reference->second;
+            bool fast = now.cellsPerSecond >= (1.0 - tolerance) * before.cellsPerSecond;
+            bool lean = now.peakRssKilobytes <= (1.0 + rssTolerance) * before.peakRssKilobytes;
+            throughput << std::setprecision(4) << before.cellsPerSecond << " -> " << now.cellsPerSecond << " ("
+                       << percentChange(before.cellsPerSecond, now.cellsPerSecond) << ")";
+            memory << std::fixed << std::setprecision(0) << before.peakRssKilobytes << " -> "
+                   << now.peakRssKilobytes << " (" << percentChange(before.peakRssKilobytes, now.peakRssKilobytes)
+                   << ")";
+            if (fast && lean) {
+                result = "PASS";
+            } else {
+                result = std::string("FAIL (") + (fast ? "" : "slower") + (fast || lean ? "" : ", ")
+                         + (lean ? "" : "more memory") + ")";
+                passed = passed && update;
+            }
+        }
+        std::cout << std::left << std::setw(20) << workload.name << std::setw(40) << throughput.str()
+                  << std::setw(36) << memory.str() << result << std::endl;
+    }
+
+    if (update) {
+        writeBaseline(baselinePath, measurements);
+        std::cout << "Baseline written to " << baselinePath << std::endl;
+        return 0;
+    }
+    std::cout << (passed ? "Performance gate passed." : "Performance gate FAILED.") << std::endl;
+    return passed ? 0 : 1;
+}
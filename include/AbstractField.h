@@ -5,28 +5,117 @@
 #ifndef CPP_CONSTRICTION_SQUID_ABSTRACTFIELD_H
 #define CPP_CONSTRICTION_SQUID_ABSTRACTFIELD_H
 
+#include <array>
 #include <vector>
 #include <complex>
+#include <cstdint>
+#include "Arena.h"
+#include "Kernels.h"
+#include "Reductions.h"
 
 typedef std::complex<double> complex;
 
+/**
+ * @brief The storage vector of a dynamic field, drawn from the arena of the thread; see Arena.h.
+ */
+template<typename T>
+using FieldVector = std::vector<T, arena::Allocator<T>>;
+
+/**
+ * @brief How fields store their elements: one per storage element by default.
+ */
+template<typename T>
+struct FieldStorage {
+    typedef T type;
+
+    /**
+     * @brief The number of storage elements that hold a number of field elements.
+     */
+    static constexpr std::size_t length(std::size_t elements) {
+        return elements;
+    }
+};
+
+/**
+ * @brief Masks are bit-packed in 64-bit words, like std::vector<bool> but with access to the words, so that mask
+ * operations work on whole words at the vector width of the CPU. Bits beyond the last element are kept 0.
+ */
+template<>
+struct FieldStorage<bool> {
+    typedef std::uint64_t type;
+
+    static constexpr std::size_t bits = 64;
+
+    static constexpr std::size_t length(std::size_t elements) {
+        return (elements + bits - 1) / bits;
+    }
+};
+
 class BoolProxy {
 public:
-    BoolProxy(std::vector<bool>& vec, size_t index);
+    BoolProxy(FieldVector<std::uint64_t>& words, size_t index);
 
     operator bool() const;
 
     BoolProxy& operator=(bool b);
 
 private:
-    std::vector<bool>& _vec;
+    FieldVector<std::uint64_t>& _words;
     size_t _index;
 };
+/**
+ * @brief Storage of a field whose dimensions are chosen at runtime, on the heap through the arena of the thread, so
+ * that temporaries in a loop can reuse their storage.
+ */
+template<typename T>
+class DynamicStorage {
+public:
+    typedef typename FieldStorage<T>::type storage_type;
+
+    /**
+     * @brief Allocates zeroed storage.
+     * @param width The width of the field.
+     * @param height The height of the field.
+     * @throws std::invalid_argument If a dimension is not positive.
+     */
+    DynamicStorage(int width, int height);
 
+protected:
+    std::size_t _width;
+    std::size_t _height;
+    FieldVector<storage_type> _field;
+};
 
-template<typename Derived, typename T>
-class AbstractField {
+/**
+ * @brief Storage of a field whose dimensions are fixed at compile time, inside the field object itself. Small fields
+ * built on it need no allocation and their loops have constant trip counts.
+ */
+template<typename T, std::size_t W, std::size_t H>
+class FixedStorage {
 public:
+    static_assert(W > 0 && H > 0, "Width and height must be positive");
+
+    typedef typename FieldStorage<T>::type storage_type;
+
+    /**
+     * @brief Constructs zeroed storage. The dimensions are only checked, so that the interface matches DynamicStorage.
+     * @param width The width of the field, must be W.
+     * @param height The height of the field, must be H.
+     * @throws std::invalid_argument If the dimensions differ from W and H.
+     */
+    FixedStorage(int width, int height);
+
+protected:
+    static constexpr std::size_t _width = W;
+    static constexpr std::size_t _height = H;
+    std::array<storage_type, FieldStorage<T>::length(W * H)> _field{};
+};
+
+template<typename Derived, typename T, typename Storage = DynamicStorage<T>>
+class AbstractField : public Storage {
+public:
+    typedef typename FieldStorage<T>::type storage_type;
+
     /**
      * @brief Constructs a new AbstractField object of correct size. Fields are initialized with value 0.
      * @param width The width of the field.
@@ -93,17 +182,39 @@ public:
      */
     std::size_t height() const;
 
-protected:
-    std::size_t _width;
-    std::size_t _height;
-    std::vector<std::vector<T> > _field;
+    /**
+     * @brief Get the number of elements in the container.
+     * @return The number of elements, width() * height().
+     */
+    std::size_t size() const;
+
+    /**
+     * @brief Direct access to the contiguous storage. Element (x, y) is stored at index x * height() + y; for masks
+     * that is the bit index into the words.
+     * @return Pointer to the first element.
+     */
+    storage_type* data();
+
+    /**
+     * @brief Direct access to the contiguous storage. Element (x, y) is stored at index x * height() + y; for masks
+     * that is the bit index into the words.
+     * @return Pointer to the first element.
+     */
+    const storage_type* data() const;
 };
 
+class Mask;
+
 template<typename scalar>
 class ScalarField : public AbstractField<ScalarField<scalar>, scalar> {
 public:
     using AbstractField<ScalarField<scalar>, scalar>::AbstractField;
 
+    /**
+     * @brief The type sums are returned in: double, or std::complex<double> for complex fields.
+     */
+    typedef typename reductions::Traits<scalar>::accumulator accumulator_type;
+
     /**
      * @brief Accesses the field at a given position.
      * @param x
@@ -161,6 +272,122 @@ public:
      * @return The resulting field.
      */
     ScalarField operator*(const ScalarField& other) const;
+
+    // The in-place operations write into the storage of this field, so that they need no temporaries.
+
+    /**
+     * @brief Adds a scalar to every element, in place.
+     * @param val The scalar to add.
+     * @return This field.
+     */
+    ScalarField& operator+=(const scalar& val);
+
+    /**
+     * @brief Adds a field, in place.
+     * @param other The field to add.
+     * @return This field.
+     */
+    ScalarField& operator+=(const ScalarField& other);
+
+    /**
+     * @brief Subtracts a scalar from every element, in place.
+     * @param val The scalar to subtract.
+     * @return This field.
+     */
+    ScalarField& operator-=(const scalar& val);
+
+    /**
+     * @brief Subtracts a field, in place.
+     * @param other The field to subtract.
+     * @return This field.
+     */
+    ScalarField& operator-=(const ScalarField& other);
+
+    /**
+     * @brief Multiplies every element by a scalar, in place.
+     * @param val The scalar to multiply by.
+     * @return This field.
+     */
+    ScalarField& operator*=(const scalar& val);
+
+    /**
+     * @brief Multiplies element-wise by a field, in place.
+     * @param other The field to multiply by.
+     * @return This field.
+     */
+    ScalarField& operator*=(const ScalarField& other);
+
+    /**
+     * @brief Sets the elements in a region to a value, for instance psi.where(geometry.exteriorVacuum(), 0.0).
+     * @param region The region, of the same dimensions; a mask of Geometry is passed as it is.
+     * @param value The value.
+     * @return This field.
+     */
+    ScalarField& where(const Mask& region, const scalar& value);
+
+    /**
+     * @brief Copies the elements of another field in a region, and keeps the others.
+     * @param region The region, of the same dimensions.
+     * @param other The field to copy from, of the same dimensions.
+     * @return This field.
+     */
+    ScalarField& assignMasked(const Mask& region, const ScalarField& other);
+
+    /**
+     * @brief Multiplies the elements in a region by a factor, and keeps the others.
+     * @param region The region, of the same dimensions.
+     * @param factor The factor.
+     * @return This field.
+     */
+    ScalarField& scaleMasked(const Mask& region, const scalar& factor);
+
+    // The reductions are accumulated in double precision along a fixed tree, so that they give the same bits on any
+    // number of threads; see Reductions.h.
+
+    /**
+     * @brief Sums all elements.
+     * @return The sum.
+     */
+    accumulator_type sum() const;
+
+    /**
+     * @brief Sums the elements in a region, for instance a mask of Geometry.
+     * @param region The region, of the same dimensions.
+     * @return The sum.
+     */
+    accumulator_type sum(const Mask& region) const;
+
+    /**
+     * @brief The inner product with another field, conjugating this one.
+     * @param other The other field.
+     * @return The sum of conj(a_i) b_i.
+     */
+    accumulator_type dot(const ScalarField& other) const;
+
+    /**
+     * @brief The sum of |a_i|^2.
+     * @return The squared Euclidean norm.
+     */
+    double squaredNorm() const;
+
+    /**
+     * @brief The sum of |a_i|^2 over a region.
+     * @param region The region, of the same dimensions.
+     * @return The squared Euclidean norm of the region.
+     */
+    double squaredNorm(const Mask& region) const;
+
+    /**
+     * @brief The Euclidean norm.
+     * @return The square root of squaredNorm().
+     */
+    double norm2() const;
+
+    /**
+     * @brief The largest magnitude of any element, the maximum norm.
+     * @return The largest |a_i|.
+     */
+    double maxAbs() const;
 };
 
 class Mask : public AbstractField<Mask, bool> {
@@ -195,11 +422,60 @@ public:
      * @return The result of the OR operation.
      */
     Mask operator||(const Mask& other) const;
+
+    /**
+     * @brief Logical OR with another mask, in place.
+     * @param other The mask to OR with.
+     * @return This mask.
+     */
+    Mask& operator|=(const Mask& other);
+
+    /**
+     * @brief Negates the mask in place.
+     * @return This mask.
+     */
+    Mask& invert();
+
+    /**
+     * @brief Counts the elements that are set.
+     * @return The number of set elements.
+     */
+    std::size_t count() const;
 };
 
 typedef ScalarField<complex> Field;
 typedef ScalarField<double> RealField;
 
+/**
+ * @brief A complex field of a given precision; ComplexField<double> is Field.
+ */
+template<typename real>
+using ComplexField = ScalarField<std::complex<real>>;
+
+/**
+ * @brief A field of unit-modulus phasors, stored as 32-bit phases; a quarter of the size of a Field.
+ */
+typedef ScalarField<Phase> PhaseField;
+
+/**
+ * @brief The storage of the fields of a superconductor and its solver, by where they live on the grid: the grid points,
+ * the bonds in x and y and the plaquettes. DynamicGrid holds fields of runtime dimensions, FixedGrid of FixedField.h
+ * fields of compile-time dimensions.
+ */
+struct DynamicGrid {
+    template<typename T>
+    using points = ScalarField<T>;
+
+    template<typename T>
+    using xBonds = ScalarField<T>;
+
+    template<typename T>
+    using yBonds = ScalarField<T>;
+
+    template<typename T>
+    using plaquettes = ScalarField<T>;
+};
+
 #include "../src/AbstractField.tpp"
 
 #endif //CPP_CONSTRICTION_SQUID_ABSTRACTFIELD_H
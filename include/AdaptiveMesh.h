@@ -0,0 +1,313 @@
+#ifndef CPP_CONSTRICTION_SQUID_ADAPTIVEMESH_H
+#define CPP_CONSTRICTION_SQUID_ADAPTIVEMESH_H
+
+#include "Gauge.h"
+#include "Geometry.h"
+#include "Solver.h"
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Settings of the refinement of an adaptive mesh.
+ */
+struct RefinementParameters {
+    /**
+     * @brief The number of levels, each with half the grid spacing of the one before; the finest has the grid of the
+     * geometry.
+     */
+    int levels = 3;
+
+    /**
+     * @brief The grid points on a side of a patch.
+     */
+    int patchSize = 16;
+
+    /**
+     * @brief Regions are refined until the superconductor in them is at least this many grid points wide, along x
+     * and along y.
+     */
+    double featureWidth = 6.0;
+
+    /**
+     * @brief Regions are refined where |u psi_j - psi_i| exceeds this on a bond: at vortex cores and steep edges.
+     */
+    double gradient = 0.25;
+
+    /**
+     * @brief The steps of the coarsest level between regrids; 0 to keep the patches of the last regrid.
+     */
+    int regridInterval = 10;
+};
+
+/**
+ * @brief Block-structured adaptive mesh refinement of a run without screening.
+ *
+ * The mesh is a quadtree of square patches of a fixed number of grid points. Level 0 covers the superconductor with
+ * patches at the coarsest spacing; a refined patch is replaced by its four children on the next level, at half the
+ * spacing. Grid point (X, Y) of a level sits on point (2 X, 2 Y) of the next, as in multiresolution, and every level
+ * samples its geometry from the next with multiresolution::coarsen(). Regions are refined where the superconductor is
+ * narrower than RefinementParameters::featureWidth points of the level, which puts the constrictions of a SQUID on the
+ * finest grid and leaves its arms and pads coarse, and where psi changes steeply between neighbours, at vortex cores.
+ * Patches next to a refined patch are refined on the level before, so that every level is nested in the one before
+ * with a margin of a patch.
+ *
+ * Every patch keeps a ring of ghost points around it, which the solver kernel reads as neighbours. They are copied
+ * from the patches beside it, or interpolated from the level before where there are none: covariantly, as in
+ * multiresolution::prolongate(), with psi transported along the links before it is averaged. All links are the line
+ * integrals of one vector potential of the applied field, with a common origin, so a coarse link is the product of
+ * the fine links along it and every level is in the same gauge.
+ *
+ * Time steps are subcycled: forward Euler is stable for dt <= h^2 / 4, so each level takes four steps per step of the
+ * level before, with ghost values interpolated linearly in time between its two states. The finest level takes the
+ * time step of the parameters. After the steps of a level its points are injected into the level before.
+ *
+ * Patches are allocated on construction and regrid; step() only allocates when it regrids.
+ */
+class AdaptiveMesh {
+public:
+    /**
+     * @brief Constructs a mesh of a geometry and refines it around its narrow features.
+     * @param geometry The geometry at the finest spacing.
+     * @param parameters The parameters of the finest level, without screening or noise.
+     * @param refinement The levels, patch size and refinement criteria.
+     * @throws std::invalid_argument If the parameters are invalid, have screening or noise, or the geometry is too
+     * small for the levels.
+     */
+    AdaptiveMesh(const Geometry& geometry, const SolverParameters& parameters,
+                 const RefinementParameters& refinement = RefinementParameters());
+
+    /**
+     * @brief Sets psi to 1 in the superconductor on every level, the field to 0 and the time to 0, and regrids.
+     */
+    void initialize();
+
+    /**
+     * @brief Samples a state of the finest grid onto every level, and regrids until every level is refined where
+     * it is steep.
+     * @param orderParameter psi on the grid of the geometry, in the gauge of the applied field.
+     * @param appliedField The applied field of the state.
+     * @throws std::invalid_argument If the dimensions do not match.
+     */
+    void load(const ComplexField<double>& orderParameter, double appliedField);
+
+    /**
+     * @brief Takes a step of the coarsest level, and of all the levels below it. Regrids after every regrid interval.
+     * @param appliedField The applied field.
+     */
+    void step(double appliedField);
+
+    /**
+     * @brief Rebuilds the patches of all refined levels from the refinement criteria. Patches that stay keep their
+     * state, new ones are interpolated from the level before.
+     */
+    void regrid();
+
+    /**
+     * @brief Writes psi on the grid of the geometry: from the finest patch covering a point, interpolated where
+     * the patch is coarser than the grid.
+     * @param orderParameter Receives psi, of the dimensions of the geometry.
+     * @throws std::invalid_argument If the dimensions do not match.
+     */
+    void composite(ComplexField<double>& orderParameter) const;
+
+    /**
+     * @brief Accesses the simulated time.
+     * @return The time.
+     */
+    double time() const;
+
+    /**
+     * @brief Accesses the time step of the coarsest level, the time step() advances by.
+     * @return The time step.
+     */
+    double timeStep() const;
+
+    /**
+     * @brief Accesses the number of levels.
+     * @return The number of levels.
+     */
+    std::size_t levels() const;
+
+    /**
+     * @brief Accesses the number of patches on a level.
+     * @param level The level, 0 for the coarsest.
+     * @return The number of patches.
+     */
+    std::size_t patches(std::size_t level) const;
+
+    /**
+     * @brief Finds the finest level with a patch over a grid point.
+     * @param x The x coordinate on the grid of the geometry.
+     * @param y The y coordinate on the grid of the geometry.
+     * @return The level, -1 if no patch covers the point.
+     */
+    int coverage(int x, int y) const;
+
+    /**
+     * @brief Accesses the number of grid points in the patches of all levels, ghosts left out.
+     * @return The number of points.
+     */
+    std::size_t cells() const;
+
+    /**
+     * @brief Accesses the number of grid point updates of a step: four times as many per level as on the one before.
+     * A uniform grid of the finest spacing updates its points as many times as the finest level does.
+     * @return The number of updates.
+     */
+    std::size_t cellUpdates() const;
+
+private:
+    typedef std::complex<double> complex;
+
+    struct Patch {
+        /**
+         * @brief The position of the patch on its level: it covers points x P to x P + P - 1 by y P to y P + P - 1.
+         */
+        int x;
+        int y;
+
+        /**
+         * @brief psi, its next value and its value before the last step, (P + 2) x (P + 2) with the ghost ring.
+         */
+        ComplexField<double> orderParameter;
+        ComplexField<double> nextOrderParameter;
+        ComplexField<double> previousOrderParameter;
+
+        ScalarField<complex> linkingVariableX;
+        ScalarField<complex> linkingVariableY;
+        RealField cellWeight;
+        RealField linkWeightX;
+        RealField linkWeightY;
+    };
+
+    /**
+     * @brief A term of a ghost point: weight times psi at a point of a patch.
+     */
+    struct Term {
+        std::size_t patch;
+        std::size_t point;
+        complex weight;
+    };
+
+    /**
+     * @brief A ghost point in the superconductor, the sum of the terms from the end of the last ghost to end; from the
+     * level before if coarse.
+     */
+    struct Ghost {
+        std::size_t patch;
+        std::size_t point;
+        std::size_t end;
+        bool coarse;
+    };
+
+    /**
+     * @brief A term of an interpolation: weight times psi at point (x, y) of the level before.
+     */
+    struct Sample {
+        long x;
+        long y;
+        complex weight;
+    };
+
+    struct Level {
+        Geometry geometry;
+        double gridSpacing;
+        double timeStep;
+
+        /**
+         * @brief The number of patch positions along x and y, and the patch at every position, -1 for none.
+         */
+        int columns;
+        int rows;
+        std::vector<Patch> patches;
+        std::vector<int> index;
+
+        /**
+         * @brief Whether any point of the geometry at every position is in the superconductor, and whether its
+         * features ask for refinement.
+         */
+        std::vector<std::uint8_t> occupied;
+        std::vector<std::uint8_t> narrow;
+
+        std::vector<Ghost> ghosts;
+        std::vector<Term> terms;
+    };
+
+    SolverParameters _parameters;
+    RefinementParameters _refinement;
+    std::size_t _size;
+    std::vector<Level> _levels;
+    double _time;
+    std::uint64_t _steps;
+    double _appliedField;
+    VectorPotential _potential;
+
+    /**
+     * @brief Whether point (x, y) of a level is in its superconductor; false off the grid.
+     */
+    bool _inSuperconductor(std::size_t level, long x, long y) const;
+
+    /**
+     * @brief The patch covering point (x, y) of a level, -1 for none.
+     */
+    int _patchAt(std::size_t level, long x, long y) const;
+
+    /**
+     * @brief The storage index of point (x, y) of a level in the patch covering it.
+     */
+    std::size_t _pointOf(long x, long y) const;
+
+    /**
+     * @brief The covariant interpolation of point (x, y) of a level from the level before, as samples of its points.
+     */
+    void _interpolation(std::size_t level, long x, long y, std::vector<Sample>& samples) const;
+
+    /**
+     * @brief Adds a patch to a level, with its weights and links.
+     */
+    Patch& _addPatch(std::size_t level, int x, int y);
+
+    /**
+     * @brief Write the links of a patch for the applied field.
+     */
+    void _updateLinks(std::size_t level, Patch& patch) const;
+
+    /**
+     * @brief Find the sources of the ghost points of a level.
+     */
+    void _connect(std::size_t level);
+
+    /**
+     * @brief Fill the ghost points of a level, with the level before a fraction of the way through its last step.
+     */
+    void _fillGhosts(std::size_t level, double fraction);
+
+    /**
+     * @brief Step a level, and the levels below it.
+     */
+    void _advance(std::size_t level, double fraction);
+
+    /**
+     * @brief Inject the points of a level into the level before.
+     */
+    void _restrict(std::size_t level);
+
+    /**
+     * @brief Whether psi changes by more than the gradient criterion on a bond inside a patch.
+     */
+    bool _steep(const Patch& patch) const;
+
+    /**
+     * @brief Copy psi of the finest grid into the points of all patches.
+     */
+    void _sample(const ComplexField<double>& orderParameter);
+
+    /**
+     * @brief Rebuild the links and ghost sources of all patches for an applied field.
+     */
+    void _setAppliedField(double appliedField);
+};
+
+#endif //CPP_CONSTRICTION_SQUID_ADAPTIVEMESH_H
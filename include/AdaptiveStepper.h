@@ -0,0 +1,167 @@
+#ifndef CPP_CONSTRICTION_SQUID_ADAPTIVESTEPPER_H
+#define CPP_CONSTRICTION_SQUID_ADAPTIVESTEPPER_H
+
+#include "Solver.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+/**
+ * @brief Settings of the adaptive time step.
+ */
+struct AdaptiveParameters {
+    /**
+     * @brief The largest accepted error of a step: the root mean square over the superconductor of the change of psi
+     * between one full step and two half steps.
+     */
+    double tolerance = 1e-3;
+
+    /**
+     * @brief The smallest time step. A step of this size is accepted regardless of its error.
+     */
+    double minimumTimeStep = 1e-6;
+
+    /**
+     * @brief The largest time step; 0 for the stability limit of the solver.
+     */
+    double maximumTimeStep = 0.0;
+};
+
+/**
+ * @brief The outcome of one adaptive step.
+ */
+struct AdaptiveStep {
+    /**
+     * @brief The time step that was accepted.
+     */
+    double timeStep;
+
+    /**
+     * @brief The estimated error of the accepted step.
+     */
+    double error;
+
+    /**
+     * @brief The number of attempts that were rejected before it.
+     */
+    int rejections;
+};
+
+/**
+ * @brief Adapts the time step of a solver by step doubling.
+ *
+ * Every attempt takes one step of dt and, from the same state, two steps of dt / 2. The difference of the two results
+ * estimates the local error of forward Euler, which is of second order in dt; the two half steps are kept if it is
+ * within the tolerance, otherwise the state is restored and the attempt retried at a smaller dt. After each accepted
+ * step dt is scaled by 0.9 sqrt(tolerance / error), by at least 0.2 and at most 5, and kept between the minimum time
+ * step and the maximum, which is at most the stability limit. Only psi enters the error: with screening the vector
+ * potential relaxes kappa^2 times faster and is held to the stability limit instead.
+ *
+ * The state is saved in buffers allocated on construction; step() does not allocate. The solver is left with the time
+ * step of the last half step in its parameters. Runs with noise cannot be adapted, the noise of a half step would not
+ * match that of the full one.
+ * @tparam real The storage precision of the solver.
+ * @tparam link The storage of its linking variables.
+ */
+template<typename real, typename link = std::complex<real>>
+class BasicAdaptiveStepper {
+public:
+    /**
+     * @brief Constructs a stepper of a solver, which must outlive it. The first attempt uses the time step of the
+     * solver's parameters.
+     * @param solver The solver to step.
+     * @param parameters The tolerance and bounds of the time step.
+     * @throws std::invalid_argument If the tolerance or minimum time step is not positive, or the bounds are crossed.
+     */
+    BasicAdaptiveStepper(BasicSolver<real, link>& solver, const AdaptiveParameters& parameters);
+
+    /**
+     * @brief Advances the solver by one accepted step.
+     * @param appliedField The applied field, held for the whole step.
+     * @param appliedCurrent The applied current, held for the whole step.
+     * @param maximumTimeStep A bound on the time step of this step only, to land on an output time.
+     * @return The accepted time step, its error and the number of rejected attempts.
+     * @throws std::invalid_argument If the solver has noise.
+     */
+    AdaptiveStep step(double appliedField, double appliedCurrent,
+                      double maximumTimeStep = std::numeric_limits<double>::infinity());
+
+    /**
+     * @brief Accesses the time step the next attempt starts from.
+     * @return The time step.
+     */
+    double timeStep() const;
+
+    /**
+     * @brief Accesses the number of accepted steps since construction.
+     * @return The number of steps.
+     */
+    std::size_t accepted() const;
+
+    /**
+     * @brief Accesses the number of rejected attempts since construction.
+     * @return The number of attempts.
+     */
+    std::size_t rejected() const;
+
+private:
+    BasicSolver<real, link>& _solver;
+    AdaptiveParameters _parameters;
+    double _timeStep;
+    std::size_t _accepted;
+    std::size_t _rejected;
+
+    /**
+     * @brief The time and step count of the solver at the start of the step.
+     */
+    double _time;
+    std::uint64_t _steps;
+
+    /**
+     * @brief The order parameter at the start of the step.
+     */
+    ComplexField<real> _orderParameter;
+
+    /**
+     * @brief The linking variables at the start of the step, only saved with screening.
+     */
+    ScalarField<link> _linkingVariableX;
+    ScalarField<link> _linkingVariableY;
+
+    /**
+     * @brief The order parameter after the full step, then its difference to the half steps.
+     */
+    ComplexField<real> _fullStep;
+
+    /**
+     * @brief Copy the state of the superconductor and the clock of the solver into the buffers.
+     */
+    void _save();
+
+    /**
+     * @brief Copy the buffers back into the superconductor and the solver.
+     */
+    void _restore();
+
+    /**
+     * @brief Take steps of the solver.
+     * @param timeStep The time step.
+     * @param count The number of steps.
+     * @param appliedField The applied field.
+     * @param appliedCurrent The applied current.
+     */
+    void _advance(double timeStep, int count, double appliedField, double appliedCurrent);
+
+    /**
+     * @brief The error of the half steps in the superconductor against the full step.
+     * @return The root mean square of the difference over the superconductor.
+     */
+    double _error();
+};
+
+/**
+ * @brief An adaptive stepper of a solver in double precision.
+ */
+typedef BasicAdaptiveStepper<double> AdaptiveStepper;
+
+#endif //CPP_CONSTRICTION_SQUID_ADAPTIVESTEPPER_H
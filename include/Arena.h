@@ -0,0 +1,130 @@
+#ifndef CPP_CONSTRICTION_SQUID_ARENA_H
+#define CPP_CONSTRICTION_SQUID_ARENA_H
+
+#include <cstddef>
+#include <new>
+
+/**
+ * Storage of dynamic fields, recycled per thread.
+ *
+ * Every field of runtime dimensions draws its storage from here, aligned to a cache line. Outside of a Scope storage
+ * goes straight back to the heap. While a thread has a Scope open, the storage of fields it destroys is kept in a
+ * cache of that thread instead, and the next field of the same size in bytes takes it from there. A loop that creates
+ * and destroys the same temporaries every iteration then allocates only in its first iteration:
+ *
+ *     arena::Scope scratch;
+ *     for (...) {
+ *         RealField weights = density * factor;    // storage of the previous iteration
+ *         ...
+ *     }
+ *
+ * When the outermost Scope of a thread closes, its cache is returned to the heap. The caches are not shared, so
+ * nothing here takes a lock; storage freed on another thread than it was allocated on joins the cache of the thread
+ * that frees it.
+ */
+namespace arena {
+    /**
+     * @brief The alignment of all storage: a cache line, and the width of the widest vectors.
+     */
+    constexpr std::size_t alignment = 64;
+
+    /**
+     * @brief Takes storage from the cache of the calling thread, or from the heap.
+     * @param bytes The size of the storage.
+     * @return The storage, aligned to alignment.
+     * @throws std::bad_alloc If the heap is exhausted.
+     */
+    void* allocate(std::size_t bytes);
+
+    /**
+     * @brief Returns storage to the cache of the calling thread while it has a Scope open, to the heap otherwise.
+     * @param pointer The storage, as returned by allocate().
+     * @param bytes The size it was allocated with.
+     */
+    void deallocate(void* pointer, std::size_t bytes) noexcept;
+
+    /**
+     * @brief Keeps the storage of fields destroyed on this thread for reuse, until the outermost scope closes.
+     * Scopes nest and must be closed on the thread that opened them.
+     */
+    class Scope {
+    public:
+        /**
+         * @brief Opens a scope on the calling thread.
+         */
+        Scope();
+
+        /**
+         * @brief Closes the scope. The outermost one returns the cache of the thread to the heap.
+         */
+        ~Scope();
+
+        /**
+         * @brief Scopes belong to a thread and a stretch of code, they cannot be copied.
+         */
+        Scope(const Scope& other) = delete;
+
+        /**
+         * @brief Scopes belong to a thread and a stretch of code, they cannot be copied.
+         */
+        Scope& operator=(const Scope& other) = delete;
+    };
+
+    /**
+     * @brief Counters of the calling thread, since it started.
+     */
+    struct Statistics {
+        /**
+         * @brief Storage taken from the heap.
+         */
+        std::size_t allocations;
+
+        /**
+         * @brief Storage taken from the cache.
+         */
+        std::size_t reuses;
+
+        /**
+         * @brief Storage in the cache now, and its size.
+         */
+        std::size_t cachedBlocks;
+        std::size_t cachedBytes;
+    };
+
+    /**
+     * @brief Reads the counters of the calling thread.
+     * @return The counters.
+     */
+    Statistics statistics();
+
+    /**
+     * @brief A standard allocator on allocate() and deallocate(), for the storage vectors of fields.
+     */
+    template<typename T>
+    class Allocator {
+    public:
+        typedef T value_type;
+
+        Allocator() noexcept = default;
+
+        template<typename U>
+        Allocator(const Allocator<U>&) noexcept {
+        }
+
+        T* allocate(std::size_t n) {
+            static_assert(alignof(T) <= alignment, "Storage is aligned to a cache line at most");
+            return static_cast<T*>(arena::allocate(n * sizeof(T)));
+        }
+
+        void deallocate(T* pointer, std::size_t n) noexcept {
+            arena::deallocate(pointer, n * sizeof(T));
+        }
+
+        template<typename U>
+        bool operator==(const Allocator<U>&) const noexcept {
+            return true;
+        }
+    };
+}
+
+#endif //CPP_CONSTRICTION_SQUID_ARENA_H
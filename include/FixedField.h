@@ -0,0 +1,224 @@
+#ifndef CPP_CONSTRICTION_SQUID_FIXEDFIELD_H
+#define CPP_CONSTRICTION_SQUID_FIXEDFIELD_H
+
+#include "AbstractField.h"
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief A scalar field with dimensions fixed at compile time and its elements stored inline, for ensembles of small
+ * grids. A FixedField never allocates, so thousands of them fit side by side in cache, and all of its loops have
+ * constant trip counts. The element-wise operators are inline loops over W * H elements, which the compiler unrolls
+ * and vectorizes for the instruction set of the including code; where the kernel table of ScalarField has a wider
+ * variant for the element type and the CPU, they call that instead. Converts to and from ScalarField<scalar> and
+ * combines with it in the arithmetic operators.
+ * @tparam scalar The element type.
+ * @tparam W The width.
+ * @tparam H The height.
+ */
+template<typename scalar, std::size_t W, std::size_t H>
+class FixedField : public AbstractField<FixedField<scalar, W, H>, scalar, FixedStorage<scalar, W, H>> {
+public:
+    static_assert(!std::is_same_v<scalar, bool>, "Masks are not available with fixed dimensions");
+
+    /**
+     * @brief The width, as a constant expression.
+     */
+    static constexpr std::size_t fixedWidth = W;
+
+    /**
+     * @brief The height, as a constant expression.
+     */
+    static constexpr std::size_t fixedHeight = H;
+
+    /**
+     * @brief Constructs a new FixedField initialized with value 0.
+     */
+    FixedField();
+
+    /**
+     * @brief Constructs a new FixedField initialized with value 0 from its dimensions, as a ScalarField is, so that code
+     * for fields of either storage constructs them alike.
+     * @param width The width, W.
+     * @param height The height, H.
+     * @throws std::invalid_argument If the dimensions differ from W and H.
+     */
+    FixedField(int width, int height);
+
+    /**
+     * @brief Copies a ScalarField of the same dimensions.
+     * @param other The field to copy.
+     * @throws std::invalid_argument If the dimensions differ.
+     */
+    explicit FixedField(const ScalarField<scalar>& other);
+
+    /**
+     * @brief Copies the field into a ScalarField, which lets a FixedField be passed wherever one is expected.
+     * @return The copy.
+     */
+    operator ScalarField<scalar>() const;
+
+    /**
+     * @brief The storage index of a position.
+     * @param x
+     * @param y
+     * @return x * H + y.
+     */
+    static constexpr std::size_t index(std::size_t x, std::size_t y);
+
+    /**
+     * @brief Accesses the field at a given position.
+     * @param x
+     * @param y
+     * @return Value at coordinates (x,y).
+     */
+    scalar operator()(std::size_t x, std::size_t y) const;
+
+    /**
+     * @brief Accesses the field at a given position.
+     * @param x
+     * @param y
+     * @return Reference to value at coordinates (x,y)
+     */
+    scalar& operator()(std::size_t x, std::size_t y);
+
+    /**
+     * @brief Calls a stencil on every interior point, 0 < x < W - 1 and 0 < y < H - 1. The loop over y, the
+     * contiguous direction, is unrolled at compile time, so the stencil is inlined with constant offsets.
+     * @param stencil Callable as stencil(x, y).
+     */
+    template<typename Stencil>
+    void forEachInterior(Stencil&& stencil) const;
+
+    /**
+     * @brief Addition of a scalar to a field.
+     * @param val The scalar to add.
+     * @return The resulting field.
+     */
+    FixedField operator+(const scalar& val) const;
+
+    /**
+     * @brief Scalar addition of two fields.
+     * @param other The field to add.
+     * @return The resulting field.
+     */
+    FixedField operator+(const FixedField& other) const;
+
+    /**
+     * @brief Scalar addition of a field with runtime dimensions.
+     * @param other The field to add.
+     * @return The resulting field.
+     * @throws std::invalid_argument If the dimensions differ.
+     */
+    FixedField operator+(const ScalarField<scalar>& other) const;
+
+    /**
+     * @brief Subtraction of a scalar from a field.
+     * @param val The scalar to subtract.
+     * @return The resulting field.
+     */
+    FixedField operator-(const scalar& val) const;
+
+    /**
+     * @brief Scalar subtraction of two fields.
+     * @param other The field to subtract.
+     * @return The resulting field.
+     */
+    FixedField operator-(const FixedField& other) const;
+
+    /**
+     * @brief Scalar subtraction of a field with runtime dimensions.
+     * @param other The field to subtract.
+     * @return The resulting field.
+     * @throws std::invalid_argument If the dimensions differ.
+     */
+    FixedField operator-(const ScalarField<scalar>& other) const;
+
+    /**
+     * @brief Multiplication of a field by a scalar.
+     * @param val The scalar to multiply by.
+     * @return The resulting field.
+     */
+    FixedField operator*(const scalar& val) const;
+
+    /**
+     * @brief Element-wise scalar multiplication of two fields.
+     * @param other The field to multiply by.
+     * @return The resulting field.
+     */
+    FixedField operator*(const FixedField& other) const;
+
+    /**
+     * @brief Element-wise scalar multiplication by a field with runtime dimensions.
+     * @param other The field to multiply by.
+     * @return The resulting field.
+     * @throws std::invalid_argument If the dimensions differ.
+     */
+    FixedField operator*(const ScalarField<scalar>& other) const;
+
+private:
+    /**
+     * @brief Checks that a runtime field has dimensions W x H.
+     */
+    static void _checkDimensions(const ScalarField<scalar>& other);
+
+    /**
+     * @brief The product of two elements, without the special cases of std::complex that keep a loop from vectorizing.
+     */
+    static scalar _product(const scalar& a, const scalar& b);
+
+    /**
+     * @brief The entries of the kernel table for operations on two fields, and on a field and a scalar.
+     */
+    typedef decltype(&kernels::ElementwiseKernels<scalar>::add) FieldKernel;
+    typedef decltype(&kernels::ElementwiseKernels<scalar>::addScalar) ScalarKernel;
+
+    /**
+     * @brief Whether the selected kernels are wider than the inline loops, for element types the table has variants of.
+     */
+    static bool _dispatched();
+
+    /**
+     * @brief Applies an operation to the elements of this field and another field of W x H elements.
+     * @param kernel The kernel of the operation, called instead of the loop if _dispatched().
+     */
+    template<typename Operation>
+    FixedField _map(const scalar* other, FieldKernel kernel, Operation operation) const;
+
+    /**
+     * @brief Applies an operation with a scalar to every element of this field.
+     * @param kernel The kernel of the operation, called instead of the loop if _dispatched().
+     */
+    template<typename Operation>
+    FixedField _map(const scalar& val, ScalarKernel kernel, Operation operation) const;
+
+    template<typename Stencil, std::size_t... Y>
+    static void _unrolledColumn(std::size_t x, Stencil& stencil, std::index_sequence<Y...>);
+};
+
+/**
+ * @brief The storage of a superconductor and its solver on W x H grid points in FixedFields, inside the objects, so
+ * that an ensemble of small ones needs no allocation; see DynamicGrid.
+ * @tparam W The width, in grid points.
+ * @tparam H The height, in grid points.
+ */
+template<std::size_t W, std::size_t H>
+struct FixedGrid {
+    static_assert(W >= 2 && H >= 2, "Width and height must be at least 2");
+
+    template<typename T>
+    using points = FixedField<T, W, H>;
+
+    template<typename T>
+    using xBonds = FixedField<T, W - 1, H>;
+
+    template<typename T>
+    using yBonds = FixedField<T, W, H - 1>;
+
+    template<typename T>
+    using plaquettes = FixedField<T, W - 1, H - 1>;
+};
+
+#include "../src/FixedField.tpp"
+
+#endif //CPP_CONSTRICTION_SQUID_FIXEDFIELD_H
@@ -0,0 +1,94 @@
+#ifndef CPP_CONSTRICTION_SQUID_GAUGE_H
+#define CPP_CONSTRICTION_SQUID_GAUGE_H
+
+#include "AbstractField.h"
+#include "Phase.h"
+#include <array>
+#include <functional>
+
+/**
+ * @brief The gauge of the vector potential of a uniform applied field B.
+ */
+enum class Gauge {
+    /**
+     * @brief A = (-B y, 0): only the x-links carry a phase, which depends on y alone.
+     */
+    landau,
+
+    /**
+     * @brief A = B / 2 (-(y - yc), x - xc) around the centre (xc, yc) of the grid: the x-links depend on y alone and the
+     * y-links on x alone.
+     */
+    symmetric
+};
+
+/**
+ * @brief A vector potential (A_x, A_y) at a position (x, y), in coherence lengths from grid point (0, 0).
+ */
+typedef std::function<std::array<double, 2>(double x, double y)> VectorPotential;
+
+/**
+ * Linking variables of a static vector potential. Without screening the vector potential is the applied one, and the
+ * solver builds the links once from here instead of integrating them.
+ *
+ * The link on the bond from grid point i to j is exp(-i integral_i^j A . dl), in the layouts of Solver: the x-links
+ * are (width - 1) x height and the y-links width x (height - 1).
+ */
+namespace gauge {
+    /**
+     * @brief The vector potential of a uniform field.
+     * @param field The field B.
+     * @param gauge The gauge.
+     * @param width The width of the grid, in grid points.
+     * @param height The height of the grid, in grid points.
+     * @param gridSpacing The distance between neighbouring grid points.
+     * @return The vector potential.
+     */
+    VectorPotential uniformField(double field, Gauge gauge, std::size_t width, std::size_t height,
+                                 double gridSpacing);
+
+    /**
+     * @brief Builds the links of an arbitrary vector potential. The line integrals are taken with Simpson's rule,
+     * exact for potentials up to quadratic in the position.
+     * @tparam link std::complex<float>, std::complex<double> or Phase.
+     * @param potential The vector potential.
+     * @param gridSpacing The distance between neighbouring grid points.
+     * @param linkingVariableX Receives the x-links, (width - 1) x height.
+     * @param linkingVariableY Receives the y-links, width x (height - 1).
+     */
+    template<typename link>
+    void linkingVariables(const VectorPotential& potential, double gridSpacing, ScalarField<link>& linkingVariableX,
+                          ScalarField<link>& linkingVariableY);
+
+    /**
+     * @brief Builds the links of a uniform field, the same as linkingVariables() of uniformField() but in closed form.
+     * In both gauges a link only depends on one coordinate, so a single row and column of phasors are evaluated and
+     * copied across the grid.
+     * @tparam link std::complex<float>, std::complex<double> or Phase.
+     * @param field The field B.
+     * @param gauge The gauge.
+     * @param gridSpacing The distance between neighbouring grid points.
+     * @param linkingVariableX Receives the x-links, (width - 1) x height.
+     * @param linkingVariableY Receives the y-links, width x (height - 1).
+     */
+    template<typename link>
+    void uniformField(double field, Gauge gauge, double gridSpacing, ScalarField<link>& linkingVariableX,
+                      ScalarField<link>& linkingVariableY);
+
+    /**
+     * @brief uniformField() on the storage of the links, for link fields of any storage.
+     * @tparam link std::complex<float>, std::complex<double> or Phase.
+     * @param field The field B.
+     * @param gauge The gauge.
+     * @param gridSpacing The distance between neighbouring grid points.
+     * @param width The width of the grid, in grid points.
+     * @param height The height of the grid, in grid points.
+     * @param linkingVariableX Receives the x-links, (width - 1) x height.
+     * @param linkingVariableY Receives the y-links, width x (height - 1).
+     */
+    template<typename link>
+    void uniformField(double field, Gauge gauge, double gridSpacing, std::size_t width, std::size_t height,
+                      link* linkingVariableX, link* linkingVariableY);
+}
+
+#endif //CPP_CONSTRICTION_SQUID_GAUGE_H
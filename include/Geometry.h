@@ -48,6 +48,15 @@ public:
      */
     Geometry& operator=(Geometry&& other) noexcept = default;
 
+    /**
+     * @brief Builds the mask of a two-hole SQUID: a rectangular loop whose holes are separated by a central bar,
+     * with a constriction in the outer arm above each hole.
+     * @param width The width of the mask, at least 16.
+     * @param height The height of the mask, at least 16.
+     * @return The mask.
+     */
+    static Mask squidMask(int width, int height);
+
     /**
      * @brief Accesses the geometry's width.
      * @return The width.
@@ -66,6 +75,24 @@ public:
      */
     void setGeometry(const Mask& geometry);
 
+    /**
+     * @brief Accesses the superconductor as a region, for reductions over it.
+     * @return The mask of the points in the superconductor.
+     */
+    const Mask& superconductor() const;
+
+    /**
+     * @brief Accesses the vacuum not enclosed by the superconductor as a region, for masked operations on fields.
+     * @return The mask of the points in the exterior vacuum.
+     */
+    const Mask& exteriorVacuum() const;
+
+    /**
+     * @brief Accesses the vacuum enclosed by the superconductor, the holes, as a region.
+     * @return The mask of the points in the interior vacuum.
+     */
+    const Mask& interiorVacuum() const;
+
     /**
      * @brief Check whether point (x, y) is in the superconductor.
      * @param x The x coordinate.
@@ -130,6 +157,20 @@ public:
      */
     int inHole(int x, int y) const;
 
+    /**
+     * @brief Accesses the number of holes, the connected pieces of the interior vacuum.
+     * @return The number of holes.
+     */
+    int holeCount() const;
+
+    /**
+     * @brief Builds the mask of a hole. Holes are numbered in the order of their first point, by x and then y.
+     * @param index The index of the hole.
+     * @return The mask of the hole.
+     * @throws std::out_of_range If there is no such hole.
+     */
+    Mask hole(int index) const;
+
 private:
     int _width;
     int _height;
@@ -170,9 +211,21 @@ private:
     Mask _interiorVacuum;
 
     /**
-     * @brief A list of masks, each representing the holes inside the superconductor.
+     * @brief A vertical run of points bottom to top, inclusive, in column x of a hole.
+     */
+    struct HoleRun {
+        int x;
+        int bottom;
+        int top;
+        int hole;
+    };
+
+    /**
+     * @brief The holes inside the superconductor as runs, ordered by x and then y. Far smaller than a mask per hole.
      */
-    maskList _holes;
+    std::vector<HoleRun> _holeRuns;
+    int _holeCount = 0;
+
 
     /**
      * @brief Update all boundaries.
@@ -188,6 +241,13 @@ private:
      * @brief Update interior vacuum.
      */
     void _updateInteriorVacuum();
+
+    /**
+     * @brief Split the interior vacuum into holes. Points touching at a corner belong to the same hole, as the
+     * superconductor between them does not separate them. The runs of each column are joined to the overlapping runs
+     * of the previous one with a union-find.
+     */
+    void _updateHoles();
 };
 
 #endif //CPP_CONSTRICTION_SQUID_GEOMETRY_H
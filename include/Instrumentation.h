@@ -0,0 +1,151 @@
+#ifndef CPP_CONSTRICTION_SQUID_INSTRUMENTATION_H
+#define CPP_CONSTRICTION_SQUID_INSTRUMENTATION_H
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief Timers and counters for the hot paths.
+ *
+ * Code is instrumented with the SQUID_TIMED_SCOPE and SQUID_COUNT macros. They expand to nothing unless the build
+ * defines SQUID_INSTRUMENTATION (CMake option of the same name), so instrumentation costs nothing in production
+ * builds. Every thread accumulates into its own counters without locks or atomic read-modify-writes; reports sum over
+ * all threads that ever recorded anything. The counters and trace buffer of a thread that exits are taken over by the
+ * next thread that starts recording.
+ */
+namespace instrumentation {
+    /**
+     * @brief Whether the instrumentation macros are compiled in.
+     */
+#ifdef SQUID_INSTRUMENTATION
+    constexpr bool enabled = true;
+#else
+    constexpr bool enabled = false;
+#endif
+
+    /**
+     * @brief The maximum number of distinct phases.
+     */
+    constexpr int maximumPhases = 64;
+
+    /**
+     * @brief Looks up a phase by name, registering it on first use. Thread-safe, but takes a lock: call once per
+     * call site (the macros keep the result in a function-local static).
+     * @param name The phase name. Must outlive the program, typically a string literal.
+     * @return The phase index.
+     * @throws std::length_error If more than maximumPhases phases are registered.
+     */
+    int registerPhase(const char* name);
+
+    /**
+     * @brief Adds to the counters of a phase on the calling thread.
+     * @param phase The phase index.
+     * @param nanoseconds The time spent.
+     * @param cells The number of grid cells touched.
+     * @param bytes The number of bytes moved.
+     */
+    void record(int phase, std::int64_t nanoseconds, std::uint64_t cells, std::uint64_t bytes);
+
+    /**
+     * @brief Appends a trace event on the calling thread, if tracing is enabled. Events beyond the per-thread capacity
+     * are dropped and counted.
+     * @param phase The phase index.
+     * @param start The start of the event.
+     * @param end The end of the event.
+     */
+    void trace(int phase, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    /**
+     * @brief Zeroes all counters, discards all trace events and restarts the report clock. Must not race with
+     * recording threads.
+     */
+    void reset();
+
+    /**
+     * @brief Starts recording trace events. Each record allocates its event buffer once, on the first event
+     * of its first thread.
+     * @param eventsPerThread The number of events each thread can hold.
+     */
+    void enableTracing(std::size_t eventsPerThread);
+
+    /**
+     * @brief Stops recording trace events. Events recorded so far are kept.
+     */
+    void disableTracing();
+
+    /**
+     * @brief Writes the per-phase totals as JSON: time, calls, cells, bytes and achieved throughput, and the number of
+     * running threads that have recorded.
+     * @param out The stream to write to.
+     */
+    void writeReport(std::ostream& out);
+
+    /**
+     * @brief Writes all trace events in the Chrome trace-event format, for chrome://tracing or Perfetto.
+     * @param out The stream to write to.
+     */
+    void writeChromeTrace(std::ostream& out);
+
+    /**
+     * @brief Times a scope and records it on destruction.
+     */
+    class ScopedTimer {
+    public:
+        /**
+         * @brief Starts the timer.
+         * @param phase The phase index.
+         * @param cells The number of grid cells the scope touches.
+         * @param bytes The number of bytes the scope moves.
+         */
+        ScopedTimer(int phase, std::uint64_t cells, std::uint64_t bytes);
+
+        /**
+         * @brief Stops the timer and records the phase.
+         */
+        ~ScopedTimer();
+
+        /**
+         * @brief Timers measure a single scope and cannot be copied.
+         */
+        ScopedTimer(const ScopedTimer& other) = delete;
+
+        /**
+         * @brief Timers measure a single scope and cannot be copied.
+         */
+        ScopedTimer& operator=(const ScopedTimer& other) = delete;
+
+    private:
+        int _phase;
+        std::uint64_t _cells;
+        std::uint64_t _bytes;
+        std::chrono::steady_clock::time_point _start;
+    };
+}
+
+#define SQUID_CONCATENATE_(a, b) a##b
+#define SQUID_CONCATENATE(a, b) SQUID_CONCATENATE_(a, b)
+
+#ifdef SQUID_INSTRUMENTATION
+/**
+ * @brief Times the rest of the enclosing scope as the named phase.
+ */
+#define SQUID_TIMED_SCOPE(name, cells, bytes) \
+    static const int SQUID_CONCATENATE(squidPhase_, __LINE__) = instrumentation::registerPhase(name); \
+    instrumentation::ScopedTimer SQUID_CONCATENATE(squidTimer_, __LINE__)(SQUID_CONCATENATE(squidPhase_, __LINE__), \
+                                                                           (cells), (bytes))
+
+/**
+ * @brief Counts one call of the named phase, without timing it.
+ */
+#define SQUID_COUNT(name, cells, bytes) \
+    do { \
+        static const int squidPhase = instrumentation::registerPhase(name); \
+        instrumentation::record(squidPhase, 0, (cells), (bytes)); \
+    } while (0)
+#else
+#define SQUID_TIMED_SCOPE(name, cells, bytes) static_assert(true)
+#define SQUID_COUNT(name, cells, bytes) static_assert(true)
+#endif
+
+#endif //CPP_CONSTRICTION_SQUID_INSTRUMENTATION_H
@@ -0,0 +1,184 @@
+#ifndef CPP_CONSTRICTION_SQUID_JOB_H
+#define CPP_CONSTRICTION_SQUID_JOB_H
+
+#include "AbstractField.h"
+#include "AdaptiveMesh.h"
+#include "AdaptiveStepper.h"
+#include "Multigrid.h"
+#include "Multiresolution.h"
+#include "Observables.h"
+#include "Schedule.h"
+#include "Solver.h"
+#include <istream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief The grid points [x0, x1) by [y0, y1).
+ */
+struct Rectangle {
+    std::size_t x0;
+    std::size_t y0;
+    std::size_t x1;
+    std::size_t y1;
+};
+
+/**
+ * @brief A single simulation run, as described by one section of a job file.
+ *
+ * Job files are plain text. Every job starts with a "[job <name>]" header, followed by "key = value" lines:
+ *
+ *     [job ramp]
+ *     geometry = square          # "square", "squid" or the path to a mask file
+ *     width = 128                # grid points, not needed for mask files
+ *     height = 64
+ *     grid_spacing = 0.5
+ *     kappa = 2.0
+ *     time_step = 0.01           # with adaptive time steps the first one
+ *     adaptive = false           # adapt the time step to the error estimate of step doubling
+ *     tolerance = 1e-3           # largest RMS error of psi per adaptive step
+ *     min_time_step = 1e-6
+ *     max_time_step = 0          # 0 for the stability limit
+ *     refine = false             # step an adaptive mesh without screening instead of the uniform grid
+ *     refinement_levels = 3      # grids of the mesh, each with half the spacing of the one before
+ *     patch_size = 16            # grid points on a side of a patch
+ *     feature_width = 6.0        # refine where the superconductor is narrower than this many points of a level
+ *     refinement_gradient = 0.25 # refine where |u psi_j - psi_i| exceeds this on a bond
+ *     regrid_interval = 10       # steps of the coarsest grid between regrids, 0 for never
+ *     noise = 0.0                # Langevin noise strength, the temperature in units of the condensation energy
+ *     seed = 0                   # key of the noise; a noisy run is reproduced by its seed on any number of threads
+ *     temporal_blocking = 1      # steps per sweep over the grid without screening, leads, noise or transport probes
+ *     screening = true           # false: the vector potential is the applied one, links are built once per field
+ *     gauge = landau             # "symmetric"; the gauge of the applied vector potential without screening
+ *     precision = double         # "single" stores the state in float; the solver still computes in double
+ *     links = complex            # "phase" stores the linking variables as 32-bit phases
+ *     duration = 500
+ *     field = 0:0.0, 400:0.8     # time:value pairs, linearly interpolated
+ *     current = 0.0
+ *     source = 1 24 3 40         # without screening: current leads, grid points [x0, x1) by [y0, y1)
+ *     drain = 125 24 127 40
+ *     cycle = f                  # multigrid cycle of the scalar potential, "v", "w" or "f"
+ *     potential_tolerance = 1e-4 # residual of the scalar potential relative to its source
+ *     coarse_levels = 0          # relax on this many coarser grids first, each of half the resolution
+ *     coarse_duration = 100      # simulated time on every coarse grid, at the field and current at time 0
+ *     output = results/ramp      # writes results/ramp.csv and results/ramp_psi.txt
+ *     output_interval = 5.0
+ *     vortices = false           # also write results/ramp_vortices.csv and, with holes, results/ramp_fluxoids.csv
+ *     snapshots = false          # also write |psi|^2 at every output to results/ramp_psi_<output number>.txt
+ *     cut = x 63 0 64            # supercurrent in x across the bonds from column 63 to 64, rows [0, 64)
+ *     probe = 32 16              # supercurrent density at a grid point
+ *     voltage = 2 32 125 32      # voltage from the first grid point to the second
+ *     threads = 4
+ *     analysis_threads = 0       # threads that write vortices and snapshots next to the solver; 0 for in between steps
+ *     analysis_queue = 4         # outputs the analysis may fall behind before the solver waits for it
+ *     profile_interval = 60      # wall-clock seconds between intermediate profiles, 0 for only at the end
+ *     trace = false              # write a Chrome trace of all timed phases
+ *
+ * With leads the applied current enters at the source and leaves at the drain, and the scalar potential is solved for
+ * in every step; see Solver::setLeads.
+ * Adaptive runs also write results/ramp_timesteps.csv, with the time, time step, error and rejected attempts of
+ * every step; they land on every output time and cannot have noise.
+ * Refined runs take the time steps of the coarsest grid of the mesh, and write psi of the finest patch over each grid
+ * point; see AdaptiveMesh. They have no noise, leads, adaptive time steps, temporal blocking or transport probes, run
+ * in double precision with complex links.
+ * Without screening the magnetic field written at every output is the applied one.
+ * Cuts, probes and voltages may be repeated; if there are any they are sampled after every time step, and
+ * results/ramp_transport.csv receives their mean, variance, minimum and maximum over every output interval. Profiles
+ * and traces are only written by builds with SQUID_INSTRUMENTATION enabled.
+ * With analysis threads the vortices and snapshots of an output are written from a snapshot of the state while the
+ * solver goes on; the files are the same as without.
+ * Everything after a '#' is a comment. A schedule is either a single constant or a comma-separated list of
+ * time:value pairs. Mask files contain one line per row of grid points, top row first; '#' or '1' marks
+ * superconductor, '.' or '0' vacuum.
+ */
+struct Job {
+    std::string name;
+    std::string source;
+
+    std::string geometry = "square";
+    int width = 0;
+    int height = 0;
+
+    SolverParameters parameters;
+    bool singlePrecision = false;
+    bool phaseLinks = false;
+    double duration = 0.0;
+    Schedule field;
+    Schedule current;
+    std::optional<Rectangle> sourceLead;
+    std::optional<Rectangle> drainLead;
+    MultigridParameters multigrid;
+    NestedIteration nested;
+    bool adaptive = false;
+    AdaptiveParameters adaptiveParameters;
+    bool refine = false;
+    RefinementParameters refinement;
+
+    std::string output;
+    double outputInterval = 1.0;
+    bool vortices = false;
+    bool snapshots = false;
+    std::vector<CutLine> cutLines;
+    std::vector<GridPoint> probes;
+    std::vector<std::pair<GridPoint, GridPoint>> voltageProbes;
+    int threads = 1;
+    int analysisThreads = 0;
+    int analysisQueue = 4;
+
+    double profileInterval = 0.0;
+    bool trace = false;
+
+    /**
+     * @brief The mask of the geometry, empty for the default square.
+     */
+    std::optional<Mask> mask;
+
+    /**
+     * @brief The grid points of a lead.
+     * @param lead The rectangle of the lead.
+     * @return The mask of its points that are on the grid.
+     */
+    Mask leadMask(const Rectangle& lead) const;
+
+    /**
+     * @brief The number of fixed time steps needed to cover the duration.
+     * @return The number of steps.
+     */
+    long steps() const;
+};
+
+/**
+ * @brief Parses job descriptions. The jobs are not validated.
+ * @param in The stream to read from.
+ * @param source The name of the stream, used in error messages.
+ * @return The jobs, in order of appearance.
+ * @throws std::invalid_argument On syntax errors, unknown keys and malformed values.
+ */
+std::vector<Job> parseJobs(std::istream& in, const std::string& source);
+
+/**
+ * @brief Reads, parses and validates all jobs in a job file. Mask files are loaded relative to the working directory.
+ * @param path The path of the job file.
+ * @return The jobs, in order of appearance.
+ * @throws std::invalid_argument If the file cannot be read or any job is invalid.
+ */
+std::vector<Job> readJobFile(const std::string& path);
+
+/**
+ * @brief Loads the mask file of a job, if any, and checks that the job can be run.
+ * @param job The job to validate.
+ * @throws std::invalid_argument If the job is invalid.
+ */
+void validateJob(Job& job);
+
+/**
+ * @brief Reads a mask file.
+ * @param in The stream to read from.
+ * @return The mask, with the first line of the file as the top row (largest y).
+ * @throws std::invalid_argument If the rows are ragged or contain unknown characters.
+ */
+Mask readMask(std::istream& in);
+
+#endif //CPP_CONSTRICTION_SQUID_JOB_H
@@ -0,0 +1,132 @@
+#ifndef CPP_CONSTRICTION_SQUID_KERNELCOST_H
+#define CPP_CONSTRICTION_SQUID_KERNELCOST_H
+
+#include <complex>
+
+/**
+ * @brief Memory traffic and arithmetic of a kernel, per grid cell.
+ *
+ * Bytes follow the STREAM convention: every array the kernel reads or writes counts once, assuming perfect cache reuse
+ * of stencil neighbours and no write-allocate traffic. Flops count real additions and multiplications; a complex
+ * multiplication is 6, a complex addition 2. std::arg and std::polar are counted as transcendentalFlops each, about
+ * the cost of the polynomial approximations behind them.
+ */
+struct KernelCost {
+    const char* name;
+    double bytesPerCell;
+    double flopsPerCell;
+
+    /**
+     * @brief The arithmetic intensity.
+     * @return Flops per byte.
+     */
+    constexpr double intensity() const {
+        return bytesPerCell > 0.0 ? flopsPerCell / bytesPerCell : 0.0;
+    }
+};
+
+namespace kernelCost {
+    constexpr double transcendentalFlops = 20.0;
+
+    /**
+     * @brief The solver kernels for a storage precision and link type. Psi is a std::complex<real>, the weights and
+     * the field are real, the scalar potential and the divergence are double; the kernels compute in double either way.
+     */
+    template<typename real, typename link>
+    struct Solver {
+        static constexpr double psi = 2 * sizeof(real);
+        static constexpr double links = 2 * sizeof(link);
+        static constexpr double weight = sizeof(real);
+
+        /**
+         * @brief Solver::_updateFluxCells: reads both linking variables, writes the flux cell phasor and the field.
+         * Three complex multiplications, one arg and a scaling.
+         */
+        static constexpr KernelCost fluxCells{"flux_cells", links + sizeof(link) + weight,
+                                              3 * 6 + transcendentalFlops + 1};
+
+        /**
+         * @brief Solver::_updateOrderParameter: reads psi, both linking variables and three weights, writes psi. Four
+         * bond terms of 12 flops and 16 flops for the nonlinear term and the Euler update.
+         */
+        static constexpr KernelCost orderParameter{"psi_update", psi + links + 3 * weight + psi, 4 * 12 + 16};
+
+        /**
+         * @brief Solver::_updateLinkingVariables: reads psi, the field and two weights, rewrites both linking
+         * variables. Per bond two complex multiplications, a polar, a complex multiplication and 7 real operations.
+         */
+        static constexpr KernelCost linkingVariables{"link_update", psi + 2 * links + 2 * weight + weight,
+                                                     2 * (2 * 6 + transcendentalFlops + 6 + 7)};
+
+        /**
+         * @brief Solver::_addThermalNoise: reads the cell weight, rewrites psi. Ten Philox rounds of 2 multiplications
+         * and 6 integer operations, a logarithm and a square root, and the phasor of the angle.
+         */
+        static constexpr KernelCost thermalNoise{"thermal_noise", weight + 2 * psi,
+                                                 10 * 8 + 2 * transcendentalFlops + 12 + 6};
+
+        /**
+         * @brief Solver::_updateScalarPotential, without the multigrid: reads psi, both linking variables and two
+         * weights, writes the divergence. Four bond products of 8 flops and their weighted sum.
+         */
+        static constexpr KernelCost supercurrentDivergence{"supercurrent_divergence",
+                                                           psi + links + 2 * weight + sizeof(double), 4 * 8 + 7};
+
+        /**
+         * @brief Solver::_applyScalarPotential: reads the potential, rewrites psi. A sine, a cosine and a complex
+         * multiplication.
+         */
+        static constexpr KernelCost scalarPotential{"scalar_potential", sizeof(double) + 2 * psi,
+                                                    2 * transcendentalFlops + 1 + 6};
+    };
+
+    // The solver kernels in double precision with complex links
+    constexpr KernelCost fluxCells = Solver<double, std::complex<double>>::fluxCells;
+    constexpr KernelCost orderParameter = Solver<double, std::complex<double>>::orderParameter;
+    constexpr KernelCost linkingVariables = Solver<double, std::complex<double>>::linkingVariables;
+    constexpr KernelCost thermalNoise = Solver<double, std::complex<double>>::thermalNoise;
+    constexpr KernelCost supercurrentDivergence = Solver<double, std::complex<double>>::supercurrentDivergence;
+    constexpr KernelCost scalarPotential = Solver<double, std::complex<double>>::scalarPotential;
+
+    /**
+     * @brief A full solver step.
+     */
+    constexpr KernelCost solverStep{"solver_step",
+                                    fluxCells.bytesPerCell + orderParameter.bytesPerCell
+                                    + linkingVariables.bytesPerCell,
+                                    fluxCells.flopsPerCell + orderParameter.flopsPerCell
+                                    + linkingVariables.flopsPerCell};
+
+    /**
+     * @brief ScalarField<complex>::fill.
+     */
+    constexpr KernelCost fieldFill{"field_fill", 16, 0};
+
+    /**
+     * @brief ScalarField<complex> operator+ and operator- with a scalar. The result is zero-filled on construction
+     * before it is written.
+     */
+    constexpr KernelCost fieldAddScalar{"field_add_scalar", 16 + 16 + 16, 2};
+
+    /**
+     * @brief ScalarField<complex> operator+ and operator- with a field.
+     */
+    constexpr KernelCost fieldAddField{"field_add_field", 16 + 16 + 16 + 16, 2};
+
+    /**
+     * @brief ScalarField<complex> operator* with a scalar.
+     */
+    constexpr KernelCost fieldMultiplyScalar{"field_multiply_scalar", 16 + 16 + 16, 6};
+
+    /**
+     * @brief ScalarField<complex> operator* with a field.
+     */
+    constexpr KernelCost fieldMultiplyField{"field_multiply_field", 16 + 16 + 16 + 16, 6};
+
+    /**
+     * @brief ScalarField<double> operator* with a field.
+     */
+    constexpr KernelCost realMultiplyField{"real_multiply_field", 8 + 8 + 8 + 8, 1};
+}
+
+#endif //CPP_CONSTRICTION_SQUID_KERNELCOST_H
@@ -0,0 +1,441 @@
+#ifndef CPP_CONSTRICTION_SQUID_KERNELS_H
+#define CPP_CONSTRICTION_SQUID_KERNELS_H
+
+#include "Phase.h"
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <type_traits>
+
+/**
+ * Multi-versioned kernels of the hot field, mask and solver loops.
+ *
+ * Every kernel is compiled once per instruction set, each variant in its own translation unit with its own -m flags,
+ * and the widest variant the CPU supports is selected on first use. The environment variable SQUID_ISA (scalar,
+ * sse4.2, avx2 or avx512) overrides the choice, which is how the variants are compared against each other. Variants
+ * may differ in the last bits because the wider ones contract multiply-adds into FMAs.
+ */
+namespace kernels {
+    /**
+     * @brief The instruction sets kernels are compiled for, from narrow to wide.
+     */
+    enum class InstructionSet {
+        scalar,
+        sse42,
+        avx2,
+        avx512
+    };
+
+    /**
+     * @brief The widest instruction set the including code is compiled for, as the kernel variants of it are. Inline
+     * loops of code built with the default flags run narrower than the kernels selected for a newer CPU.
+     */
+#if defined(__AVX512F__) && defined(__AVX512DQ__) && defined(__AVX512VL__) && defined(__FMA__)
+    constexpr InstructionSet compiledInstructionSet = InstructionSet::avx512;
+#elif defined(__AVX2__) && defined(__FMA__)
+    constexpr InstructionSet compiledInstructionSet = InstructionSet::avx2;
+#elif defined(__SSE4_2__)
+    constexpr InstructionSet compiledInstructionSet = InstructionSet::sse42;
+#else
+    constexpr InstructionSet compiledInstructionSet = InstructionSet::scalar;
+#endif
+
+    /**
+     * @brief Element-wise kernels on contiguous arrays of n elements. Outputs may alias inputs. The masked kernels
+     * only write the elements whose bit is set in the bit-packed mask, as Mask stores it, and leave the others.
+     */
+    template<typename T>
+    struct ElementwiseKernels {
+        void (*fill)(T* out, T value, std::size_t n);
+        void (*add)(const T* a, const T* b, T* out, std::size_t n);
+        void (*subtract)(const T* a, const T* b, T* out, std::size_t n);
+        void (*multiply)(const T* a, const T* b, T* out, std::size_t n);
+        void (*addScalar)(const T* a, T value, T* out, std::size_t n);
+        void (*subtractScalar)(const T* a, T value, T* out, std::size_t n);
+        void (*multiplyScalar)(const T* a, T value, T* out, std::size_t n);
+        void (*fillMasked)(T* out, const std::uint64_t* mask, T value, std::size_t n);
+        void (*copyMasked)(const T* a, const std::uint64_t* mask, T* out, std::size_t n);
+        void (*multiplyScalarMasked)(T* out, const std::uint64_t* mask, T value, std::size_t n);
+    };
+
+    /**
+     * @brief The state one solver step works on, in the layouts of Solver: psi is width x height, the x-links
+     * (width - 1) x height, the y-links width x (height - 1) and the plaquettes (width - 1) x (height - 1), all with
+     * the y index running fastest.
+     * @tparam real The precision the state is stored in. The kernels compute in double precision either way, only the
+     * sines, cosines and arctangents are evaluated in the storage precision.
+     * @tparam link The type the linking variables and flux cell phasors are stored as, std::complex<real> or Phase.
+     */
+    template<typename real, typename link = std::complex<real>>
+    struct SolverArguments {
+        std::size_t width;
+        std::size_t height;
+        double gridSpacing;
+        double timeStep;
+        double kappa;
+
+        /**
+         * @brief The applied field and transport current; only read by the link update.
+         */
+        double appliedField;
+        double appliedCurrent;
+
+        const real* cellWeight;
+        const real* linkWeightX;
+        const real* linkWeightY;
+        const std::complex<real>* orderParameter;
+        std::complex<real>* nextOrderParameter;
+        link* linkingVariableX;
+        link* linkingVariableY;
+        link* fluxCellPhasor;
+        real* magneticField;
+
+        /**
+         * @brief The Langevin noise of the step: each component of psi at each grid point receives noiseAmplitude
+         * times a standard normal variate drawn from the counter-based generator keyed by seed, at counter (step,
+         * storage index). Only read by the noise kernel.
+         */
+        double noiseAmplitude;
+        std::uint64_t seed;
+        std::uint64_t step;
+    };
+
+    /**
+     * @brief The tiles several steps of psi are taken on at once, and their scratch space: 3 (steps - 1) (tileHeight
+     * + 2 (steps - 1)) values for each thread of the parallel region, which its tiles take in turn so that the ring
+     * stays in cache.
+     */
+    template<typename real>
+    struct TemporalTiling {
+        int steps;
+        std::size_t tileWidth;
+        std::size_t tileHeight;
+        std::complex<real>* scratch;
+    };
+
+    /**
+     * @brief The three phases of Solver::step and its thermal noise, see there, and the vortex detection of Vorticity.
+     */
+    template<typename real, typename link = std::complex<real>>
+    struct SolverKernels {
+        void (*fluxCells)(const SolverArguments<real, link>& arguments);
+        void (*orderParameter)(const SolverArguments<real, link>& arguments);
+        void (*linkingVariables)(const SolverArguments<real, link>& arguments);
+
+        /**
+         * @brief Writes the winding number of the gauge-invariant phase around every plaquette, in the layout of the
+         * flux cells; 0 on plaquettes with a corner outside of the superconductor.
+         */
+        void (*windingNumbers)(const SolverArguments<real, link>& arguments, int* winding);
+
+        /**
+         * @brief Adds the Langevin noise of a step to the next order parameter, in the superconductor only. The
+         * variates do not depend on the instruction set or the number of threads, apart from the last bits.
+         */
+        void (*thermalNoise)(const SolverArguments<real, link>& arguments);
+
+        /**
+         * @brief Writes the supercurrent leaving every grid point, summed over its bonds in the superconductor and
+         * multiplied by the grid spacing, in the layout of psi; 0 on the edge of the grid.
+         */
+        void (*supercurrentDivergence)(const SolverArguments<real, link>& arguments, double* divergence);
+
+        /**
+         * @brief Rotates the next order parameter by exp(-i phi dt), for a scalar potential phi in the layout of psi.
+         */
+        void (*scalarPotential)(const SolverArguments<real, link>& arguments, const double* potential);
+
+        /**
+         * @brief Takes tiling.steps steps of psi from the order parameter into the next order parameter, with the
+         * links fixed, by overlapped time-skewed tiles; bitwise the same as as many calls of orderParameter. The order
+         * parameter is left as it is.
+         */
+        void (*orderParameterSteps)(const SolverArguments<real, link>& arguments, const TemporalTiling<real>& tiling);
+    };
+
+    /**
+     * @brief One level of the multigrid solver of the scalar potential, all fields width x height with the y index
+     * running fastest. The conductances are those of the bonds to (x + 1, y) and (x, y + 1); grid points with an inverse
+     * diagonal of 0 are not solved for. Points on the edge of the grid are never solved for.
+     */
+    struct MultigridArguments {
+        std::size_t width;
+        std::size_t height;
+        const double* conductanceX;
+        const double* conductanceY;
+        const double* inverseDiagonal;
+        const double* source;
+        double* potential;
+        double* residual;
+    };
+
+    /**
+     * @brief Multigrid levels of fewer points than this are too small to be worth the threads, in the kernels and in
+     * Multigrid itself.
+     */
+    constexpr std::size_t multigridParallelPoints = 16384;
+
+    /**
+     * @brief The smoother and residual of Multigrid, for the operator (L phi)_i = sum_j c_ij (phi_i - phi_j).
+     */
+    struct MultigridKernels {
+        /**
+         * @brief A Gauss-Seidel sweep over the points with (x + y) % 2 == colour. Their neighbours are all of the
+         * other colour, so the points of one colour are independent and the result does not depend on the threads.
+         */
+        void (*smooth)(const MultigridArguments& arguments, int colour);
+
+        /**
+         * @brief Writes source - L potential into the residual, 0 where the point is not solved for.
+         */
+        void (*residual)(const MultigridArguments& arguments);
+    };
+
+    /**
+     * @brief The number of partial sums the reduction kernels keep.
+     */
+    constexpr std::size_t reductionLanes = 8;
+
+    /**
+     * @brief Reductions of n contiguous doubles; complex numbers are pairs of them. The summing kernels add value i to
+     * lane i % reductionLanes in order of i and write the lanes out, so their result only depends on n and the values.
+     * Combining lanes and blocks in a fixed order is left to Reductions.h.
+     */
+    struct ReductionKernels {
+        void (*sum)(const double* a, std::size_t n, double* lanes);
+
+        /**
+         * @brief Sums a_i b_i.
+         */
+        void (*dot)(const double* a, const double* b, std::size_t n, double* lanes);
+
+        /**
+         * @brief Sums a_i b_(i xor 1): for pairs, the cross terms of a complex product.
+         */
+        void (*crossDot)(const double* a, const double* b, std::size_t n, double* lanes);
+
+        /**
+         * @brief Sums of the n real or complex elements from element first on, a multiple of 64, whose bit in mask
+         * is set; of their values or of the squares of their values.
+         */
+        void (*maskedSum)(const double* a, const std::uint64_t* mask, std::size_t first, std::size_t n,
+                          double* lanes);
+        void (*maskedSumComplex)(const double* a, const std::uint64_t* mask, std::size_t first, std::size_t n,
+                                 double* lanes);
+        void (*maskedSquares)(const double* a, const std::uint64_t* mask, std::size_t first, std::size_t n,
+                              double* lanes);
+        void (*maskedSquaresComplex)(const double* a, const std::uint64_t* mask, std::size_t first, std::size_t n,
+                                     double* lanes);
+
+        double (*maxAbs)(const double* a, std::size_t n);
+
+        /**
+         * @brief The largest squared modulus of n complex numbers.
+         */
+        double (*maxNorm)(const double* a, std::size_t n);
+
+        /**
+         * @brief The number of set bits in n words.
+         */
+        std::uint64_t (*popcount)(const std::uint64_t* words, std::size_t n);
+    };
+
+    /**
+     * @brief All kernels of one instruction set.
+     */
+    struct KernelTable {
+        InstructionSet instructionSet;
+        ElementwiseKernels<std::complex<double>> complexField;
+        ElementwiseKernels<double> realField;
+
+        /**
+         * @brief Mask operations on n elements, bit-packed in 64-bit words. The bits beyond the last element are
+         * written as 0.
+         */
+        void (*maskNot)(const std::uint64_t* a, std::uint64_t* out, std::size_t n);
+        void (*maskOr)(const std::uint64_t* a, const std::uint64_t* b, std::uint64_t* out, std::size_t n);
+
+        ReductionKernels reductions;
+        MultigridKernels multigrid;
+
+        SolverKernels<double> doublePrecision;
+        SolverKernels<float> singlePrecision;
+        SolverKernels<double, Phase> doublePrecisionPhases;
+        SolverKernels<float, Phase> singlePrecisionPhases;
+
+        /**
+         * @brief Runs multiplyAddChains independent multiply-add chains of a number of steps each on the calling
+         * thread, in the vectors of the instruction set, and returns their sum: the compute roof of Roofline.
+         */
+        std::size_t multiplyAddChains;
+        double (*multiplyAdd)(long iterations);
+    };
+
+    /**
+     * @brief The name of an instruction set, as accepted by SQUID_ISA.
+     * @param instructionSet The instruction set.
+     * @return The name.
+     */
+    const char* name(InstructionSet instructionSet);
+
+    /**
+     * @brief Checks whether kernels were compiled for an instruction set and the CPU can run them.
+     * @param instructionSet The instruction set.
+     * @return True if table() can be called for it.
+     */
+    bool supported(InstructionSet instructionSet);
+
+    /**
+     * @brief Picks the instruction set to run on.
+     * @param request The requested instruction set name, or nullptr for the widest supported one.
+     * @param warnings Receives a message if the request is unknown or unsupported.
+     * @return The requested instruction set if supported; otherwise the widest supported one that is not wider.
+     */
+    InstructionSet select(const char* request, std::ostream& warnings);
+
+    /**
+     * @brief Accesses the kernels of a specific instruction set.
+     * @param instructionSet The instruction set.
+     * @return The kernels.
+     * @throws std::invalid_argument If the instruction set is not supported.
+     */
+    const KernelTable& table(InstructionSet instructionSet);
+
+    /**
+     * @brief Accesses the kernels selected at startup, from the CPU and SQUID_ISA.
+     * @return The kernels.
+     */
+    const KernelTable& active();
+
+    /**
+     * @brief Accesses the selected solver kernels for a storage precision.
+     * @tparam real float or double.
+     * @tparam link std::complex<real> or Phase.
+     * @return The kernels.
+     */
+    template<typename real, typename link = std::complex<real>>
+    const SolverKernels<real, link>& solver() {
+        if constexpr (std::is_same_v<real, float> && std::is_same_v<link, Phase>) {
+            return active().singlePrecisionPhases;
+        } else if constexpr (std::is_same_v<link, Phase>) {
+            return active().doublePrecisionPhases;
+        } else if constexpr (std::is_same_v<real, float>) {
+            return active().singlePrecision;
+        } else {
+            return active().doublePrecision;
+        }
+    }
+
+    /**
+     * @brief Whether the element-wise kernels of T are multi-versioned.
+     */
+    template<typename T>
+    constexpr bool dispatched = std::is_same_v<T, std::complex<double>> || std::is_same_v<T, double>;
+
+    /**
+     * @brief Portable element-wise kernels, for element types without multi-versioned ones.
+     */
+    namespace generic {
+        template<typename T>
+        void fill(T* out, T value, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = value;
+            }
+        }
+
+        template<typename T>
+        void add(const T* a, const T* b, T* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = a[i] + b[i];
+            }
+        }
+
+        template<typename T>
+        void subtract(const T* a, const T* b, T* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = a[i] - b[i];
+            }
+        }
+
+        template<typename T>
+        void multiply(const T* a, const T* b, T* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = a[i] * b[i];
+            }
+        }
+
+        template<typename T>
+        void addScalar(const T* a, T value, T* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = a[i] + value;
+            }
+        }
+
+        template<typename T>
+        void subtractScalar(const T* a, T value, T* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = a[i] - value;
+            }
+        }
+
+        template<typename T>
+        void multiplyScalar(const T* a, T value, T* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = a[i] * value;
+            }
+        }
+
+        inline bool maskBit(const std::uint64_t* mask, std::size_t i) {
+            return (mask[i / 64] >> (i % 64)) & 1u;
+        }
+
+        template<typename T>
+        void fillMasked(T* out, const std::uint64_t* mask, T value, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                if (maskBit(mask, i)) {
+                    out[i] = value;
+                }
+            }
+        }
+
+        template<typename T>
+        void copyMasked(const T* a, const std::uint64_t* mask, T* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                if (maskBit(mask, i)) {
+                    out[i] = a[i];
+                }
+            }
+        }
+
+        template<typename T>
+        void multiplyScalarMasked(T* out, const std::uint64_t* mask, T value, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                if (maskBit(mask, i)) {
+                    out[i] *= value;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Accesses the element-wise kernels of an element type.
+     * @return The selected variant for dispatched types, the portable kernels otherwise.
+     */
+    template<typename T>
+    const ElementwiseKernels<T>& elementwise() {
+        if constexpr (std::is_same_v<T, std::complex<double>>) {
+            return active().complexField;
+        } else if constexpr (std::is_same_v<T, double>) {
+            return active().realField;
+        } else {
+            static const ElementwiseKernels<T> portable{
+                    generic::fill<T>, generic::add<T>, generic::subtract<T>, generic::multiply<T>,
+                    generic::addScalar<T>, generic::subtractScalar<T>, generic::multiplyScalar<T>,
+                    generic::fillMasked<T>, generic::copyMasked<T>, generic::multiplyScalarMasked<T>};
+            return portable;
+        }
+    }
+}
+
+#endif //CPP_CONSTRICTION_SQUID_KERNELS_H
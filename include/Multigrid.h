@@ -0,0 +1,210 @@
+#ifndef CPP_CONSTRICTION_SQUID_MULTIGRID_H
+#define CPP_CONSTRICTION_SQUID_MULTIGRID_H
+
+#include "AbstractField.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief The order in which a multigrid cycle visits the coarser grids.
+ */
+enum class Cycle {
+    /**
+     * @brief Once per level.
+     */
+    v,
+
+    /**
+     * @brief Twice per level: more work on the coarse grids, for hard problems.
+     */
+    w,
+
+    /**
+     * @brief An F-cycle on the next level followed by a V-cycle there; between V and W in cost and robustness.
+     */
+    f
+};
+
+/**
+ * @brief Settings of the multigrid solver.
+ */
+struct MultigridParameters {
+    Cycle cycle = Cycle::f;
+
+    /**
+     * @brief The red-black sweeps before and after every coarse-grid correction.
+     */
+    int smoothing = 2;
+
+    /**
+     * @brief The largest number of cycles per solve.
+     */
+    int maximumCycles = 30;
+
+    /**
+     * @brief The norm of the residual to reach, relative to that of the source.
+     */
+    double tolerance = 1e-4;
+};
+
+/**
+ * @brief Geometric multigrid for the Poisson problem of the scalar potential on a masked domain.
+ *
+ * Solves (L phi)_i = sum_j c_ij (phi_i - phi_j) = f_i on the grid points of the domain, where j runs over the four
+ * neighbours and c_ij is 1 on bonds with both ends in the domain and 0 elsewhere: the finite volume Laplacian times
+ * -h^2, with no flux through the edge of the domain. The problem is singular; the source is projected to zero mean on
+ * every connected part of the domain, and the solution is returned with zero mean on each.
+ *
+ * The grids are cell-centred: coarse point (X, Y) covers the fine points 2 X - 1 and 2 X by 2 Y - 1 and 2 Y, and is in
+ * the coarse domain if any of them is. Its bonds have half the conductance of the fine bonds crossing them, which
+ * rediscretizes the Laplacian at twice the spacing and follows the mask down to the coarsest grid. Corrections are
+ * interpolated bilinearly over the coarse points the fine point is connected to, so that they do not leak across slots
+ * in the domain, and residuals restricted by the transpose. The smoother is red-black Gauss-Seidel, whose result does
+ * not depend on the number of threads.
+ *
+ * The coarse grids cannot resolve constrictions a few points wide, such as the weak links of a SQUID, and a cycle
+ * alone converges slowly on them. Every cycle therefore preconditions a step of flexible conjugate gradients, which
+ * removes the few slow modes the constrictions leave.
+ *
+ * All levels are allocated on construction; solve() does not allocate.
+ */
+class Multigrid {
+public:
+    /**
+     * @brief Builds the levels for a domain.
+     * @param domain The grid points to solve for. Points on the edge of the grid are left out.
+     * @param parameters The cycle and tolerance.
+     */
+    explicit Multigrid(const Mask& domain, const MultigridParameters& parameters = MultigridParameters());
+
+    /**
+     * @brief Solves for the potential, starting from its current value: the previous solution makes a good start for
+     * a source that changed little.
+     * @param potential The start, overwritten with the solution; 0 outside of the domain.
+     * @param source The source f, of the dimensions of the domain.
+     * @return The number of cycles taken.
+     * @throws std::invalid_argument If the dimensions do not match.
+     */
+    int solve(RealField& potential, const RealField& source);
+
+    /**
+     * @brief Applies the operator.
+     * @param potential The potential.
+     * @param result L potential, 0 outside of the domain.
+     */
+    void apply(const RealField& potential, RealField& result);
+
+    /**
+     * @brief Accesses the settings.
+     * @return The cycle and tolerance.
+     */
+    const MultigridParameters& parameters() const;
+
+    /**
+     * @brief Accesses the number of grids, the finest included.
+     * @return The number of levels.
+     */
+    std::size_t levels() const;
+
+    /**
+     * @brief Accesses the residual norm of the last solve, relative to that of the source.
+     * @return The relative residual.
+     */
+    double residual() const;
+
+private:
+    struct Level {
+        std::size_t width;
+        std::size_t height;
+        RealField conductanceX;
+        RealField conductanceY;
+        RealField inverseDiagonal;
+        RealField source;
+        RealField potential;
+        RealField residual;
+
+        /**
+         * @brief For every grid point, which of the coarse points around its parent it interpolates from; see
+         * _connect(). Empty on the coarsest level.
+         */
+        std::vector<std::uint8_t> interpolation;
+
+        /**
+         * @brief The connected part of the domain of every grid point, -1 outside of it, and the number of points
+         * in each part.
+         */
+        std::vector<int> component;
+        std::vector<double> componentSize;
+
+        /**
+         * @brief The blocks the sums over the parts are taken in, and scratch space for their sums.
+         */
+        std::size_t componentBlocks;
+        std::vector<double> componentSum;
+    };
+
+    MultigridParameters _parameters;
+    std::vector<Level> _levels;
+    double _residual;
+
+    /**
+     * @brief The search direction of the conjugate gradients and the operator applied to it, on the finest grid.
+     */
+    RealField _direction;
+    RealField _image;
+
+    /**
+     * @brief Build a level from its conductances: the inverse diagonal and the connected parts.
+     * @param level The level, with its conductances set.
+     */
+    static void _finish(Level& level);
+
+    /**
+     * @brief Subtract the mean over every connected part.
+     * @param level The level whose parts to use.
+     * @param field The field to project, of the dimensions of the level.
+     */
+    static void _project(Level& level, RealField& field);
+
+    /**
+     * @brief Run red-black sweeps, red first or black first.
+     */
+    static void _smooth(Level& level, int sweeps, bool redFirst);
+
+    /**
+     * @brief Write the residual of a level.
+     */
+    static void _computeResidual(Level& level);
+
+    /**
+     * @brief Write the residual of another potential on a level, with the source of the level.
+     */
+    static void _computeResidual(Level& level, double* potential, RealField& residual);
+
+    /**
+     * @brief Find the coarse points every point of a level interpolates from: its parent, and the points beside the
+     * parent toward it along x, along y and diagonally if they are connected to the parent, so that corrections do not
+     * leak across slots in the domain.
+     * @param level The level, whose next level has its conductances set.
+     */
+    void _connect(std::size_t level);
+
+    /**
+     * @brief Restrict the residual of a level into the source of the next by the transpose of the interpolation, and
+     * clear its potential.
+     */
+    void _restrict(std::size_t level);
+
+    /**
+     * @brief Add the interpolation of the potential of the next level to that of a level.
+     */
+    void _prolongate(std::size_t level);
+
+    /**
+     * @brief Run a cycle from a level down.
+     */
+    void _cycle(std::size_t level, Cycle cycle);
+};
+
+#endif //CPP_CONSTRICTION_SQUID_MULTIGRID_H
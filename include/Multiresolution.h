@@ -0,0 +1,90 @@
+#ifndef CPP_CONSTRICTION_SQUID_MULTIRESOLUTION_H
+#define CPP_CONSTRICTION_SQUID_MULTIRESOLUTION_H
+
+#include "Geometry.h"
+#include "Solver.h"
+#include "Superconductor.h"
+
+/**
+ * @brief How far to relax a state on coarser grids before a run.
+ */
+struct NestedIteration {
+    /**
+     * @brief The number of coarser grids, each with half the resolution of the next; 0 for none.
+     */
+    int levels = 0;
+
+    /**
+     * @brief The simulated time to relax on every coarse grid.
+     */
+    double duration = 100.0;
+};
+
+/**
+ * Nested iteration: a state relaxed on a coarse grid, interpolated to a grid of twice the resolution, is a far better
+ * start than the uniform state, and relaxing on the coarse grid costs a sixteenth of the time (a quarter of the points
+ * at four times the time step).
+ *
+ * Coarse grid point (X, Y) sits on fine grid point (2 X, 2 Y), so a fine grid of width w has a coarse grid of width
+ * w / 2 + 1. The coarse geometry samples the fine one at these points, which keeps strips and holes that are at least
+ * two grid points wide. The coarse grid must resolve the applied field, with less than pi flux per coarse plaquette.
+ */
+namespace multiresolution {
+    /**
+     * @brief Coarsens a geometry to half the resolution.
+     * @param geometry The fine geometry.
+     * @return The coarse geometry: a point is in the superconductor if the fine point on it is, unless it is on the
+     * edge of the coarse grid.
+     */
+    Geometry coarsen(const Geometry& geometry);
+
+    /**
+     * @brief Interpolates a coarse state to the fine grid, covariantly: psi is transported along the links before it
+     * is averaged, so the result does not depend on the gauge of the coarse state.
+     *
+     * Each coarse link is split into two equal halves. Inside a coarse plaquette the links to its centre are chosen so
+     * that each of the four fine plaquettes carries a quarter of its flux, which keeps vortices in place. psi on the
+     * midpoints of coarse bonds is the mean of its transported ends, at the plaquette centres the mean of the
+     * transported midpoints; ends outside of the superconductor are left out.
+     * @param coarse The coarse state, of dimensions w / 2 + 1 by h / 2 + 1; only read.
+     * @param fine The fine state to write, w by h. The flux cell phasors are left to the next solver step.
+     * @param geometry The fine geometry; psi is 0 outside of its superconductor.
+     * @throws std::invalid_argument If the dimensions do not match.
+     */
+    template<typename real, typename link>
+    void prolongate(BasicSuperconductor<real, link>& coarse, BasicSuperconductor<real, link>& fine,
+                    const Geometry& geometry);
+
+    /**
+     * @brief Replaces the linking variables by those of the applied field, and transforms psi to the same gauge. The
+     * state must carry the flux of the applied field in every plaquette, modulo 2 pi.
+     * @param superconductor The state.
+     * @param appliedField The applied field.
+     * @param gauge The gauge of the applied field.
+     * @param gridSpacing The grid spacing.
+     */
+    template<typename real, typename link>
+    void toAppliedGauge(BasicSuperconductor<real, link>& superconductor, double appliedField, Gauge gauge,
+                        double gridSpacing);
+
+    /**
+     * @brief Starts a run from a state relaxed on coarser grids. On the coarsest grid the state starts out uniform;
+     * on every grid it is relaxed for the duration at a constant applied field and current, and then prolongated to
+     * the next. Coarsening stops early at grids of less than 8 points on a side, or without any superconductor.
+     *
+     * The coarse grids have twice the grid spacing of the next and four times its time step, which keeps the time
+     * step at the same fraction of the stability limit. They run without noise.
+     * @param superconductor The state to initialize, as left by Solver::initialize().
+     * @param geometry Its geometry.
+     * @param parameters The parameters of the fine grid.
+     * @param nested The number of levels and the relaxation time.
+     * @param appliedField The applied field.
+     * @param appliedCurrent The applied transport current.
+     */
+    template<typename real, typename link>
+    void initialize(BasicSuperconductor<real, link>& superconductor, const Geometry& geometry,
+                    const SolverParameters& parameters, const NestedIteration& nested, double appliedField,
+                    double appliedCurrent);
+}
+
+#endif //CPP_CONSTRICTION_SQUID_MULTIRESOLUTION_H
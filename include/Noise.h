@@ -0,0 +1,36 @@
+#ifndef CPP_CONSTRICTION_SQUID_NOISE_H
+#define CPP_CONSTRICTION_SQUID_NOISE_H
+
+#include <array>
+#include <complex>
+#include <cstdint>
+
+/**
+ * The counter-based random numbers behind the Langevin noise of the solver.
+ *
+ * A counter-based generator has no state to share or advance: a variate is the encryption of its counter under the
+ * key, so the noise of a grid point in a step is a pure function of (seed, step, point). It comes out the same on
+ * any number of threads and in any order, and costs no synchronization. The noise kernel inlines its own copy of these
+ * functions per instruction set; these are the portable reference it is tested against.
+ */
+namespace noise {
+    /**
+     * @brief Philox4x32-10 of Salmon, Moraes, Dror and Shaw, "Parallel random numbers: as easy as 1, 2, 3" (SC'11).
+     * @param counter The counter.
+     * @param key The key.
+     * @return Four independent uniformly distributed 32-bit words.
+     */
+    std::array<std::uint32_t, 4> philox(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key);
+
+    /**
+     * @brief A pair of independent standard normal variates, by the Box-Muller transform of the Philox words of
+     * counter (cell, step) and key seed, as the solver draws them.
+     * @param seed The seed.
+     * @param step The step index.
+     * @param cell The storage index of the grid point.
+     * @return The variates, as the real and imaginary part.
+     */
+    std::complex<double> gaussian(std::uint64_t seed, std::uint64_t step, std::uint64_t cell);
+}
+
+#endif //CPP_CONSTRICTION_SQUID_NOISE_H
@@ -0,0 +1,401 @@
+#ifndef CPP_CONSTRICTION_SQUID_OBSERVABLES_H
+#define CPP_CONSTRICTION_SQUID_OBSERVABLES_H
+
+#include "AbstractField.h"
+#include "Geometry.h"
+#include "Superconductor.h"
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A plaquette around which the gauge-invariant phase winds.
+ */
+struct Vortex {
+    /**
+     * @brief The plaquette, by its lower left grid point. Its centre is at ((x + 1/2) h, (y + 1/2) h).
+     */
+    std::size_t x;
+    std::size_t y;
+
+    /**
+     * @brief The winding number; positive for vortices carrying flux along a positive applied field.
+     */
+    int charge;
+};
+
+/**
+ * @brief Vortices in the superconductor and the fluxoid number of every hole of its geometry.
+ *
+ * The winding number of a plaquette is (sum over its bonds of arg(conj(psi_i) U_ij psi_j) - arg(flux cell phasor))
+ * / 2 pi, an integer that is gauge invariant. update() evaluates it on all plaquettes in one vectorized pass, without
+ * evaluating any angle, and cheaply enough to run every few steps.
+ *
+ * The fluxoid of a hole is the same sum taken along a contour around it: the bonds on the edge of the plaquettes that
+ * touch the hole, minus the flux through all of these plaquettes. Inside the hole psi vanishes, so this is the one
+ * place where the phase is evaluated, on the contour only. The contour runs through the superconductor as long as
+ * the hole is surrounded by at least two grid points of it.
+ * @tparam real The storage precision of the superconductor.
+ * @tparam link The storage of its linking variables.
+ */
+template<typename real, typename link = std::complex<real>>
+class BasicVorticity {
+public:
+    /**
+     * @brief Constructs the observables of a superconductor, which is only read. Both arguments must outlive the
+     * object.
+     * @param superconductor The superconductor.
+     * @param geometry The geometry of the superconductor, of the same dimensions.
+     */
+    BasicVorticity(BasicSuperconductor<real, link>& superconductor, const Geometry& geometry);
+
+    /**
+     * @brief Re-reads the geometry and its holes. Must be called after the geometry passed on construction has been
+     * changed.
+     */
+    void updateGeometry();
+
+    /**
+     * @brief Evaluates the winding numbers and fluxoids of the current state of the superconductor.
+     */
+    void update();
+
+    /**
+     * @brief Accesses the winding numbers, as evaluated by the last update().
+     * @return The winding number of every plaquette, (width - 1) x (height - 1); 0 on plaquettes with a corner
+     * outside of the superconductor.
+     */
+    const ScalarField<int>& windingNumbers() const;
+
+    /**
+     * @brief Lists the vortices, as evaluated by the last update().
+     * @return The plaquettes with a nonzero winding number, by x and then y.
+     */
+    std::vector<Vortex> vortices() const;
+
+    /**
+     * @brief Accesses the fluxoid numbers, as evaluated by the last update().
+     * @return The fluxoid number of every hole, in the order of Geometry::hole().
+     */
+    const std::vector<int>& fluxoids() const;
+
+private:
+    /**
+     * @brief A bond on a hole contour, oriented counterclockwise around the hole.
+     */
+    struct ContourBond {
+        bool vertical;
+        std::size_t x;
+        std::size_t y;
+        int sign;
+    };
+
+    BasicSuperconductor<real, link>& _superconductor;
+    const Geometry& _geometry;
+    std::size_t _width;
+    std::size_t _height;
+
+    /**
+     * @brief 1 on x-bonds with both ends in the superconductor; a plaquette is inside if its x-bonds are.
+     */
+    ScalarField<real> _linkWeightX;
+
+    ScalarField<int> _windingNumbers;
+    std::vector<std::vector<ContourBond>> _contours;
+
+    /**
+     * @brief Per hole, the storage indices of the plaquettes inside its contour.
+     */
+    std::vector<std::vector<std::size_t>> _enclosed;
+
+    std::vector<int> _fluxoids;
+
+    /**
+     * @brief The angle of conj(psi_i) U_ij psi_j along a bond, in its positive direction.
+     */
+    double _bondAngle(const ContourBond& bond);
+
+    /**
+     * @brief The principal angle of a flux cell phasor, from the linking variables around the plaquette.
+     */
+    double _plaquetteAngle(std::size_t x, std::size_t y);
+};
+
+/**
+ * @brief The observables of a superconductor stored in double precision.
+ */
+typedef BasicVorticity<double> Vorticity;
+
+/**
+ * @brief The mean, variance, minimum and maximum of a sampled quantity, updated in constant time and memory per sample
+ * with Welford's algorithm, which stays accurate when the spread is small compared to the mean. With samples taken at
+ * a fixed time step the mean is the time average.
+ */
+class RunningStatistics {
+public:
+    /**
+     * @brief Adds a sample.
+     * @param value The sample.
+     */
+    void add(double value);
+
+    /**
+     * @brief Forgets all samples.
+     */
+    void reset();
+
+    /**
+     * @brief The number of samples.
+     * @return The count.
+     */
+    std::size_t count() const;
+
+    /**
+     * @brief The mean of the samples.
+     * @return The mean; NaN without samples.
+     */
+    double mean() const;
+
+    /**
+     * @brief The population variance of the samples.
+     * @return The variance; NaN without samples.
+     */
+    double variance() const;
+
+    /**
+     * @brief The smallest sample.
+     * @return The minimum; NaN without samples.
+     */
+    double minimum() const;
+
+    /**
+     * @brief The largest sample.
+     * @return The maximum; NaN without samples.
+     */
+    double maximum() const;
+
+private:
+    std::size_t _count = 0;
+    double _mean = 0.0;
+
+    /**
+     * @brief The sum of squared deviations from the mean.
+     */
+    double _squares = 0.0;
+    double _minimum = 0.0;
+    double _maximum = 0.0;
+};
+
+/**
+ * @brief A straight cut through the grid, across which the supercurrent is summed.
+ */
+struct CutLine {
+    /**
+     * @brief True to sum the current in the x direction over the x-bonds from column position to position + 1,
+     * false to sum the current in the y direction over the y-bonds from row position to position + 1.
+     */
+    bool vertical;
+    std::size_t position;
+
+    /**
+     * @brief The rows (vertical cuts) or columns crossed, [begin, end).
+     */
+    std::size_t begin;
+    std::size_t end;
+};
+
+/**
+ * @brief A grid point.
+ */
+struct GridPoint {
+    std::size_t x;
+    std::size_t y;
+};
+
+/**
+ * @brief Supercurrents and voltages of a superconductor, sampled after every time step and accumulated as running
+ * statistics.
+ *
+ * The supercurrent density on the bond from grid point i to j is Im(conj(psi_i) U_ij psi_j) / h. It is only evaluated
+ * on the bonds of the cut lines and around the probes, straight from psi and the links, so no current field is ever
+ * stored and a sample costs time in proportion to the cut lengths only.
+ *
+ * The voltage between two grid points follows from the Josephson relation: it is the rate of change of the gauge
+ * invariant phase difference arg(conj(psi_from) U_path psi_to), with U_path the product of the links along a path
+ * from the first point along x and then along y. Changes are taken between consecutive samples, which must therefore
+ * be close enough in time for the phase to advance by less than pi. The voltage is in units of hbar / (2 e) per unit of
+ * time, positive if the potential at the first point is the higher one. A changing flux through the area between path
+ * and current only adds to the instantaneous voltage; it averages out over time in a stationary state. With a scalar
+ * potential phi, the difference phi_to - phi_from is added, which keeps the voltage gauge invariant.
+ * @tparam real The storage precision of the superconductor.
+ * @tparam link The storage of its linking variables.
+ */
+template<typename real, typename link = std::complex<real>>
+class BasicTransport {
+public:
+    /**
+     * @brief Constructs observables without any cut lines or probes. The superconductor is only read; both arguments
+     * must outlive the object.
+     * @param superconductor The superconductor.
+     * @param geometry The geometry of the superconductor, of the same dimensions. Bonds with an end outside of it
+     * carry no supercurrent.
+     * @param gridSpacing The distance between neighbouring grid points.
+     */
+    BasicTransport(BasicSuperconductor<real, link>& superconductor, const Geometry& geometry, double gridSpacing);
+
+    /**
+     * @brief Adds a cut line, whose statistics are those of the total supercurrent through it, h times the sum of
+     * the current densities of its bonds.
+     * @param cut The cut line.
+     * @return The index of the cut line.
+     * @throws std::invalid_argument If the cut line does not fit in the grid or is empty.
+     */
+    std::size_t addCutLine(const CutLine& cut);
+
+    /**
+     * @brief Adds a probe point, whose statistics are those of the two components of the supercurrent density, each
+     * the average over the bonds on either side of the point that are in the superconductor.
+     * @param point The point.
+     * @return The index of the probe.
+     * @throws std::invalid_argument If the point is not in the superconductor.
+     */
+    std::size_t addProbe(const GridPoint& point);
+
+    /**
+     * @brief Adds a pair of voltage probes.
+     * @param from The first point.
+     * @param to The second point.
+     * @return The index of the pair.
+     * @throws std::invalid_argument If either point is not in the superconductor.
+     */
+    std::size_t addVoltageProbe(const GridPoint& from, const GridPoint& to);
+
+    /**
+     * @brief Sets the scalar potential the voltages include, see Solver::setLeads.
+     * @param potential The potential, which must outlive the object; nullptr for none.
+     */
+    void setScalarPotential(const RealField* potential);
+
+    /**
+     * @brief Samples all cut lines and probes. The first sample of a voltage probe only fixes its phase.
+     * @param time The simulated time of the state, increasing between calls.
+     */
+    void update(double time);
+
+    /**
+     * @brief Forgets all samples, for instance to average over a new window. The voltages carry on from the last
+     * sampled phase.
+     */
+    void reset();
+
+    /**
+     * @brief Accesses the statistics of the current through a cut line.
+     * @param index The index of the cut line.
+     * @return The statistics.
+     */
+    const RunningStatistics& current(std::size_t index) const;
+
+    /**
+     * @brief Accesses the statistics of the supercurrent density at a probe.
+     * @param index The index of the probe.
+     * @return The statistics of the x component.
+     */
+    const RunningStatistics& currentDensityX(std::size_t index) const;
+
+    /**
+     * @brief Accesses the statistics of the supercurrent density at a probe.
+     * @param index The index of the probe.
+     * @return The statistics of the y component.
+     */
+    const RunningStatistics& currentDensityY(std::size_t index) const;
+
+    /**
+     * @brief Accesses the statistics of the voltage between a pair of probes.
+     * @param index The index of the pair.
+     * @return The statistics.
+     */
+    const RunningStatistics& voltage(std::size_t index) const;
+
+    /**
+     * @brief The number of cut lines.
+     */
+    std::size_t cutLines() const;
+
+    /**
+     * @brief The number of probes.
+     */
+    std::size_t probes() const;
+
+    /**
+     * @brief The number of voltage probe pairs.
+     */
+    std::size_t voltageProbes() const;
+
+private:
+    /**
+     * @brief A bond from psi index from to psi index to, over the link at index bond of the x- or y-links.
+     */
+    struct Bond {
+        bool vertical;
+        std::size_t from;
+        std::size_t to;
+        std::size_t bond;
+    };
+
+    /**
+     * @brief The bonds on either side of a probe, each in the superconductor.
+     */
+    struct Probe {
+        std::vector<Bond> x;
+        std::vector<Bond> y;
+        RunningStatistics currentX;
+        RunningStatistics currentY;
+    };
+
+    /**
+     * @brief A pair of voltage probes and the bonds of the path between them, each with its direction.
+     */
+    struct VoltageProbe {
+        std::size_t from;
+        std::size_t to;
+        std::vector<std::pair<Bond, bool>> path;
+        bool sampled = false;
+        double phase = 0.0;
+        double time = 0.0;
+        RunningStatistics voltage;
+    };
+
+    BasicSuperconductor<real, link>& _superconductor;
+    const Geometry& _geometry;
+    double _gridSpacing;
+    std::size_t _width;
+    std::size_t _height;
+
+    std::vector<std::vector<Bond>> _cutLines;
+    std::vector<RunningStatistics> _currents;
+    std::vector<Probe> _probes;
+    std::vector<VoltageProbe> _voltageProbes;
+    const RealField* _scalarPotential;
+
+    /**
+     * @brief The bond from a grid point to its neighbour in the positive x or y direction.
+     */
+    Bond _bond(std::size_t x, std::size_t y, bool vertical) const;
+
+    /**
+     * @brief Whether both ends of a bond are in the superconductor.
+     */
+    bool _active(std::size_t x, std::size_t y, bool vertical) const;
+
+    /**
+     * @brief The phasor conj(psi_from) U psi_to of a bond, whose imaginary part is h times the supercurrent density.
+     */
+    static std::complex<double> _bondProduct(const Bond& bond, const std::complex<real>* psi, const link* ux,
+                                             const link* uy);
+};
+
+/**
+ * @brief The transport observables of a superconductor stored in double precision.
+ */
+typedef BasicTransport<double> Transport;
+
+#endif //CPP_CONSTRICTION_SQUID_OBSERVABLES_H
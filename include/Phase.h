@@ -0,0 +1,75 @@
+#ifndef CPP_CONSTRICTION_SQUID_PHASE_H
+#define CPP_CONSTRICTION_SQUID_PHASE_H
+
+#include <complex>
+#include <cstdint>
+
+/**
+ * @brief A unit-modulus phasor exp(i phi) stored as its phase in 32-bit fixed point: value counts 2^-32 turns.
+ *
+ * A quarter of the size of a complex<double>. Multiplying phasors adds phases, which wraps around modulo one turn by
+ * unsigned overflow and so is exact: a product of phases never drifts off the unit circle. The resolution is
+ * 2 pi / 2^32, about 1.5e-9 radians. Default-constructed phases are 0, the phasor 1.
+ */
+struct Phase {
+    /**
+     * @brief The number of leading bits of the phase that index table().
+     */
+    static constexpr int tableBits = 10;
+
+    /**
+     * @brief Radians per unit of value.
+     */
+    static constexpr double radiansPerUnit = 6.283185307179586476925286766559 / 4294967296.0;
+
+    std::uint32_t value = 0;
+
+    /**
+     * @brief Constructs the phase 0.
+     */
+    Phase() = default;
+
+    /**
+     * @brief Constructs a phase from an angle, rounded to the nearest representable phase.
+     * @param angle The angle in radians, of any magnitude.
+     */
+    explicit Phase(double angle);
+
+    /**
+     * @brief Constructs the phase of a phasor. The modulus is discarded.
+     * @param phasor The phasor, not 0.
+     * @return The phase.
+     */
+    static Phase of(const std::complex<double>& phasor);
+
+    /**
+     * @brief The angle, in radians.
+     * @return The angle in [-pi, pi).
+     */
+    double angle() const;
+
+    /**
+     * @brief Reconstructs the phasor from the table, accurate to the last bits of a double.
+     * @return exp(i angle()).
+     */
+    std::complex<double> phasor() const;
+
+    /**
+     * @brief The product of two phasors.
+     * @param other The other phasor.
+     * @return The sum of the phases.
+     */
+    Phase operator*(const Phase& other) const;
+
+    bool operator==(const Phase& other) const = default;
+
+    /**
+     * @brief cos and sin of the 2^tableBits phases k 2 pi / 2^tableBits, interleaved. A phase is reconstructed from
+     * the entry of its leading bits, rotated by the remaining angle of less than 2 pi / 2^tableBits, whose sine and
+     * cosine converge to double precision within a few terms of their series.
+     * @return The table, 2^(tableBits + 1) values.
+     */
+    static const double* table();
+};
+
+#endif //CPP_CONSTRICTION_SQUID_PHASE_H
@@ -0,0 +1,643 @@
+#ifndef CPP_CONSTRICTION_SQUID_PIPELINE_H
+#define CPP_CONSTRICTION_SQUID_PIPELINE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * Coroutines that let analysis run next to the solver instead of in between its steps.
+ *
+ * A producer, the simulation driver, runs on its own thread. Its outputs go into bounded channels, and each channel
+ * feeds one Task: a coroutine that suspends while its channel is empty and is resumed on a ThreadPool when the next
+ * item arrives. Items are handles into a BufferPool: every buffer is allocated once, handed on without copies and
+ * reference counted, and it returns to the pool when the last stage lets go of it. A full pool or channel blocks the
+ * producer. That back-pressure bounds the memory of a run whose analysis falls behind the solver.
+ */
+namespace pipeline {
+    /**
+     * @brief A fixed set of threads that resume coroutines in the order they were posted.
+     *
+     * The workers run OpenMP regions on a single thread: the cores they would share belong to the solver.
+     */
+    class ThreadPool {
+    public:
+        /**
+         * @brief Starts the worker threads.
+         * @param threads The number of workers.
+         * @throws std::invalid_argument If threads is less than 1.
+         */
+        explicit ThreadPool(int threads);
+
+        /**
+         * @brief Resumes the coroutines still queued, then joins the workers.
+         */
+        ~ThreadPool();
+
+        /**
+         * @brief Thread pools own their threads and cannot be copied.
+         */
+        ThreadPool(const ThreadPool& other) = delete;
+
+        /**
+         * @brief Thread pools own their threads and cannot be copied.
+         */
+        ThreadPool& operator=(const ThreadPool& other) = delete;
+
+        /**
+         * @brief Queues a suspended coroutine to be resumed on a worker.
+         * @param handle The coroutine.
+         */
+        void post(std::coroutine_handle<> handle);
+
+        /**
+         * @brief Moves the awaiting coroutine to a worker.
+         * @return An awaitable that resumes on the pool.
+         */
+        auto schedule() {
+            struct Awaiter {
+                ThreadPool& pool;
+
+                bool await_ready() const noexcept {
+                    return false;
+                }
+
+                void await_suspend(std::coroutine_handle<> handle) {
+                    pool.post(handle);
+                }
+
+                void await_resume() const noexcept {
+                }
+            };
+            return Awaiter{*this};
+        }
+
+        /**
+         * @brief Accesses the number of workers.
+         * @return The number of workers.
+         */
+        int size() const;
+
+    private:
+        void _work();
+
+        std::mutex _mutex;
+        std::condition_variable _posted;
+
+        /**
+         * @brief The queued coroutines.
+         */
+        std::vector<std::coroutine_handle<>> _queue;
+
+        /**
+         * @brief The first coroutine in _queue not yet taken by a worker; the queue is compacted when it runs empty.
+         */
+        std::size_t _next = 0;
+        bool _stopping = false;
+        std::vector<std::thread> _threads;
+    };
+
+    /**
+     * @brief A coroutine that runs to completion on a thread pool, started explicitly and waited for by a thread that
+     * is not a coroutine itself.
+     *
+     * An exception that leaves the coroutine is kept and rethrown by wait(). A started task is waited for on
+     * destruction, so whatever it awaits must be released first.
+     */
+    class Task {
+    public:
+        struct promise_type {
+            std::mutex mutex;
+            std::condition_variable finished;
+            bool done = false;
+            std::exception_ptr error;
+
+            Task get_return_object() {
+                return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() noexcept {
+                return {};
+            }
+
+            auto final_suspend() noexcept {
+                struct Awaiter {
+                    bool await_ready() const noexcept {
+                        return false;
+                    }
+
+                    void await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+                        promise_type& promise = handle.promise();
+                        std::lock_guard<std::mutex> lock(promise.mutex);
+                        promise.done = true;
+                        promise.finished.notify_all();
+                    }
+
+                    void await_resume() const noexcept {
+                    }
+                };
+                return Awaiter{};
+            }
+
+            void return_void() {
+            }
+
+            void unhandled_exception() {
+                error = std::current_exception();
+            }
+        };
+
+        /**
+         * @brief Constructs a Task that holds no coroutine.
+         */
+        Task() = default;
+
+        /**
+         * @brief Waits for a started coroutine and destroys it. Its exception, if any, is dropped.
+         */
+        ~Task();
+
+        /**
+         * @brief Tasks own their coroutine and cannot be copied.
+         */
+        Task(const Task& other) = delete;
+
+        /**
+         * @brief Tasks own their coroutine and cannot be copied.
+         */
+        Task& operator=(const Task& other) = delete;
+
+        /**
+         * @brief Move constructor.
+         * @param other The Task to move.
+         */
+        Task(Task&& other) noexcept;
+
+        /**
+         * @brief Move assignment operator. The coroutine held before is released as on destruction.
+         * @param other The Task to move.
+         */
+        Task& operator=(Task&& other) noexcept;
+
+        /**
+         * @brief Starts the coroutine on a worker of the pool.
+         * @param pool The pool.
+         * @throws std::logic_error If there is no coroutine, or it has been started before.
+         */
+        void start(ThreadPool& pool);
+
+        /**
+         * @brief Blocks until the coroutine has finished.
+         * @throws std::logic_error If the coroutine was never started.
+         * @throws Whatever left the coroutine.
+         */
+        void wait();
+
+    private:
+        explicit Task(std::coroutine_handle<promise_type> handle);
+
+        /**
+         * @brief Waits for the coroutine if it was started, and destroys it.
+         */
+        void _release() noexcept;
+
+        std::coroutine_handle<promise_type> _handle;
+        bool _started = false;
+    };
+
+    /**
+     * @brief A coroutine that produces a sequence of values by co_yield, resumed by the loop that reads them.
+     *
+     * Values are handed out by reference and live until the coroutine is resumed for the next. The sequence can be
+     * read once; an exception that leaves the coroutine is rethrown from the loop.
+     */
+    template<typename T>
+    class Generator {
+    public:
+        struct promise_type {
+            const T* value = nullptr;
+            std::exception_ptr error;
+
+            Generator get_return_object() {
+                return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+            }
+
+            std::suspend_always initial_suspend() noexcept {
+                return {};
+            }
+
+            std::suspend_always final_suspend() noexcept {
+                return {};
+            }
+
+            std::suspend_always yield_value(const T& yielded) noexcept {
+                value = std::addressof(yielded);
+                return {};
+            }
+
+            void return_void() {
+            }
+
+            void unhandled_exception() {
+                error = std::current_exception();
+            }
+
+            // Awaiting inside a generator would resume the reader on another thread
+            template<typename U>
+            void await_transform(U&& awaited) = delete;
+        };
+
+        class iterator {
+        public:
+            using iterator_category = std::input_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+            iterator() = default;
+
+            explicit iterator(std::coroutine_handle<promise_type> handle) : _handle(handle) {
+            }
+
+            reference operator*() const {
+                return *_handle.promise().value;
+            }
+
+            pointer operator->() const {
+                return _handle.promise().value;
+            }
+
+            iterator& operator++() {
+                _handle.resume();
+                _rethrow();
+                return *this;
+            }
+
+            void operator++(int) {
+                ++*this;
+            }
+
+            bool operator==(std::default_sentinel_t) const {
+                return !_handle || _handle.done();
+            }
+
+        private:
+            friend class Generator;
+
+            void _rethrow() const {
+                if (_handle.done() && _handle.promise().error) {
+                    std::rethrow_exception(_handle.promise().error);
+                }
+            }
+
+            std::coroutine_handle<promise_type> _handle;
+        };
+
+        /**
+         * @brief Destroys the coroutine, wherever it was suspended.
+         */
+        ~Generator() {
+            if (_handle) {
+                _handle.destroy();
+            }
+        }
+
+        /**
+         * @brief Generators own their coroutine and cannot be copied.
+         */
+        Generator(const Generator& other) = delete;
+
+        /**
+         * @brief Generators own their coroutine and cannot be copied.
+         */
+        Generator& operator=(const Generator& other) = delete;
+
+        /**
+         * @brief Move constructor.
+         * @param other The Generator to move.
+         */
+        Generator(Generator&& other) noexcept : _handle(std::exchange(other._handle, nullptr)) {
+        }
+
+        /**
+         * @brief Runs the coroutine to its first value.
+         * @return An iterator on the first value, or the end if there is none.
+         */
+        iterator begin() {
+            iterator first(_handle);
+            if (_handle) {
+                _handle.resume();
+                first._rethrow();
+            }
+            return first;
+        }
+
+        std::default_sentinel_t end() const noexcept {
+            return std::default_sentinel;
+        }
+
+    private:
+        explicit Generator(std::coroutine_handle<promise_type> handle) : _handle(handle) {
+        }
+
+        std::coroutine_handle<promise_type> _handle;
+    };
+
+    /**
+     * @brief A queue of at most a fixed number of items, from threads to a single Task.
+     *
+     * push() blocks while the channel is full; pop() suspends the task while it is empty and resumes it on the pool
+     * when an item arrives. The storage is allocated on construction.
+     */
+    template<typename T>
+    class Channel {
+    public:
+        /**
+         * @brief Constructs an empty channel.
+         * @param capacity The number of items it holds.
+         * @param pool The pool its consumer is resumed on.
+         * @throws std::invalid_argument If capacity is 0.
+         */
+        Channel(std::size_t capacity, ThreadPool& pool) : _pool(pool) {
+            if (capacity == 0) {
+                throw std::invalid_argument("A channel must hold at least one item.");
+            }
+            _items.resize(capacity);
+        }
+
+        /**
+         * @brief Appends an item, after waiting for room.
+         * @param item The item.
+         * @return Whether the item was appended; false, and the item dropped, once the channel has been closed.
+         */
+        bool push(T item) {
+            std::coroutine_handle<> consumer;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _space.wait(lock, [this] { return _count < _items.size() || _closed; });
+                if (_closed) {
+                    return false;
+                }
+                _items[(_head + _count) % _items.size()] = std::move(item);
+                _count++;
+                consumer = std::exchange(_consumer, nullptr);
+            }
+            if (consumer) {
+                _pool.post(consumer);
+            }
+            return true;
+        }
+
+        /**
+         * @brief Ends the sequence: the consumer receives the items left, then nothing. Closing twice is harmless; a
+         * consumer that fails closes its channel, so that its producer does not wait for it forever.
+         */
+        void close() {
+            std::coroutine_handle<> consumer;
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _closed = true;
+                consumer = std::exchange(_consumer, nullptr);
+            }
+            _space.notify_all();
+            if (consumer) {
+                _pool.post(consumer);
+            }
+        }
+
+        /**
+         * @brief Takes the first item, suspending until there is one.
+         * @return An awaitable of the item, or of std::nullopt once the channel is closed and empty.
+         */
+        auto pop() {
+            struct Awaiter {
+                Channel& channel;
+
+                bool await_ready() const noexcept {
+                    return false;
+                }
+
+                bool await_suspend(std::coroutine_handle<> handle) {
+                    std::lock_guard<std::mutex> lock(channel._mutex);
+                    if (channel._count > 0 || channel._closed) {
+                        return false;
+                    }
+                    channel._consumer = handle;
+                    return true;
+                }
+
+                std::optional<T> await_resume() {
+                    std::optional<T> item;
+                    {
+                        std::lock_guard<std::mutex> lock(channel._mutex);
+                        if (channel._count == 0) {
+                            return item;
+                        }
+                        item = std::move(channel._items[channel._head]);
+                        channel._items[channel._head] = T();
+                        channel._head = (channel._head + 1) % channel._items.size();
+                        channel._count--;
+                    }
+                    channel._space.notify_one();
+                    return item;
+                }
+            };
+            return Awaiter{*this};
+        }
+
+    private:
+        ThreadPool& _pool;
+        std::mutex _mutex;
+        std::condition_variable _space;
+
+        /**
+         * @brief A ring of _count items from _head on.
+         */
+        std::vector<T> _items;
+        std::size_t _head = 0;
+        std::size_t _count = 0;
+        bool _closed = false;
+
+        /**
+         * @brief The consumer, while it is suspended on an empty channel.
+         */
+        std::coroutine_handle<> _consumer;
+    };
+
+    /**
+     * @brief A fixed set of buffers, lent out by reference-counted handles.
+     *
+     * The buffers are allocated on construction. acquire() blocks until one is free; a buffer is free again once the
+     * last handle to it is gone. Handles may be copied and released on any thread. The pool must outlive its handles.
+     */
+    template<typename T>
+    class BufferPool {
+        struct Slot {
+            std::unique_ptr<T> value;
+            std::atomic<int> references{0};
+            BufferPool* pool = nullptr;
+        };
+
+    public:
+        /**
+         * @brief A shared reference to a buffer of the pool.
+         */
+        class Handle {
+        public:
+            Handle() = default;
+
+            ~Handle() {
+                _release();
+            }
+
+            Handle(const Handle& other) noexcept : _slot(other._slot) {
+                if (_slot) {
+                    _slot->references.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            Handle& operator=(const Handle& other) noexcept {
+                if (this != &other) {
+                    _release();
+                    _slot = other._slot;
+                    if (_slot) {
+                        _slot->references.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+                return *this;
+            }
+
+            Handle(Handle&& other) noexcept : _slot(std::exchange(other._slot, nullptr)) {
+            }
+
+            Handle& operator=(Handle&& other) noexcept {
+                if (this != &other) {
+                    _release();
+                    _slot = std::exchange(other._slot, nullptr);
+                }
+                return *this;
+            }
+
+            T& operator*() const {
+                return *_slot->value;
+            }
+
+            T* operator->() const {
+                return _slot->value.get();
+            }
+
+            explicit operator bool() const {
+                return _slot != nullptr;
+            }
+
+        private:
+            friend class BufferPool;
+
+            explicit Handle(Slot* slot) : _slot(slot) {
+            }
+
+            void _release() noexcept {
+                // The last owner has seen every write of the others before the buffer is lent out again
+                if (_slot && _slot->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    _slot->pool->_free(_slot);
+                }
+                _slot = nullptr;
+            }
+
+            Slot* _slot = nullptr;
+        };
+
+        /**
+         * @brief Allocates the buffers.
+         * @param size The number of buffers.
+         * @param make Returns a new buffer, as a std::unique_ptr<T>.
+         * @throws std::invalid_argument If size is 0.
+         */
+        template<typename Factory>
+        BufferPool(std::size_t size, Factory make) {
+            if (size == 0) {
+                throw std::invalid_argument("A buffer pool must hold at least one buffer.");
+            }
+            _slots.reserve(size);
+            _available.reserve(size);
+            for (std::size_t i = 0; i < size; i++) {
+                auto slot = std::make_unique<Slot>();
+                slot->value = make();
+                slot->pool = this;
+                _available.push_back(slot.get());
+                _slots.push_back(std::move(slot));
+            }
+        }
+
+        /**
+         * @brief Buffer pools are referred to by their handles and cannot be copied.
+         */
+        BufferPool(const BufferPool& other) = delete;
+
+        /**
+         * @brief Buffer pools are referred to by their handles and cannot be copied.
+         */
+        BufferPool& operator=(const BufferPool& other) = delete;
+
+        /**
+         * @brief Lends out a buffer, after waiting for one to be free. Its contents are those its last user left.
+         * @return The only handle to the buffer.
+         */
+        Handle acquire() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _returned.wait(lock, [this] { return !_available.empty(); });
+            Slot* slot = _available.back();
+            _available.pop_back();
+            slot->references.store(1, std::memory_order_relaxed);
+            return Handle(slot);
+        }
+
+        /**
+         * @brief Counts the buffers not lent out.
+         * @return The number of free buffers.
+         */
+        std::size_t available() const {
+            std::lock_guard<std::mutex> lock(_mutex);
+            return _available.size();
+        }
+
+        /**
+         * @brief Accesses the number of buffers.
+         * @return The number of buffers.
+         */
+        std::size_t size() const {
+            return _slots.size();
+        }
+
+    private:
+        void _free(Slot* slot) {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _available.push_back(slot);
+            }
+            _returned.notify_one();
+        }
+
+        mutable std::mutex _mutex;
+        std::condition_variable _returned;
+        std::vector<std::unique_ptr<Slot>> _slots;
+
+        /**
+         * @brief The free buffers; has room for all of them, so returning one never allocates.
+         */
+        std::vector<Slot*> _available;
+    };
+}
+
+#endif //CPP_CONSTRICTION_SQUID_PIPELINE_H
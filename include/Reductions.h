@@ -0,0 +1,348 @@
+#ifndef CPP_CONSTRICTION_SQUID_REDUCTIONS_H
+#define CPP_CONSTRICTION_SQUID_REDUCTIONS_H
+
+#include "Kernels.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * Reductions over contiguous arrays whose result does not depend on the number of threads.
+ *
+ * The values are split into blocks whose length only depends on their number. Each block is reduced into
+ * kernels::reductionLanes partial sums, by the vectorized kernels for double and std::complex<double> and by portable
+ * loops of the same order for other types, and the blocks are reduced in parallel. The lanes of a block and then the
+ * blocks are combined along fixed pairwise trees, so the result is the same bits on one thread or sixty-four; and as
+ * a pairwise sum its rounding error grows with the logarithm of the length rather than the length. All sums are
+ * accumulated in double precision. Wider instruction sets may still differ in the last bits, as they contract
+ * multiply-adds into FMAs.
+ */
+namespace reductions {
+    /**
+     * @brief The values an element consists of and the type its sums are returned in.
+     */
+    template<typename T>
+    struct Traits {
+        typedef T component;
+        typedef double accumulator;
+        static constexpr std::size_t width = 1;
+    };
+
+    template<typename real>
+    struct Traits<std::complex<real>> {
+        typedef real component;
+        typedef std::complex<double> accumulator;
+        static constexpr std::size_t width = 2;
+    };
+
+    /**
+     * @brief At most this many blocks, which bounds the partial sums kept on the stack.
+     */
+    constexpr std::size_t maxBlocks = 1024;
+
+    /**
+     * @brief Blocks are at least this many values long, so that small arrays stay on one thread.
+     */
+    constexpr std::size_t minBlockLength = 16384;
+
+    /**
+     * @brief The sums of the even and of the odd lanes: the real and imaginary parts of complex elements.
+     */
+    typedef std::array<double, 2> Partial;
+
+    /**
+     * @brief The length of the blocks n values are split into.
+     * @param n The number of values.
+     * @param granularity Block lengths are a multiple of this, a multiple of the number of lanes.
+     * @return The block length.
+     */
+    inline std::size_t blockLength(std::size_t n, std::size_t granularity) {
+        const std::size_t length = std::max(minBlockLength, (n + maxBlocks - 1) / maxBlocks);
+        return (length + granularity - 1) / granularity * granularity;
+    }
+
+    /**
+     * @brief Adds up partial sums along a fixed pairwise tree.
+     */
+    inline Partial pairwise(const Partial* partials, std::size_t count) {
+        if (count == 0) {
+            return {0.0, 0.0};
+        }
+        if (count == 1) {
+            return partials[0];
+        }
+        const Partial left = pairwise(partials, count / 2);
+        const Partial right = pairwise(partials + count / 2, count - count / 2);
+        return {left[0] + right[0], left[1] + right[1]};
+    }
+
+    /**
+     * @brief Reduces n values block by block.
+     * @param n The number of values.
+     * @param granularity Block lengths are a multiple of this.
+     * @param block Called as block(begin, end, lanes) to write the lanes of the values [begin, end).
+     * @return The sums of the even and odd lanes.
+     */
+    template<typename Block>
+    Partial sum(std::size_t n, std::size_t granularity, const Block& block) {
+        const std::size_t length = blockLength(n, granularity);
+        const auto blocks = static_cast<long>((n + length - 1) / length);
+        std::array<Partial, maxBlocks> partials;
+#pragma omp parallel for if(blocks > 1)
+        for (long b = 0; b < blocks; b++) {
+            const std::size_t begin = static_cast<std::size_t>(b) * length;
+            double lanes[kernels::reductionLanes];
+            block(begin, std::min(n, begin + length), lanes);
+            partials[b] = {(lanes[0] + lanes[2]) + (lanes[4] + lanes[6]),
+                           (lanes[1] + lanes[3]) + (lanes[5] + lanes[7])};
+        }
+        return pairwise(partials.data(), static_cast<std::size_t>(blocks));
+    }
+
+    /**
+     * @brief The maximum over n values, block by block. Maxima are exact, so any order gives the same result.
+     * @param block Called as block(begin, end) to return the maximum of the values [begin, end).
+     */
+    template<typename Block>
+    double maximum(std::size_t n, std::size_t granularity, const Block& block) {
+        const std::size_t length = blockLength(n, granularity);
+        const auto blocks = static_cast<long>((n + length - 1) / length);
+        double result = 0.0;
+#pragma omp parallel for if(blocks > 1) reduction(max:result)
+        for (long b = 0; b < blocks; b++) {
+            const std::size_t begin = static_cast<std::size_t>(b) * length;
+            result = std::max(result, block(begin, std::min(n, begin + length)));
+        }
+        return result;
+    }
+
+    /**
+     * @brief Portable block reductions in the order of the kernels, for element types without kernels.
+     */
+    namespace generic {
+        template<typename C>
+        void sum(const C* a, std::size_t n, double* lanes) {
+            std::fill(lanes, lanes + kernels::reductionLanes, 0.0);
+            for (std::size_t i = 0; i < n; i++) {
+                lanes[i % kernels::reductionLanes] += static_cast<double>(a[i]);
+            }
+        }
+
+        template<typename C>
+        void dot(const C* a, const C* b, std::size_t n, double* lanes) {
+            std::fill(lanes, lanes + kernels::reductionLanes, 0.0);
+            for (std::size_t i = 0; i < n; i++) {
+                lanes[i % kernels::reductionLanes] += static_cast<double>(a[i]) * static_cast<double>(b[i]);
+            }
+        }
+
+        template<typename C>
+        void crossDot(const C* a, const C* b, std::size_t n, double* lanes) {
+            std::fill(lanes, lanes + kernels::reductionLanes, 0.0);
+            for (std::size_t i = 0; i < n; i++) {
+                lanes[i % kernels::reductionLanes] += static_cast<double>(a[i]) * static_cast<double>(b[i ^ 1]);
+            }
+        }
+
+        template<std::size_t width, bool squares, typename C>
+        void masked(const C* a, const std::uint64_t* mask, std::size_t first, std::size_t n, double* lanes) {
+            std::fill(lanes, lanes + kernels::reductionLanes, 0.0);
+            for (std::size_t i = 0; i < n * width; i++) {
+                const std::size_t element = first + i / width;
+                const double value = squares ? static_cast<double>(a[i]) * static_cast<double>(a[i])
+                                             : static_cast<double>(a[i]);
+                lanes[i % kernels::reductionLanes] += (mask[element / 64] >> (element % 64)) & 1 ? value : 0.0;
+            }
+        }
+
+        template<typename C>
+        double maxAbs(const C* a, std::size_t n) {
+            double result = 0.0;
+            for (std::size_t i = 0; i < n; i++) {
+                result = std::max(result, std::abs(static_cast<double>(a[i])));
+            }
+            return result;
+        }
+
+        template<typename C>
+        double maxNorm(const C* a, std::size_t n) {
+            double result = 0.0;
+            for (std::size_t i = 0; i < n; i++) {
+                const auto re = static_cast<double>(a[2 * i]);
+                const auto im = static_cast<double>(a[2 * i + 1]);
+                result = std::max(result, re * re + im * im);
+            }
+            return result;
+        }
+    }
+
+    /**
+     * @brief The values of an array of elements.
+     */
+    template<typename T>
+    const typename Traits<T>::component* components(const T* a) {
+        return reinterpret_cast<const typename Traits<T>::component*>(a);
+    }
+
+    /**
+     * @brief Block lengths keep the elements of a mask word together.
+     */
+    template<typename T>
+    constexpr std::size_t granularity = 64 * Traits<T>::width;
+
+    template<typename T>
+    typename Traits<T>::accumulator accumulate(const Partial& partial) {
+        if constexpr (Traits<T>::width == 2) {
+            return {partial[0], partial[1]};
+        } else {
+            return partial[0] + partial[1];
+        }
+    }
+
+    /**
+     * @brief The sum of n elements.
+     */
+    template<typename T>
+    typename Traits<T>::accumulator sum(const T* a, std::size_t n) {
+        const auto* values = components(a);
+        return accumulate<T>(sum(n * Traits<T>::width, granularity<T>,
+                                 [values](std::size_t begin, std::size_t end, double* lanes) {
+            if constexpr (kernels::dispatched<T>) {
+                kernels::active().reductions.sum(values + begin, end - begin, lanes);
+            } else {
+                generic::sum(values + begin, end - begin, lanes);
+            }
+        }));
+    }
+
+    /**
+     * @brief The sum of the n elements whose bit in a mask of at least n bits is set.
+     */
+    template<typename T>
+    typename Traits<T>::accumulator maskedSum(const T* a, const std::uint64_t* mask, std::size_t n) {
+        constexpr std::size_t width = Traits<T>::width;
+        const auto* values = components(a);
+        return accumulate<T>(sum(n * width, granularity<T>,
+                                 [values, mask](std::size_t begin, std::size_t end, double* lanes) {
+            if constexpr (std::is_same_v<T, double>) {
+                kernels::active().reductions.maskedSum(values + begin, mask, begin, end - begin, lanes);
+            } else if constexpr (kernels::dispatched<T>) {
+                kernels::active().reductions.maskedSumComplex(values + begin, mask, begin / 2, (end - begin) / 2,
+                                                              lanes);
+            } else {
+                generic::masked<width, false>(values + begin, mask, begin / width, (end - begin) / width, lanes);
+            }
+        }));
+    }
+
+    /**
+     * @brief The sum of |a_i|^2 over n elements.
+     */
+    template<typename T>
+    double squaredNorm(const T* a, std::size_t n) {
+        const auto* values = components(a);
+        const Partial partial = sum(n * Traits<T>::width, granularity<T>,
+                                    [values](std::size_t begin, std::size_t end, double* lanes) {
+            if constexpr (kernels::dispatched<T>) {
+                kernels::active().reductions.dot(values + begin, values + begin, end - begin, lanes);
+            } else {
+                generic::dot(values + begin, values + begin, end - begin, lanes);
+            }
+        });
+        return partial[0] + partial[1];
+    }
+
+    /**
+     * @brief The sum of |a_i|^2 over the n elements whose bit in a mask of at least n bits is set.
+     */
+    template<typename T>
+    double maskedSquaredNorm(const T* a, const std::uint64_t* mask, std::size_t n) {
+        constexpr std::size_t width = Traits<T>::width;
+        const auto* values = components(a);
+        const Partial partial = sum(n * width, granularity<T>,
+                                    [values, mask](std::size_t begin, std::size_t end, double* lanes) {
+            if constexpr (std::is_same_v<T, double>) {
+                kernels::active().reductions.maskedSquares(values + begin, mask, begin, end - begin, lanes);
+            } else if constexpr (kernels::dispatched<T>) {
+                kernels::active().reductions.maskedSquaresComplex(values + begin, mask, begin / 2,
+                                                                  (end - begin) / 2, lanes);
+            } else {
+                generic::masked<width, true>(values + begin, mask, begin / width, (end - begin) / width, lanes);
+            }
+        });
+        return partial[0] + partial[1];
+    }
+
+    /**
+     * @brief The sum of conj(a_i) b_i over n elements.
+     */
+    template<typename T>
+    typename Traits<T>::accumulator dot(const T* a, const T* b, std::size_t n) {
+        const auto* left = components(a);
+        const auto* right = components(b);
+        auto products = [left, right](std::size_t begin, std::size_t end, double* lanes) {
+            if constexpr (kernels::dispatched<T>) {
+                kernels::active().reductions.dot(left + begin, right + begin, end - begin, lanes);
+            } else {
+                generic::dot(left + begin, right + begin, end - begin, lanes);
+            }
+        };
+        const Partial real = sum(n * Traits<T>::width, granularity<T>, products);
+        if constexpr (Traits<T>::width == 2) {
+            // Im(conj(a) b) = Re(a) Im(b) - Im(a) Re(b), the even and odd lanes of the cross products
+            const Partial cross = sum(n * 2, granularity<T>, [left, right](std::size_t begin, std::size_t end,
+                                                                          double* lanes) {
+                if constexpr (kernels::dispatched<T>) {
+                    kernels::active().reductions.crossDot(left + begin, right + begin, end - begin, lanes);
+                } else {
+                    generic::crossDot(left + begin, right + begin, end - begin, lanes);
+                }
+            });
+            return {real[0] + real[1], cross[0] - cross[1]};
+        } else {
+            return real[0] + real[1];
+        }
+    }
+
+    /**
+     * @brief The largest |a_i| of n elements.
+     */
+    template<typename T>
+    double maxAbs(const T* a, std::size_t n) {
+        constexpr std::size_t width = Traits<T>::width;
+        const auto* values = components(a);
+        const double result = maximum(n * width, granularity<T>, [values](std::size_t begin, std::size_t end) {
+            if constexpr (std::is_same_v<T, double>) {
+                return kernels::active().reductions.maxAbs(values + begin, end - begin);
+            } else if constexpr (kernels::dispatched<T>) {
+                return kernels::active().reductions.maxNorm(values + begin, (end - begin) / 2);
+            } else if constexpr (width == 2) {
+                return generic::maxNorm(values + begin, (end - begin) / 2);
+            } else {
+                return generic::maxAbs(values + begin, end - begin);
+            }
+        });
+        return width == 2 ? std::sqrt(result) : result;
+    }
+
+    /**
+     * @brief The number of set bits in n words.
+     */
+    inline std::size_t popcount(const std::uint64_t* words, std::size_t n) {
+        const std::size_t length = blockLength(n, 1);
+        const auto blocks = static_cast<long>((n + length - 1) / length);
+        std::uint64_t count = 0;
+#pragma omp parallel for if(blocks > 1) reduction(+:count)
+        for (long b = 0; b < blocks; b++) {
+            const std::size_t begin = static_cast<std::size_t>(b) * length;
+            count += kernels::active().reductions.popcount(words + begin, std::min(n, begin + length) - begin);
+        }
+        return static_cast<std::size_t>(count);
+    }
+}
+
+#endif //CPP_CONSTRICTION_SQUID_REDUCTIONS_H
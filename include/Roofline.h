@@ -0,0 +1,66 @@
+#ifndef CPP_CONSTRICTION_SQUID_ROOFLINE_H
+#define CPP_CONSTRICTION_SQUID_ROOFLINE_H
+
+#include "KernelCost.h"
+#include <ostream>
+#include <vector>
+
+/**
+ * @brief A kernel's cost model together with its measured throughput.
+ */
+struct KernelMeasurement {
+    KernelCost cost;
+    double cellsPerSecond;
+};
+
+/**
+ * @brief Places the solver and field kernels on the roofline of the host.
+ *
+ * The memory roof is the sustained bandwidth of a STREAM triad, the compute roof the rate of independent
+ * multiply-adds, both using all OpenMP threads and compiled with the same flags as the kernels. A kernel's attainable
+ * time per cell is the larger of its memory time and its compute time; the report gives the measured time as a
+ * fraction of that.
+ */
+class Roofline {
+public:
+    /**
+     * @brief Constructs a new Roofline object.
+     * @param gridSize The edge length of the square grids the kernels are timed on.
+     * @param streamElements The number of doubles in each of the three STREAM arrays.
+     * @param repetitions Every measurement is the best of this many runs.
+     */
+    Roofline(int gridSize, std::size_t streamElements, int repetitions);
+
+    /**
+     * @brief Measures the sustained memory bandwidth with a STREAM triad, a = b + s * c.
+     * @return The bandwidth in bytes per second.
+     */
+    double measureBandwidth() const;
+
+    /**
+     * @brief Measures the peak floating point rate with independent multiply-add chains that stay in registers, in the
+     * vectors of the active instruction set.
+     * @return The rate in flops per second.
+     */
+    double measurePeakFlops() const;
+
+    /**
+     * @brief Times the solver phases and the ScalarField operators.
+     * @return The measured throughput of every kernel.
+     */
+    std::vector<KernelMeasurement> measureKernels() const;
+
+    /**
+     * @brief Runs all measurements and writes a table with the arithmetic intensity, the bound and the fraction of
+     * the attainable roofline of every kernel.
+     * @param out The stream to write to.
+     */
+    void report(std::ostream& out) const;
+
+private:
+    int _gridSize;
+    std::size_t _streamElements;
+    int _repetitions;
+};
+
+#endif //CPP_CONSTRICTION_SQUID_ROOFLINE_H
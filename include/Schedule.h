@@ -0,0 +1,45 @@
+#ifndef CPP_CONSTRICTION_SQUID_SCHEDULE_H
+#define CPP_CONSTRICTION_SQUID_SCHEDULE_H
+
+#include <utility>
+#include <vector>
+
+typedef std::pair<double, double> schedulePoint;
+
+class Schedule {
+public:
+    /**
+     * @brief Constructs a schedule that is 0 at all times.
+     */
+    Schedule();
+
+    /**
+     * @brief Constructs a constant schedule.
+     * @param value The value at all times.
+     */
+    explicit Schedule(double value);
+
+    /**
+     * @brief Constructs a piecewise-linear schedule. Before the first and after the last point the schedule is constant.
+     * @param points (time, value) pairs, sorted by strictly increasing time.
+     */
+    explicit Schedule(std::vector<schedulePoint> points);
+
+    /**
+     * @brief Evaluates the schedule.
+     * @param time The time.
+     * @return The linearly interpolated value at the given time.
+     */
+    double operator()(double time) const;
+
+    /**
+     * @brief Accesses the points defining the schedule.
+     * @return The (time, value) pairs.
+     */
+    const std::vector<schedulePoint>& points() const;
+
+private:
+    std::vector<schedulePoint> _points;
+};
+
+#endif //CPP_CONSTRICTION_SQUID_SCHEDULE_H
@@ -0,0 +1,242 @@
+#ifndef CPP_CONSTRICTION_SQUID_SIMULATION_H
+#define CPP_CONSTRICTION_SQUID_SIMULATION_H
+
+#include "AdaptiveMesh.h"
+#include "AdaptiveStepper.h"
+#include "Geometry.h"
+#include "Job.h"
+#include "Observables.h"
+#include "Pipeline.h"
+#include "Solver.h"
+#include "Superconductor.h"
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <variant>
+#include <vector>
+
+/**
+ * @brief Runs validated jobs back to back.
+ *
+ * The geometry, superconductor and solver buffers are kept between jobs and only rebuilt when the grid dimensions
+ * change; a changed geometry source only re-reads the mask. Everything a job needs is allocated before its first
+ * time step. State is only held in the storage types of the last job; switching precision or link storage rebuilds it.
+ *
+ * The time stepping of a job is a generator that yields at every output time. With analysis threads the vortices and
+ * snapshots of an output are written by tasks on a pool of their own, from a snapshot of the state, while the solver
+ * takes the next steps; see pipeline. Refined jobs step an AdaptiveMesh instead of the solver and bring its composite
+ * onto the state at every output, so that the outputs are those of the uniform grid.
+ */
+class Simulation {
+public:
+    /**
+     * @brief Constructs a new Simulation object.
+     * @param log Stream for progress messages.
+     */
+    explicit Simulation(std::ostream& log);
+
+    /**
+     * @brief Destroys the Simulation object.
+     */
+    ~Simulation() = default;
+
+    /**
+     * @brief Simulations own the solver state and cannot be copied.
+     */
+    Simulation(const Simulation& other) = delete;
+
+    /**
+     * @brief Simulations own the solver state and cannot be copied.
+     */
+    Simulation& operator=(const Simulation& other) = delete;
+
+    /**
+     * @brief Runs a single job.
+     * @param job The job, as returned by readJobFile().
+     */
+    void run(const Job& job);
+
+    /**
+     * @brief Runs a batch of jobs in order.
+     * @param jobs The jobs, as returned by readJobFile().
+     */
+    void run(const std::vector<Job>& jobs);
+
+    /**
+     * @brief Accesses the superconductor of the last job.
+     * @return The superconductor.
+     * @throws std::logic_error If no job has been run, or the last one did not run in double precision with complex
+     * links.
+     */
+    const Superconductor& superconductor() const;
+
+private:
+    std::ostream& _log;
+
+    /**
+     * @brief The geometry source and dimensions the current geometry was built from.
+     */
+    std::string _geometryKey;
+
+    /**
+     * @brief The superconductor and solver of one storage precision and link storage.
+     */
+    template<typename real, typename link>
+    struct State {
+        std::unique_ptr<BasicSuperconductor<real, link>> superconductor;
+        std::unique_ptr<BasicSolver<real, link>> solver;
+    };
+
+    /**
+     * @brief An output time of a running job, as yielded by _integrate().
+     */
+    struct Output {
+        double time;
+        double field;
+        double current;
+
+        /**
+         * @brief The number of the output, from 0.
+         */
+        long index;
+
+        /**
+         * @brief The time steps taken so far.
+         */
+        long steps;
+    };
+
+    /**
+     * @brief The state at an output, handed from the solver to the analysis tasks.
+     */
+    template<typename real, typename link>
+    struct Snapshot {
+        BasicSuperconductor<real, link> superconductor;
+
+        /**
+         * @brief The vortices of the state, if the job writes them.
+         */
+        std::unique_ptr<BasicVorticity<real, link>> vorticity;
+
+        /**
+         * @brief Without screening, the applied field whose links the state had; the vortex task builds them itself.
+         * Nothing if the links were copied.
+         */
+        std::optional<double> appliedField;
+
+        /**
+         * @brief The applied field whose links the vortex task last built, if it did.
+         */
+        std::optional<double> linkField;
+        double time = 0.0;
+        long index = 0;
+    };
+
+    /**
+     * @brief The thread pool, snapshots and tasks of the analysis of one job; see Simulation.cpp.
+     */
+    template<typename real, typename link>
+    class Analysis;
+
+    std::unique_ptr<Geometry> _geometry;
+
+    /**
+     * @brief The state of the last job. Declared after the geometry, which its solver refers to.
+     */
+    std::variant<std::monostate, State<double, std::complex<double>>, State<float, std::complex<float>>,
+            State<double, Phase>, State<float, Phase>> _state;
+
+    /**
+     * @brief Runs a single job with the given storage types.
+     * @param job The job.
+     */
+    template<typename real, typename link>
+    void _run(const Job& job);
+
+    /**
+     * @brief Takes the time steps of a job: fixed, in blocks, adaptive, or on an adaptive mesh, and samples the
+     * transport after every step.
+     * @param job The job.
+     * @param solver The solver, initialized.
+     * @param stepper The adaptive stepper of the solver, or nullptr for fixed time steps.
+     * @param mesh The adaptive mesh that takes the steps instead of the solver, or nullptr.
+     * @param transport The transport observables, or nullptr.
+     * @param timeSteps Receives a row per adaptive step.
+     * @return A generator of the output times of the job, the end of the run last; the state is that at the output,
+     * or with a mesh the state of the mesh.
+     */
+    template<typename real, typename link>
+    pipeline::Generator<Output> _integrate(const Job& job, BasicSolver<real, link>& solver,
+                                           BasicAdaptiveStepper<real, link>* stepper, AdaptiveMesh* mesh,
+                                           BasicTransport<real, link>* transport, std::ostream& timeSteps);
+
+    /**
+     * @brief Rebuild whatever part of the state does not fit the job. State of other storage types is dropped.
+     * @param job The job to prepare for.
+     * @return The state.
+     */
+    template<typename real, typename link>
+    State<real, link>& _prepare(const Job& job);
+
+    /**
+     * @brief Opens an output file of a job.
+     * @param job The job.
+     * @param suffix Appended to the output path of the job.
+     * @return The file.
+     * @throws std::runtime_error If the file cannot be written.
+     */
+    std::ofstream _openOutput(const Job& job, const std::string& suffix) const;
+
+    /**
+     * @brief The file of the snapshot of an output.
+     * @param job The job.
+     * @param index The number of the output.
+     * @return <output>_psi_<index>.txt.
+     */
+    std::string _snapshotPath(const Job& job, long index) const;
+
+    /**
+     * @brief Evaluate the vortices and fluxoids and append them to their files.
+     * @param time The simulated time.
+     * @param gridSpacing The grid spacing, to place the vortices.
+     * @param vorticity The observables of the running job.
+     * @param vortices Receives a row per vortex.
+     * @param fluxoids Receives a row with the fluxoid of every hole, if there are holes.
+     */
+    template<typename real, typename link>
+    void _writeVortices(double time, double gridSpacing, BasicVorticity<real, link>& vorticity, std::ostream& vortices,
+                        std::ostream& fluxoids) const;
+
+    /**
+     * @brief Append the statistics of all cut lines and probes since the last call to their file, and start new ones.
+     * @param time The simulated time.
+     * @param transport The observables of the running job.
+     * @param file Receives a row.
+     */
+    template<typename real, typename link>
+    void _writeTransport(double time, BasicTransport<real, link>& transport, std::ostream& file) const;
+
+    /**
+     * @brief Write |psi|^2 as text, one line per row of grid points, top row first.
+     * @param path The file to write.
+     * @param psi The order parameter to write.
+     */
+    template<typename real>
+    void _writeSuperfluidDensity(const std::string& path, const ComplexField<real>& psi) const;
+
+    /**
+     * @brief Write the instrumentation report of the running job to <output>_profile.json.
+     * @param job The running job.
+     */
+    void _writeProfile(const Job& job) const;
+
+    /**
+     * @brief Write the trace events of the running job to <output>_trace.json.
+     * @param job The running job.
+     */
+    void _writeTrace(const Job& job) const;
+};
+
+#endif //CPP_CONSTRICTION_SQUID_SIMULATION_H
@@ -0,0 +1,455 @@
+#ifndef CPP_CONSTRICTION_SQUID_SOLVER_H
+#define CPP_CONSTRICTION_SQUID_SOLVER_H
+
+#include "AbstractField.h"
+#include "Gauge.h"
+#include "Geometry.h"
+#include "KernelCost.h"
+#include "Kernels.h"
+#include "Multigrid.h"
+#include "Superconductor.h"
+#include <memory>
+#include <optional>
+#include <vector>
+
+/**
+ * @brief Dimensionless parameters of the TDGL equations. Lengths are in units of the coherence length, fields in units
+ * of the upper critical field and times in units of the Ginzburg-Landau time.
+ */
+struct SolverParameters {
+    /**
+     * @brief The Ginzburg-Landau parameter.
+     */
+    double kappa = 2.0;
+
+    /**
+     * @brief The time step.
+     */
+    double timeStep = 0.01;
+
+    /**
+     * @brief The distance between neighbouring grid points.
+     */
+    double gridSpacing = 0.5;
+
+    /**
+     * @brief Whether the supercurrent screens the applied field. Without screening (the limit of large kappa) the
+     * vector potential is the applied one and only the order parameter is evolved.
+     */
+    bool screening = true;
+
+    /**
+     * @brief The gauge of the applied vector potential; only used without screening.
+     */
+    Gauge gauge = Gauge::landau;
+
+    /**
+     * @brief The strength D of the Langevin noise zeta added to the order parameter equation, with <zeta(r, t)
+     * conj(zeta(r', t'))> = 2 D delta(r - r') delta(t - t'): the temperature in units of the condensation energy in a
+     * coherence volume. 0 for the deterministic equations.
+     */
+    double noise = 0.0;
+
+    /**
+     * @brief The key of the noise. A run is reproduced by its seed, on any number of threads.
+     */
+    std::uint64_t seed = 0;
+
+    /**
+     * @brief The steps advance() takes in one sweep over the grid, by time-skewed tiles; 1 for a sweep per step.
+     * Only runs without screening, leads or noise are blocked, and the result is the same to the bit either way.
+     */
+    int temporalBlocking = 1;
+};
+
+/**
+ * @brief Explicit link-variable integrator of the TDGL equations in the zero scalar potential gauge.
+ *
+ * The order parameter lives on the grid points, the linking variables on the bonds between them and the flux cell
+ * phasors on the plaquettes. The vector potential is evolved on the whole grid; the applied field and current enter
+ * as the magnetic field on the outer edge of the grid. All buffers are allocated on construction, step() does not
+ * allocate.
+ *
+ * The state, geometry weights and magnetic field are stored in the precision of the superconductor. The kernels load
+ * every value into a double, so only the stored state is rounded; the observables are accumulated in double precision,
+ * to the same bits on any number of threads.
+ * @tparam real The storage precision, float or double.
+ * @tparam link The storage of the linking variables, std::complex<real> or Phase. Phase links need no sines, cosines
+ * or arctangents outside of a table lookup, and a quarter of the memory traffic of complex<double> ones.
+ * @tparam grid The storage of the fields of the superconductor and the solver, DynamicGrid or FixedGrid<W, H>. A
+ * solver on a FixedGrid holds its buffers inline, so that an ensemble of small grids stays in cache; the leads, which
+ * solve for the potential by multigrid, still allocate.
+ */
+template<typename real, typename link = std::complex<real>, typename grid = DynamicGrid>
+class BasicSolver {
+public:
+    /**
+     * @brief The type of the superconductor the solver evolves.
+     */
+    typedef BasicSuperconductor<real, link, grid> superconductor_type;
+
+    /**
+     * @brief The type of the order parameter.
+     */
+    typedef typename superconductor_type::field_type field_type;
+
+    /**
+     * @brief The type of the magnetic field on the plaquettes.
+     */
+    typedef typename grid::template plaquettes<real> magnetic_field_type;
+
+    /**
+     * @brief Constructs a new solver acting on a superconductor. Both arguments must outlive the solver.
+     * @param superconductor The superconductor whose state is evolved.
+     * @param geometry The geometry of the superconductor, of the same dimensions.
+     * @param parameters The TDGL parameters.
+     */
+    BasicSolver(superconductor_type& superconductor, const Geometry& geometry, const SolverParameters& parameters);
+
+    /**
+     * @brief Destroys the solver.
+     */
+    ~BasicSolver() = default;
+
+    /**
+     * @brief Solvers refer to their superconductor and cannot be copied.
+     */
+    BasicSolver(const BasicSolver& other) = delete;
+
+    /**
+     * @brief Solvers refer to their superconductor and cannot be copied.
+     */
+    BasicSolver& operator=(const BasicSolver& other) = delete;
+
+    /**
+     * @brief Checks that the parameters are positive, the noise not negative, and that the time step is within the
+     * explicit stability limit.
+     * Without screening the vector potential is not integrated and does not limit the time step.
+     * @param parameters The parameters to check.
+     * @throws std::invalid_argument If the parameters are unusable.
+     */
+    static void validateParameters(const SolverParameters& parameters);
+
+    /**
+     * @brief The largest time step of forward Euler: h^2 / 4 on the order parameter, and h^2 / (4 kappa^2) on the
+     * vector potential with screening and kappa > 1.
+     * @param parameters The parameters; the time step is not read.
+     * @return The stability limit.
+     */
+    static double stabilityLimit(const SolverParameters& parameters);
+
+    /**
+     * @brief Replaces the TDGL parameters. The state of the superconductor is left untouched.
+     * @param parameters The new parameters.
+     */
+    void setParameters(const SolverParameters& parameters);
+
+    /**
+     * @brief Accesses the TDGL parameters.
+     * @return The parameters.
+     */
+    const SolverParameters& parameters() const;
+
+    /**
+     * @brief Re-reads the geometry. Must be called after the geometry passed on construction has been changed.
+     */
+    void updateGeometry();
+
+    /**
+     * @brief Injects the applied current through leads, and solves for the scalar potential phi in every step.
+     *
+     * Without screening the supercurrent is not conserved on its own: the normal current -grad phi carries the
+     * difference, and the current entering at the source lead and leaving at the drain. Every step solves
+     * div(grad phi) = div(Js) on the superconductor by multigrid, starting from the potential of the step before, with
+     * the lead currents as sources, and rotates psi by exp(-i phi dt). The applied current is the total current from
+     * source to drain, spread evenly over the lead points in the superconductor. Only without screening; with screening
+     * the current enters through the self-field.
+     * @param source The grid points the current enters through.
+     * @param drain The grid points it leaves through.
+     * @param multigrid The cycle and tolerance of the potential.
+     * @throws std::invalid_argument If the leads do not match the grid, or either has no point in the superconductor.
+     */
+    void setLeads(const Mask& source, const Mask& drain, const MultigridParameters& multigrid = MultigridParameters());
+
+    /**
+     * @brief Removes the leads and the scalar potential.
+     */
+    void removeLeads();
+
+    /**
+     * @brief Accesses the scalar potential of the last step, with zero mean over the superconductor.
+     * @return The scalar potential.
+     * @throws std::logic_error If there are no leads.
+     */
+    const RealField& scalarPotential() const;
+
+    /**
+     * @brief Accesses the number of multigrid cycles the potential of the last step took.
+     * @return The number of cycles, 0 without leads.
+     */
+    int potentialCycles() const;
+
+    /**
+     * @brief Resets the superconductor to the field-free Meissner state (psi = 1, all linking variables 1) and the
+     * time to 0.
+     */
+    void initialize();
+
+    /**
+     * @brief Advances the superconductor by one time step.
+     *
+     * Without screening the linking variables and flux cells are those of the applied field in the gauge of the
+     * parameters. They are cached in the superconductor and only rebuilt when the applied field changes, or after
+     * initialize() or setParameters().
+     *
+     * With noise, every component of psi at every grid point in the superconductor receives sqrt(D dt) / h times a
+     * standard normal variate, noise::gaussian() of the seed, the number of steps since initialize() and the point.
+     * @param appliedField The applied perpendicular magnetic field.
+     * @param appliedCurrent The applied transport current per unit thickness, flowing in the x direction.
+     * @throws std::invalid_argument If a current is applied without screening or leads, or there are leads with
+     * screening.
+     */
+    void step(double appliedField, double appliedCurrent);
+
+    /**
+     * @brief Takes a number of steps at a fixed applied field and current.
+     *
+     * Without screening, leads and noise the links are fixed over the steps, and temporalBlocking of them at a time
+     * are taken in one sweep over the grid: by overlapped tiles of the grid, each taking all the steps on a window of
+     * columns that moves across the tile, so that psi is read from and written to memory once per block of steps
+     * instead of once per step. Tiles recompute the points on their margins that their neighbours compute as well,
+     * one column and row more per step. The result is bitwise that of as many calls of step(). Other runs and the
+     * steps left over take steps one by one.
+     * @param appliedField The applied perpendicular magnetic field.
+     * @param appliedCurrent The applied transport current per unit thickness, flowing in the x direction.
+     * @param steps The number of steps.
+     * @throws std::invalid_argument As step().
+     */
+    void advance(double appliedField, double appliedCurrent, int steps);
+
+    /**
+     * @brief Hands the order parameter over to a buffer without copying it. The next step reads the order parameter in
+     * place; after it the storage of the two is swapped, so the buffer holds the state before that step and the
+     * solver writes its steps into the former storage of the buffer from then on.
+     * @param buffer A field of the dimensions of the superconductor with zero edges, such as an earlier order
+     * parameter, that outlives the next step; or nullptr to call off a hand-over still to come. initialize() calls it
+     * off as well.
+     * @throws std::invalid_argument If the buffer has other dimensions.
+     */
+    void handOver(field_type *buffer);
+
+    /**
+     * @brief Accesses the applied field whose links the superconductor holds, which steps without screening build and
+     * then reuse until the field changes.
+     * @return The applied field, or nothing with screening and until the first step.
+     */
+    std::optional<double> appliedLinkField() const;
+
+    /**
+     * @brief Accesses the simulated time.
+     * @return The time.
+     */
+    double time() const;
+
+    /**
+     * @brief Accesses the magnetic field on the plaquettes, as computed in the last step.
+     * @return The magnetic field.
+     */
+    const magnetic_field_type& magneticField() const;
+
+    /**
+     * @brief Computes the mean of |psi|^2 over the superconductor.
+     * @return The mean superfluid density.
+     */
+    double meanSuperfluidDensity() const;
+
+    /**
+     * @brief Computes the mean magnetic field over the grid, as computed in the last step.
+     * @return The mean magnetic field.
+     */
+    double meanMagneticField() const;
+
+private:
+    /**
+     * @brief The roofline report times the phases of a step separately.
+     */
+    friend class Roofline;
+
+    /**
+     * @brief The adaptive stepper sets the time step of every attempt and rewinds the clock after a rejected one.
+     */
+    template<typename, typename> friend class BasicAdaptiveStepper;
+
+    /**
+     * @brief The memory traffic of the kernels in the precision and link type of this solver, for the timed phases.
+     */
+    typedef kernelCost::Solver<real, link> cost;
+
+    /**
+     * @brief The grid points on a side of a tile of advance(). Columns of 256 rows keep the window of a block of 8
+     * steps, 3 columns of each step, in the L2 cache in double precision; the tiles are narrow enough for several per
+     * thread on the grids of the benchmarks.
+     */
+    static constexpr std::size_t _tileWidth = 128;
+    static constexpr std::size_t _tileHeight = 256;
+
+    superconductor_type& _superconductor;
+    const Geometry& _geometry;
+    SolverParameters _parameters;
+    std::size_t _width;
+    std::size_t _height;
+    double _time;
+
+    /**
+     * @brief The number of steps since initialize(), the counter of the noise.
+     */
+    std::uint64_t _steps;
+
+    /**
+     * @brief 1 on grid points in the superconductor, 0 elsewhere.
+     */
+    typename grid::template points<real> _cellWeight;
+
+    /**
+     * @brief 1 on x-bonds with both ends in the superconductor, 0 elsewhere. Supercurrent only flows on these bonds.
+     */
+    typename grid::template xBonds<real> _linkWeightX;
+
+    /**
+     * @brief 1 on y-bonds with both ends in the superconductor, 0 elsewhere.
+     */
+    typename grid::template yBonds<real> _linkWeightY;
+
+    /**
+     * @brief The number of grid points in the superconductor.
+     */
+    double _activeCells;
+
+    /**
+     * @brief Scratch buffer for the order parameter of the next time step.
+     */
+    field_type _nextOrderParameter;
+
+    /**
+     * @brief The buffer that takes over the order parameter after the next step, see handOver().
+     */
+    field_type *_handOverBuffer;
+
+    /**
+     * @brief The scratch space of advance(), a ring of columns per thread; sized for the largest block on
+     * construction and by setParameters().
+     */
+    std::vector<std::complex<real>> _tileScratch;
+
+    /**
+     * @brief The magnetic field on the plaquettes.
+     */
+    magnetic_field_type _magneticField;
+
+    /**
+     * @brief The leads and the buffers of the scalar potential.
+     */
+    struct Leads {
+        Mask source;
+        Mask drain;
+        MultigridParameters parameters;
+        std::unique_ptr<Multigrid> multigrid;
+
+        /**
+         * @brief The fraction of the applied current entering at every grid point, negative at the drain.
+         */
+        RealField injection;
+        RealField divergence;
+        RealField potential;
+        int cycles;
+    };
+    std::unique_ptr<Leads> _leads;
+
+    /**
+     * @brief Whether the linking variables hold those of _appliedField; only used without screening.
+     */
+    bool _appliedLinksValid;
+    double _appliedField;
+
+    /**
+     * @brief The linking variable of a vanishing vector potential.
+     */
+    static link _unitLink();
+
+    /**
+     * @brief Collect the buffers and parameters for the kernels of a step, which are selected per instruction set.
+     * @param appliedField The applied magnetic field.
+     * @param appliedCurrent The applied transport current.
+     * @return The kernel arguments.
+     */
+    kernels::SolverArguments<real, link> _kernelArguments(double appliedField, double appliedCurrent);
+
+    /**
+     * @brief Sizes the scratch space of advance() for the temporal blocking and the thread count. Only grows it again
+     * in advance() if the thread count was raised after construction.
+     */
+    void _reserveTileScratch();
+
+    /**
+     * @brief Makes the order parameter computed in the scratch buffer the current one, and completes a hand-over.
+     */
+    void _swapOrderParameter();
+
+    /**
+     * @brief Recompute the flux cell phasors and the magnetic field from the linking variables.
+     */
+    void _updateFluxCells();
+
+    /**
+     * @brief Rebuild the linking variables and flux cells of the applied field, unless they are cached.
+     * @param appliedField The applied magnetic field.
+     */
+    void _updateAppliedLinks(double appliedField);
+
+    /**
+     * @brief Write the order parameter of the next time step into _nextOrderParameter.
+     */
+    void _updateOrderParameter();
+
+    /**
+     * @brief Add the Langevin noise of the step to _nextOrderParameter, if any.
+     */
+    void _addThermalNoise();
+
+    /**
+     * @brief Build the solver and injection of the leads for the current geometry.
+     */
+    void _updateLeads();
+
+    /**
+     * @brief Solve for the scalar potential of the step, from the supercurrent and the lead currents.
+     * @param appliedCurrent The applied transport current.
+     */
+    void _updateScalarPotential(double appliedCurrent);
+
+    /**
+     * @brief Rotate _nextOrderParameter by the scalar potential.
+     */
+    void _applyScalarPotential();
+
+    /**
+     * @brief Advance the linking variables by one time step.
+     * @param appliedField The applied magnetic field.
+     * @param appliedCurrent The applied transport current.
+     */
+    void _updateLinkingVariables(double appliedField, double appliedCurrent);
+};
+
+/**
+ * @brief A solver for a superconductor stored in double precision.
+ */
+typedef BasicSolver<double> Solver;
+
+#include "../src/Solver.tpp"
+
+extern template class BasicSolver<float>;
+extern template class BasicSolver<double>;
+extern template class BasicSolver<float, Phase>;
+extern template class BasicSolver<double, Phase>;
+
+#endif //CPP_CONSTRICTION_SQUID_SOLVER_H
@@ -7,91 +7,114 @@
 
 #include "AbstractField.h"
 
-class Superconductor {
+/**
+ * @brief The state of a superconductor: the order parameter on the grid points, the linking variables on the bonds
+ * and the flux cell phasors on the plaquettes.
+ * @tparam real The precision the state is stored in, float or double. Single precision halves the memory traffic of
+ * the solver; the solver computes in double precision either way.
+ * @tparam link The type of the linking variables and flux cell phasors: std::complex<real>, or Phase to store only
+ * their phases in 4 bytes each.
+ * @tparam grid The storage of the fields: DynamicGrid for dimensions chosen at runtime, or FixedGrid<W, H> of
+ * FixedField.h to hold W x H grid points inside the object.
+ */
+template<typename real, typename link = std::complex<real>, typename grid = DynamicGrid>
+class BasicSuperconductor {
 public:
+    /**
+     * @brief The type of the order parameter.
+     */
+    typedef typename grid::template points<std::complex<real>> field_type;
+
+    /**
+     * @brief The types of the linking variables in x and y, and of the flux cell phasors.
+     */
+    typedef typename grid::template xBonds<link> x_link_field_type;
+    typedef typename grid::template yBonds<link> y_link_field_type;
+    typedef typename grid::template plaquettes<link> plaquette_field_type;
+
     /**
      * @brief Constructs a new Superconductor object.
      * @param width
      * @param height
      */
-    Superconductor(int width, int height);
+    BasicSuperconductor(int width, int height);
 
     /**
      * @brief Destroys the Superconductor object.
      */
-    ~Superconductor();
+    ~BasicSuperconductor();
 
     /**
      * @brief Copy constructor.
      * @param other The Superconductor to copy.
      */
-    Superconductor(const Superconductor& other);
+    BasicSuperconductor(const BasicSuperconductor& other);
 
     /**
      * @brief Copy assignment operator.
      * @param other The Superconductor to copy.
      */
-    Superconductor& operator=(const Superconductor& other);
+    BasicSuperconductor& operator=(const BasicSuperconductor& other);
 
     /**
      * @brief Move constructor.
      * @param other The Superconductor to move.
      */
-    Superconductor(Superconductor&& other) noexcept;
+    BasicSuperconductor(BasicSuperconductor&& other) noexcept;
 
     /**
      * @brief Move assignment operator.
      * @param other The Superconductor to move.
      */
-    Superconductor& operator=(Superconductor&& other) noexcept;
+    BasicSuperconductor& operator=(BasicSuperconductor&& other) noexcept;
 
     /**
      * @brief Accesses the superconductor's order parameter.
      * @return The order parameter.
      */
-    Field orderParameter() const;
+    field_type orderParameter() const;
 
     /**
      * @brief Accesses the superconductor's order parameter.
      * @return The order parameter.
      */
-    Field& orderParameter();
+    field_type& orderParameter();
 
     /**
      * @brief Accesses the superconductor's linking variable in the x direction.
      * @return The linking variable.
      */
-    Field linkingVariableX() const;
+    x_link_field_type linkingVariableX() const;
 
     /**
      * @brief Accesses the superconductor's linking variable in the x direction.
      * @return The linking variable.
      */
-    Field& linkingVariableX();
+    x_link_field_type& linkingVariableX();
 
     /**
      * @brief Accesses the superconductor's linking variable in the y direction.
      * @return The linking variable.
      */
-    Field linkingVariableY() const;
+    y_link_field_type linkingVariableY() const;
 
     /**
      * @brief Accesses the superconductor's linking variable in the y direction.
      * @return The linking variable.
      */
-    Field& linkingVariableY();
+    y_link_field_type& linkingVariableY();
 
     /**
      * @brief Accesses the superconductor's flux cell phasor.
      * @return The flux cell phasor.
      */
-    Field fluxCellPhasor() const;
+    plaquette_field_type fluxCellPhasor() const;
 
     /**
      * @brief Accesses the superconductor's flux cell phasor.
      * @return The flux cell phasor.
      */
-    Field& fluxCellPhasor();
+    plaquette_field_type& fluxCellPhasor();
 
     /**
      * @brief Access the superconductor's width.
@@ -110,10 +133,22 @@ private:
     std::size_t _width;
     std::size_t _height;
 
-    Field _orderParameter;
-    Field _linkingVariableX;
-    Field _linkingVariableY;
-    Field _fluxCellPhasor;
+    field_type _orderParameter;
+    x_link_field_type _linkingVariableX;
+    y_link_field_type _linkingVariableY;
+    plaquette_field_type _fluxCellPhasor;
 };
 
+/**
+ * @brief A superconductor stored in double precision.
+ */
+typedef BasicSuperconductor<double> Superconductor;
+
+#include "../src/Superconductor.tpp"
+
+extern template class BasicSuperconductor<float>;
+extern template class BasicSuperconductor<double>;
+extern template class BasicSuperconductor<float, Phase>;
+extern template class BasicSuperconductor<double, Phase>;
+
 #endif //CPP_CONSTRICTION_SQUID_SUPERCONDUCTOR_H
@@ -4,22 +4,23 @@
 
 #include <iostream>
 
-inline BoolProxy::BoolProxy(std::vector<bool>& vec, size_t index) : _vec(vec), _index(index) {
+inline BoolProxy::BoolProxy(FieldVector<std::uint64_t>& words, size_t index) : _words(words), _index(index) {
 
 }
 
 inline BoolProxy::operator bool() const {
-    return _vec[_index];
+    return (_words[_index / FieldStorage<bool>::bits] >> (_index % FieldStorage<bool>::bits)) & 1u;
 }
 
 inline BoolProxy& BoolProxy::operator=(bool b) {
-    _vec[_index] = b;
+    const std::uint64_t bit = std::uint64_t(1) << (_index % FieldStorage<bool>::bits);
+    std::uint64_t &word = _words[_index / FieldStorage<bool>::bits];
+    word = b ? word | bit : word & ~bit;
     return *this;
 }
 
-template<typename Derived, typename T>
-inline AbstractField<Derived, T>::AbstractField(int width, int height): _width(1), _height(1),
-                                                                 _field(1, std::vector<T>(1)) {
+template<typename T>
+inline DynamicStorage<T>::DynamicStorage(int width, int height): _width(1), _height(1) {
     if (width <= 0 || height <= 0) {
         throw std::invalid_argument("Width and height must be non-negative");
     }
@@ -27,25 +28,60 @@ inline AbstractField<Derived, T>::AbstractField(int width, int height): _width(1
     _width = static_cast<std::size_t>(width);
     _height = static_cast<std::size_t>(height);
 
-    _field = std::vector<std::vector<T>>(height, std::vector<T>(width));
-    fill(0);
+    _field = FieldVector<storage_type>(FieldStorage<T>::length(_width * _height));
 }
 
-template<typename Derived, typename T>
-inline void AbstractField<Derived, T>::fill(const T &value) {
-    for (auto &row : _field) {
-        std::fill(row.begin(), row.end(), value);
+template<typename T, std::size_t W, std::size_t H>
+inline FixedStorage<T, W, H>::FixedStorage(int width, int height) {
+    if (width != static_cast<int>(W) || height != static_cast<int>(H)) {
+        throw std::invalid_argument("Dimensions must match");
+    }
+}
+
+template<typename Derived, typename T, typename Storage>
+inline AbstractField<Derived, T, Storage>::AbstractField(int width, int height): Storage(width, height) {
+    // Both storages value-initialize their elements, which zeroes them
+}
+
+template<typename Derived, typename T, typename Storage>
+inline void AbstractField<Derived, T, Storage>::fill(const T &value) {
+    // Fixed-size fields are small and keep their constant trip count rather than calling out to a kernel
+    if constexpr (kernels::dispatched<T> && std::is_same_v<Storage, DynamicStorage<T>>) {
+        kernels::elementwise<T>().fill(this->_field.data(), value, this->_field.size());
+    } else if constexpr (std::is_same_v<T, bool>) {
+        std::fill(this->_field.begin(), this->_field.end(), value ? ~storage_type(0) : storage_type(0));
+        const std::size_t tail = size() % FieldStorage<bool>::bits;
+        if (value && tail != 0) {
+            this->_field.back() &= (storage_type(1) << tail) - 1;
+        }
+    } else {
+        std::fill(this->_field.begin(), this->_field.end(), value);
     }
 }
 
-template<typename Derived, typename T>
-inline std::size_t AbstractField<Derived, T>::width() const {
-    return _width;
+template<typename Derived, typename T, typename Storage>
+inline std::size_t AbstractField<Derived, T, Storage>::width() const {
+    return this->_width;
 }
 
-template<typename Derived, typename T>
-inline std::size_t AbstractField<Derived, T>::height() const {
-    return _height;
+template<typename Derived, typename T, typename Storage>
+inline std::size_t AbstractField<Derived, T, Storage>::height() const {
+    return this->_height;
+}
+
+template<typename Derived, typename T, typename Storage>
+inline std::size_t AbstractField<Derived, T, Storage>::size() const {
+    return this->_width * this->_height;
+}
+
+template<typename Derived, typename T, typename Storage>
+inline typename AbstractField<Derived, T, Storage>::storage_type *AbstractField<Derived, T, Storage>::data() {
+    return this->_field.data();
+}
+
+template<typename Derived, typename T, typename Storage>
+inline const typename AbstractField<Derived, T, Storage>::storage_type *AbstractField<Derived, T, Storage>::data() const {
+    return this->_field.data();
 }
 
 template<typename scalar>
@@ -53,7 +89,7 @@ inline scalar ScalarField<scalar>::operator()(std::size_t x, std::size_t y) cons
     if (x >= this->_width || y >= this->_height) {
         throw std::out_of_range("Index out of range");
     }
-    return this->_field[x][y];
+    return this->_field[x * this->_height + y];
 }
 
 template<typename scalar>
@@ -61,23 +97,20 @@ inline scalar &ScalarField<scalar>::operator()(std::size_t x, std::size_t y) {
     if (x >= this->_width || y >= this->_height) {
         throw std::out_of_range("Index out of range");
     }
-    return this->_field[x][y];
+    return this->_field[x * this->_height + y];
 }
 
 inline bool Mask::operator()(std::size_t x, std::size_t y) const{
     if (x >= this->_width || y >= this->_height) {
         throw std::out_of_range("Index out of range");
     }
-    return _field[x][y];
+    const std::size_t index = x * _height + y;
+    return (_field[index / FieldStorage<bool>::bits] >> (index % FieldStorage<bool>::bits)) & 1u;
 }
 
 inline Mask Mask::operator!() const {
     Mask result(this->_width, this->_height);
-    for (std::size_t x = 0; x < this->_width; x++) {
-        for (std::size_t y = 0; y < this->_height; y++) {
-            result(x, y) = !this->_field[x][y];
-        }
-    }
+    kernels::active().maskNot(data(), result.data(), size());
     return result;
 }
 
@@ -87,29 +120,38 @@ inline Mask Mask::operator||(const Mask &other) const {
     }
 
     Mask result(this->_width, this->_height);
-    for (std::size_t x = 0; x < this->_width; x++) {
-        for (std::size_t y = 0; y < this->_height; y++) {
-            result(x, y) = this->_field[x][y] || other._field[x][y];
-        }
-    }
+    kernels::active().maskOr(data(), other.data(), result.data(), size());
     return result;
 }
 
+inline Mask &Mask::operator|=(const Mask &other) {
+    if (this->_width != other._width || this->_height != other._height) {
+        throw std::invalid_argument("Dimensions must match");
+    }
+    kernels::active().maskOr(data(), other.data(), data(), size());
+    return *this;
+}
+
+inline Mask &Mask::invert() {
+    kernels::active().maskNot(data(), data(), size());
+    return *this;
+}
+
+inline std::size_t Mask::count() const {
+    return reductions::popcount(data(), _field.size());
+}
+
 inline BoolProxy Mask::operator()(std::size_t x, std::size_t y) {
     if (x >= this->_width || y >= this->_height) {
         throw std::out_of_range("Index out of range");
     }
-    return BoolProxy(_field[x], y);
+    return BoolProxy(_field, x * _height + y);
 }
 
 template<typename scalar>
 inline ScalarField<scalar> ScalarField<scalar>::operator+(const scalar& val) const{
     ScalarField<scalar> result(this->_width, this->_height);
-    for (std::size_t x = 0; x < this->_width; x++) {
-        for (std::size_t y = 0; y < this->_height; y++) {
-            result(x, y) = this->_field[x][y] + val;
-        }
-    }
+    kernels::elementwise<scalar>().addScalar(this->data(), val, result.data(), this->size());
     return result;
 }
 
@@ -121,22 +163,14 @@ inline ScalarField<scalar> ScalarField<scalar>::operator+(const ScalarField<scal
     }
 
     ScalarField<scalar> result(this->_width, this->_height);
-    for (std::size_t x = 0; x < this->_width; x++) {
-        for (std::size_t y = 0; y < this->_height; y++) {
-            result(x, y) = this->_field[x][y] + other._field[x][y];
-        }
-    }
+    kernels::elementwise<scalar>().add(this->data(), other.data(), result.data(), this->size());
     return result;
 }
 
 template<typename scalar>
 ScalarField<scalar> ScalarField<scalar>::operator-(const scalar& val) const{
     ScalarField<scalar> result(this->_width, this->_height);
-    for (std::size_t x = 0; x < this->_width; x++) {
-        for (std::size_t y = 0; y < this->_height; y++) {
-            result(x, y) = this->_field[x][y] - val;
-        }
-    }
+    kernels::elementwise<scalar>().subtractScalar(this->data(), val, result.data(), this->size());
     return result;
 }
 
@@ -147,22 +181,14 @@ inline ScalarField<scalar> ScalarField<scalar>::operator-(const ScalarField<scal
     }
 
     ScalarField<scalar> result(this->_width, this->_height);
-    for (std::size_t x = 0; x < this->_width; x++) {
-        for (std::size_t y = 0; y < this->_height; y++) {
-            result(x, y) = this->_field[x][y] - other._field[x][y];
-        }
-    }
+    kernels::elementwise<scalar>().subtract(this->data(), other.data(), result.data(), this->size());
     return result;
 }
 
 template<typename scalar>
 inline ScalarField<scalar> ScalarField<scalar>::operator*(const scalar& val) const{
     ScalarField<scalar> result(this->_width, this->_height);
-    for (std::size_t x = 0; x < this->_width; x++) {
-        for (std::size_t y = 0; y < this->_height; y++) {
-            result(x, y) = this->_field[x][y] * val;
-        }
-    }
+    kernels::elementwise<scalar>().multiplyScalar(this->data(), val, result.data(), this->size());
     return result;
 }
 
@@ -173,10 +199,123 @@ inline ScalarField<scalar> ScalarField<scalar>::operator*(const ScalarField<scal
     }
 
     ScalarField<scalar> result(this->_width, this->_height);
-    for (std::size_t x = 0; x < this->_width; x++) {
-        for (std::size_t y = 0; y < this->_height; y++) {
-            result(x, y) = this->_field[x][y] * other._field[x][y];
-        }
-    }
+    kernels::elementwise<scalar>().multiply(this->data(), other.data(), result.data(), this->size());
     return result;
-}
\ No newline at end of file
+}
+
+template<typename scalar>
+inline ScalarField<scalar> &ScalarField<scalar>::operator+=(const scalar &val) {
+    kernels::elementwise<scalar>().addScalar(this->data(), val, this->data(), this->size());
+    return *this;
+}
+
+template<typename scalar>
+inline ScalarField<scalar> &ScalarField<scalar>::operator+=(const ScalarField<scalar> &other) {
+    if (this->_width != other._width || this->_height != other._height) {
+        throw std::invalid_argument("Dimensions must match");
+    }
+    kernels::elementwise<scalar>().add(this->data(), other.data(), this->data(), this->size());
+    return *this;
+}
+
+template<typename scalar>
+inline ScalarField<scalar> &ScalarField<scalar>::operator-=(const scalar &val) {
+    kernels::elementwise<scalar>().subtractScalar(this->data(), val, this->data(), this->size());
+    return *this;
+}
+
+template<typename scalar>
+inline ScalarField<scalar> &ScalarField<scalar>::operator-=(const ScalarField<scalar> &other) {
+    if (this->_width != other._width || this->_height != other._height) {
+        throw std::invalid_argument("Dimensions must match");
+    }
+    kernels::elementwise<scalar>().subtract(this->data(), other.data(), this->data(), this->size());
+    return *this;
+}
+
+template<typename scalar>
+inline ScalarField<scalar> &ScalarField<scalar>::operator*=(const scalar &val) {
+    kernels::elementwise<scalar>().multiplyScalar(this->data(), val, this->data(), this->size());
+    return *this;
+}
+
+template<typename scalar>
+inline ScalarField<scalar> &ScalarField<scalar>::operator*=(const ScalarField<scalar> &other) {
+    if (this->_width != other._width || this->_height != other._height) {
+        throw std::invalid_argument("Dimensions must match");
+    }
+    kernels::elementwise<scalar>().multiply(this->data(), other.data(), this->data(), this->size());
+    return *this;
+}
+
+template<typename scalar>
+inline ScalarField<scalar> &ScalarField<scalar>::where(const Mask &region, const scalar &value) {
+    if (this->_width != region.width() || this->_height != region.height()) {
+        throw std::invalid_argument("Dimensions must match");
+    }
+    kernels::elementwise<scalar>().fillMasked(this->data(), region.data(), value, this->size());
+    return *this;
+}
+
+template<typename scalar>
+inline ScalarField<scalar> &ScalarField<scalar>::assignMasked(const Mask &region, const ScalarField<scalar> &other) {
+    if (this->_width != region.width() || this->_height != region.height() || this->_width != other._width
+        || this->_height != other._height) {
+        throw std::invalid_argument("Dimensions must match");
+    }
+    kernels::elementwise<scalar>().copyMasked(other.data(), region.data(), this->data(), this->size());
+    return *this;
+}
+
+template<typename scalar>
+inline ScalarField<scalar> &ScalarField<scalar>::scaleMasked(const Mask &region, const scalar &factor) {
+    if (this->_width != region.width() || this->_height != region.height()) {
+        throw std::invalid_argument("Dimensions must match");
+    }
+    kernels::elementwise<scalar>().multiplyScalarMasked(this->data(), region.data(), factor, this->size());
+    return *this;
+}
+
+template<typename scalar>
+inline typename ScalarField<scalar>::accumulator_type ScalarField<scalar>::sum() const {
+    return reductions::sum(this->data(), this->size());
+}
+
+template<typename scalar>
+inline typename ScalarField<scalar>::accumulator_type ScalarField<scalar>::sum(const Mask &region) const {
+    if (this->_width != region.width() || this->_height != region.height()) {
+        throw std::invalid_argument("Dimensions must match");
+    }
+    return reductions::maskedSum(this->data(), region.data(), this->size());
+}
+
+template<typename scalar>
+inline typename ScalarField<scalar>::accumulator_type ScalarField<scalar>::dot(const ScalarField &other) const {
+    if (this->_width != other._width || this->_height != other._height) {
+        throw std::invalid_argument("Dimensions must match");
+    }
+    return reductions::dot(this->data(), other.data(), this->size());
+}
+
+template<typename scalar>
+inline double ScalarField<scalar>::squaredNorm() const {
+    return reductions::squaredNorm(this->data(), this->size());
+}
+
+template<typename scalar>
+inline double ScalarField<scalar>::squaredNorm(const Mask &region) const {
+    if (this->_width != region.width() || this->_height != region.height()) {
+        throw std::invalid_argument("Dimensions must match");
+    }
+    return reductions::maskedSquaredNorm(this->data(), region.data(), this->size());
+}
+
+template<typename scalar>
+inline double ScalarField<scalar>::norm2() const {
+    return std::sqrt(squaredNorm());
+}
+
+template<typename scalar>
+inline double ScalarField<scalar>::maxAbs() const {
+    return reductions::maxAbs(this->data(), this->size());
+}
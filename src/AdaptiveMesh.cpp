@@ -0,0 +1,670 @@
+#include "../include/AdaptiveMesh.h"
+#include "../include/Instrumentation.h"
+#include "../include/KernelCost.h"
+#include "../include/Kernels.h"
+#include "../include/Multiresolution.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+    /**
+     * @brief Levels are only coarsened from geometries of at least this many points on a side.
+     */
+    constexpr int smallestGeometry = 8;
+
+    /**
+     * @brief The length of the run of superconductor through every point of a geometry, along x and along y, 0
+     * outside of it.
+     */
+    std::vector<int> featureWidths(const Geometry &geometry) {
+        const int W = geometry.width();
+        const int H = geometry.height();
+        std::vector<int> alongX(static_cast<std::size_t>(W) * H, 0);
+        std::vector<int> alongY(static_cast<std::size_t>(W) * H, 0);
+        for (int y = 0; y < H; y++) {
+            for (int x = 0; x < W;) {
+                int end = x;
+                while (end < W && geometry.inSuperconductor(end, y)) {
+                    end++;
+                }
+                for (int i = x; i < end; i++) {
+                    alongX[static_cast<std::size_t>(i) * H + y] = end - x;
+                }
+                x = end + 1;
+            }
+        }
+        for (int x = 0; x < W; x++) {
+            for (int y = 0; y < H;) {
+                int end = y;
+                while (end < H && geometry.inSuperconductor(x, end)) {
+                    end++;
+                }
+                for (int i = y; i < end; i++) {
+                    alongY[static_cast<std::size_t>(x) * H + i] = end - y;
+                }
+                y = end + 1;
+            }
+        }
+        for (std::size_t i = 0; i < alongX.size(); i++) {
+            alongX[i] = std::min(alongX[i], alongY[i]);
+        }
+        return alongX;
+    }
+}
+
+AdaptiveMesh::AdaptiveMesh(const Geometry &geometry, const SolverParameters &parameters,
+                           const RefinementParameters &refinement) :
+        _parameters(parameters), _refinement(refinement), _size(0), _time(0.0), _steps(0), _appliedField(0.0) {
+    Solver::validateParameters(parameters);
+    if (parameters.screening) {
+        throw std::invalid_argument("Adaptive meshes need a run without screening.");
+    }
+    if (parameters.noise != 0.0) {
+        throw std::invalid_argument("Adaptive meshes cannot run with noise.");
+    }
+    if (refinement.levels < 1) {
+        throw std::invalid_argument("An adaptive mesh needs at least one level.");
+    }
+    if (refinement.patchSize < 4) {
+        throw std::invalid_argument("Patches need at least 4 points on a side.");
+    }
+    if (!(refinement.featureWidth >= 0.0) || !(refinement.gradient > 0.0) || refinement.regridInterval < 0) {
+        throw std::invalid_argument("Refinement criteria must be positive.");
+    }
+    _size = static_cast<std::size_t>(refinement.patchSize);
+
+    // The geometries from the finest level up
+    std::vector<Geometry> geometries{geometry};
+    for (int l = 1; l < refinement.levels; l++) {
+        const Geometry &fine = geometries.back();
+        if (fine.width() < smallestGeometry || fine.height() < smallestGeometry) {
+            throw std::invalid_argument("The geometry is too small for " + std::to_string(refinement.levels)
+                                        + " levels.");
+        }
+        geometries.push_back(multiresolution::coarsen(fine));
+    }
+    std::reverse(geometries.begin(), geometries.end());
+
+    const std::vector<int> widths = featureWidths(geometry);
+    const auto L = static_cast<std::size_t>(refinement.levels);
+    const auto P = static_cast<int>(_size);
+    for (std::size_t l = 0; l < L; l++) {
+        const int stride = 1 << (L - 1 - l);
+        const Geometry &level = geometries[l];
+        const int columns = (level.width() + P - 1) / P;
+        const int rows = (level.height() + P - 1) / P;
+        const auto positions = static_cast<std::size_t>(columns) * rows;
+        _levels.push_back({level, parameters.gridSpacing * stride,
+                           parameters.timeStep * static_cast<double>(stride) * stride, columns, rows, {},
+                           std::vector<int>(positions, -1), std::vector<std::uint8_t>(positions, 0),
+                           std::vector<std::uint8_t>(positions, 0), {}, {}});
+
+        // Patch (X, Y) of the level covers points X P s to (X + 1) P s - 1 of the geometry, likewise y
+        Level &current = _levels.back();
+        const double narrow = refinement.featureWidth * stride;
+        for (int x = 0; x < geometry.width(); x++) {
+            for (int y = 0; y < geometry.height(); y++) {
+                if (!geometry.inSuperconductor(x, y)) {
+                    continue;
+                }
+                const std::size_t position = static_cast<std::size_t>(x / (P * stride)) * rows + y / (P * stride);
+                current.occupied[position] = 1;
+                if (l + 1 < L && widths[static_cast<std::size_t>(x) * geometry.height() + y] < narrow) {
+                    current.narrow[position] = 1;
+                }
+            }
+        }
+    }
+    initialize();
+}
+
+void AdaptiveMesh::initialize() {
+    _time = 0.0;
+    _steps = 0;
+    for (Level &level : _levels) {
+        level.patches.clear();
+        std::fill(level.index.begin(), level.index.end(), -1);
+    }
+    _setAppliedField(0.0);
+    Level &base = _levels.front();
+    for (int x = 0; x < base.columns; x++) {
+        for (int y = 0; y < base.rows; y++) {
+            if (base.occupied[static_cast<std::size_t>(x) * base.rows + y]) {
+                _addPatch(0, x, y);
+            }
+        }
+    }
+    regrid();
+    for (Level &level : _levels) {
+        for (Patch &patch : level.patches) {
+            for (std::size_t i = 0; i < patch.cellWeight.size(); i++) {
+                patch.orderParameter.data()[i] = patch.cellWeight.data()[i];
+                patch.previousOrderParameter.data()[i] = patch.cellWeight.data()[i];
+            }
+        }
+    }
+}
+
+void AdaptiveMesh::load(const ComplexField<double> &orderParameter, double appliedField) {
+    const Geometry &geometry = _levels.back().geometry;
+    if (orderParameter.width() != static_cast<std::size_t>(geometry.width())
+        || orderParameter.height() != static_cast<std::size_t>(geometry.height())) {
+        throw std::invalid_argument("The state must have the dimensions of the geometry.");
+    }
+    _setAppliedField(appliedField);
+    // A regrid adds at most one level where psi is steep, sampled again to locate the steep regions on it
+    _sample(orderParameter);
+    for (std::size_t l = 1; l < _levels.size(); l++) {
+        regrid();
+        _sample(orderParameter);
+    }
+}
+
+void AdaptiveMesh::step(double appliedField) {
+    if (appliedField != _appliedField) {
+        _setAppliedField(appliedField);
+    }
+    _advance(0, 0.0);
+    _time += _levels.front().timeStep;
+    _steps++;
+    if (_refinement.regridInterval > 0 && _steps % static_cast<std::uint64_t>(_refinement.regridInterval) == 0) {
+        regrid();
+    }
+}
+
+void AdaptiveMesh::regrid() {
+    SQUID_TIMED_SCOPE("regrid", cells(), 0);
+    const std::size_t L = _levels.size();
+
+    // Which positions of every level to refine, from the finest level up: those the criteria ask for, and those
+    // under or beside the refined positions of the next level, which keeps each level nested in the one before
+    std::vector<std::vector<std::uint8_t>> refine(L);
+    for (std::size_t l = L - 1; l-- > 0;) {
+        Level &level = _levels[l];
+        refine[l] = level.narrow;
+        for (const Patch &patch : level.patches) {
+            if (_steep(patch)) {
+                refine[l][static_cast<std::size_t>(patch.x) * level.rows + patch.y] = 1;
+            }
+        }
+        if (l + 2 < L) {
+            const Level &next = _levels[l + 1];
+            for (int x = 0; x < next.columns; x++) {
+                for (int y = 0; y < next.rows; y++) {
+                    if (!refine[l + 1][static_cast<std::size_t>(x) * next.rows + y]) {
+                        continue;
+                    }
+                    for (int nx = std::max(0, x - 1); nx <= std::min(next.columns - 1, x + 1); nx++) {
+                        for (int ny = std::max(0, y - 1); ny <= std::min(next.rows - 1, y + 1); ny++) {
+                            if (next.occupied[static_cast<std::size_t>(nx) * next.rows + ny]) {
+                                refine[l][static_cast<std::size_t>(nx / 2) * level.rows + ny / 2] = 1;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // The children of the refined positions, from the coarsest level down, so that new patches are interpolated
+    // from a level that is already complete
+    std::vector<Sample> samples;
+    const std::size_t n = _size + 2;
+    for (std::size_t l = 1; l < L; l++) {
+        Level &level = _levels[l];
+        const Level &coarse = _levels[l - 1];
+        std::vector<Patch> previous = std::move(level.patches);
+        const std::vector<int> previousIndex = level.index;
+        level.patches.clear();
+        std::fill(level.index.begin(), level.index.end(), -1);
+        for (const Patch &parent : coarse.patches) {
+            if (!refine[l - 1][static_cast<std::size_t>(parent.x) * coarse.rows + parent.y]) {
+                continue;
+            }
+            for (int x = 2 * parent.x; x < std::min(level.columns, 2 * parent.x + 2); x++) {
+                for (int y = 2 * parent.y; y < std::min(level.rows, 2 * parent.y + 2); y++) {
+                    const std::size_t position = static_cast<std::size_t>(x) * level.rows + y;
+                    if (!level.occupied[position]) {
+                        continue;
+                    }
+                    if (previousIndex[position] >= 0) {
+                        level.patches.push_back(std::move(previous[previousIndex[position]]));
+                        level.index[position] = static_cast<int>(level.patches.size() - 1);
+                        continue;
+                    }
+                    Patch &patch = _addPatch(l, x, y);
+                    for (std::size_t u = 0; u < n; u++) {
+                        for (std::size_t v = 0; v < n; v++) {
+                            const std::size_t i = u * n + v;
+                            if (patch.cellWeight.data()[i] == 0.0) {
+                                continue;
+                            }
+                            _interpolation(l, static_cast<long>(x * _size + u) - 1,
+                                           static_cast<long>(y * _size + v) - 1, samples);
+                            complex sum = 0.0;
+                            for (const Sample &sample : samples) {
+                                const Patch &source = coarse.patches[_patchAt(l - 1, sample.x, sample.y)];
+                                sum += sample.weight * source.orderParameter.data()[_pointOf(sample.x,
+                                                                                              sample.y)];
+                            }
+                            patch.orderParameter.data()[i] = sum;
+                            patch.previousOrderParameter.data()[i] = sum;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    for (std::size_t l = 0; l < L; l++) {
+        _connect(l);
+    }
+}
+
+void AdaptiveMesh::composite(ComplexField<double> &orderParameter) const {
+    const Geometry &geometry = _levels.back().geometry;
+    if (orderParameter.width() != static_cast<std::size_t>(geometry.width())
+        || orderParameter.height() != static_cast<std::size_t>(geometry.height())) {
+        throw std::invalid_argument("The state must have the dimensions of the geometry.");
+    }
+
+    // Every level in full, from the patches where it has them and interpolated from the level before elsewhere
+    std::vector<complex> coarse;
+    std::vector<complex> fine;
+    std::vector<Sample> samples;
+    std::size_t coarseHeight = 0;
+    for (std::size_t l = 0; l < _levels.size(); l++) {
+        const Level &level = _levels[l];
+        const auto W = static_cast<long>(level.geometry.width());
+        const auto H = static_cast<long>(level.geometry.height());
+        fine.assign(static_cast<std::size_t>(W * H), 0.0);
+        for (long x = 0; x < W; x++) {
+            for (long y = 0; y < H; y++) {
+                if (!_inSuperconductor(l, x, y)) {
+                    continue;
+                }
+                const int patch = _patchAt(l, x, y);
+                complex &value = fine[x * H + y];
+                if (patch >= 0) {
+                    value = level.patches[patch].orderParameter.data()[_pointOf(x, y)];
+                } else if (l > 0) {
+                    _interpolation(l, x, y, samples);
+                    for (const Sample &sample : samples) {
+                        value += sample.weight * coarse[sample.x * coarseHeight + sample.y];
+                    }
+                }
+            }
+        }
+        std::swap(coarse, fine);
+        coarseHeight = static_cast<std::size_t>(H);
+    }
+    std::copy(coarse.begin(), coarse.end(), orderParameter.data());
+}
+
+double AdaptiveMesh::time() const {
+    return _time;
+}
+
+double AdaptiveMesh::timeStep() const {
+    return _levels.front().timeStep;
+}
+
+std::size_t AdaptiveMesh::levels() const {
+    return _levels.size();
+}
+
+std::size_t AdaptiveMesh::patches(std::size_t level) const {
+    return _levels.at(level).patches.size();
+}
+
+int AdaptiveMesh::coverage(int x, int y) const {
+    const Geometry &geometry = _levels.back().geometry;
+    if (x < 0 || y < 0 || x >= geometry.width() || y >= geometry.height()) {
+        return -1;
+    }
+    const std::size_t L = _levels.size();
+    for (std::size_t l = L; l-- > 0;) {
+        const Level &level = _levels[l];
+        const int span = static_cast<int>(_size) << (L - 1 - l);
+        if (level.index[static_cast<std::size_t>(x / span) * level.rows + y / span] >= 0) {
+            return static_cast<int>(l);
+        }
+    }
+    return -1;
+}
+
+std::size_t AdaptiveMesh::cells() const {
+    std::size_t patches = 0;
+    for (const Level &level : _levels) {
+        patches += level.patches.size();
+    }
+    return patches * _size * _size;
+}
+
+std::size_t AdaptiveMesh::cellUpdates() const {
+    std::size_t updates = 0;
+    std::size_t steps = 1;
+    for (const Level &level : _levels) {
+        updates += steps * level.patches.size() * _size * _size;
+        steps *= 4;
+    }
+    return updates;
+}
+
+bool AdaptiveMesh::_inSuperconductor(std::size_t level, long x, long y) const {
+    const Geometry &geometry = _levels[level].geometry;
+    return x >= 0 && y >= 0 && x < geometry.width() && y < geometry.height()
+           && geometry.inSuperconductor(static_cast<int>(x), static_cast<int>(y));
+}
+
+int AdaptiveMesh::_patchAt(std::size_t level, long x, long y) const {
+    const Level &current = _levels[level];
+    const auto P = static_cast<long>(_size);
+    if (x < 0 || y < 0 || x / P >= current.columns || y / P >= current.rows) {
+        return -1;
+    }
+    return current.index[static_cast<std::size_t>(x / P) * current.rows + y / P];
+}
+
+std::size_t AdaptiveMesh::_pointOf(long x, long y) const {
+    const auto P = static_cast<long>(_size);
+    return static_cast<std::size_t>((x % P + 1) * (P + 2) + y % P + 1);
+}
+
+void AdaptiveMesh::_interpolation(std::size_t level, long x, long y, std::vector<Sample> &samples) const {
+    samples.clear();
+    const double h = _levels[level].gridSpacing;
+
+    // The link exp(-i integral A . dl) from point (x0, y0) of the level to (x1, y1), by Simpson's rule
+    auto transport = [this, h](long x0, long y0, long x1, long y1) {
+        const double ax = static_cast<double>(x0) * h;
+        const double ay = static_cast<double>(y0) * h;
+        const double bx = static_cast<double>(x1) * h;
+        const double by = static_cast<double>(y1) * h;
+        const std::array<double, 2> start = _potential(ax, ay);
+        const std::array<double, 2> middle = _potential(0.5 * (ax + bx), 0.5 * (ay + by));
+        const std::array<double, 2> end = _potential(bx, by);
+        const double integral = ((bx - ax) * (start[0] + 4.0 * middle[0] + end[0])
+                                 + (by - ay) * (start[1] + 4.0 * middle[1] + end[1])) / 6.0;
+        return std::polar(1.0, -integral);
+    };
+    // Points with even coordinates are the points of the level before
+    auto node = [this, level](long px, long py) {
+        return _inSuperconductor(level - 1, px / 2, py / 2);
+    };
+    auto hasEnds = [&node](long px, long py) {
+        const long dx = px & 1;
+        const long dy = 1 - dx;
+        return node(px - dx, py - dy) || node(px + dx, py + dy);
+    };
+    // The mean of the ends of a bond of the level before in the superconductor, transported to its midpoint
+    auto midpoint = [&](long px, long py, complex weight) {
+        const long dx = px & 1;
+        const long dy = 1 - dx;
+        const bool first = node(px - dx, py - dy);
+        const bool second = node(px + dx, py + dy);
+        const double ends = (first ? 1.0 : 0.0) + (second ? 1.0 : 0.0);
+        if (first) {
+            samples.push_back({(px - dx) / 2, (py - dy) / 2, weight * transport(px, py, px - dx, py - dy) / ends});
+        }
+        if (second) {
+            samples.push_back({(px + dx) / 2, (py + dy) / 2, weight * transport(px, py, px + dx, py + dy) / ends});
+        }
+    };
+
+    const bool oddX = (x & 1) != 0;
+    const bool oddY = (y & 1) != 0;
+    if (!oddX && !oddY) {
+        if (node(x, y)) {
+            samples.push_back({x / 2, y / 2, 1.0});
+        }
+    } else if (oddX != oddY) {
+        midpoint(x, y, 1.0);
+    } else {
+        // The centre of a plaquette of the level before: the mean of its midpoints, transported to it
+        const long midpoints[4][2] = {{x, y - 1}, {x, y + 1}, {x - 1, y}, {x + 1, y}};
+        double count = 0.0;
+        for (const auto &m : midpoints) {
+            count += hasEnds(m[0], m[1]) ? 1.0 : 0.0;
+        }
+        for (const auto &m : midpoints) {
+            if (hasEnds(m[0], m[1])) {
+                midpoint(m[0], m[1], transport(x, y, m[0], m[1]) / count);
+            }
+        }
+    }
+}
+
+AdaptiveMesh::Patch &AdaptiveMesh::_addPatch(std::size_t level, int x, int y) {
+    Level &current = _levels[level];
+    const auto n = static_cast<int>(_size + 2);
+    current.patches.push_back({x, y, ComplexField<double>(n, n), ComplexField<double>(n, n),
+                               ComplexField<double>(n, n), ScalarField<complex>(n - 1, n),
+                               ScalarField<complex>(n, n - 1), RealField(n, n), RealField(n - 1, n),
+                               RealField(n, n - 1)});
+    current.index[static_cast<std::size_t>(x) * current.rows + y] = static_cast<int>(current.patches.size() - 1);
+    Patch &patch = current.patches.back();
+    patch.orderParameter.fill(0.0);
+    patch.nextOrderParameter.fill(0.0);
+    patch.previousOrderParameter.fill(0.0);
+
+    // Weights of the ghost ring as well, the kernel reads the bonds to it
+    const auto P = static_cast<long>(_size);
+    for (int u = 0; u < n; u++) {
+        for (int v = 0; v < n; v++) {
+            const bool active = _inSuperconductor(level, x * P + u - 1, y * P + v - 1);
+            patch.cellWeight(u, v) = active ? 1.0 : 0.0;
+        }
+    }
+    for (int u = 0; u + 1 < n; u++) {
+        for (int v = 0; v < n; v++) {
+            patch.linkWeightX(u, v) = patch.cellWeight(u, v) * patch.cellWeight(u + 1, v);
+        }
+    }
+    for (int u = 0; u < n; u++) {
+        for (int v = 0; v + 1 < n; v++) {
+            patch.linkWeightY(u, v) = patch.cellWeight(u, v) * patch.cellWeight(u, v + 1);
+        }
+    }
+    _updateLinks(level, patch);
+    return patch;
+}
+
+void AdaptiveMesh::_updateLinks(std::size_t level, Patch &patch) const {
+    const double h = _levels[level].gridSpacing;
+    const auto P = static_cast<double>(_size);
+    const double x0 = (patch.x * P - 1.0) * h;
+    const double y0 = (patch.y * P - 1.0) * h;
+    const VectorPotential &potential = _potential;
+    gauge::linkingVariables<complex>([&potential, x0, y0](double x, double y) { return potential(x0 + x, y0 + y); },
+                                     h, patch.linkingVariableX, patch.linkingVariableY);
+}
+
+void AdaptiveMesh::_connect(std::size_t level) {
+    Level &current = _levels[level];
+    current.ghosts.clear();
+    current.terms.clear();
+    std::vector<Sample> samples;
+    const auto n = static_cast<long>(_size + 2);
+    const auto P = static_cast<long>(_size);
+    for (std::size_t p = 0; p < current.patches.size(); p++) {
+        const Patch &patch = current.patches[p];
+        for (long u = 0; u < n; u++) {
+            for (long v = 0; v < n; v++) {
+                // The ring without its corners, which the five-point stencil does not reach
+                if ((u == 0 || u == n - 1) == (v == 0 || v == n - 1)) {
+                    continue;
+                }
+                const long x = patch.x * P + u - 1;
+                const long y = patch.y * P + v - 1;
+                if (!_inSuperconductor(level, x, y)) {
+                    continue;
+                }
+                const auto point = static_cast<std::size_t>(u * n + v);
+                const int neighbour = _patchAt(level, x, y);
+                if (neighbour >= 0) {
+                    current.terms.push_back({static_cast<std::size_t>(neighbour), _pointOf(x, y), 1.0});
+                    current.ghosts.push_back({p, point, current.terms.size(), false});
+                    continue;
+                }
+                // Nesting puts a patch of the level before over every point it interpolates from
+                _interpolation(level, x, y, samples);
+                for (const Sample &sample : samples) {
+                    current.terms.push_back({static_cast<std::size_t>(_patchAt(level - 1, sample.x, sample.y)),
+                                             _pointOf(sample.x, sample.y), sample.weight});
+                }
+                current.ghosts.push_back({p, point, current.terms.size(), true});
+            }
+        }
+    }
+}
+
+void AdaptiveMesh::_fillGhosts(std::size_t level, double fraction) {
+    Level &current = _levels[level];
+    SQUID_TIMED_SCOPE("ghost points", current.ghosts.size(), current.terms.size() * 2 * sizeof(complex));
+    const std::vector<Patch> *coarse = level > 0 ? &_levels[level - 1].patches : nullptr;
+    const auto count = static_cast<long>(current.ghosts.size());
+#pragma omp parallel for if(count > 4096)
+    for (long g = 0; g < count; g++) {
+        const Ghost &ghost = current.ghosts[g];
+        complex sum = 0.0;
+        for (std::size_t t = g > 0 ? current.ghosts[g - 1].end : 0; t < ghost.end; t++) {
+            const Term &term = current.terms[t];
+            if (ghost.coarse) {
+                // Linear in time between the states of the level before at the start and the end of its step
+                const Patch &source = (*coarse)[term.patch];
+                sum += term.weight * ((1.0 - fraction) * source.previousOrderParameter.data()[term.point]
+                                      + fraction * source.orderParameter.data()[term.point]);
+            } else {
+                sum += term.weight * current.patches[term.patch].orderParameter.data()[term.point];
+            }
+        }
+        current.patches[ghost.patch].orderParameter.data()[ghost.point] = sum;
+    }
+}
+
+void AdaptiveMesh::_advance(std::size_t level, double fraction) {
+    Level &current = _levels[level];
+    _fillGhosts(level, fraction);
+    {
+        const std::size_t n = _size + 2;
+        [[maybe_unused]] const std::size_t points = current.patches.size() * n * n;
+        SQUID_TIMED_SCOPE(kernelCost::orderParameter.name, points, points * kernelCost::orderParameter.bytesPerCell);
+        const auto &kernel = kernels::solver<double>().orderParameter;
+        const auto count = static_cast<long>(current.patches.size());
+        // Patches are independent and small, so the threads share out the patches and each runs the kernel alone:
+        // its own parallel loop gets a team of one, whatever the nesting settings
+#pragma omp parallel
+        {
+#ifdef _OPENMP
+            omp_set_num_threads(1);
+#endif
+#pragma omp for schedule(static)
+            for (long p = 0; p < count; p++) {
+                Patch &patch = current.patches[p];
+                kernel({n, n, current.gridSpacing, current.timeStep, _parameters.kappa, 0.0, 0.0,
+                        patch.cellWeight.data(), patch.linkWeightX.data(), patch.linkWeightY.data(),
+                        patch.orderParameter.data(), patch.nextOrderParameter.data(), patch.linkingVariableX.data(),
+                        patch.linkingVariableY.data(), nullptr, nullptr, 0.0, 0, 0});
+                // The state before the step becomes the previous one, the next the current one, without copying
+                std::swap(patch.previousOrderParameter, patch.orderParameter);
+                std::swap(patch.orderParameter, patch.nextOrderParameter);
+            }
+        }
+    }
+    if (level + 1 < _levels.size() && !_levels[level + 1].patches.empty()) {
+        for (int substep = 0; substep < 4; substep++) {
+            _advance(level + 1, 0.25 * substep);
+        }
+        _restrict(level + 1);
+    }
+}
+
+void AdaptiveMesh::_restrict(std::size_t level) {
+    Level &fine = _levels[level];
+    Level &coarse = _levels[level - 1];
+    const auto n = static_cast<long>(_size + 2);
+    const auto P = static_cast<long>(_size);
+    const auto count = static_cast<long>(fine.patches.size());
+#pragma omp parallel for schedule(static)
+    for (long p = 0; p < count; p++) {
+        const Patch &patch = fine.patches[p];
+        for (long u = 1; u <= P; u++) {
+            for (long v = 1; v <= P; v++) {
+                const long x = patch.x * P + u - 1;
+                const long y = patch.y * P + v - 1;
+                if ((x & 1) != 0 || (y & 1) != 0) {
+                    continue;
+                }
+                const int parent = _patchAt(level - 1, x / 2, y / 2);
+                if (parent >= 0) {
+                    coarse.patches[parent].orderParameter.data()[_pointOf(x / 2, y / 2)]
+                            = patch.orderParameter.data()[u * n + v];
+                }
+            }
+        }
+    }
+}
+
+bool AdaptiveMesh::_steep(const Patch &patch) const {
+    const auto n = static_cast<std::size_t>(_size + 2);
+    const complex *psi = patch.orderParameter.data();
+    const complex *ux = patch.linkingVariableX.data();
+    const complex *uy = patch.linkingVariableY.data();
+    const double *wx = patch.linkWeightX.data();
+    const double *wy = patch.linkWeightY.data();
+    for (std::size_t u = 1; u <= _size; u++) {
+        for (std::size_t v = 1; v <= _size; v++) {
+            const std::size_t i = u * n + v;
+            if (u < _size && wx[i] > 0.0 && std::abs(ux[i] * psi[i + n] - psi[i]) > _refinement.gradient) {
+                return true;
+            }
+            if (v < _size && wy[u * (n - 1) + v] > 0.0
+                && std::abs(uy[u * (n - 1) + v] * psi[i + 1] - psi[i]) > _refinement.gradient) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void AdaptiveMesh::_sample(const ComplexField<double> &orderParameter) {
+    const std::size_t L = _levels.size();
+    const auto n = static_cast<long>(_size + 2);
+    const auto P = static_cast<long>(_size);
+    for (std::size_t l = 0; l < L; l++) {
+        const long stride = 1L << (L - 1 - l);
+        for (Patch &patch : _levels[l].patches) {
+            for (long u = 0; u < n; u++) {
+                for (long v = 0; v < n; v++) {
+                    const std::size_t i = u * n + v;
+                    const complex value = patch.cellWeight.data()[i] != 0.0
+                                          ? orderParameter((patch.x * P + u - 1) * stride,
+                                                           (patch.y * P + v - 1) * stride)
+                                          : complex(0.0);
+                    patch.orderParameter.data()[i] = value;
+                    patch.previousOrderParameter.data()[i] = value;
+                }
+            }
+        }
+    }
+}
+
+void AdaptiveMesh::_setAppliedField(double appliedField) {
+    const Geometry &geometry = _levels.back().geometry;
+    _appliedField = appliedField;
+    _potential = gauge::uniformField(appliedField, _parameters.gauge, geometry.width(), geometry.height(),
+                                     _parameters.gridSpacing);
+    for (std::size_t l = 0; l < _levels.size(); l++) {
+        for (Patch &patch : _levels[l].patches) {
+            _updateLinks(l, patch);
+        }
+        _connect(l);
+    }
+}
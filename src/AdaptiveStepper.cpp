@@ -0,0 +1,160 @@
+#include "../include/AdaptiveStepper.h"
+#include "../include/Instrumentation.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace {
+    /**
+     * @brief The safety factor on the optimal time step, and the bounds on its change per step.
+     */
+    constexpr double safety = 0.9;
+    constexpr double smallestFactor = 0.2;
+    constexpr double largestFactor = 5.0;
+
+    /**
+     * @brief Copies a field into another of the same dimensions, without reallocating.
+     */
+    template<typename scalar>
+    void copy(const ScalarField<scalar> &from, ScalarField<scalar> &to) {
+        std::copy(from.data(), from.data() + from.size(), to.data());
+    }
+}
+
+template<typename real, typename link>
+BasicAdaptiveStepper<real, link>::BasicAdaptiveStepper(BasicSolver<real, link> &solver,
+                                                       const AdaptiveParameters &parameters) :
+        _solver(solver), _parameters(parameters), _timeStep(solver.parameters().timeStep), _accepted(0),
+        _rejected(0), _time(0.0), _steps(0), _orderParameter(solver._width, solver._height),
+        _linkingVariableX(solver._width - 1, solver._height), _linkingVariableY(solver._width, solver._height - 1),
+        _fullStep(solver._width, solver._height) {
+    if (!(parameters.tolerance > 0.0)) {
+        throw std::invalid_argument("Tolerance must be positive.");
+    }
+    if (!(parameters.minimumTimeStep > 0.0)) {
+        throw std::invalid_argument("Minimum time step must be positive.");
+    }
+    if (parameters.maximumTimeStep != 0.0 && !(parameters.maximumTimeStep >= parameters.minimumTimeStep)) {
+        throw std::invalid_argument("Maximum time step must not be below the minimum.");
+    }
+}
+
+template<typename real, typename link>
+AdaptiveStep BasicAdaptiveStepper<real, link>::step(double appliedField, double appliedCurrent,
+                                                    double maximumTimeStep) {
+    const SolverParameters &parameters = _solver._parameters;
+    if (parameters.noise != 0.0) {
+        throw std::invalid_argument("Adaptive time steps need a run without noise.");
+    }
+    double largest = BasicSolver<real, link>::stabilityLimit(parameters);
+    if (_parameters.maximumTimeStep > 0.0) {
+        largest = std::min(largest, _parameters.maximumTimeStep);
+    }
+    _timeStep = std::clamp(_timeStep, _parameters.minimumTimeStep, largest);
+
+    // A bound below the minimum time step is respected, it only shortens this step
+    const double bound = std::min(largest, maximumTimeStep);
+    double timeStep = std::min(_timeStep, bound);
+    _save();
+
+    int rejections = 0;
+    for (;;) {
+        _advance(timeStep, 1, appliedField, appliedCurrent);
+        copy(_solver._superconductor.orderParameter(), _fullStep);
+        _restore();
+        _advance(0.5 * timeStep, 2, appliedField, appliedCurrent);
+        const double error = _error();
+
+        // Forward Euler has a local error of order dt^2
+        const double factor = error > 0.0 ? safety * std::sqrt(_parameters.tolerance / error) : largestFactor;
+        if (error <= _parameters.tolerance || timeStep <= _parameters.minimumTimeStep) {
+            _accepted++;
+            _solver._time = _time + timeStep;
+            if (timeStep == _timeStep || factor < 1.0) {
+                // Steps shortened by the bound keep the time step for the next
+                _timeStep = std::clamp(timeStep * std::clamp(factor, smallestFactor, largestFactor),
+                                       _parameters.minimumTimeStep, largest);
+            }
+            return {timeStep, error, rejections};
+        }
+
+        _restore();
+        _rejected++;
+        rejections++;
+        timeStep = std::max(_parameters.minimumTimeStep, timeStep * std::clamp(factor, smallestFactor, 1.0));
+        _timeStep = timeStep;
+    }
+}
+
+template<typename real, typename link>
+double BasicAdaptiveStepper<real, link>::timeStep() const {
+    return _timeStep;
+}
+
+template<typename real, typename link>
+std::size_t BasicAdaptiveStepper<real, link>::accepted() const {
+    return _accepted;
+}
+
+template<typename real, typename link>
+std::size_t BasicAdaptiveStepper<real, link>::rejected() const {
+    return _rejected;
+}
+
+template<typename real, typename link>
+void BasicAdaptiveStepper<real, link>::_save() {
+    SQUID_TIMED_SCOPE("adaptive state", _orderParameter.size(),
+                      _orderParameter.size() * 2 * sizeof(std::complex<real>));
+    BasicSuperconductor<real, link> &superconductor = _solver._superconductor;
+    copy(superconductor.orderParameter(), _orderParameter);
+    _time = _solver._time;
+    _steps = _solver._steps;
+    if (_solver._parameters.screening) {
+        copy(superconductor.linkingVariableX(), _linkingVariableX);
+        copy(superconductor.linkingVariableY(), _linkingVariableY);
+    }
+}
+
+template<typename real, typename link>
+void BasicAdaptiveStepper<real, link>::_restore() {
+    SQUID_TIMED_SCOPE("adaptive state", _orderParameter.size(),
+                      _orderParameter.size() * 2 * sizeof(std::complex<real>));
+    BasicSuperconductor<real, link> &superconductor = _solver._superconductor;
+    copy(_orderParameter, superconductor.orderParameter());
+    _solver._time = _time;
+    _solver._steps = _steps;
+    // Without screening the links are those of the applied field, which the solver rebuilds if it changes
+    if (_solver._parameters.screening) {
+        copy(_linkingVariableX, superconductor.linkingVariableX());
+        copy(_linkingVariableY, superconductor.linkingVariableY());
+    }
+}
+
+template<typename real, typename link>
+void BasicAdaptiveStepper<real, link>::_advance(double timeStep, int count, double appliedField,
+                                                double appliedCurrent) {
+    // Set directly: setParameters() would validate and drop the cached links of the applied field
+    _solver._parameters.timeStep = timeStep;
+    for (int n = 0; n < count; n++) {
+        _solver.step(appliedField, appliedCurrent);
+    }
+}
+
+template<typename real, typename link>
+double BasicAdaptiveStepper<real, link>::_error() {
+    SQUID_TIMED_SCOPE("adaptive error", _fullStep.size(), _fullStep.size() * 2 * sizeof(std::complex<real>));
+    if (_solver._activeCells == 0.0) {
+        return 0.0;
+    }
+    const std::complex<real> *half = _solver._superconductor.orderParameter().data();
+    std::complex<real> *difference = _fullStep.data();
+    for (std::size_t i = 0; i < _fullStep.size(); i++) {
+        difference[i] -= half[i];
+    }
+    return std::sqrt(_fullStep.squaredNorm(_solver._geometry.superconductor()) / _solver._activeCells);
+}
+
+template class BasicAdaptiveStepper<float>;
+template class BasicAdaptiveStepper<double>;
+template class BasicAdaptiveStepper<float, Phase>;
+template class BasicAdaptiveStepper<double, Phase>;
@@ -0,0 +1,131 @@
+#include "../include/Arena.h"
+#include <cstdint>
+#include <vector>
+
+namespace {
+    /**
+     * @brief Takes storage from the heap and aligns it by hand, keeping the pointer the heap returned just in front of
+     * it. The aligned operator new of glibc leaves padding chunks between freed fields, which keep the heap from
+     * shrinking when large fields come and go.
+     */
+    void* heapAllocate(std::size_t bytes) {
+        void* base = ::operator new(bytes + sizeof(void*) + arena::alignment - 1);
+        const auto address = reinterpret_cast<std::uintptr_t>(base) + sizeof(void*);
+        auto* aligned = reinterpret_cast<void**>((address + arena::alignment - 1) & ~(arena::alignment - 1));
+        aligned[-1] = base;
+        return aligned;
+    }
+
+    void heapDeallocate(void* pointer) noexcept {
+        ::operator delete(static_cast<void**>(pointer)[-1]);
+    }
+
+    struct Block {
+        void* pointer;
+        std::size_t bytes;
+    };
+
+    /**
+     * @brief Whether the cache of this thread has not been constructed yet, is alive, or has been destroyed: fields
+     * with static storage may be destroyed after the thread-local cache of the main thread.
+     */
+    enum class CacheState {
+        unused, alive, destroyed
+    };
+
+    thread_local CacheState cacheState = CacheState::unused;
+
+    /**
+     * @brief The cache of a thread. Its list keeps its capacity when emptied, so a steady loop does not grow it.
+     */
+    struct Cache {
+        std::vector<Block> blocks;
+        std::size_t bytes = 0;
+        int scopes = 0;
+        std::size_t allocations = 0;
+        std::size_t reuses = 0;
+
+        Cache() {
+            cacheState = CacheState::alive;
+        }
+
+        ~Cache() {
+            release();
+            cacheState = CacheState::destroyed;
+        }
+
+        void release() noexcept {
+            for (const Block& block : blocks) {
+                heapDeallocate(block.pointer);
+            }
+            blocks.clear();
+            bytes = 0;
+        }
+    };
+
+    Cache& cache() {
+        thread_local Cache threadCache;
+        return threadCache;
+    }
+}
+
+void* arena::allocate(std::size_t bytes) {
+    if (cacheState == CacheState::destroyed) {
+        return heapAllocate(bytes);
+    }
+    Cache& own = cache();
+    // The latest block first: fields are mostly destroyed in the reverse order of their construction
+    for (std::size_t i = own.blocks.size(); i-- > 0;) {
+        if (own.blocks[i].bytes == bytes) {
+            void* pointer = own.blocks[i].pointer;
+            own.blocks[i] = own.blocks.back();
+            own.blocks.pop_back();
+            own.bytes -= bytes;
+            own.reuses++;
+            return pointer;
+        }
+    }
+    own.allocations++;
+    return heapAllocate(bytes);
+}
+
+void arena::deallocate(void* pointer, std::size_t bytes) noexcept {
+    if (pointer == nullptr) {
+        return;
+    }
+    // Without a cache there is no scope open either
+    if (cacheState != CacheState::alive) {
+        heapDeallocate(pointer);
+        return;
+    }
+    Cache& own = cache();
+    if (own.scopes > 0) {
+        try {
+            own.blocks.push_back({pointer, bytes});
+            own.bytes += bytes;
+            return;
+        } catch (const std::bad_alloc&) {
+            // Without room in the list the block goes back to the heap
+        }
+    }
+    heapDeallocate(pointer);
+}
+
+arena::Scope::Scope() {
+    cache().scopes++;
+}
+
+arena::Scope::~Scope() {
+    Cache& own = cache();
+    if (--own.scopes == 0) {
+        own.release();
+    }
+}
+
+arena::Statistics arena::statistics() {
+    if (cacheState == CacheState::destroyed) {
+        return {0, 0, 0, 0};
+    }
+    const Cache& own = cache();
+    return {own.allocations, own.reuses, own.blocks.size(), own.bytes};
+}
@@ -0,0 +1,181 @@
+template<typename scalar, std::size_t W, std::size_t H>
+inline FixedField<scalar, W, H>::FixedField() :
+        AbstractField<FixedField<scalar, W, H>, scalar, FixedStorage<scalar, W, H>>(W, H) {
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline FixedField<scalar, W, H>::FixedField(int width, int height) :
+        AbstractField<FixedField<scalar, W, H>, scalar, FixedStorage<scalar, W, H>>(width, height) {
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline FixedField<scalar, W, H>::FixedField(const ScalarField<scalar> &other) : FixedField() {
+    _checkDimensions(other);
+    const scalar *source = other.data();
+    for (std::size_t i = 0; i < W * H; i++) {
+        this->_field[i] = source[i];
+    }
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline FixedField<scalar, W, H>::operator ScalarField<scalar>() const {
+    ScalarField<scalar> result(static_cast<int>(W), static_cast<int>(H));
+    scalar *target = result.data();
+    for (std::size_t i = 0; i < W * H; i++) {
+        target[i] = this->_field[i];
+    }
+    return result;
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+constexpr std::size_t FixedField<scalar, W, H>::index(std::size_t x, std::size_t y) {
+    return x * H + y;
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline scalar FixedField<scalar, W, H>::operator()(std::size_t x, std::size_t y) const {
+    if (x >= W || y >= H) {
+        throw std::out_of_range("Index out of range");
+    }
+    return this->_field[index(x, y)];
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline scalar &FixedField<scalar, W, H>::operator()(std::size_t x, std::size_t y) {
+    if (x >= W || y >= H) {
+        throw std::out_of_range("Index out of range");
+    }
+    return this->_field[index(x, y)];
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+template<typename Stencil, std::size_t... Y>
+inline void FixedField<scalar, W, H>::_unrolledColumn(std::size_t x, Stencil &stencil, std::index_sequence<Y...>) {
+    (stencil(x, Y + 1), ...);
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+template<typename Stencil>
+inline void FixedField<scalar, W, H>::forEachInterior(Stencil &&stencil) const {
+    static_assert(W > 2 && H > 2, "A field without interior points");
+    for (std::size_t x = 1; x + 1 < W; x++) {
+        _unrolledColumn(x, stencil, std::make_index_sequence<H - 2>());
+    }
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline void FixedField<scalar, W, H>::_checkDimensions(const ScalarField<scalar> &other) {
+    if (other.width() != W || other.height() != H) {
+        throw std::invalid_argument("Dimensions must match");
+    }
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline scalar FixedField<scalar, W, H>::_product(const scalar &a, const scalar &b) {
+    if constexpr (std::is_arithmetic_v<scalar>) {
+        return a * b;
+    } else {
+        // Written out, because std::complex's operator* calls a library routine for the infinities of Annex G
+        return scalar(a.real() * b.real() - a.imag() * b.imag(), a.real() * b.imag() + a.imag() * b.real());
+    }
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline bool FixedField<scalar, W, H>::_dispatched() {
+    if constexpr (std::is_same_v<scalar, double> || std::is_same_v<scalar, std::complex<double>>) {
+        return kernels::active().instructionSet > kernels::compiledInstructionSet;
+    } else {
+        return false;
+    }
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+template<typename Operation>
+inline FixedField<scalar, W, H> FixedField<scalar, W, H>::_map(const scalar *other, FieldKernel kernel,
+                                                               Operation operation) const {
+    FixedField result;
+    const scalar *a = this->data();
+    scalar *out = result.data();
+    if (_dispatched()) {
+        (kernels::elementwise<scalar>().*kernel)(a, other, out, W * H);
+        return result;
+    }
+    for (std::size_t i = 0; i < W * H; i++) {
+        out[i] = operation(a[i], other[i]);
+    }
+    return result;
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+template<typename Operation>
+inline FixedField<scalar, W, H> FixedField<scalar, W, H>::_map(const scalar &val, ScalarKernel kernel,
+                                                               Operation operation) const {
+    FixedField result;
+    const scalar *a = this->data();
+    scalar *out = result.data();
+    if (_dispatched()) {
+        (kernels::elementwise<scalar>().*kernel)(a, val, out, W * H);
+        return result;
+    }
+    for (std::size_t i = 0; i < W * H; i++) {
+        out[i] = operation(a[i], val);
+    }
+    return result;
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline FixedField<scalar, W, H> FixedField<scalar, W, H>::operator+(const scalar &val) const {
+    return _map(val, &kernels::ElementwiseKernels<scalar>::addScalar,
+                [](const scalar &a, const scalar &b) { return a + b; });
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline FixedField<scalar, W, H> FixedField<scalar, W, H>::operator+(const FixedField &other) const {
+    return _map(other.data(), &kernels::ElementwiseKernels<scalar>::add,
+                [](const scalar &a, const scalar &b) { return a + b; });
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline FixedField<scalar, W, H> FixedField<scalar, W, H>::operator+(const ScalarField<scalar> &other) const {
+    _checkDimensions(other);
+    return _map(other.data(), &kernels::ElementwiseKernels<scalar>::add,
+                [](const scalar &a, const scalar &b) { return a + b; });
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline FixedField<scalar, W, H> FixedField<scalar, W, H>::operator-(const scalar &val) const {
+    return _map(val, &kernels::ElementwiseKernels<scalar>::subtractScalar,
+                [](const scalar &a, const scalar &b) { return a - b; });
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline FixedField<scalar, W, H> FixedField<scalar, W, H>::operator-(const FixedField &other) const {
+    return _map(other.data(), &kernels::ElementwiseKernels<scalar>::subtract,
+                [](const scalar &a, const scalar &b) { return a - b; });
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline FixedField<scalar, W, H> FixedField<scalar, W, H>::operator-(const ScalarField<scalar> &other) const {
+    _checkDimensions(other);
+    return _map(other.data(), &kernels::ElementwiseKernels<scalar>::subtract,
+                [](const scalar &a, const scalar &b) { return a - b; });
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline FixedField<scalar, W, H> FixedField<scalar, W, H>::operator*(const scalar &val) const {
+    return _map(val, &kernels::ElementwiseKernels<scalar>::multiplyScalar,
+                [](const scalar &a, const scalar &b) { return _product(a, b); });
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline FixedField<scalar, W, H> FixedField<scalar, W, H>::operator*(const FixedField &other) const {
+    return _map(other.data(), &kernels::ElementwiseKernels<scalar>::multiply,
+                [](const scalar &a, const scalar &b) { return _product(a, b); });
+}
+
+template<typename scalar, std::size_t W, std::size_t H>
+inline FixedField<scalar, W, H> FixedField<scalar, W, H>::operator*(const ScalarField<scalar> &other) const {
+    _checkDimensions(other);
+    return _map(other.data(), &kernels::ElementwiseKernels<scalar>::multiply,
+                [](const scalar &a, const scalar &b) { return _product(a, b); });
+}
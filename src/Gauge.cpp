@@ -0,0 +1,122 @@
+#include "../include/Gauge.h"
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+    /**
+     * @brief The link exp(i angle).
+     */
+    template<typename link>
+    link linkOf(double angle) {
+        if constexpr (std::is_same_v<link, Phase>) {
+            return Phase(angle);
+        } else {
+            return link(std::polar(1.0, angle));
+        }
+    }
+
+    template<typename link>
+    void checkDimensions(const ScalarField<link> &linkingVariableX, const ScalarField<link> &linkingVariableY) {
+        if (linkingVariableY.width() != linkingVariableX.width() + 1
+            || linkingVariableX.height() != linkingVariableY.height() + 1) {
+            throw std::invalid_argument("Link fields must be (width - 1) x height and width x (height - 1).");
+        }
+    }
+}
+
+VectorPotential gauge::uniformField(double field, Gauge gauge, std::size_t width, std::size_t height,
+                                    double gridSpacing) {
+    if (gauge == Gauge::landau) {
+        return [field](double, double y) {
+            return std::array<double, 2>{-field * y, 0.0};
+        };
+    }
+    const double centreX = 0.5 * static_cast<double>(width - 1) * gridSpacing;
+    const double centreY = 0.5 * static_cast<double>(height - 1) * gridSpacing;
+    return [field, centreX, centreY](double x, double y) {
+        return std::array<double, 2>{-0.5 * field * (y - centreY), 0.5 * field * (x - centreX)};
+    };
+}
+
+template<typename link>
+void gauge::linkingVariables(const VectorPotential &potential, double gridSpacing,
+                             ScalarField<link> &linkingVariableX, ScalarField<link> &linkingVariableY) {
+    checkDimensions(linkingVariableX, linkingVariableY);
+    const std::size_t width = linkingVariableY.width();
+    const std::size_t height = linkingVariableX.height();
+    const double h = gridSpacing;
+
+    for (std::size_t x = 0; x + 1 < width; x++) {
+        for (std::size_t y = 0; y < height; y++) {
+            const double x0 = static_cast<double>(x) * h;
+            const double y0 = static_cast<double>(y) * h;
+            const double integral = h / 6.0 * (potential(x0, y0)[0] + 4.0 * potential(x0 + 0.5 * h, y0)[0]
+                                               + potential(x0 + h, y0)[0]);
+            linkingVariableX(x, y) = linkOf<link>(-integral);
+        }
+    }
+    for (std::size_t x = 0; x < width; x++) {
+        for (std::size_t y = 0; y + 1 < height; y++) {
+            const double x0 = static_cast<double>(x) * h;
+            const double y0 = static_cast<double>(y) * h;
+            const double integral = h / 6.0 * (potential(x0, y0)[1] + 4.0 * potential(x0, y0 + 0.5 * h)[1]
+                                               + potential(x0, y0 + h)[1]);
+            linkingVariableY(x, y) = linkOf<link>(-integral);
+        }
+    }
+}
+
+template<typename link>
+void gauge::uniformField(double field, Gauge gauge, double gridSpacing, ScalarField<link> &linkingVariableX,
+                         ScalarField<link> &linkingVariableY) {
+    checkDimensions(linkingVariableX, linkingVariableY);
+    uniformField(field, gauge, gridSpacing, linkingVariableY.width(), linkingVariableX.height(),
+                 linkingVariableX.data(), linkingVariableY.data());
+}
+
+template<typename link>
+void gauge::uniformField(double field, Gauge gauge, double gridSpacing, std::size_t width, std::size_t height,
+                         link *linkingVariableX, link *linkingVariableY) {
+    const double h2 = gridSpacing * gridSpacing;
+
+    // Landau: the x-link angle is B h^2 y. Symmetric: B h^2 / 2 (y - yc) on x-links, -B h^2 / 2 (x - xc) on y-links
+    const bool symmetric = gauge == Gauge::symmetric;
+    const double slope = symmetric ? 0.5 * field * h2 : field * h2;
+    const double centreX = symmetric ? 0.5 * static_cast<double>(width - 1) : 0.0;
+    const double centreY = symmetric ? 0.5 * static_cast<double>(height - 1) : 0.0;
+
+    // The first column is evaluated in place and copied to the others, so that the solver can call this in every step
+    // of a field ramp without allocating
+    link *ux = linkingVariableX;
+    if (width > 1) {
+        for (std::size_t y = 0; y < height; y++) {
+            ux[y] = linkOf<link>(slope * (static_cast<double>(y) - centreY));
+        }
+    }
+    for (std::size_t x = 1; x + 1 < width; x++) {
+        std::copy(ux, ux + height, ux + x * height);
+    }
+
+    link *uy = linkingVariableY;
+    for (std::size_t x = 0; x < width; x++) {
+        const link row = symmetric ? linkOf<link>(-slope * (static_cast<double>(x) - centreX)) : linkOf<link>(0.0);
+        std::fill(uy + x * (height - 1), uy + (x + 1) * (height - 1), row);
+    }
+}
+
+template void gauge::linkingVariables(const VectorPotential &, double, ScalarField<std::complex<float>> &,
+                                      ScalarField<std::complex<float>> &);
+template void gauge::linkingVariables(const VectorPotential &, double, ScalarField<std::complex<double>> &,
+                                      ScalarField<std::complex<double>> &);
+template void gauge::linkingVariables(const VectorPotential &, double, ScalarField<Phase> &, ScalarField<Phase> &);
+template void gauge::uniformField(double, Gauge, double, ScalarField<std::complex<float>> &,
+                                  ScalarField<std::complex<float>> &);
+template void gauge::uniformField(double, Gauge, double, ScalarField<std::complex<double>> &,
+                                  ScalarField<std::complex<double>> &);
+template void gauge::uniformField(double, Gauge, double, ScalarField<Phase> &, ScalarField<Phase> &);
+template void gauge::uniformField(double, Gauge, double, std::size_t, std::size_t, std::complex<float> *,
+                                  std::complex<float> *);
+template void gauge::uniformField(double, Gauge, double, std::size_t, std::size_t, std::complex<double> *,
+                                  std::complex<double> *);
+template void gauge::uniformField(double, Gauge, double, std::size_t, std::size_t, Phase *, Phase *);
@@ -2,6 +2,12 @@
 // Created by Matthijs Rog on 11/19/2023.
 //
 #include "../include/Geometry.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
 
 Geometry::Geometry(int width, int height) : _width(width), _height(height), _geometry(width, height),
 _southernBoundary(width, height), _easternBoundary(width, height), _northernBoundary(width, height),
@@ -21,14 +27,52 @@ _westernBoundary(width, height), _interiorVacuum(width, height), _exteriorVacuum
     _updateBoundaries();
     _updateExteriorVacuum();
     _updateInteriorVacuum();
+    _updateHoles();
+}
+
+Mask Geometry::squidMask(int width, int height) {
+    if (width < 16 || height < 16) {
+        throw std::invalid_argument("A SQUID needs at least 16x16 grid points.");
+    }
+    Mask mask(width, height);
+
+    // Outer rectangle with two rectangular holes on either side of the centre
+    int left = width / 8;
+    int right = width - 1 - width / 8;
+    int bottom = height / 4;
+    int top = height - 1 - height / 4;
+    int holeBottom = 3 * height / 8;
+    int holeTop = height - 1 - 3 * height / 8;
+    int barLeft = 7 * width / 16;
+    int barRight = width - 1 - 7 * width / 16;
+    for (int x = left; x <= right; x++) {
+        for (int y = bottom; y <= top; y++) {
+            bool inHole = y >= holeBottom && y <= holeTop && x > width / 4 && x < width - 1 - width / 4
+                          && (x < barLeft || x > barRight);
+            mask(x, y) = !inHole;
+        }
+    }
+
+    // Notch the upper arm above the middle of each hole down to a third of its width
+    int armWidth = top - holeTop;
+    int notch = armWidth - std::max(1, armWidth / 3);
+    int notchHalfWidth = std::max(1, width / 64);
+    for (int centre : {(width / 4 + barLeft) / 2, (barRight + width - 1 - width / 4) / 2}) {
+        for (int x = centre - notchHalfWidth; x <= centre + notchHalfWidth; x++) {
+            for (int y = top - notch + 1; y <= top; y++) {
+                mask(x, y) = false;
+            }
+        }
+    }
+    return mask;
 }
 
 int Geometry::width() const {
-    return 0;
+    return _width;
 }
 
 int Geometry::height() const {
-    return 0;
+    return _height;
 }
 
 void Geometry::setGeometry(const Mask &geometry) {
@@ -43,6 +87,19 @@ void Geometry::setGeometry(const Mask &geometry) {
     _updateBoundaries();
     _updateExteriorVacuum();
     _updateInteriorVacuum();
+    _updateHoles();
+}
+
+const Mask &Geometry::superconductor() const {
+    return _geometry;
+}
+
+const Mask &Geometry::exteriorVacuum() const {
+    return _exteriorVacuum;
+}
+
+const Mask &Geometry::interiorVacuum() const {
+    return _interiorVacuum;
 }
 
 bool Geometry::inSuperconductor(int x, int y) const {
@@ -109,10 +166,44 @@ bool Geometry::onInteriorVacuum(int x, int y) const {
 }
 
 int Geometry::inHole(int x, int y) const {
-    return 0;
+    // The last run starting at or below (x, y)
+    auto run = std::upper_bound(_holeRuns.begin(), _holeRuns.end(), std::pair(x, y),
+                                [](const std::pair<int, int> &point, const HoleRun &run) {
+                                    return point.first < run.x || (point.first == run.x && point.second < run.bottom);
+                                });
+    if (run == _holeRuns.begin()) {
+        return -1;
+    }
+    --run;
+    return run->x == x && y <= run->top ? run->hole : -1;
+}
+
+int Geometry::holeCount() const {
+    return _holeCount;
+}
+
+Mask Geometry::hole(int index) const {
+    if (index < 0 || index >= _holeCount) {
+        throw std::out_of_range("No hole " + std::to_string(index) + ".");
+    }
+    Mask mask(_width, _height);
+    for (const HoleRun &run : _holeRuns) {
+        if (run.hole == index) {
+            for (int y = run.bottom; y <= run.top; y++) {
+                mask(run.x, y) = true;
+            }
+        }
+    }
+    return mask;
 }
 
 void Geometry::_updateBoundaries() {
+    // Clear boundaries left over from a previous geometry
+    _southernBoundary.fill(false);
+    _easternBoundary.fill(false);
+    _northernBoundary.fill(false);
+    _westernBoundary.fill(false);
+
     // Loop over all points and check explicitly if on a boundary
     for (int x = 0; x < _width; x++) {
         for (int y = 0; y < _height; y++) {
@@ -143,6 +234,8 @@ void Geometry::_updateBoundaries() {
 }
 
 void Geometry::_updateExteriorVacuum() {
+    _exteriorVacuum.fill(false);
+
     // For every row, trace from left to right and right to left to find the exterior vacuum cells
     for (int y = 0; y < _height; y++) {
         bool inVacuum = true;
@@ -203,5 +296,76 @@ void Geometry::_updateExteriorVacuum() {
 
 void Geometry::_updateInteriorVacuum() {
     // By simple set theory, the interior vacuum is the complement of the union of the exterior vacuum and the geometry.
-    _interiorVacuum = !(_exteriorVacuum || _geometry);
+    // Computed in place, in the storage the mask already has.
+    _interiorVacuum = _exteriorVacuum;
+    (_interiorVacuum |= _geometry).invert();
+}
+
+void Geometry::_updateHoles() {
+    _holeRuns.clear();
+    std::vector<int> parent;
+    auto root = [&parent](int run) {
+        while (parent[run] != run) {
+            parent[run] = parent[parent[run]];
+            run = parent[run];
+        }
+        return run;
+    };
+
+    const std::uint64_t *words = _interiorVacuum.data();
+    const auto height = static_cast<std::size_t>(_height);
+    std::size_t previous = 0;
+    for (int x = 0; x < _width; x++) {
+        const std::size_t current = _holeRuns.size();
+        std::size_t y = 0;
+        while (y < height) {
+            // Skip empty words, most of the grid is not in a hole
+            const std::size_t index = static_cast<std::size_t>(x) * height + y;
+            const std::size_t bit = index % FieldStorage<bool>::bits;
+            const std::uint64_t word = words[index / FieldStorage<bool>::bits] >> bit;
+            if (word == 0) {
+                y += FieldStorage<bool>::bits - bit;
+                continue;
+            }
+            y += static_cast<std::size_t>(std::countr_zero(word));
+            if (y >= height) {
+                break;
+            }
+            const std::size_t bottom = y;
+            while (y < height) {
+                const std::size_t end = static_cast<std::size_t>(x) * height + y;
+                const std::size_t offset = end % FieldStorage<bool>::bits;
+                const auto ones = static_cast<std::size_t>(
+                        std::countr_one(words[end / FieldStorage<bool>::bits] >> offset));
+                y += ones;
+                if (ones < FieldStorage<bool>::bits - offset) {
+                    break;
+                }
+            }
+            // The run may have continued into the next column
+            y = std::min(y, height);
+            const auto run = static_cast<int>(_holeRuns.size());
+            _holeRuns.push_back({x, static_cast<int>(bottom), static_cast<int>(y) - 1, 0});
+            parent.push_back(run);
+
+            // Join the runs of the previous column that touch this one, corners included
+            for (std::size_t other = previous; other < current; other++) {
+                if (_holeRuns[other].bottom <= static_cast<int>(y) && static_cast<int>(bottom) <= _holeRuns[other].top + 1) {
+                    parent[root(run)] = root(static_cast<int>(other));
+                }
+            }
+        }
+        previous = current;
+    }
+
+    // Number the holes by their first run
+    std::vector<int> number(_holeRuns.size(), -1);
+    _holeCount = 0;
+    for (std::size_t run = 0; run < _holeRuns.size(); run++) {
+        int &hole = number[root(static_cast<int>(run))];
+        if (hole < 0) {
+            hole = _holeCount++;
+        }
+        _holeRuns[run].hole = hole;
+    }
 }
@@ -0,0 +1,248 @@
+#include "../include/Instrumentation.h"
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace instrumentation {
+    namespace {
+        /**
+         * @brief Counters of one phase on one thread. Only the owning thread writes, with plain load/store pairs;
+         * the atomics only make concurrent reports well-defined.
+         */
+        struct PhaseCounters {
+            std::atomic<std::uint64_t> nanoseconds{0};
+            std::atomic<std::uint64_t> calls{0};
+            std::atomic<std::uint64_t> cells{0};
+            std::atomic<std::uint64_t> bytes{0};
+        };
+
+        struct TraceEvent {
+            int phase;
+            std::int64_t start;
+            std::int64_t duration;
+        };
+
+        struct ThreadRecord {
+            int id = 0;
+            std::array<PhaseCounters, maximumPhases> phases;
+            std::unique_ptr<TraceEvent[]> eventStorage;
+            std::atomic<TraceEvent *> events{nullptr};
+            std::size_t capacity = 0;
+            std::atomic<std::size_t> eventCount{0};
+            std::atomic<std::uint64_t> droppedEvents{0};
+        };
+
+        /**
+         * @brief Everything shared between threads. Records are owned here rather than by the threads, so that the
+         * counters of finished threads still show up in reports. A finished thread leaves its record on the free list,
+         * and the next new thread takes it over, trace buffer and all, so that a batch of jobs that each start threads
+         * of their own does not add a record and a buffer per job.
+         */
+        struct Registry {
+            std::mutex mutex;
+            std::array<const char *, maximumPhases> names{};
+            std::atomic<int> phaseCount{0};
+            std::vector<std::unique_ptr<ThreadRecord>> threads;
+            std::vector<ThreadRecord *> freeThreads;
+            std::atomic<bool> tracing{false};
+            std::atomic<std::size_t> eventsPerThread{0};
+            std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+        };
+
+        Registry &registry() {
+            static Registry instance;
+            return instance;
+        }
+
+        /**
+         * @brief The record of a thread, returned to the free list when the thread exits.
+         */
+        struct RecordLease {
+            ThreadRecord *record = nullptr;
+
+            ~RecordLease() {
+                if (record != nullptr) {
+                    Registry &shared = registry();
+                    std::lock_guard<std::mutex> lock(shared.mutex);
+                    shared.freeThreads.push_back(record);
+                }
+            }
+        };
+
+        ThreadRecord &threadRecord() {
+            thread_local RecordLease lease;
+            if (lease.record == nullptr) {
+                Registry &shared = registry();
+                std::lock_guard<std::mutex> lock(shared.mutex);
+                if (!shared.freeThreads.empty()) {
+                    lease.record = shared.freeThreads.back();
+                    shared.freeThreads.pop_back();
+                } else {
+                    shared.threads.push_back(std::make_unique<ThreadRecord>());
+                    lease.record = shared.threads.back().get();
+                    lease.record->id = static_cast<int>(shared.threads.size()) - 1;
+                }
+            }
+            return *lease.record;
+        }
+
+        void add(std::atomic<std::uint64_t> &counter, std::uint64_t amount) {
+            counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+        }
+
+        std::int64_t sinceEpoch(std::chrono::steady_clock::time_point time) {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(time - registry().epoch).count();
+        }
+    }
+
+    int registerPhase(const char *name) {
+        Registry &shared = registry();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        int count = shared.phaseCount.load(std::memory_order_relaxed);
+        for (int phase = 0; phase < count; phase++) {
+            if (std::strcmp(shared.names[phase], name) == 0) {
+                return phase;
+            }
+        }
+        if (count == maximumPhases) {
+            throw std::length_error("Too many instrumented phases.");
+        }
+        shared.names[count] = name;
+        shared.phaseCount.store(count + 1, std::memory_order_release);
+        return count;
+    }
+
+    void record(int phase, std::int64_t nanoseconds, std::uint64_t cells, std::uint64_t bytes) {
+        PhaseCounters &counters = threadRecord().phases[phase];
+        add(counters.nanoseconds, static_cast<std::uint64_t>(nanoseconds));
+        add(counters.calls, 1);
+        add(counters.cells, cells);
+        add(counters.bytes, bytes);
+    }
+
+    void trace(int phase, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+        Registry &shared = registry();
+        if (!shared.tracing.load(std::memory_order_relaxed)) {
+            return;
+        }
+        ThreadRecord &thread = threadRecord();
+        TraceEvent *events = thread.events.load(std::memory_order_relaxed);
+        if (events == nullptr) {
+            // The only allocation, once per record
+            thread.capacity = shared.eventsPerThread.load(std::memory_order_relaxed);
+            thread.eventStorage = std::make_unique<TraceEvent[]>(thread.capacity);
+            events = thread.eventStorage.get();
+            thread.events.store(events, std::memory_order_release);
+        }
+        std::size_t count = thread.eventCount.load(std::memory_order_relaxed);
+        if (count == thread.capacity) {
+            add(thread.droppedEvents, 1);
+            return;
+        }
+        events[count] = TraceEvent{phase, sinceEpoch(start), sinceEpoch(end) - sinceEpoch(start)};
+        thread.eventCount.store(count + 1, std::memory_order_release);
+    }
+
+    void reset() {
+        Registry &shared = registry();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        for (auto &thread : shared.threads) {
+            for (PhaseCounters &counters : thread->phases) {
+                counters.nanoseconds.store(0, std::memory_order_relaxed);
+                counters.calls.store(0, std::memory_order_relaxed);
+                counters.cells.store(0, std::memory_order_relaxed);
+                counters.bytes.store(0, std::memory_order_relaxed);
+            }
+            thread->eventCount.store(0, std::memory_order_relaxed);
+            thread->droppedEvents.store(0, std::memory_order_relaxed);
+        }
+        shared.epoch = std::chrono::steady_clock::now();
+    }
+
+    void enableTracing(std::size_t eventsPerThread) {
+        Registry &shared = registry();
+        shared.eventsPerThread.store(eventsPerThread, std::memory_order_relaxed);
+        shared.tracing.store(eventsPerThread > 0, std::memory_order_relaxed);
+    }
+
+    void disableTracing() {
+        registry().tracing.store(false, std::memory_order_relaxed);
+    }
+
+    void writeReport(std::ostream &out) {
+        Registry &shared = registry();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+        int phases = shared.phaseCount.load(std::memory_order_acquire);
+        double wallTime = 1e-9 * static_cast<double>(sinceEpoch(std::chrono::steady_clock::now()));
+        std::streamsize precision = out.precision(12);
+
+        out << "{\n  \"enabled\": " << (enabled ? "true" : "false") << ",\n"
+            << "  \"wall_time_s\": " << wallTime << ",\n"
+            << "  \"threads\": " << shared.threads.size() - shared.freeThreads.size() << ",\n"
+            << "  \"phases\": [";
+        for (int phase = 0; phase < phases; phase++) {
+            std::uint64_t nanoseconds = 0;
+            std::uint64_t calls = 0;
+            std::uint64_t cells = 0;
+            std::uint64_t bytes = 0;
+            for (auto &thread : shared.threads) {
+                nanoseconds += thread->phases[phase].nanoseconds.load(std::memory_order_relaxed);
+                calls += thread->phases[phase].calls.load(std::memory_order_relaxed);
+                cells += thread->phases[phase].cells.load(std::memory_order_relaxed);
+                bytes += thread->phases[phase].bytes.load(std::memory_order_relaxed);
+            }
+            double seconds = 1e-9 * static_cast<double>(nanoseconds);
+            double rate = seconds > 0.0 ? 1.0 / seconds : 0.0;
+
+            out << (phase > 0 ? "," : "") << "\n    {\"name\": \"" << shared.names[phase] << "\""
+                << ", \"time_s\": " << seconds
+                << ", \"calls\": " << calls
+                << ", \"cells\": " << cells
+                << ", \"bytes\": " << bytes
+                << ", \"cells_per_s\": " << static_cast<double>(cells) * rate
+                << ", \"gb_per_s\": " << 1e-9 * static_cast<double>(bytes) * rate << "}";
+        }
+        out << "\n  ]\n}\n";
+        out.precision(precision);
+    }
+
+    void writeChromeTrace(std::ostream &out) {
+        Registry &shared = registry();
+        std::lock_guard<std::mutex> lock(shared.mutex);
+
+        // Chrome expects microseconds
+        std::streamsize precision = out.precision(15);
+        out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+        bool first = true;
+        std::uint64_t dropped = 0;
+        for (auto &thread : shared.threads) {
+            const TraceEvent *events = thread->events.load(std::memory_order_acquire);
+            std::size_t count = thread->eventCount.load(std::memory_order_acquire);
+            dropped += thread->droppedEvents.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; events != nullptr && i < count; i++) {
+                out << (first ? "" : ",") << "\n{\"name\": \"" << shared.names[events[i].phase]
+                    << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << thread->id
+                    << ", \"ts\": " << 1e-3 * static_cast<double>(events[i].start)
+                    << ", \"dur\": " << 1e-3 * static_cast<double>(events[i].duration) << "}";
+                first = false;
+            }
+        }
+        out << "\n], \"otherData\": {\"dropped_events\": " << dropped << "}}\n";
+        out.precision(precision);
+    }
+
+    ScopedTimer::ScopedTimer(int phase, std::uint64_t cells, std::uint64_t bytes) : _phase(phase), _cells(cells),
+                                                                                    _bytes(bytes),
+                                                                                    _start(std::chrono::steady_clock::now()) {
+    }
+
+    ScopedTimer::~ScopedTimer() {
+        auto end = std::chrono::steady_clock::now();
+        record(_phase, std::chrono::duration_cast<std::chrono::nanoseconds>(end - _start).count(), _cells, _bytes);
+        trace(_phase, _start, end);
+    }
+}
@@ -0,0 +1,493 @@
+#include "../include/Job.h"
+#include "../include/Geometry.h"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    std::string trim(const std::string &text) {
+        const char *whitespace = " \t\r\n";
+        std::size_t begin = text.find_first_not_of(whitespace);
+        if (begin == std::string::npos) {
+            return "";
+        }
+        std::size_t end = text.find_last_not_of(whitespace);
+        return text.substr(begin, end - begin + 1);
+    }
+
+    double parseDouble(const std::string &text) {
+        std::size_t consumed = 0;
+        double value = 0.0;
+        try {
+            value = std::stod(text, &consumed);
+        } catch (const std::exception &) {
+            throw std::invalid_argument("'" + text + "' is not a number.");
+        }
+        if (consumed != text.size()) {
+            throw std::invalid_argument("'" + text + "' is not a number.");
+        }
+        return value;
+    }
+
+    int parseInt(const std::string &text) {
+        std::size_t consumed = 0;
+        int value = 0;
+        try {
+            value = std::stoi(text, &consumed);
+        } catch (const std::exception &) {
+            throw std::invalid_argument("'" + text + "' is not an integer.");
+        }
+        if (consumed != text.size()) {
+            throw std::invalid_argument("'" + text + "' is not an integer.");
+        }
+        return value;
+    }
+
+    /**
+     * @brief Parses a 64-bit seed, decimal or 0x-prefixed hexadecimal.
+     */
+    std::uint64_t parseSeed(const std::string &text) {
+        std::size_t consumed = 0;
+        unsigned long long value = 0;
+        try {
+            value = std::stoull(text, &consumed, 0);
+        } catch (const std::exception &) {
+            throw std::invalid_argument("'" + text + "' is not a seed, expected a non-negative integer.");
+        }
+        // stoull accepts and negates a leading minus
+        if (consumed != text.size() || text[0] == '-') {
+            throw std::invalid_argument("'" + text + "' is not a seed, expected a non-negative integer.");
+        }
+        return value;
+    }
+
+    bool parseBool(const std::string &text) {
+        if (text == "true" || text == "yes" || text == "1") {
+            return true;
+        }
+        if (text == "false" || text == "no" || text == "0") {
+            return false;
+        }
+        throw std::invalid_argument("'" + text + "' is not a boolean.");
+    }
+
+    /**
+     * @brief Parses a whitespace-separated list of grid indices.
+     */
+    std::vector<std::size_t> parseIndices(const std::string &text, std::size_t count) {
+        std::vector<std::size_t> indices;
+        std::istringstream stream(text);
+        std::string item;
+        while (stream >> item) {
+            int index = parseInt(item);
+            if (index < 0) {
+                throw std::invalid_argument("'" + item + "' is negative.");
+            }
+            indices.push_back(static_cast<std::size_t>(index));
+        }
+        if (indices.size() != count) {
+            throw std::invalid_argument("'" + text + "' does not have " + std::to_string(count) + " indices.");
+        }
+        return indices;
+    }
+
+    Schedule parseSchedule(const std::string &text) {
+        if (text.find(':') == std::string::npos) {
+            return Schedule(parseDouble(text));
+        }
+
+        std::vector<schedulePoint> points;
+        std::stringstream stream(text);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            std::size_t colon = item.find(':');
+            if (colon == std::string::npos) {
+                throw std::invalid_argument("Schedule entry '" + trim(item) + "' is not of the form time:value.");
+            }
+            points.emplace_back(parseDouble(trim(item.substr(0, colon))), parseDouble(trim(item.substr(colon + 1))));
+        }
+        return Schedule(points);
+    }
+
+    void setValue(Job &job, const std::string &key, const std::string &value) {
+        if (key == "geometry") {
+            job.geometry = value;
+        } else if (key == "width") {
+            job.width = parseInt(value);
+        } else if (key == "height") {
+            job.height = parseInt(value);
+        } else if (key == "grid_spacing") {
+            job.parameters.gridSpacing = parseDouble(value);
+        } else if (key == "kappa") {
+            job.parameters.kappa = parseDouble(value);
+        } else if (key == "time_step") {
+            job.parameters.timeStep = parseDouble(value);
+        } else if (key == "adaptive") {
+            job.adaptive = parseBool(value);
+        } else if (key == "tolerance") {
+            job.adaptiveParameters.tolerance = parseDouble(value);
+        } else if (key == "min_time_step") {
+            job.adaptiveParameters.minimumTimeStep = parseDouble(value);
+        } else if (key == "max_time_step") {
+            job.adaptiveParameters.maximumTimeStep = parseDouble(value);
+        } else if (key == "refine") {
+            job.refine = parseBool(value);
+        } else if (key == "refinement_levels") {
+            job.refinement.levels = parseInt(value);
+        } else if (key == "patch_size") {
+            job.refinement.patchSize = parseInt(value);
+        } else if (key == "feature_width") {
+            job.refinement.featureWidth = parseDouble(value);
+        } else if (key == "refinement_gradient") {
+            job.refinement.gradient = parseDouble(value);
+        } else if (key == "regrid_interval") {
+            job.refinement.regridInterval = parseInt(value);
+        } else if (key == "noise") {
+            job.parameters.noise = parseDouble(value);
+        } else if (key == "seed") {
+            job.parameters.seed = parseSeed(value);
+        } else if (key == "temporal_blocking") {
+            job.parameters.temporalBlocking = parseInt(value);
+        } else if (key == "screening") {
+            job.parameters.screening = parseBool(value);
+        } else if (key == "gauge") {
+            if (value != "landau" && value != "symmetric") {
+                throw std::invalid_argument("'" + value + "' is not a gauge, expected landau or symmetric.");
+            }
+            job.parameters.gauge = value == "symmetric" ? Gauge::symmetric : Gauge::landau;
+        } else if (key == "precision") {
+            if (value != "single" && value != "double") {
+                throw std::invalid_argument("'" + value + "' is not a precision, expected single or double.");
+            }
+            job.singlePrecision = value == "single";
+        } else if (key == "links") {
+            if (value != "complex" && value != "phase") {
+                throw std::invalid_argument("'" + value + "' is not a link storage, expected complex or phase.");
+            }
+            job.phaseLinks = value == "phase";
+        } else if (key == "duration") {
+            job.duration = parseDouble(value);
+        } else if (key == "field") {
+            job.field = parseSchedule(value);
+        } else if (key == "current") {
+            job.current = parseSchedule(value);
+        } else if (key == "source" || key == "drain") {
+            std::vector<std::size_t> indices = parseIndices(value, 4);
+            const Rectangle lead{indices[0], indices[1], indices[2], indices[3]};
+            (key == "source" ? job.sourceLead : job.drainLead) = lead;
+        } else if (key == "cycle") {
+            if (value != "v" && value != "w" && value != "f") {
+                throw std::invalid_argument("'" + value + "' is not a cycle, expected v, w or f.");
+            }
+            job.multigrid.cycle = value == "v" ? Cycle::v : value == "w" ? Cycle::w : Cycle::f;
+        } else if (key == "potential_tolerance") {
+            job.multigrid.tolerance = parseDouble(value);
+        } else if (key == "output") {
+            job.output = value;
+        } else if (key == "output_interval") {
+            job.outputInterval = parseDouble(value);
+        } else if (key == "coarse_levels") {
+            job.nested.levels = parseInt(value);
+        } else if (key == "coarse_duration") {
+            job.nested.duration = parseDouble(value);
+        } else if (key == "vortices") {
+            job.vortices = parseBool(value);
+        } else if (key == "snapshots") {
+            job.snapshots = parseBool(value);
+        } else if (key == "cut") {
+            if (value.empty() || (value.front() != 'x' && value.front() != 'y')) {
+                throw std::invalid_argument("'" + value + "' is not a cut, expected x or y and three indices.");
+            }
+            std::vector<std::size_t> indices = parseIndices(value.substr(1), 3);
+            job.cutLines.push_back({value.front() == 'x', indices[0], indices[1], indices[2]});
+        } else if (key == "probe") {
+            std::vector<std::size_t> indices = parseIndices(value, 2);
+            job.probes.push_back({indices[0], indices[1]});
+        } else if (key == "voltage") {
+            std::vector<std::size_t> indices = parseIndices(value, 4);
+            job.voltageProbes.emplace_back(GridPoint{indices[0], indices[1]}, GridPoint{indices[2], indices[3]});
+        } else if (key == "threads") {
+            job.threads = parseInt(value);
+        } else if (key == "analysis_threads") {
+            job.analysisThreads = parseInt(value);
+        } else if (key == "analysis_queue") {
+            job.analysisQueue = parseInt(value);
+        } else if (key == "profile_interval") {
+            job.profileInterval = parseDouble(value);
+        } else if (key == "trace") {
+            job.trace = parseBool(value);
+        } else {
+            throw std::invalid_argument("Unknown key '" + key + "'.");
+        }
+    }
+}
+
+Mask Job::leadMask(const Rectangle &lead) const {
+    Mask mask(width, height);
+    for (std::size_t x = lead.x0; x < lead.x1 && x < static_cast<std::size_t>(width); x++) {
+        for (std::size_t y = lead.y0; y < lead.y1 && y < static_cast<std::size_t>(height); y++) {
+            mask(x, y) = true;
+        }
+    }
+    return mask;
+}
+
+long Job::steps() const {
+    return static_cast<long>(std::ceil(duration / parameters.timeStep - 1e-9));
+}
+
+std::vector<Job> parseJobs(std::istream &in, const std::string &source) {
+    std::vector<Job> jobs;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(in, line)) {
+        lineNumber++;
+        std::string location = source + ":" + std::to_string(lineNumber) + ": ";
+
+        line = trim(line.substr(0, line.find('#')));
+        if (line.empty()) {
+            continue;
+        }
+
+        if (line.front() == '[') {
+            if (line.back() != ']' || line.compare(0, 5, "[job ") != 0) {
+                throw std::invalid_argument(location + "Expected a header of the form [job <name>].");
+            }
+            Job job;
+            job.name = trim(line.substr(5, line.size() - 6));
+            job.source = source;
+            if (job.name.empty()) {
+                throw std::invalid_argument(location + "Job name is empty.");
+            }
+            jobs.push_back(job);
+            continue;
+        }
+
+        std::size_t equals = line.find('=');
+        if (equals == std::string::npos) {
+            throw std::invalid_argument(location + "Expected key = value.");
+        }
+        if (jobs.empty()) {
+            throw std::invalid_argument(location + "Setting outside of a [job <name>] section.");
+        }
+        try {
+            setValue(jobs.back(), trim(line.substr(0, equals)), trim(line.substr(equals + 1)));
+        } catch (const std::invalid_argument &error) {
+            throw std::invalid_argument(location + error.what());
+        }
+    }
+    return jobs;
+}
+
+std::vector<Job> readJobFile(const std::string &path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::invalid_argument("Cannot open job file " + path + ".");
+    }
+    std::vector<Job> jobs = parseJobs(file, path);
+    if (jobs.empty()) {
+        throw std::invalid_argument(path + " contains no jobs.");
+    }
+    for (Job &job : jobs) {
+        validateJob(job);
+    }
+    return jobs;
+}
+
+void validateJob(Job &job) {
+    std::string prefix = "job '" + job.name + "' (" + job.source + "): ";
+    try {
+        if (job.geometry == "square") {
+            if (job.width < 3 || job.height < 3) {
+                throw std::invalid_argument("width and height must be at least 3.");
+            }
+        } else if (job.geometry == "squid") {
+            job.mask = Geometry::squidMask(job.width, job.height);
+        } else {
+            std::ifstream file(job.geometry);
+            if (!file) {
+                throw std::invalid_argument("Cannot open mask file " + job.geometry + ".");
+            }
+            job.mask = readMask(file);
+            int width = static_cast<int>(job.mask->width());
+            int height = static_cast<int>(job.mask->height());
+            if ((job.width != 0 && job.width != width) || (job.height != 0 && job.height != height)) {
+                throw std::invalid_argument("width and height do not match the mask file.");
+            }
+            job.width = width;
+            job.height = height;
+
+            // Geometry rejects masks that touch the edge of the grid
+            Geometry(width, height).setGeometry(*job.mask);
+        }
+
+        if (!job.probes.empty() || !job.voltageProbes.empty()) {
+            Geometry geometry(job.width, job.height);
+            if (job.mask) {
+                geometry.setGeometry(*job.mask);
+            }
+            auto inSuperconductor = [&geometry](const GridPoint &point) {
+                return point.x < static_cast<std::size_t>(geometry.width())
+                       && point.y < static_cast<std::size_t>(geometry.height())
+                       && geometry.inSuperconductor(static_cast<int>(point.x), static_cast<int>(point.y));
+            };
+            for (const GridPoint &probe : job.probes) {
+                if (!inSuperconductor(probe)) {
+                    throw std::invalid_argument("probe is not in the superconductor.");
+                }
+            }
+            for (const auto &[from, to] : job.voltageProbes) {
+                if (!inSuperconductor(from) || !inSuperconductor(to)) {
+                    throw std::invalid_argument("voltage probe is not in the superconductor.");
+                }
+            }
+        }
+        for (const CutLine &cut : job.cutLines) {
+            const auto along = static_cast<std::size_t>(cut.vertical ? job.width : job.height);
+            const auto across = static_cast<std::size_t>(cut.vertical ? job.height : job.width);
+            if (cut.position + 1 >= along || cut.begin >= cut.end || cut.end > across) {
+                throw std::invalid_argument("cut does not fit in the grid.");
+            }
+        }
+
+        Solver::validateParameters(job.parameters);
+        if (job.sourceLead.has_value() != job.drainLead.has_value()) {
+            throw std::invalid_argument("source and drain go together.");
+        }
+        if (job.sourceLead) {
+            if (job.parameters.screening) {
+                throw std::invalid_argument("leads need screening = false.");
+            }
+            Geometry geometry(job.width, job.height);
+            if (job.mask) {
+                geometry.setGeometry(*job.mask);
+            }
+            for (const Rectangle &lead : {*job.sourceLead, *job.drainLead}) {
+                if (lead.x0 >= lead.x1 || lead.y0 >= lead.y1 || lead.x1 > static_cast<std::size_t>(job.width)
+                    || lead.y1 > static_cast<std::size_t>(job.height)) {
+                    throw std::invalid_argument("lead does not fit in the grid.");
+                }
+                bool touches = false;
+                for (std::size_t x = lead.x0; x < lead.x1; x++) {
+                    for (std::size_t y = lead.y0; y < lead.y1; y++) {
+                        touches |= geometry.inSuperconductor(static_cast<int>(x), static_cast<int>(y));
+                    }
+                }
+                if (!touches) {
+                    throw std::invalid_argument("lead has no points in the superconductor.");
+                }
+            }
+            if (!(job.multigrid.tolerance > 0.0)) {
+                throw std::invalid_argument("potential_tolerance must be positive.");
+            }
+        } else if (!job.parameters.screening) {
+            for (const schedulePoint &point : job.current.points()) {
+                if (point.second != 0.0) {
+                    throw std::invalid_argument("current needs screening = true or leads.");
+                }
+            }
+        }
+        if (job.adaptive) {
+            const AdaptiveParameters &adaptive = job.adaptiveParameters;
+            if (!(adaptive.tolerance > 0.0)) {
+                throw std::invalid_argument("tolerance must be positive.");
+            }
+            if (!(adaptive.minimumTimeStep > 0.0)) {
+                throw std::invalid_argument("min_time_step must be positive.");
+            }
+            if (adaptive.maximumTimeStep != 0.0 && !(adaptive.maximumTimeStep >= adaptive.minimumTimeStep)) {
+                throw std::invalid_argument("max_time_step must be 0 or at least min_time_step.");
+            }
+            if (job.parameters.noise != 0.0) {
+                throw std::invalid_argument("adaptive time steps need noise = 0.");
+            }
+        }
+        if (job.refine) {
+            if (job.parameters.screening) {
+                throw std::invalid_argument("refine needs screening = false.");
+            }
+            if (job.sourceLead || job.adaptive || job.parameters.temporalBlocking != 1) {
+                throw std::invalid_argument("refine cannot have leads, adaptive time steps or temporal blocking.");
+            }
+            if (!job.cutLines.empty() || !job.probes.empty() || !job.voltageProbes.empty()) {
+                throw std::invalid_argument("refine cannot have cuts, probes or voltages.");
+            }
+            if (job.singlePrecision || job.phaseLinks) {
+                throw std::invalid_argument("refine needs precision = double and links = complex.");
+            }
+            // The mesh checks its parameters and the levels against the geometry itself
+            Geometry geometry(job.width, job.height);
+            if (job.mask) {
+                geometry.setGeometry(*job.mask);
+            }
+            AdaptiveMesh(geometry, job.parameters, job.refinement);
+        }
+        if (job.parameters.temporalBlocking < 1) {
+            throw std::invalid_argument("temporal_blocking must be at least 1.");
+        }
+        if (!(job.duration > 0.0)) {
+            throw std::invalid_argument("duration must be positive.");
+        }
+        if (job.nested.levels < 0) {
+            throw std::invalid_argument("coarse_levels must not be negative.");
+        }
+        if (job.nested.levels > 0 && !(job.nested.duration > 0.0)) {
+            throw std::invalid_argument("coarse_duration must be positive.");
+        }
+        if (!(job.outputInterval > 0.0)) {
+            throw std::invalid_argument("output_interval must be positive.");
+        }
+        if (job.output.empty()) {
+            throw std::invalid_argument("output is not set.");
+        }
+        if (job.threads < 1) {
+            throw std::invalid_argument("threads must be at least 1.");
+        }
+        if (job.analysisThreads < 0) {
+            throw std::invalid_argument("analysis_threads must not be negative.");
+        }
+        if (job.analysisQueue < 1) {
+            throw std::invalid_argument("analysis_queue must be at least 1.");
+        }
+        if (job.profileInterval < 0.0) {
+            throw std::invalid_argument("profile_interval must not be negative.");
+        }
+    } catch (const std::invalid_argument &error) {
+        throw std::invalid_argument(prefix + error.what());
+    }
+}
+
+Mask readMask(std::istream &in) {
+    std::vector<std::string> rows;
+    std::string line;
+    while (std::getline(in, line)) {
+        line = trim(line);
+        if (line.empty()) {
+            continue;
+        }
+        if (!rows.empty() && line.size() != rows.front().size()) {
+            throw std::invalid_argument("Mask rows must all have the same length.");
+        }
+        rows.push_back(line);
+    }
+    if (rows.empty()) {
+        throw std::invalid_argument("Mask is empty.");
+    }
+
+    int width = static_cast<int>(rows.front().size());
+    int height = static_cast<int>(rows.size());
+    Mask mask(width, height);
+    for (int y = 0; y < height; y++) {
+        const std::string &row = rows[height - 1 - y];
+        for (int x = 0; x < width; x++) {
+            char c = row[x];
+            if (c == '#' || c == '1') {
+                mask(x, y) = true;
+            } else if (c != '.' && c != '0') {
+                throw std::invalid_argument(std::string("Unknown mask character '") + c + "'.");
+            }
+        }
+    }
+    return mask;
+}
@@ -0,0 +1,132 @@
+#include "../include/Kernels.h"
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+// Each variant is compiled in its own translation unit, see src/kernels. The build defines SQUID_KERNELS_<ISA> for
+// every variant the compiler could build; on other architectures only the scalar one exists.
+namespace kernels::scalar {
+    extern const KernelTable table;
+}
+#ifdef SQUID_KERNELS_SSE42
+namespace kernels::sse42 {
+    extern const KernelTable table;
+}
+#endif
+#ifdef SQUID_KERNELS_AVX2
+namespace kernels::avx2 {
+    extern const KernelTable table;
+}
+#endif
+#ifdef SQUID_KERNELS_AVX512
+namespace kernels::avx512 {
+    extern const KernelTable table;
+}
+#endif
+
+namespace kernels {
+    namespace {
+        constexpr InstructionSet widest[] = {InstructionSet::avx512, InstructionSet::avx2, InstructionSet::sse42,
+                                             InstructionSet::scalar};
+
+        const KernelTable* compiled(InstructionSet instructionSet) {
+            switch (instructionSet) {
+                case InstructionSet::scalar:
+                    return &scalar::table;
+#ifdef SQUID_KERNELS_SSE42
+                case InstructionSet::sse42:
+                    return &sse42::table;
+#endif
+#ifdef SQUID_KERNELS_AVX2
+                case InstructionSet::avx2:
+                    return &avx2::table;
+#endif
+#ifdef SQUID_KERNELS_AVX512
+                case InstructionSet::avx512:
+                    return &avx512::table;
+#endif
+                default:
+                    return nullptr;
+            }
+        }
+
+        bool cpuSupports(InstructionSet instructionSet) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+            switch (instructionSet) {
+                case InstructionSet::scalar:
+                    return true;
+                case InstructionSet::sse42:
+                    return __builtin_cpu_supports("sse4.2");
+                case InstructionSet::avx2:
+                    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+                case InstructionSet::avx512:
+                    return __builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512dq")
+                           && __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx2")
+                           && __builtin_cpu_supports("fma");
+            }
+            return false;
+#else
+            return instructionSet == InstructionSet::scalar;
+#endif
+        }
+    }
+
+    const char *name(InstructionSet instructionSet) {
+        switch (instructionSet) {
+            case InstructionSet::scalar:
+                return "scalar";
+            case InstructionSet::sse42:
+                return "sse4.2";
+            case InstructionSet::avx2:
+                return "avx2";
+            case InstructionSet::avx512:
+                return "avx512";
+        }
+        return "unknown";
+    }
+
+    bool supported(InstructionSet instructionSet) {
+        return compiled(instructionSet) != nullptr && cpuSupports(instructionSet);
+    }
+
+    InstructionSet select(const char *request, std::ostream &warnings) {
+        InstructionSet ceiling = InstructionSet::avx512;
+        if (request != nullptr && *request != '\0') {
+            bool known = false;
+            for (InstructionSet candidate : widest) {
+                if (std::strcmp(request, name(candidate)) == 0) {
+                    ceiling = candidate;
+                    known = true;
+                }
+            }
+            if (!known) {
+                warnings << "SQUID_ISA=" << request << " is not one of scalar, sse4.2, avx2, avx512; ignored."
+                         << std::endl;
+            } else if (!supported(ceiling)) {
+                warnings << "SQUID_ISA=" << request << " is not supported on this CPU or build; falling back."
+                         << std::endl;
+            }
+        }
+        for (InstructionSet candidate : widest) {
+            if (candidate <= ceiling && supported(candidate)) {
+                return candidate;
+            }
+        }
+        return InstructionSet::scalar;
+    }
+
+    const KernelTable &table(InstructionSet instructionSet) {
+        if (!supported(instructionSet)) {
+            throw std::invalid_argument(std::string("Kernels for ") + name(instructionSet) + " are not supported.");
+        }
+        return *compiled(instructionSet);
+    }
+
+    const KernelTable &active() {
+        // Selected once, on first use; thread-safe as a function-local static
+        static const KernelTable &selected = table(select(std::getenv("SQUID_ISA"), std::cerr));
+        return selected;
+    }
+}
@@ -3,27 +3,59 @@
 //
 
 #include <iostream>
-#include "../include/AbstractField.h"
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../include/Job.h"
+#include "../include/Roofline.h"
+#include "../include/Simulation.h"
 
 
 /**
- * @brief A brief description of main.
- * @param param1 Description of the first parameter.
- * @param param2 Description of the second parameter.
- * @return Description of the return value.
+ * @brief Runs all jobs in the given job files, back to back. All files are read and validated before the first job
+ * starts, so a typo in the last job does not waste the runs before it. With --roofline, measures the host and prints
+ * the roofline report of the kernels instead.
+ * @param argc The number of arguments.
+ * @param argv The paths of the job files, or --roofline followed by an optional grid size.
+ * @return 0 on success, 1 on invalid input, 2 if a job failed while running.
  */
 int main(int argc, const char * argv[]) {
-    AbstractField field1 = AbstractField(10, 10);
-    AbstractField field2 = AbstractField(10, 10);
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <job file> [<job file> ...]" << std::endl;
+        std::cerr << "       " << argv[0] << " --roofline [<grid size>]" << std::endl;
+        return 1;
+    }
 
-    // Fill field1 with ones and field2 with twos.
-    field1.fill(1);
-    field2.fill(2);
+    if (std::string(argv[1]) == "--roofline") {
+        try {
+            int gridSize = argc > 2 ? std::stoi(argv[2]) : 2048;
+            Roofline roofline(gridSize, std::size_t(1) << 24, 5);
+            roofline.report(std::cout);
+        } catch (const std::exception &error) {
+            std::cerr << error.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
 
-    AbstractField field3 = field1 + field2;
-    field1(1,3) = 3;
+    std::vector<Job> jobs;
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::vector<Job> fileJobs = readJobFile(argv[i]);
+            jobs.insert(jobs.end(), fileJobs.begin(), fileJobs.end());
+        }
+    } catch (const std::invalid_argument &error) {
+        std::cerr << error.what() << std::endl;
+        return 1;
+    }
 
-    std::cout << field1(1, 3) << " " << field3(1, 3) << std::endl;
+    try {
+        Simulation simulation(std::cout);
+        simulation.run(jobs);
+    } catch (const std::exception &error) {
+        std::cerr << error.what() << std::endl;
+        return 2;
+    }
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,428 @@
+#include "../include/Multigrid.h"
+#include "../include/Instrumentation.h"
+#include "../include/Kernels.h"
+#include "../include/Reductions.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+
+namespace {
+    /**
+     * @brief Grids are coarsened until neither side has this many points.
+     */
+    constexpr std::size_t smallestGrid = 8;
+
+    /**
+     * @brief The sums over the connected parts are taken in at most this many blocks, and only with at most this many
+     * parts, which bounds their scratch space.
+     */
+    constexpr std::size_t maxProjectionBlocks = 64;
+
+    /**
+     * @brief The bilinear weights of the parent, the coarse points beside it along x and y and the one diagonal to it,
+     * by the bits of Level::interpolation: 1 if the point along x is connected to the parent, 2 along y, 4 diagonal.
+     * Points that are not connected get weight 0.
+     */
+    struct Stencil {
+        double parent;
+        double x;
+        double y;
+        double diagonal;
+    };
+
+    constexpr Stencil stencils[8] = {
+            {1.0, 0.0, 0.0, 0.0}, {0.75, 0.25, 0.0, 0.0}, {0.75, 0.0, 0.25, 0.0}, {0.6, 0.2, 0.2, 0.0},
+            {1.0, 0.0, 0.0, 0.0}, {0.75, 0.25, 0.0, 0.0}, {0.75, 0.0, 0.25, 0.0}, {0.5625, 0.1875, 0.1875, 0.0625}};
+
+    /**
+     * @brief Copies a field into another of the same dimensions, without reallocating.
+     */
+    void copy(const RealField &from, RealField &to) {
+        std::copy(from.data(), from.data() + from.size(), to.data());
+    }
+}
+
+Multigrid::Multigrid(const Mask &domain, const MultigridParameters &parameters) :
+        _parameters(parameters), _residual(0.0),
+        _direction(static_cast<int>(domain.width()), static_cast<int>(domain.height())),
+        _image(static_cast<int>(domain.width()), static_cast<int>(domain.height())) {
+    auto addLevel = [this](std::size_t width, std::size_t height) -> Level & {
+        const auto w = static_cast<int>(width);
+        const auto h = static_cast<int>(height);
+        _levels.push_back({width, height, RealField(w, h), RealField(w, h), RealField(w, h), RealField(w, h),
+                           RealField(w, h), RealField(w, h), {}, std::vector<int>(width * height, -1), {}, 1, {}});
+        return _levels.back();
+    };
+
+    const std::size_t W = domain.width();
+    const std::size_t H = domain.height();
+    Level &fine = addLevel(W, H);
+    auto interior = [&domain, W, H](std::size_t x, std::size_t y) {
+        return x > 0 && y > 0 && x + 1 < W && y + 1 < H && domain(x, y);
+    };
+    for (std::size_t x = 0; x < W; x++) {
+        for (std::size_t y = 0; y < H; y++) {
+            fine.conductanceX(x, y) = interior(x, y) && interior(x + 1, y) ? 1.0 : 0.0;
+            fine.conductanceY(x, y) = interior(x, y) && interior(x, y + 1) ? 1.0 : 0.0;
+        }
+    }
+    _finish(fine);
+
+    while (std::max(_levels.back().width, _levels.back().height) >= smallestGrid) {
+        const std::size_t w = _levels.back().width;
+        const std::size_t h = _levels.back().height;
+        Level &coarse = addLevel((w + 1) / 2 + 1, (h + 1) / 2 + 1);
+        const Level &next = _levels[_levels.size() - 2];
+        // The fine bonds from 2 X to 2 X + 1 cross the face between coarse points X and X + 1
+        for (std::size_t X = 0; X < coarse.width; X++) {
+            for (std::size_t Y = 0; Y < coarse.height; Y++) {
+                double x = 0.0;
+                double y = 0.0;
+                for (std::size_t k = 0; k < 2; k++) {
+                    const std::size_t across = 2 * Y + k;
+                    if (2 * X < w && across >= 1 && across - 1 < h) {
+                        x += next.conductanceX(2 * X, across - 1);
+                    }
+                    const std::size_t along = 2 * X + k;
+                    if (2 * Y < h && along >= 1 && along - 1 < w) {
+                        y += next.conductanceY(along - 1, 2 * Y);
+                    }
+                }
+                coarse.conductanceX(X, Y) = 0.5 * x;
+                coarse.conductanceY(X, Y) = 0.5 * y;
+            }
+        }
+        _finish(coarse);
+        _connect(_levels.size() - 2);
+    }
+}
+
+int Multigrid::solve(RealField &potential, const RealField &source) {
+    Level &fine = _levels.front();
+    if (potential.width() != fine.width || potential.height() != fine.height || source.width() != fine.width
+        || source.height() != fine.height) {
+        throw std::invalid_argument("Potential, source and domain dimensions must match.");
+    }
+    SQUID_TIMED_SCOPE("multigrid", fine.width * fine.height, 0);
+    copy(source, fine.source);
+    _project(fine, fine.source);
+    const double norm = std::sqrt(fine.source.squaredNorm());
+    if (norm == 0.0) {
+        potential.fill(0.0);
+        _residual = 0.0;
+        return 0;
+    }
+
+    // Flexible conjugate gradients, preconditioned by one cycle: the W- and F-cycles are not symmetric. The residual r
+    // is kept in the source of the finest level, which the cycle only reads.
+    const std::size_t n = potential.size();
+    const auto points = static_cast<long>(n);
+    const bool parallel = n >= kernels::multigridParallelPoints;
+    double *x = potential.data();
+    double *r = fine.source.data();
+    double *p = _direction.data();
+    double *q = _image.data();
+    const double *z = fine.potential.data();
+    _project(fine, potential);
+    _computeResidual(fine, x, _image);
+    copy(_image, fine.source);
+    _residual = std::sqrt(fine.source.squaredNorm()) / norm;
+
+    double rho = 0.0;
+    double alpha = 0.0;
+    int cycles = 0;
+    while (_residual > _parameters.tolerance && cycles < _parameters.maximumCycles) {
+        // The cycle leaves z with some constant on every part, to which the iteration is blind: r and A p have zero
+        // mean on each. The potential is projected once at the end.
+        fine.potential.fill(0.0);
+        _cycle(0, _parameters.cycle);
+
+        // The inner products are the deterministic reductions, so the iteration is the same on any number of threads
+        const double rz = reductions::dot(r, z, n);
+        const double zq = reductions::dot(z, q, n);
+        const double beta = cycles == 0 ? 0.0 : -alpha * zq / rho;
+#pragma omp parallel for if(parallel)
+        for (long i = 0; i < points; i++) {
+            p[i] = z[i] + beta * p[i];
+        }
+        rho = rz;
+
+        // The residual of p is r - A p
+        _computeResidual(fine, p, _image);
+#pragma omp parallel for if(parallel)
+        for (long i = 0; i < points; i++) {
+            q[i] = r[i] - q[i];
+        }
+        const double pq = reductions::dot(p, q, n);
+        if (!(pq > 0.0)) {
+            break;
+        }
+        alpha = rho / pq;
+#pragma omp parallel for if(parallel)
+        for (long i = 0; i < points; i++) {
+            x[i] += alpha * p[i];
+            r[i] -= alpha * q[i];
+        }
+        _residual = std::sqrt(reductions::squaredNorm(r, n)) / norm;
+        cycles++;
+    }
+    _project(fine, potential);
+    return cycles;
+}
+
+void Multigrid::apply(const RealField &potential, RealField &result) {
+    Level &fine = _levels.front();
+    copy(potential, fine.potential);
+    fine.source.fill(0.0);
+    _computeResidual(fine, fine.potential.data(), result);
+    double *out = result.data();
+    const auto points = static_cast<long>(result.size());
+#pragma omp parallel for if(result.size() >= kernels::multigridParallelPoints)
+    for (long i = 0; i < points; i++) {
+        out[i] = -out[i];
+    }
+}
+
+const MultigridParameters &Multigrid::parameters() const {
+    return _parameters;
+}
+
+std::size_t Multigrid::levels() const {
+    return _levels.size();
+}
+
+double Multigrid::residual() const {
+    return _residual;
+}
+
+void Multigrid::_finish(Level &level) {
+    const std::size_t W = level.width;
+    const std::size_t H = level.height;
+    for (std::size_t x = 0; x < W; x++) {
+        for (std::size_t y = 0; y < H; y++) {
+            double diagonal = 0.0;
+            if (x > 0 && y > 0 && x + 1 < W && y + 1 < H) {
+                diagonal = level.conductanceX(x, y) + level.conductanceX(x - 1, y) + level.conductanceY(x, y)
+                           + level.conductanceY(x, y - 1);
+            }
+            level.inverseDiagonal(x, y) = diagonal > 0.0 ? 1.0 / diagonal : 0.0;
+        }
+    }
+
+    // Flood fill the connected parts, in storage order
+    std::vector<std::size_t> stack;
+    for (std::size_t start = 0; start < W * H; start++) {
+        if (level.inverseDiagonal.data()[start] == 0.0 || level.component[start] >= 0) {
+            continue;
+        }
+        const auto part = static_cast<int>(level.componentSize.size());
+        level.componentSize.push_back(0.0);
+        level.component[start] = part;
+        stack.push_back(start);
+        while (!stack.empty()) {
+            const std::size_t i = stack.back();
+            stack.pop_back();
+            level.componentSize[part] += 1.0;
+            const std::size_t x = i / H;
+            const std::size_t y = i % H;
+            const std::size_t neighbours[] = {i + H, i - H, i + 1, i - 1};
+            const double conductances[] = {level.conductanceX(x, y), level.conductanceX(x - 1, y),
+                                           level.conductanceY(x, y), level.conductanceY(x, y - 1)};
+            for (int k = 0; k < 4; k++) {
+                if (conductances[k] > 0.0 && level.component[neighbours[k]] < 0) {
+                    level.component[neighbours[k]] = part;
+                    stack.push_back(neighbours[k]);
+                }
+            }
+        }
+    }
+
+    // Large levels with few parts sum them in blocks; see _project()
+    const std::size_t parts = level.componentSize.size();
+    level.componentBlocks = 1;
+    if (parts <= maxProjectionBlocks) {
+        level.componentBlocks = std::clamp<std::size_t>(W * H / kernels::multigridParallelPoints, 1,
+                                                        maxProjectionBlocks);
+    }
+    level.componentSum.resize(level.componentBlocks * parts);
+}
+
+void Multigrid::_project(Level &level, RealField &field) {
+    double *values = field.data();
+    const int *component = level.component.data();
+    const std::size_t n = field.size();
+    const std::size_t parts = level.componentSize.size();
+    const auto blocks = static_cast<long>(level.componentBlocks);
+    const std::size_t length = (n + level.componentBlocks - 1) / level.componentBlocks;
+    double *sums = level.componentSum.data();
+
+    // Every block sums the parts on its own and the blocks are added in order, which gives the same bits on any
+    // number of threads
+#pragma omp parallel for if(blocks > 1)
+    for (long b = 0; b < blocks; b++) {
+        double *own = sums + b * parts;
+        std::fill(own, own + parts, 0.0);
+        const std::size_t end = std::min(n, (b + 1) * length);
+        for (std::size_t i = b * length; i < end; i++) {
+            if (component[i] >= 0) {
+                own[component[i]] += values[i];
+            }
+        }
+    }
+    for (long b = 1; b < blocks; b++) {
+        for (std::size_t part = 0; part < parts; part++) {
+            sums[part] += sums[b * parts + part];
+        }
+    }
+
+    const auto points = static_cast<long>(n);
+#pragma omp parallel for if(n >= kernels::multigridParallelPoints)
+    for (long i = 0; i < points; i++) {
+        const int part = component[i];
+        values[i] = part >= 0 ? values[i] - sums[part] / level.componentSize[part] : 0.0;
+    }
+}
+
+void Multigrid::_smooth(Level &level, int sweeps, bool redFirst) {
+    const kernels::MultigridArguments arguments{level.width, level.height, level.conductanceX.data(),
+                                                level.conductanceY.data(), level.inverseDiagonal.data(),
+                                                level.source.data(), level.potential.data(), level.residual.data()};
+    const int first = redFirst ? 0 : 1;
+    for (int sweep = 0; sweep < sweeps; sweep++) {
+        kernels::active().multigrid.smooth(arguments, first);
+        kernels::active().multigrid.smooth(arguments, 1 - first);
+    }
+}
+
+void Multigrid::_computeResidual(Level &level) {
+    _computeResidual(level, level.potential.data(), level.residual);
+}
+
+void Multigrid::_computeResidual(Level &level, double *potential, RealField &residual) {
+    kernels::active().multigrid.residual({level.width, level.height, level.conductanceX.data(),
+                                          level.conductanceY.data(), level.inverseDiagonal.data(),
+                                          level.source.data(), potential, residual.data()});
+}
+
+void Multigrid::_connect(std::size_t level) {
+    Level &fine = _levels[level];
+    const Level &coarse = _levels[level + 1];
+    const std::size_t H = coarse.height;
+    const double *cx = coarse.conductanceX.data();
+    const double *cy = coarse.conductanceY.data();
+    fine.interpolation.assign(fine.width * fine.height, 0);
+    for (std::size_t x = 1; x + 1 < fine.width; x++) {
+        for (std::size_t y = 1; y + 1 < fine.height; y++) {
+            // The parent and the coarse points on the side of the child: 2 X - 1 is the left child of X, 2 X the right
+            const std::size_t X = (x + 1) / 2;
+            const std::size_t Y = (y + 1) / 2;
+            const std::size_t sideX = x % 2 == 1 ? X - 1 : X + 1;
+            const std::size_t sideY = y % 2 == 1 ? Y - 1 : Y + 1;
+            const std::size_t bondX = std::min(X, sideX);
+            const std::size_t bondY = std::min(Y, sideY);
+            const bool alongX = cx[bondX * H + Y] > 0.0;
+            const bool alongY = cy[X * H + bondY] > 0.0;
+            const bool diagonal = alongX && alongY && (cy[sideX * H + bondY] > 0.0 || cx[bondX * H + sideY] > 0.0);
+            fine.interpolation[x * fine.height + y] = static_cast<std::uint8_t>(alongX | alongY << 1 | diagonal << 2);
+        }
+    }
+}
+
+void Multigrid::_restrict(std::size_t level) {
+    const Level &fine = _levels[level];
+    Level &coarse = _levels[level + 1];
+    const std::size_t h = fine.height;
+    const std::size_t H = coarse.height;
+    const double *residual = fine.residual.data();
+    const double *inverseDiagonal = fine.inverseDiagonal.data();
+    double *source = coarse.source.data();
+    // Gathered per coarse point rather than scattered from the fine ones, so that the coarse points can be summed in
+    // parallel. Coarse point X is the parent of fine points 2 X - 1 and 2 X and beside the parents of 2 X - 2 and
+    // 2 X + 1.
+    const auto columns = static_cast<long>(coarse.width);
+#pragma omp parallel for if(fine.width * h >= kernels::multigridParallelPoints)
+    for (long X = 0; X < columns; X++) {
+        const long x0 = std::max(2 * X - 2, 1L);
+        const long x1 = std::min(2 * X + 1, static_cast<long>(fine.width) - 2);
+        for (long Y = 0; Y < static_cast<long>(H); Y++) {
+            const long y0 = std::max(2 * Y - 2, 1L);
+            const long y1 = std::min(2 * Y + 1, static_cast<long>(h) - 2);
+            double sum = 0.0;
+            for (long x = x0; x <= x1; x++) {
+                const bool besideX = (x + 1) / 2 != X;
+                for (long y = y0; y <= y1; y++) {
+                    const std::size_t i = x * h + y;
+                    if (inverseDiagonal[i] == 0.0) {
+                        continue;
+                    }
+                    const bool besideY = (y + 1) / 2 != Y;
+                    const Stencil &stencil = stencils[fine.interpolation[i]];
+                    const double weight = besideX ? (besideY ? stencil.diagonal : stencil.x)
+                                                  : (besideY ? stencil.y : stencil.parent);
+                    sum += weight * residual[i];
+                }
+            }
+            source[X * H + Y] = sum;
+        }
+    }
+    coarse.potential.fill(0.0);
+}
+
+void Multigrid::_prolongate(std::size_t level) {
+    Level &fine = _levels[level];
+    const Level &coarse = _levels[level + 1];
+    const std::size_t h = fine.height;
+    const std::size_t H = coarse.height;
+    const double *correction = coarse.potential.data();
+    const double *inverseDiagonal = fine.inverseDiagonal.data();
+    double *potential = fine.potential.data();
+    const auto columns = static_cast<long>(fine.width);
+#pragma omp parallel for if(fine.width * h >= kernels::multigridParallelPoints)
+    for (long column = 1; column < columns - 1; column++) {
+        const auto x = static_cast<std::size_t>(column);
+        const std::size_t X = (x + 1) / 2;
+        const std::size_t sideX = x % 2 == 1 ? X - 1 : X + 1;
+        for (std::size_t y = 1; y + 1 < h; y++) {
+            const std::size_t i = x * h + y;
+            if (inverseDiagonal[i] == 0.0) {
+                continue;
+            }
+            const std::size_t Y = (y + 1) / 2;
+            const std::size_t sideY = y % 2 == 1 ? Y - 1 : Y + 1;
+            const Stencil &stencil = stencils[fine.interpolation[i]];
+            potential[i] += stencil.parent * correction[X * H + Y] + stencil.x * correction[sideX * H + Y]
+                            + stencil.y * correction[X * H + sideY] + stencil.diagonal * correction[sideX * H + sideY];
+        }
+    }
+}
+
+void Multigrid::_cycle(std::size_t level, Cycle cycle) {
+    Level &current = _levels[level];
+    if (level + 1 == _levels.size()) {
+        // Red-black Gauss-Seidel damps the smoothest mode by about pi^2 / n^2 per sweep
+        const std::size_t n = std::max(current.width, current.height);
+        _project(current, current.source);
+        _smooth(current, static_cast<int>(n * n), true);
+        return;
+    }
+
+    _smooth(current, _parameters.smoothing, true);
+    _computeResidual(current);
+    _restrict(level);
+    switch (cycle) {
+        case Cycle::v:
+            _cycle(level + 1, Cycle::v);
+            break;
+        case Cycle::w:
+            _cycle(level + 1, Cycle::w);
+            _cycle(level + 1, Cycle::w);
+            break;
+        case Cycle::f:
+            _cycle(level + 1, Cycle::f);
+            _cycle(level + 1, Cycle::v);
+            break;
+    }
+    _prolongate(level);
+    _smooth(current, _parameters.smoothing, false);
+}
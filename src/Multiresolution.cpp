@@ -0,0 +1,292 @@
+#include "../include/Multiresolution.h"
+#include "../include/Gauge.h"
+#include "../include/Instrumentation.h"
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+namespace {
+    typedef std::complex<double> complex;
+
+    /**
+     * @brief The angle of a link, in [-pi, pi].
+     */
+    double angleOf(const Phase &value) {
+        return value.angle();
+    }
+
+    template<typename real>
+    double angleOf(const std::complex<real> &value) {
+        return std::arg(complex(value));
+    }
+
+    /**
+     * @brief The link exp(i angle).
+     */
+    template<typename link>
+    link linkOf(double angle) {
+        if constexpr (std::is_same_v<link, Phase>) {
+            return Phase(angle);
+        } else {
+            return link(std::polar(1.0, angle));
+        }
+    }
+
+    /**
+     * @brief Halves of the angles of a link field, in [-pi / 2, pi / 2].
+     */
+    template<typename link>
+    std::vector<double> halfAngles(const ScalarField<link> &links) {
+        std::vector<double> angles(links.size());
+        const link *values = links.data();
+        for (std::size_t i = 0; i < angles.size(); i++) {
+            angles[i] = 0.5 * angleOf(values[i]);
+        }
+        return angles;
+    }
+
+    /**
+     * @brief The weighted mean of transported values, 0 without weight.
+     */
+    complex mean(complex sum, double weight) {
+        return weight > 0.0 ? sum / weight : complex(0.0, 0.0);
+    }
+}
+
+Geometry multiresolution::coarsen(const Geometry &geometry) {
+    const int width = geometry.width() / 2 + 1;
+    const int height = geometry.height() / 2 + 1;
+    Mask mask(width, height);
+    for (int x = 1; x + 1 < width; x++) {
+        for (int y = 1; y + 1 < height; y++) {
+            // 2 x <= fine width - 2 off the edge, likewise y
+            mask(x, y) = geometry.inSuperconductor(2 * x, 2 * y);
+        }
+    }
+    Geometry coarse(width, height);
+    coarse.setGeometry(mask);
+    return coarse;
+}
+
+template<typename real, typename link>
+void multiresolution::prolongate(BasicSuperconductor<real, link> &coarse, BasicSuperconductor<real, link> &fine,
+                                 const Geometry &geometry) {
+    const std::size_t W = fine.width();
+    const std::size_t H = fine.height();
+    const std::size_t Wc = coarse.width();
+    const std::size_t Hc = coarse.height();
+    if (geometry.width() != static_cast<int>(W) || geometry.height() != static_cast<int>(H)
+        || Wc != W / 2 + 1 || Hc != H / 2 + 1) {
+        throw std::invalid_argument("A coarse state must be width / 2 + 1 by height / 2 + 1 of its fine state.");
+    }
+    SQUID_TIMED_SCOPE("prolongation", W * H, 0);
+    const Geometry coarseGeometry = coarsen(geometry);
+
+    // hx(X, Y) on the coarse x-links, hy(X, Y) on the coarse y-links: the angle of either fine half
+    const std::vector<double> hx = halfAngles(coarse.linkingVariableX());
+    const std::vector<double> hy = halfAngles(coarse.linkingVariableY());
+    auto halfX = [&](std::size_t X, std::size_t Y) { return hx[X * Hc + Y]; };
+    auto halfY = [&](std::size_t X, std::size_t Y) { return hy[X * (Hc - 1) + Y]; };
+
+    const ComplexField<real> &psi = coarse.orderParameter();
+    auto node = [&](std::size_t X, std::size_t Y) { return complex(psi(X, Y)); };
+    auto weight = [&](std::size_t X, std::size_t Y) {
+        return coarseGeometry.inSuperconductor(static_cast<int>(X), static_cast<int>(Y)) ? 1.0 : 0.0;
+    };
+
+    // psi on the midpoints of the coarse x-bonds and y-bonds, each end transported over its half link
+    std::vector<complex> midX((Wc - 1) * Hc);
+    std::vector<double> weightX((Wc - 1) * Hc);
+    for (std::size_t X = 0; X + 1 < Wc; X++) {
+        for (std::size_t Y = 0; Y < Hc; Y++) {
+            const complex half = std::polar(1.0, halfX(X, Y));
+            const double w = weight(X, Y) + weight(X + 1, Y);
+            midX[X * Hc + Y] = mean(weight(X, Y) * std::conj(half) * node(X, Y)
+                                    + weight(X + 1, Y) * half * node(X + 1, Y), w);
+            weightX[X * Hc + Y] = w > 0.0 ? 1.0 : 0.0;
+        }
+    }
+    std::vector<complex> midY(Wc * (Hc - 1));
+    std::vector<double> weightY(Wc * (Hc - 1));
+    for (std::size_t X = 0; X < Wc; X++) {
+        for (std::size_t Y = 0; Y + 1 < Hc; Y++) {
+            const complex half = std::polar(1.0, halfY(X, Y));
+            const double w = weight(X, Y) + weight(X, Y + 1);
+            midY[X * (Hc - 1) + Y] = mean(weight(X, Y) * std::conj(half) * node(X, Y)
+                                          + weight(X, Y + 1) * half * node(X, Y + 1), w);
+            weightY[X * (Hc - 1) + Y] = w > 0.0 ? 1.0 : 0.0;
+        }
+    }
+
+    ComplexField<real> &out = fine.orderParameter();
+    ScalarField<link> &ux = fine.linkingVariableX();
+    ScalarField<link> &uy = fine.linkingVariableY();
+    out.fill(0.0);
+
+    // Coarse bonds: both halves of every link, and psi on the nodes and midpoints
+    for (std::size_t X = 0; X < Wc; X++) {
+        for (std::size_t Y = 0; Y < Hc; Y++) {
+            const std::size_t x = 2 * X;
+            const std::size_t y = 2 * Y;
+            if (x < W && y < H) {
+                out(x, y) = static_cast<std::complex<real>>(node(X, Y));
+            }
+            if (X + 1 < Wc && y < H) {
+                ux(x, y) = linkOf<link>(halfX(X, Y));
+                if (x + 1 < W - 1) {
+                    ux(x + 1, y) = linkOf<link>(halfX(X, Y));
+                }
+                out(x + 1, y) = static_cast<std::complex<real>>(midX[X * Hc + Y]);
+            }
+            if (Y + 1 < Hc && x < W) {
+                uy(x, y) = linkOf<link>(halfY(X, Y));
+                if (y + 1 < H - 1) {
+                    uy(x, y + 1) = linkOf<link>(halfY(X, Y));
+                }
+                out(x, y + 1) = static_cast<std::complex<real>>(midY[X * (Hc - 1) + Y]);
+            }
+        }
+    }
+
+    // Coarse plaquettes: the links from the centre C to the midpoints S, E, N and W of the edges, such that each of
+    // the four fine plaquettes carries a quarter of the flux. The centre has a gauge freedom, fixed by taking the
+    // link to S as the mean of the links on the west and east edges.
+    for (std::size_t X = 0; X + 1 < Wc; X++) {
+        for (std::size_t Y = 0; Y + 1 < Hc; Y++) {
+            const std::size_t x = 2 * X;
+            const std::size_t y = 2 * Y;
+            const double south = halfX(X, Y);
+            const double east = halfY(X + 1, Y);
+            const double north = halfX(X, Y + 1);
+            const double west = halfY(X, Y);
+            // The counterclockwise sum over the eight halves is the coarse flux angle up to a multiple of 2 pi
+            const double quarter = 0.25 * std::remainder(2.0 * (south + east - north - west), 2.0 * M_PI);
+            const double sc = 0.5 * (west + east);                // S -> C
+            const double wc = south + sc - west - quarter;         // W -> C
+            const double ce = south + east - sc - quarter;         // C -> E
+            const double cn = ce + east - north - quarter;         // C -> N
+            uy(x + 1, y) = linkOf<link>(sc);
+            ux(x, y + 1) = linkOf<link>(wc);
+            if (x + 1 < W - 1) {
+                ux(x + 1, y + 1) = linkOf<link>(ce);
+            }
+            if (y + 1 < H - 1) {
+                uy(x + 1, y + 1) = linkOf<link>(cn);
+            }
+
+            // Each midpoint transported to the centre, over the conjugate link of its bond from the centre
+            const std::size_t s = X * Hc + Y;
+            const std::size_t n = X * Hc + Y + 1;
+            const std::size_t w = X * (Hc - 1) + Y;
+            const std::size_t e = (X + 1) * (Hc - 1) + Y;
+            const complex sum = weightX[s] * std::polar(1.0, -sc) * midX[s]
+                                + weightX[n] * std::polar(1.0, cn) * midX[n]
+                                + weightY[w] * std::polar(1.0, -wc) * midY[w]
+                                + weightY[e] * std::polar(1.0, ce) * midY[e];
+            out(x + 1, y + 1) = static_cast<std::complex<real>>(
+                    mean(sum, weightX[s] + weightX[n] + weightY[w] + weightY[e]));
+        }
+    }
+
+    for (std::size_t x = 0; x < W; x++) {
+        for (std::size_t y = 0; y < H; y++) {
+            if (!geometry.inSuperconductor(static_cast<int>(x), static_cast<int>(y))) {
+                out(x, y) = 0.0;
+            }
+        }
+    }
+}
+
+template<typename real, typename link>
+void multiresolution::toAppliedGauge(BasicSuperconductor<real, link> &superconductor, double appliedField,
+                                     Gauge gauge, double gridSpacing) {
+    const std::size_t W = superconductor.width();
+    const std::size_t H = superconductor.height();
+    ScalarField<link> &ux = superconductor.linkingVariableX();
+    ScalarField<link> &uy = superconductor.linkingVariableY();
+    ScalarField<link> appliedX(W - 1, H);
+    ScalarField<link> appliedY(W, H - 1);
+    gauge::uniformField(appliedField, gauge, gridSpacing, appliedX, appliedY);
+
+    // The links differ by a gauge transformation, exp(i delta_ij) = U'_ij / U_ij = exp(i (chi_i - chi_j)). chi is
+    // integrated up the first column and then along every row, and psi becomes exp(i chi) psi.
+    auto delta = [](const link &to, const link &from) {
+        return std::remainder(angleOf(to) - angleOf(from), 2.0 * M_PI);
+    };
+    std::vector<double> column(H, 0.0);
+    for (std::size_t y = 0; y + 1 < H; y++) {
+        column[y + 1] = column[y] - delta(appliedY(0, y), uy(0, y));
+    }
+    ComplexField<real> &psi = superconductor.orderParameter();
+    for (std::size_t y = 0; y < H; y++) {
+        double chi = column[y];
+        for (std::size_t x = 0; x < W; x++) {
+            if (x > 0) {
+                chi -= delta(appliedX(x - 1, y), ux(x - 1, y));
+            }
+            psi(x, y) = static_cast<std::complex<real>>(std::polar(1.0, chi) * complex(psi(x, y)));
+        }
+    }
+    ux = appliedX;
+    uy = appliedY;
+}
+
+template<typename real, typename link>
+void multiresolution::initialize(BasicSuperconductor<real, link> &superconductor, const Geometry &geometry,
+                                 const SolverParameters &parameters, const NestedIteration &nested,
+                                 double appliedField, double appliedCurrent) {
+    if (nested.levels <= 0) {
+        return;
+    }
+    const int width = geometry.width() / 2 + 1;
+    const int height = geometry.height() / 2 + 1;
+    if (width < 8 || height < 8) {
+        return;
+    }
+    const Geometry coarseGeometry = coarsen(geometry);
+    if (coarseGeometry.superconductor().count() == 0) {
+        return;
+    }
+
+    SolverParameters coarseParameters = parameters;
+    coarseParameters.gridSpacing *= 2.0;
+    coarseParameters.timeStep *= 4.0;
+    coarseParameters.noise = 0.0;
+    BasicSuperconductor<real, link> coarse(width, height);
+    BasicSolver<real, link> solver(coarse, coarseGeometry, coarseParameters);
+    solver.initialize();
+    NestedIteration coarser = nested;
+    coarser.levels--;
+    initialize(coarse, coarseGeometry, coarseParameters, coarser, appliedField, appliedCurrent);
+
+    const auto steps = std::lround(nested.duration / coarseParameters.timeStep);
+    for (long n = 0; n < steps; n++) {
+        solver.step(appliedField, appliedCurrent);
+    }
+    prolongate(coarse, superconductor, geometry);
+    if (!parameters.screening) {
+        toAppliedGauge(superconductor, appliedField, parameters.gauge, parameters.gridSpacing);
+    }
+}
+
+template void multiresolution::prolongate(BasicSuperconductor<float> &, BasicSuperconductor<float> &,
+                                          const Geometry &);
+template void multiresolution::prolongate(BasicSuperconductor<double> &, BasicSuperconductor<double> &,
+                                          const Geometry &);
+template void multiresolution::prolongate(BasicSuperconductor<float, Phase> &, BasicSuperconductor<float, Phase> &,
+                                          const Geometry &);
+template void multiresolution::prolongate(BasicSuperconductor<double, Phase> &, BasicSuperconductor<double, Phase> &,
+                                          const Geometry &);
+template void multiresolution::toAppliedGauge(BasicSuperconductor<float> &, double, Gauge, double);
+template void multiresolution::toAppliedGauge(BasicSuperconductor<double> &, double, Gauge, double);
+template void multiresolution::toAppliedGauge(BasicSuperconductor<float, Phase> &, double, Gauge, double);
+template void multiresolution::toAppliedGauge(BasicSuperconductor<double, Phase> &, double, Gauge, double);
+template void multiresolution::initialize(BasicSuperconductor<float> &, const Geometry &, const SolverParameters &,
+                                          const NestedIteration &, double, double);
+template void multiresolution::initialize(BasicSuperconductor<double> &, const Geometry &, const SolverParameters &,
+                                          const NestedIteration &, double, double);
+template void multiresolution::initialize(BasicSuperconductor<float, Phase> &, const Geometry &,
+                                          const SolverParameters &, const NestedIteration &, double, double);
+template void multiresolution::initialize(BasicSuperconductor<double, Phase> &, const Geometry &,
+                                          const SolverParameters &, const NestedIteration &, double, double);
@@ -0,0 +1,33 @@
+#include "../include/Noise.h"
+#include "../include/Phase.h"
+#include <cmath>
+#include <cstring>
+
+std::array<std::uint32_t, 4> noise::philox(std::array<std::uint32_t, 4> counter, std::array<std::uint32_t, 2> key) {
+    for (int round = 0; round < 10; round++) {
+        const std::uint64_t p0 = std::uint64_t(0xD2511F53u) * counter[0];
+        const std::uint64_t p1 = std::uint64_t(0xCD9E8D57u) * counter[2];
+        counter = {static_cast<std::uint32_t>(p1 >> 32) ^ counter[1] ^ key[0], static_cast<std::uint32_t>(p1),
+                   static_cast<std::uint32_t>(p0 >> 32) ^ counter[3] ^ key[1], static_cast<std::uint32_t>(p0)};
+        key[0] += 0x9E3779B9u;
+        key[1] += 0xBB67AE85u;
+    }
+    return counter;
+}
+
+std::complex<double> noise::gaussian(std::uint64_t seed, std::uint64_t step, std::uint64_t cell) {
+    const std::array<std::uint32_t, 4> words = philox(
+            {static_cast<std::uint32_t>(cell), static_cast<std::uint32_t>(cell >> 32),
+             static_cast<std::uint32_t>(step), static_cast<std::uint32_t>(step >> 32)},
+            {static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32)});
+
+    // 52 random bits as the mantissa of a double in [1, 2); 2 minus it is in (0, 1], whose logarithm is finite
+    const std::uint64_t bits = (std::uint64_t(words[0]) << 20 ^ words[1] >> 12) | 0x3FF0000000000000ull;
+    double uniform;
+    std::memcpy(&uniform, &bits, sizeof(uniform));
+    const double radius = std::sqrt(-2.0 * std::log(2.0 - uniform));
+
+    Phase angle;
+    angle.value = words[2];
+    return radius * angle.phasor();
+}
@@ -0,0 +1,421 @@
+#include "../include/Observables.h"
+#include "../include/Instrumentation.h"
+#include "../include/Kernels.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+namespace {
+    template<typename link>
+    std::complex<double> phasor(const link &value) {
+        if constexpr (std::is_same_v<link, Phase>) {
+            return value.phasor();
+        } else {
+            return std::complex<double>(value);
+        }
+    }
+}
+
+template<typename real, typename link>
+BasicVorticity<real, link>::BasicVorticity(BasicSuperconductor<real, link> &superconductor,
+                                           const Geometry &geometry) :
+        _superconductor(superconductor), _geometry(geometry), _width(superconductor.width()),
+        _height(superconductor.height()), _linkWeightX(superconductor.width() - 1, superconductor.height()),
+        _windingNumbers(superconductor.width() - 1, superconductor.height() - 1) {
+    if (geometry.width() != static_cast<int>(_width) || geometry.height() != static_cast<int>(_height)) {
+        throw std::invalid_argument("Geometry and superconductor dimensions must match.");
+    }
+    updateGeometry();
+}
+
+template<typename real, typename link>
+void BasicVorticity<real, link>::updateGeometry() {
+    for (std::size_t x = 0; x + 1 < _width; x++) {
+        for (std::size_t y = 0; y < _height; y++) {
+            bool active = _geometry.inSuperconductor(static_cast<int>(x), static_cast<int>(y))
+                          && _geometry.inSuperconductor(static_cast<int>(x + 1), static_cast<int>(y));
+            _linkWeightX(x, y) = active ? 1.0 : 0.0;
+        }
+    }
+
+    // Each plaquette belongs to the first hole one of its corners is in
+    const auto holes = static_cast<std::size_t>(_geometry.holeCount());
+    ScalarField<int> owner(_width - 1, _height - 1);
+    owner.fill(-1);
+    for (std::size_t x = 0; x + 1 < _width; x++) {
+        for (std::size_t y = 0; y + 1 < _height; y++) {
+            for (auto [dx, dy] : {std::pair(0, 0), std::pair(1, 0), std::pair(1, 1), std::pair(0, 1)}) {
+                int hole = _geometry.inHole(static_cast<int>(x) + dx, static_cast<int>(y) + dy);
+                if (hole >= 0) {
+                    owner(x, y) = hole;
+                    break;
+                }
+            }
+        }
+    }
+
+    // The contour consists of the edges of these plaquettes that no other one of them shares, each oriented
+    // counterclockwise around its plaquette
+    _contours.assign(holes, {});
+    _enclosed.assign(holes, {});
+    _fluxoids.assign(holes, 0);
+    auto owned = [&](std::size_t x, std::size_t y, int hole) {
+        return x + 1 < _width && y + 1 < _height && owner(x, y) == hole;
+    };
+    for (std::size_t x = 0; x + 1 < _width; x++) {
+        for (std::size_t y = 0; y + 1 < _height; y++) {
+            const int hole = owner(x, y);
+            if (hole < 0) {
+                continue;
+            }
+            std::vector<ContourBond> &contour = _contours[hole];
+            _enclosed[hole].push_back(x * (_height - 1) + y);
+            if (y == 0 || !owned(x, y - 1, hole)) {
+                contour.push_back({false, x, y, 1});
+            }
+            if (!owned(x + 1, y, hole)) {
+                contour.push_back({true, x + 1, y, 1});
+            }
+            if (!owned(x, y + 1, hole)) {
+                contour.push_back({false, x, y + 1, -1});
+            }
+            if (x == 0 || !owned(x - 1, y, hole)) {
+                contour.push_back({true, x, y, -1});
+            }
+        }
+    }
+}
+
+template<typename real, typename link>
+void BasicVorticity<real, link>::update() {
+    {
+        SQUID_TIMED_SCOPE("winding numbers", _windingNumbers.size(),
+                          _width * _height * (sizeof(std::complex<real>) + 2 * sizeof(link) + sizeof(real)));
+        kernels::SolverArguments<real, link> arguments{};
+        arguments.width = _width;
+        arguments.height = _height;
+        arguments.linkWeightX = _linkWeightX.data();
+        arguments.orderParameter = _superconductor.orderParameter().data();
+        arguments.linkingVariableX = _superconductor.linkingVariableX().data();
+        arguments.linkingVariableY = _superconductor.linkingVariableY().data();
+        kernels::solver<real, link>().windingNumbers(arguments, _windingNumbers.data());
+    }
+
+    SQUID_TIMED_SCOPE("fluxoids", 0, 0);
+    constexpr double turn = 2.0 * M_PI;
+    for (std::size_t hole = 0; hole < _contours.size(); hole++) {
+        double phase = 0.0;
+        for (const ContourBond &bond : _contours[hole]) {
+            phase += bond.sign * _bondAngle(bond);
+        }
+        for (std::size_t index : _enclosed[hole]) {
+            phase -= _plaquetteAngle(index / (_height - 1), index % (_height - 1));
+        }
+        _fluxoids[hole] = static_cast<int>(std::lround(phase / turn));
+    }
+}
+
+template<typename real, typename link>
+const ScalarField<int> &BasicVorticity<real, link>::windingNumbers() const {
+    return _windingNumbers;
+}
+
+template<typename real, typename link>
+std::vector<Vortex> BasicVorticity<real, link>::vortices() const {
+    std::vector<Vortex> result;
+    const int *winding = _windingNumbers.data();
+    for (std::size_t i = 0; i < _windingNumbers.size(); i++) {
+        if (winding[i] != 0) {
+            result.push_back({i / (_height - 1), i % (_height - 1), winding[i]});
+        }
+    }
+    return result;
+}
+
+template<typename real, typename link>
+const std::vector<int> &BasicVorticity<real, link>::fluxoids() const {
+    return _fluxoids;
+}
+
+template<typename real, typename link>
+double BasicVorticity<real, link>::_bondAngle(const ContourBond &bond) {
+    const ComplexField<real> &psi = _superconductor.orderParameter();
+    const std::complex<double> from(psi(bond.x, bond.y));
+    std::complex<double> to;
+    std::complex<double> u;
+    if (bond.vertical) {
+        to = std::complex<double>(psi(bond.x, bond.y + 1));
+        u = phasor(_superconductor.linkingVariableY()(bond.x, bond.y));
+    } else {
+        to = std::complex<double>(psi(bond.x + 1, bond.y));
+        u = phasor(_superconductor.linkingVariableX()(bond.x, bond.y));
+    }
+    return std::arg(std::conj(from) * u * to);
+}
+
+template<typename real, typename link>
+double BasicVorticity<real, link>::_plaquetteAngle(std::size_t x, std::size_t y) {
+    const ScalarField<link> &ux = _superconductor.linkingVariableX();
+    const ScalarField<link> &uy = _superconductor.linkingVariableY();
+    if constexpr (std::is_same_v<link, Phase>) {
+        Phase cell;
+        cell.value = ux(x, y).value + uy(x + 1, y).value - ux(x, y + 1).value - uy(x, y).value;
+        return cell.angle();
+    } else {
+        return std::arg(phasor(ux(x, y)) * phasor(uy(x + 1, y)) * std::conj(phasor(ux(x, y + 1)))
+                        * std::conj(phasor(uy(x, y))));
+    }
+}
+
+void RunningStatistics::add(double value) {
+    _count++;
+    const double delta = value - _mean;
+    _mean += delta / static_cast<double>(_count);
+    _squares += delta * (value - _mean);
+    _minimum = _count == 1 ? value : std::min(_minimum, value);
+    _maximum = _count == 1 ? value : std::max(_maximum, value);
+}
+
+void RunningStatistics::reset() {
+    *this = RunningStatistics();
+}
+
+std::size_t RunningStatistics::count() const {
+    return _count;
+}
+
+double RunningStatistics::mean() const {
+    return _count > 0 ? _mean : std::numeric_limits<double>::quiet_NaN();
+}
+
+double RunningStatistics::variance() const {
+    return _count > 0 ? _squares / static_cast<double>(_count) : std::numeric_limits<double>::quiet_NaN();
+}
+
+double RunningStatistics::minimum() const {
+    return _count > 0 ? _minimum : std::numeric_limits<double>::quiet_NaN();
+}
+
+double RunningStatistics::maximum() const {
+    return _count > 0 ? _maximum : std::numeric_limits<double>::quiet_NaN();
+}
+
+template<typename real, typename link>
+BasicTransport<real, link>::BasicTransport(BasicSuperconductor<real, link> &superconductor, const Geometry &geometry,
+                                           double gridSpacing) :
+        _superconductor(superconductor), _geometry(geometry), _gridSpacing(gridSpacing),
+        _width(superconductor.width()), _height(superconductor.height()), _scalarPotential(nullptr) {
+    if (geometry.width() != static_cast<int>(_width) || geometry.height() != static_cast<int>(_height)) {
+        throw std::invalid_argument("Geometry and superconductor dimensions must match.");
+    }
+}
+
+template<typename real, typename link>
+std::size_t BasicTransport<real, link>::addCutLine(const CutLine &cut) {
+    const std::size_t along = cut.vertical ? _width : _height;
+    const std::size_t across = cut.vertical ? _height : _width;
+    if (cut.position + 1 >= along || cut.begin >= cut.end || cut.end > across) {
+        throw std::invalid_argument("Cut line does not fit in the grid.");
+    }
+    std::vector<Bond> bonds;
+    for (std::size_t i = cut.begin; i < cut.end; i++) {
+        const std::size_t x = cut.vertical ? cut.position : i;
+        const std::size_t y = cut.vertical ? i : cut.position;
+        if (_active(x, y, !cut.vertical)) {
+            bonds.push_back(_bond(x, y, !cut.vertical));
+        }
+    }
+    _cutLines.push_back(std::move(bonds));
+    _currents.emplace_back();
+    return _cutLines.size() - 1;
+}
+
+template<typename real, typename link>
+std::size_t BasicTransport<real, link>::addProbe(const GridPoint &point) {
+    if (point.x >= _width || point.y >= _height
+        || !_geometry.inSuperconductor(static_cast<int>(point.x), static_cast<int>(point.y))) {
+        throw std::invalid_argument("Probe is not in the superconductor.");
+    }
+    Probe probe;
+    if (point.x > 0 && _active(point.x - 1, point.y, false)) {
+        probe.x.push_back(_bond(point.x - 1, point.y, false));
+    }
+    if (point.x + 1 < _width && _active(point.x, point.y, false)) {
+        probe.x.push_back(_bond(point.x, point.y, false));
+    }
+    if (point.y > 0 && _active(point.x, point.y - 1, true)) {
+        probe.y.push_back(_bond(point.x, point.y - 1, true));
+    }
+    if (point.y + 1 < _height && _active(point.x, point.y, true)) {
+        probe.y.push_back(_bond(point.x, point.y, true));
+    }
+    _probes.push_back(std::move(probe));
+    return _probes.size() - 1;
+}
+
+template<typename real, typename link>
+std::size_t BasicTransport<real, link>::addVoltageProbe(const GridPoint &from, const GridPoint &to) {
+    for (const GridPoint &point : {from, to}) {
+        if (point.x >= _width || point.y >= _height
+            || !_geometry.inSuperconductor(static_cast<int>(point.x), static_cast<int>(point.y))) {
+            throw std::invalid_argument("Voltage probe is not in the superconductor.");
+        }
+    }
+    // Along x at the height of the first point, then along y; bonds walked backwards enter conjugated
+    VoltageProbe probe;
+    probe.from = from.x * _height + from.y;
+    probe.to = to.x * _height + to.y;
+    for (std::size_t x = std::min(from.x, to.x); x < std::max(from.x, to.x); x++) {
+        probe.path.emplace_back(_bond(x, from.y, false), to.x > from.x);
+    }
+    for (std::size_t y = std::min(from.y, to.y); y < std::max(from.y, to.y); y++) {
+        probe.path.emplace_back(_bond(to.x, y, true), to.y > from.y);
+    }
+    _voltageProbes.push_back(std::move(probe));
+    return _voltageProbes.size() - 1;
+}
+
+template<typename real, typename link>
+void BasicTransport<real, link>::setScalarPotential(const RealField *potential) {
+    _scalarPotential = potential;
+}
+
+template<typename real, typename link>
+void BasicTransport<real, link>::update(double time) {
+    std::size_t bonds = 0;
+    for (const std::vector<Bond> &cut : _cutLines) {
+        bonds += cut.size();
+    }
+    SQUID_TIMED_SCOPE("transport", bonds, bonds * (2 * sizeof(std::complex<real>) + sizeof(link)));
+    const std::complex<real> *psi = _superconductor.orderParameter().data();
+    const link *ux = _superconductor.linkingVariableX().data();
+    const link *uy = _superconductor.linkingVariableY().data();
+
+    for (std::size_t i = 0; i < _cutLines.size(); i++) {
+        double current = 0.0;
+        for (const Bond &bond : _cutLines[i]) {
+            current += _bondProduct(bond, psi, ux, uy).imag();
+        }
+        _currents[i].add(current);
+    }
+
+    for (Probe &probe : _probes) {
+        double currentX = 0.0;
+        for (const Bond &bond : probe.x) {
+            currentX += _bondProduct(bond, psi, ux, uy).imag();
+        }
+        double currentY = 0.0;
+        for (const Bond &bond : probe.y) {
+            currentY += _bondProduct(bond, psi, ux, uy).imag();
+        }
+        probe.currentX.add(probe.x.empty() ? 0.0 : currentX / (_gridSpacing * static_cast<double>(probe.x.size())));
+        probe.currentY.add(probe.y.empty() ? 0.0 : currentY / (_gridSpacing * static_cast<double>(probe.y.size())));
+    }
+
+    for (VoltageProbe &probe : _voltageProbes) {
+        std::complex<double> product = std::conj(std::complex<double>(psi[probe.from]))
+                                       * std::complex<double>(psi[probe.to]);
+        for (const auto &[bond, forward] : probe.path) {
+            const std::complex<double> u = phasor((bond.vertical ? uy : ux)[bond.bond]);
+            product *= forward ? u : std::conj(u);
+        }
+        const double phase = std::arg(product);
+        if (probe.sampled && time > probe.time) {
+            // The change of phase since the last sample, taken as the one of least magnitude
+            const double change = std::remainder(phase - probe.phase, 2.0 * M_PI);
+            double voltage = change / (time - probe.time);
+            if (_scalarPotential != nullptr) {
+                voltage += _scalarPotential->data()[probe.to] - _scalarPotential->data()[probe.from];
+            }
+            probe.voltage.add(voltage);
+        }
+        probe.sampled = true;
+        probe.phase = phase;
+        probe.time = time;
+    }
+}
+
+template<typename real, typename link>
+void BasicTransport<real, link>::reset() {
+    for (RunningStatistics &current : _currents) {
+        current.reset();
+    }
+    for (Probe &probe : _probes) {
+        probe.currentX.reset();
+        probe.currentY.reset();
+    }
+    for (VoltageProbe &probe : _voltageProbes) {
+        probe.voltage.reset();
+    }
+}
+
+template<typename real, typename link>
+const RunningStatistics &BasicTransport<real, link>::current(std::size_t index) const {
+    return _currents.at(index);
+}
+
+template<typename real, typename link>
+const RunningStatistics &BasicTransport<real, link>::currentDensityX(std::size_t index) const {
+    return _probes.at(index).currentX;
+}
+
+template<typename real, typename link>
+const RunningStatistics &BasicTransport<real, link>::currentDensityY(std::size_t index) const {
+    return _probes.at(index).currentY;
+}
+
+template<typename real, typename link>
+const RunningStatistics &BasicTransport<real, link>::voltage(std::size_t index) const {
+    return _voltageProbes.at(index).voltage;
+}
+
+template<typename real, typename link>
+std::size_t BasicTransport<real, link>::cutLines() const {
+    return _cutLines.size();
+}
+
+template<typename real, typename link>
+std::size_t BasicTransport<real, link>::probes() const {
+    return _probes.size();
+}
+
+template<typename real, typename link>
+std::size_t BasicTransport<real, link>::voltageProbes() const {
+    return _voltageProbes.size();
+}
+
+template<typename real, typename link>
+typename BasicTransport<real, link>::Bond BasicTransport<real, link>::_bond(std::size_t x, std::size_t y,
+                                                                          bool vertical) const {
+    const std::size_t from = x * _height + y;
+    if (vertical) {
+        return {true, from, from + 1, x * (_height - 1) + y};
+    }
+    return {false, from, from + _height, from};
+}
+
+template<typename real, typename link>
+bool BasicTransport<real, link>::_active(std::size_t x, std::size_t y, bool vertical) const {
+    const std::size_t toX = vertical ? x : x + 1;
+    const std::size_t toY = vertical ? y + 1 : y;
+    return _geometry.inSuperconductor(static_cast<int>(x), static_cast<int>(y))
+           && _geometry.inSuperconductor(static_cast<int>(toX), static_cast<int>(toY));
+}
+
+template<typename real, typename link>
+std::complex<double> BasicTransport<real, link>::_bondProduct(const Bond &bond, const std::complex<real> *psi,
+                                                              const link *ux, const link *uy) {
+    const std::complex<double> u = phasor((bond.vertical ? uy : ux)[bond.bond]);
+    return std::conj(std::complex<double>(psi[bond.from])) * u * std::complex<double>(psi[bond.to]);
+}
+
+template class BasicVorticity<float>;
+template class BasicVorticity<double>;
+template class BasicVorticity<float, Phase>;
+template class BasicVorticity<double, Phase>;
+template class BasicTransport<float>;
+template class BasicTransport<double>;
+template class BasicTransport<float, Phase>;
+template class BasicTransport<double, Phase>;
@@ -0,0 +1,46 @@
+#include "../include/Phase.h"
+#include <cmath>
+#include <vector>
+
+Phase::Phase(double angle) {
+    // remainder() is exact, and leaves an angle in [-pi, pi] that converts to the 64-bit integer without overflow
+    double turns = std::remainder(angle, 2.0 * M_PI) / radiansPerUnit;
+    value = static_cast<std::uint32_t>(static_cast<std::int64_t>(std::nearbyint(turns)));
+}
+
+Phase Phase::of(const std::complex<double> &phasor) {
+    return Phase(std::arg(phasor));
+}
+
+double Phase::angle() const {
+    return static_cast<std::int32_t>(value) * radiansPerUnit;
+}
+
+std::complex<double> Phase::phasor() const {
+    const double *entry = table() + 2 * (value >> (32 - tableBits));
+    const double delta = (value & ((std::uint32_t(1) << (32 - tableBits)) - 1)) * radiansPerUnit;
+    const double delta2 = delta * delta;
+    const double c = 1.0 - delta2 * (0.5 - delta2 * (1.0 / 24.0 - delta2 * (1.0 / 720.0)));
+    const double s = delta * (1.0 - delta2 * (1.0 / 6.0 - delta2 * (1.0 / 120.0)));
+    return {entry[0] * c - entry[1] * s, entry[1] * c + entry[0] * s};
+}
+
+Phase Phase::operator*(const Phase &other) const {
+    Phase product;
+    product.value = value + other.value;
+    return product;
+}
+
+const double *Phase::table() {
+    static const std::vector<double> entries = []() {
+        constexpr std::size_t size = std::size_t(1) << tableBits;
+        std::vector<double> values(2 * size);
+        for (std::size_t k = 0; k < size; k++) {
+            double angle = 2.0 * M_PI * static_cast<double>(k) / static_cast<double>(size);
+            values[2 * k] = std::cos(angle);
+            values[2 * k + 1] = std::sin(angle);
+        }
+        return values;
+    }();
+    return entries.data();
+}
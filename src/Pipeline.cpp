@@ -0,0 +1,117 @@
+#include "../include/Pipeline.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace pipeline {
+    ThreadPool::ThreadPool(int threads) {
+        if (threads < 1) {
+            throw std::invalid_argument("A thread pool needs at least one thread.");
+        }
+        _threads.reserve(threads);
+        for (int i = 0; i < threads; i++) {
+            _threads.emplace_back(&ThreadPool::_work, this);
+        }
+    }
+
+    ThreadPool::~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stopping = true;
+        }
+        _posted.notify_all();
+        for (std::thread &thread : _threads) {
+            thread.join();
+        }
+    }
+
+    void ThreadPool::post(std::coroutine_handle<> handle) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _queue.push_back(handle);
+        }
+        _posted.notify_one();
+    }
+
+    int ThreadPool::size() const {
+        return static_cast<int>(_threads.size());
+    }
+
+    void ThreadPool::_work() {
+#ifdef _OPENMP
+        omp_set_num_threads(1);
+#endif
+        for (;;) {
+            std::coroutine_handle<> handle;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _posted.wait(lock, [this] { return _next < _queue.size() || _stopping; });
+                if (_next == _queue.size()) {
+                    return;
+                }
+                handle = _queue[_next++];
+                // Keeps the storage, so that a steady stream of coroutines does not allocate
+                if (_next == _queue.size()) {
+                    _queue.clear();
+                    _next = 0;
+                }
+            }
+            handle.resume();
+        }
+    }
+
+    Task::Task(std::coroutine_handle<promise_type> handle) : _handle(handle) {
+    }
+
+    Task::~Task() {
+        _release();
+    }
+
+    Task::Task(Task &&other) noexcept : _handle(std::exchange(other._handle, nullptr)),
+                                        _started(std::exchange(other._started, false)) {
+    }
+
+    Task &Task::operator=(Task &&other) noexcept {
+        if (this != &other) {
+            _release();
+            _handle = std::exchange(other._handle, nullptr);
+            _started = std::exchange(other._started, false);
+        }
+        return *this;
+    }
+
+    void Task::start(ThreadPool &pool) {
+        if (!_handle || _started) {
+            throw std::logic_error("Only a task that has not been started can be started.");
+        }
+        _started = true;
+        pool.post(_handle);
+    }
+
+    void Task::wait() {
+        if (!_started) {
+            throw std::logic_error("Cannot wait for a task that has not been started.");
+        }
+        promise_type &promise = _handle.promise();
+        std::unique_lock<std::mutex> lock(promise.mutex);
+        promise.finished.wait(lock, [&promise] { return promise.done; });
+        if (promise.error) {
+            std::rethrow_exception(std::exchange(promise.error, nullptr));
+        }
+    }
+
+    void Task::_release() noexcept {
+        if (!_handle) {
+            return;
+        }
+        if (_started) {
+            promise_type &promise = _handle.promise();
+            std::unique_lock<std::mutex> lock(promise.mutex);
+            promise.finished.wait(lock, [&promise] { return promise.done; });
+        }
+        _handle.destroy();
+        _handle = nullptr;
+        _started = false;
+    }
+}
@@ -0,0 +1,194 @@
+#include "../include/Roofline.h"
+#include "../include/AbstractField.h"
+#include "../include/Kernels.h"
+#include "../include/Solver.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <stdexcept>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+    /**
+     * @brief Best wall-clock time of a function over a number of runs.
+     */
+    double bestTime(int repetitions, const std::function<void()> &function) {
+        double best = 0.0;
+        for (int i = 0; i < repetitions; i++) {
+            auto start = std::chrono::steady_clock::now();
+            function();
+            std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            best = i == 0 ? elapsed.count() : std::min(best, elapsed.count());
+        }
+        return best;
+    }
+
+    int threadCount() {
+#ifdef _OPENMP
+        return omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+}
+
+Roofline::Roofline(int gridSize, std::size_t streamElements, int repetitions) : _gridSize(gridSize),
+                                                                               _streamElements(streamElements),
+                                                                               _repetitions(repetitions) {
+    if (gridSize < 16) {
+        throw std::invalid_argument("Roofline grid size must be at least 16.");
+    }
+    if (streamElements == 0 || repetitions < 1) {
+        throw std::invalid_argument("Roofline needs at least one element and one repetition.");
+    }
+}
+
+double Roofline::measureBandwidth() const {
+    const auto n = static_cast<long>(_streamElements);
+    std::unique_ptr<double[]> a(new double[n]);
+    std::unique_ptr<double[]> b(new double[n]);
+    std::unique_ptr<double[]> c(new double[n]);
+    double *pa = a.get();
+    double *pb = b.get();
+    double *pc = c.get();
+
+    // First touch from the threads that will use the pages
+#pragma omp parallel for schedule(static)
+    for (long i = 0; i < n; i++) {
+        pa[i] = 0.0;
+        pb[i] = 1.0;
+        pc[i] = 2.0;
+    }
+
+    const double scalar = 3.0;
+    double time = bestTime(_repetitions, [=]() {
+#pragma omp parallel for schedule(static)
+        for (long i = 0; i < n; i++) {
+            pa[i] = pb[i] + scalar * pc[i];
+        }
+    });
+    return 3.0 * sizeof(double) * static_cast<double>(n) / time;
+}
+
+double Roofline::measurePeakFlops() const {
+    // The chains run in the kernels of the selected instruction set, which the solver kernels are measured against
+    const kernels::KernelTable &table = kernels::active();
+    constexpr long iterations = 1L << 22;
+    double sink = 0.0;
+
+    double time = bestTime(_repetitions, [&]() {
+#pragma omp parallel reduction(+:sink)
+        sink += table.multiplyAdd(iterations);
+    });
+    if (sink == 0.0) {
+        // Unreachable, keeps the chains alive
+        throw std::logic_error("Peak flops measurement was optimized away.");
+    }
+    return 2.0 * static_cast<double>(table.multiplyAddChains) * static_cast<double>(iterations) * threadCount() / time;
+}
+
+std::vector<KernelMeasurement> Roofline::measureKernels() const {
+    const int n = _gridSize;
+    const double cells = static_cast<double>(n) * n;
+    std::vector<KernelMeasurement> measurements;
+    auto add = [&](const KernelCost &cost, double kernelCells, const std::function<void()> &kernel) {
+        measurements.push_back({cost, kernelCells / bestTime(_repetitions, kernel)});
+    };
+
+    {
+        Geometry geometry(n, n);
+        Superconductor superconductor(n, n);
+        Solver solver(superconductor, geometry, SolverParameters());
+        solver.initialize();
+        for (int i = 0; i < 3; i++) {
+            solver.step(0.1, 0.0);
+        }
+        add(kernelCost::fluxCells, static_cast<double>(n - 1) * (n - 1), [&]() { solver._updateFluxCells(); });
+        add(kernelCost::orderParameter, cells, [&]() { solver._updateOrderParameter(); });
+        add(kernelCost::linkingVariables, cells, [&]() { solver._updateLinkingVariables(0.1, 0.0); });
+        add(kernelCost::solverStep, cells, [&]() { solver.step(0.1, 0.0); });
+
+        SolverParameters noisy;
+        noisy.noise = 0.01;
+        solver.setParameters(noisy);
+        add(kernelCost::thermalNoise, cells, [&]() { solver._addThermalNoise(); });
+
+        // Leads at the left and right edge of a thin film
+        SolverParameters thinFilm;
+        thinFilm.screening = false;
+        solver.setParameters(thinFilm);
+        Mask source(n, n);
+        Mask drain(n, n);
+        for (int y = 0; y < n; y++) {
+            source(1, y) = true;
+            drain(n - 2, y) = true;
+        }
+        solver.setLeads(source, drain);
+        solver.step(0.1, 0.5);
+        add(kernelCost::supercurrentDivergence, cells, [&]() {
+            kernels::solver<double>().supercurrentDivergence(solver._kernelArguments(0.0, 0.0),
+                                                             solver._leads->divergence.data());
+        });
+        add(kernelCost::scalarPotential, cells, [&]() { solver._applyScalarPotential(); });
+    }
+
+    Field a(n, n);
+    Field b(n, n);
+    a.fill(complex(1.0, 0.5));
+    b.fill(complex(0.5, 1.0));
+    RealField ra(n, n);
+    RealField rb(n, n);
+    ra.fill(1.5);
+    rb.fill(0.5);
+    add(kernelCost::fieldFill, cells, [&]() { a.fill(complex(1.0, 0.5)); });
+    add(kernelCost::fieldAddScalar, cells, [&]() { Field result = a + complex(1.0, 0.0); });
+    add(kernelCost::fieldAddField, cells, [&]() { Field result = a + b; });
+    add(kernelCost::fieldMultiplyScalar, cells, [&]() { Field result = a * complex(0.0, 1.0); });
+    add(kernelCost::fieldMultiplyField, cells, [&]() { Field result = a * b; });
+    add(kernelCost::realMultiplyField, cells, [&]() { RealField result = ra * rb; });
+    return measurements;
+}
+
+void Roofline::report(std::ostream &out) const {
+    double bandwidth = measureBandwidth();
+    double peak = measurePeakFlops();
+    std::vector<KernelMeasurement> kernels = measureKernels();
+
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(2)
+        << "threads: " << threadCount() << ", grid: " << _gridSize << "x" << _gridSize
+        << ", kernels: " << kernels::name(kernels::active().instructionSet) << "\n"
+        << "memory roof (STREAM triad): " << 1e-9 * bandwidth << " GB/s\n"
+        << "compute roof (multiply-add): " << 1e-9 * peak << " GFlop/s\n"
+        << "ridge point: " << peak / bandwidth << " flop/byte\n\n";
+
+    out << std::left << std::setw(24) << "kernel" << std::right << std::setw(12) << "bytes/cell"
+        << std::setw(12) << "flops/cell" << std::setw(11) << "flop/byte" << std::setw(12) << "Mcells/s"
+        << std::setw(10) << "GB/s" << std::setw(10) << "GFlop/s" << std::setw(10) << "roofline" << std::setw(9)
+        << "bound" << "\n";
+    for (const KernelMeasurement &kernel : kernels) {
+        const KernelCost &cost = kernel.cost;
+        double memoryTime = cost.bytesPerCell / bandwidth;
+        double computeTime = cost.flopsPerCell / peak;
+        double attainableTime = std::max(memoryTime, computeTime);
+        double fraction = attainableTime * kernel.cellsPerSecond;
+
+        out << std::left << std::setw(24) << cost.name << std::right
+            << std::setw(12) << std::setprecision(0) << cost.bytesPerCell
+            << std::setw(12) << cost.flopsPerCell
+            << std::setw(11) << std::setprecision(2) << cost.intensity()
+            << std::setw(12) << 1e-6 * kernel.cellsPerSecond
+            << std::setw(10) << 1e-9 * cost.bytesPerCell * kernel.cellsPerSecond
+            << std::setw(10) << 1e-9 * cost.flopsPerCell * kernel.cellsPerSecond
+            << std::setw(9) << std::setprecision(1) << 100.0 * fraction << "%"
+            << std::setw(9) << (memoryTime >= computeTime ? "memory" : "compute") << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
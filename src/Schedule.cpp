@@ -0,0 +1,40 @@
+#include "../include/Schedule.h"
+#include <algorithm>
+#include <stdexcept>
+
+Schedule::Schedule() : _points{{0.0, 0.0}} {
+}
+
+Schedule::Schedule(double value) : _points{{0.0, value}} {
+}
+
+Schedule::Schedule(std::vector<schedulePoint> points) : _points(std::move(points)) {
+    if (_points.empty()) {
+        throw std::invalid_argument("Schedule needs at least one point.");
+    }
+    for (std::size_t i = 1; i < _points.size(); i++) {
+        if (_points[i].first <= _points[i - 1].first) {
+            throw std::invalid_argument("Schedule times must be strictly increasing.");
+        }
+    }
+}
+
+double Schedule::operator()(double time) const {
+    if (time <= _points.front().first) {
+        return _points.front().second;
+    }
+    if (time >= _points.back().first) {
+        return _points.back().second;
+    }
+
+    // First point strictly later than time; the previous one is at or before it
+    auto upper = std::upper_bound(_points.begin(), _points.end(), time,
+                                  [](double t, const schedulePoint& point) { return t < point.first; });
+    auto lower = upper - 1;
+    double fraction = (time - lower->first) / (upper->first - lower->first);
+    return lower->second + fraction * (upper->second - lower->second);
+}
+
+const std::vector<schedulePoint>& Schedule::points() const {
+    return _points;
+}
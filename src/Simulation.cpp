@@ -0,0 +1,587 @@
+#include "../include/Simulation.h"
+#include "../include/AdaptiveStepper.h"
+#include "../include/Arena.h"
+#include "../include/Gauge.h"
+#include "../include/Instrumentation.h"
+#include "../include/Kernels.h"
+#include "../include/Multiresolution.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+    /**
+     * @brief Capacity of the per-thread trace buffers. A step records three events, so this covers ~300k steps.
+     */
+    constexpr std::size_t traceEventsPerThread = 1 << 20;
+}
+
+/**
+ * The state at every output goes into a pooled snapshot, whose handle is passed to a task per kind of output: one
+ * writes the vortices, one the snapshots. The order parameter is not copied: the next step reads it in place, after
+ * which the solver hands its storage over to the snapshot and writes on into the former storage of the snapshot. The
+ * links without screening are those of the applied field, which the vortex task builds itself when the field changes;
+ * with screening the next step updates them in place, so they are copied. A mesh writes the order parameter at every
+ * output, and no step follows the last output, so those are copied as well. Each task takes its outputs in order, so
+ * every file is written in order; the tasks run side by side. The pool holds a snapshot for every place in a queue,
+ * one in the hands of each task and one waiting for the next step, so the solver only waits for a snapshot when the
+ * analysis is a full queue behind.
+ */
+template<typename real, typename link>
+class Simulation::Analysis {
+public:
+    typedef typename pipeline::BufferPool<Snapshot<real, link>>::Handle handle_type;
+
+    /**
+     * @brief Starts the tasks of a job and allocates its snapshots.
+     * @param simulation The simulation, which writes the files.
+     * @param job The job, which writes vortices, snapshots or both.
+     * @param geometry The geometry of the job.
+     * @param state The superconductor and solver of the job.
+     * @param stepped Whether the solver steps the state from output to output, so that it can hand the order parameter
+     * over; not with a mesh.
+     * @param vortices Receives the vortices, if the job writes them.
+     * @param fluxoids Receives the fluxoids, if the job writes vortices and the geometry has holes.
+     */
+    Analysis(const Simulation &simulation, const Job &job, const Geometry &geometry, State<real, link> &state,
+             bool stepped, std::ostream &vortices, std::ostream &fluxoids) :
+            _simulation(simulation), _job(job), _state(state), _stepped(stepped), _vortices(vortices),
+            _fluxoids(fluxoids), _pool(job.analysisThreads),
+            _snapshots(job.analysisQueue + job.vortices + job.snapshots + 1, [&job, &geometry] {
+                auto snapshot = std::make_unique<Snapshot<real, link>>(
+                        Snapshot<real, link>{BasicSuperconductor<real, link>(job.width, job.height)});
+                if (job.vortices) {
+                    snapshot->vorticity = std::make_unique<BasicVorticity<real, link>>(snapshot->superconductor,
+                                                                                       geometry);
+                }
+                return snapshot;
+            }), _vortexQueue(job.analysisQueue, _pool), _snapshotQueue(job.analysisQueue, _pool) {
+        if (job.vortices) {
+            _vortexTask = _writeVortices();
+            _vortexTask.start(_pool);
+        }
+        if (job.snapshots) {
+            _snapshotTask = _writeSnapshots();
+            _snapshotTask.start(_pool);
+        }
+    }
+
+    /**
+     * @brief Calls off a hand-over still to come and lets the tasks finish the outputs already published.
+     */
+    ~Analysis() {
+        _state.solver->handOver(nullptr);
+        _vortexQueue.close();
+        _snapshotQueue.close();
+    }
+
+    /**
+     * @brief Takes the state at an output into a snapshot, and hands the snapshot of the output before to the tasks.
+     * The order parameter of a stepped state is handed over by the next step; the links are only copied with
+     * screening. Waits while all snapshots are in use.
+     * @param output The output.
+     * @throws Whatever a task failed with.
+     */
+    void publish(const Output &output) {
+        // The step since the output before has handed its order parameter over
+        if (_waiting && !_push(std::move(_waiting))) {
+            finish();
+        }
+        handle_type snapshot = _snapshots.acquire();
+        BasicSuperconductor<real, link> &state = *_state.superconductor;
+        snapshot->time = output.time;
+        snapshot->index = output.index;
+        if (_job.vortices) {
+            snapshot->appliedField = _stepped ? _state.solver->appliedLinkField() : std::optional<double>(output.field);
+            if (!snapshot->appliedField) {
+                SQUID_TIMED_SCOPE("snapshot", 0, 0);
+                snapshot->superconductor.linkingVariableX() = state.linkingVariableX();
+                snapshot->superconductor.linkingVariableY() = state.linkingVariableY();
+                snapshot->linkField.reset();
+            }
+        }
+        if (_stepped) {
+            _state.solver->handOver(&snapshot->superconductor.orderParameter());
+            _waiting = std::move(snapshot);
+            return;
+        }
+        {
+            SQUID_TIMED_SCOPE("snapshot", 0, 0);
+            snapshot->superconductor.orderParameter() = state.orderParameter();
+        }
+        if (!_push(std::move(snapshot))) {
+            finish();
+        }
+    }
+
+    /**
+     * @brief Waits for the tasks to write all outputs.
+     * @throws Whatever a task failed with.
+     */
+    void finish() {
+        if (_waiting) {
+            // No step followed the last output, its order parameter is still in place
+            _state.solver->handOver(nullptr);
+            {
+                SQUID_TIMED_SCOPE("snapshot", 0, 0);
+                _waiting->superconductor.orderParameter() = _state.superconductor->orderParameter();
+            }
+            _push(std::move(_waiting));
+        }
+        _vortexQueue.close();
+        _snapshotQueue.close();
+        if (_job.vortices) {
+            _vortexTask.wait();
+        }
+        if (_job.snapshots) {
+            _snapshotTask.wait();
+        }
+    }
+
+private:
+    /**
+     * @brief Hands a snapshot to the tasks.
+     * @param snapshot The snapshot.
+     * @return Whether the tasks took it; a queue is only closed before the end by a task that failed.
+     */
+    bool _push(handle_type snapshot) {
+        return (!_job.vortices || _vortexQueue.push(snapshot)) && (!_job.snapshots || _snapshotQueue.push(snapshot));
+    }
+
+    pipeline::Task _writeVortices() {
+        try {
+            while (std::optional<handle_type> snapshot = co_await _vortexQueue.pop()) {
+                SQUID_TIMED_SCOPE("analysis", 0, 0);
+                Snapshot<real, link> &state = **snapshot;
+                if (state.appliedField && state.linkField != state.appliedField) {
+                    gauge::uniformField(*state.appliedField, _job.parameters.gauge, _job.parameters.gridSpacing,
+                                        state.superconductor.linkingVariableX(),
+                                        state.superconductor.linkingVariableY());
+                    state.linkField = state.appliedField;
+                }
+                _simulation._writeVortices((*snapshot)->time, _job.parameters.gridSpacing, *(*snapshot)->vorticity,
+                                           _vortices, _fluxoids);
+            }
+        } catch (...) {
+            _vortexQueue.close();
+            throw;
+        }
+    }
+
+    pipeline::Task _writeSnapshots() {
+        try {
+            while (std::optional<handle_type> snapshot = co_await _snapshotQueue.pop()) {
+                SQUID_TIMED_SCOPE("analysis", 0, 0);
+                _simulation._writeSuperfluidDensity(_simulation._snapshotPath(_job, (*snapshot)->index),
+                                                    (*snapshot)->superconductor.orderParameter());
+            }
+        } catch (...) {
+            _snapshotQueue.close();
+            throw;
+        }
+    }
+
+    const Simulation &_simulation;
+    const Job &_job;
+    State<real, link> &_state;
+    const bool _stepped;
+    std::ostream &_vortices;
+    std::ostream &_fluxoids;
+
+    // Destroyed in reverse: the tasks finish, the handles left in the queues return to the pool, the threads join
+    pipeline::ThreadPool _pool;
+    pipeline::BufferPool<Snapshot<real, link>> _snapshots;
+    pipeline::Channel<handle_type> _vortexQueue;
+    pipeline::Channel<handle_type> _snapshotQueue;
+    pipeline::Task _vortexTask;
+    pipeline::Task _snapshotTask;
+
+    /**
+     * @brief The snapshot of the last output, until the next step hands its order parameter over.
+     */
+    handle_type _waiting;
+};
+
+Simulation::Simulation(std::ostream &log) : _log(log) {
+}
+
+void Simulation::run(const std::vector<Job> &jobs) {
+    for (const Job &job : jobs) {
+        run(job);
+    }
+}
+
+void Simulation::run(const Job &job) {
+    if (job.singlePrecision && job.phaseLinks) {
+        _run<float, Phase>(job);
+    } else if (job.singlePrecision) {
+        _run<float, std::complex<float>>(job);
+    } else if (job.phaseLinks) {
+        _run<double, Phase>(job);
+    } else {
+        _run<double, std::complex<double>>(job);
+    }
+}
+
+const Superconductor &Simulation::superconductor() const {
+    const auto *state = std::get_if<State<double, std::complex<double>>>(&_state);
+    if (state == nullptr) {
+        throw std::logic_error("No job has been run in double precision with complex links.");
+    }
+    return *state->superconductor;
+}
+
+template<typename real, typename link>
+void Simulation::_run(const Job &job) {
+    State<real, link> &state = _prepare<real, link>(job);
+    BasicSolver<real, link> &solver = *state.solver;
+
+#ifdef _OPENMP
+    omp_set_num_threads(job.threads);
+#endif
+
+    std::ofstream observables = _openOutput(job, ".csv");
+    observables << "time,field,current,superfluid_density,magnetic_field\n";
+
+    // Vortex positions in coherence lengths, one row per vortex, and the fluxoid of every hole
+    std::unique_ptr<BasicVorticity<real, link>> vorticity;
+    std::ofstream vortices;
+    std::ofstream fluxoids;
+    if (job.vortices) {
+        if (job.analysisThreads == 0) {
+            vorticity = std::make_unique<BasicVorticity<real, link>>(*state.superconductor, *_geometry);
+        }
+        vortices = _openOutput(job, "_vortices.csv");
+        vortices << "time,x,y,charge\n";
+        if (_geometry->holeCount() > 0) {
+            fluxoids = _openOutput(job, "_fluxoids.csv");
+            fluxoids << "time";
+            for (int hole = 0; hole < _geometry->holeCount(); hole++) {
+                fluxoids << ",hole_" << hole;
+            }
+            fluxoids << '\n';
+        }
+    }
+
+    // Statistics of the currents and voltages over every output interval
+    std::unique_ptr<BasicTransport<real, link>> transport;
+    std::ofstream transportFile;
+    if (!job.cutLines.empty() || !job.probes.empty() || !job.voltageProbes.empty()) {
+        transport = std::make_unique<BasicTransport<real, link>>(*state.superconductor, *_geometry,
+                                                                 job.parameters.gridSpacing);
+        transportFile = _openOutput(job, "_transport.csv");
+        transportFile << "time";
+        auto columns = [&transportFile](const std::string &name) {
+            transportFile << ',' << name << "_mean," << name << "_variance," << name << "_min," << name << "_max";
+        };
+        for (const CutLine &cut : job.cutLines) {
+            columns("cut_" + std::to_string(transport->addCutLine(cut)));
+        }
+        for (const GridPoint &probe : job.probes) {
+            const std::string name = "probe_" + std::to_string(transport->addProbe(probe));
+            columns(name + "_jx");
+            columns(name + "_jy");
+        }
+        for (const auto &[from, to] : job.voltageProbes) {
+            columns("voltage_" + std::to_string(transport->addVoltageProbe(from, to)));
+        }
+        transportFile << '\n';
+    }
+
+    solver.setParameters(job.parameters);
+    if (job.sourceLead) {
+        solver.setLeads(job.leadMask(*job.sourceLead), job.leadMask(*job.drainLead), job.multigrid);
+    } else {
+        solver.removeLeads();
+    }
+    if (transport) {
+        transport->setScalarPotential(job.sourceLead ? &solver.scalarPotential() : nullptr);
+    }
+    solver.initialize();
+    // The coarse grids have no leads, the current through them is only switched on at the finest
+    multiresolution::initialize(*state.superconductor, *_geometry, job.parameters, job.nested, job.field(0.0),
+                                job.sourceLead ? 0.0 : job.current(0.0));
+
+    // The time step of every adaptive step, its error and the attempts rejected before it
+    std::unique_ptr<BasicAdaptiveStepper<real, link>> stepper;
+    std::ofstream timeSteps;
+    if (job.adaptive) {
+        stepper = std::make_unique<BasicAdaptiveStepper<real, link>>(solver, job.adaptiveParameters);
+        timeSteps = _openOutput(job, "_timesteps.csv");
+        timeSteps << "time,time_step,error,rejections\n";
+    }
+
+    // Refined jobs start the mesh from the initial state, and bring its composite back onto the state at every output
+    std::unique_ptr<AdaptiveMesh> mesh;
+    if constexpr (std::is_same_v<BasicSuperconductor<real, link>, Superconductor>) {
+        if (job.refine) {
+            mesh = std::make_unique<AdaptiveMesh>(*_geometry, job.parameters, job.refinement);
+            mesh->load(state.superconductor->orderParameter(), job.field(0.0));
+        }
+    }
+
+    instrumentation::reset();
+    if (instrumentation::enabled && job.trace) {
+        instrumentation::enableTracing(traceEventsPerThread);
+    } else {
+        instrumentation::disableTracing();
+    }
+
+    // With analysis threads the vortices and snapshots are written from snapshots of the state next to the solver
+    std::unique_ptr<Analysis<real, link>> analysis;
+    if (job.analysisThreads > 0 && (job.vortices || job.snapshots)) {
+        analysis = std::make_unique<Analysis<real, link>>(*this, job, *_geometry, state, !mesh, vortices, fluxoids);
+    }
+
+    // Field temporaries made in between steps reuse their storage from output to output
+    arena::Scope scratch;
+    auto start = std::chrono::steady_clock::now();
+    long steps = 0;
+    for (const Output &output : _integrate(job, solver, stepper.get(), mesh.get(), transport.get(), timeSteps)) {
+        if constexpr (std::is_same_v<BasicSuperconductor<real, link>, Superconductor>) {
+            if (mesh) {
+                SQUID_TIMED_SCOPE("composite", 0, 0);
+                Superconductor &superconductor = *state.superconductor;
+                mesh->composite(superconductor.orderParameter());
+                gauge::uniformField(output.field, job.parameters.gauge, job.parameters.gridSpacing,
+                                    superconductor.linkingVariableX(), superconductor.linkingVariableY());
+            }
+        }
+        double density = solver.meanSuperfluidDensity();
+        // Without screening the field is the applied one at the output; the flux cells of the solver only follow it in
+        // the next step, and a mesh has none
+        double magneticField = job.parameters.screening ? solver.meanMagneticField() : output.field;
+        steps = output.steps;
+        if (analysis) {
+            analysis->publish(output);
+        }
+        SQUID_TIMED_SCOPE("output", 0, 0);
+        observables << output.time << ',' << output.field << ',' << output.current << ',' << density << ','
+                    << magneticField << '\n';
+        if (vorticity && !analysis) {
+            _writeVortices(output.time, job.parameters.gridSpacing, *vorticity, vortices, fluxoids);
+        }
+        if (job.snapshots && !analysis) {
+            _writeSuperfluidDensity(_snapshotPath(job, output.index), state.superconductor->orderParameter());
+        }
+        if (transport) {
+            _writeTransport(output.time, *transport, transportFile);
+        }
+    }
+    if (analysis) {
+        analysis->finish();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    {
+        SQUID_TIMED_SCOPE("output", 0, 0);
+        _writeSuperfluidDensity(job.output + "_psi.txt", state.superconductor->orderParameter());
+    }
+    if (instrumentation::enabled) {
+        _writeProfile(job);
+        if (job.trace) {
+            instrumentation::disableTracing();
+            _writeTrace(job);
+        }
+    }
+    _log << "job '" << job.name << "': " << steps << " steps";
+    if (stepper) {
+        _log << " (" << stepper->rejected() << " rejected)";
+    }
+    if (mesh) {
+        _log << " of an adaptive mesh of " << mesh->cells() << " points";
+    }
+    _log << " on " << job.width << "x" << job.height << " in " << elapsed.count() << " s ("
+         << kernels::name(kernels::active().instructionSet) << " kernels"
+         << (job.singlePrecision ? ", single precision" : "") << (job.phaseLinks ? ", phase links" : "") << ")"
+         << std::endl;
+}
+
+template<typename real, typename link>
+pipeline::Generator<Simulation::Output> Simulation::_integrate(const Job &job, BasicSolver<real, link> &solver,
+                                                               BasicAdaptiveStepper<real, link> *stepper,
+                                                               AdaptiveMesh *mesh,
+                                                               BasicTransport<real, link> *transport,
+                                                               std::ostream &timeSteps) {
+    const bool periodicProfiles = instrumentation::enabled && job.profileInterval > 0.0;
+    const long steps = job.steps();
+    const int block = job.parameters.temporalBlocking;
+    auto lastProfile = std::chrono::steady_clock::now();
+    long outputs = 0;
+    long n = 0;
+    for (;; n++) {
+        double time = mesh ? mesh->time() : solver.time();
+        double field = job.field(time);
+        double current = job.current(time);
+        if (transport) {
+            transport->update(time);
+        }
+
+        // Compare against the output count rather than accumulating the interval to avoid drift
+        const bool done = stepper || mesh ? time >= job.duration - 1e-9 : n == steps;
+        if (done || time >= static_cast<double>(outputs) * job.outputInterval - 1e-9) {
+            co_yield Output{time, field, current, outputs, n};
+            outputs++;
+        }
+        if (done) {
+            break;
+        }
+        if (mesh) {
+            // The steps of the coarsest grid, several of the finest; outputs fall on the first step past their time
+            mesh->step(field);
+        } else if (stepper) {
+            // Land on the next output time and on the end of the run
+            const double next = std::min(static_cast<double>(outputs) * job.outputInterval, job.duration);
+            AdaptiveStep step = stepper->step(field, current, next - time);
+            SQUID_TIMED_SCOPE("output", 0, 0);
+            timeSteps << time << ',' << step.timeStep << ',' << step.error << ',' << step.rejections << '\n';
+        } else if (block > 1 && !transport) {
+            // A block of steps up to the next output and the end of the run, as long as the field and current hold
+            const double dt = job.parameters.timeStep;
+            const double output = static_cast<double>(outputs) * job.outputInterval - 1e-9;
+            double later = time + dt;
+            int count = 1;
+            while (count < block && n + count < steps && later < output && job.field(later) == field
+                   && job.current(later) == current) {
+                later += dt;
+                count++;
+            }
+            solver.advance(field, current, count);
+            n += count - 1;
+        } else {
+            solver.step(field, current);
+        }
+
+        if (periodicProfiles) {
+            auto now = std::chrono::steady_clock::now();
+            if (std::chrono::duration<double>(now - lastProfile).count() >= job.profileInterval) {
+                _writeProfile(job);
+                lastProfile = now;
+            }
+        }
+    }
+}
+
+template<typename real, typename link>
+Simulation::State<real, link> &Simulation::_prepare(const Job &job) {
+    std::string key = job.geometry + ":" + std::to_string(job.width) + "x" + std::to_string(job.height);
+
+    auto *state = std::get_if<State<real, link>>(&_state);
+    if (state == nullptr || state->superconductor->width() != static_cast<std::size_t>(job.width)
+        || state->superconductor->height() != static_cast<std::size_t>(job.height)) {
+        // The solver refers to the geometry and superconductor, so it goes first
+        _state = std::monostate();
+        _geometry = std::make_unique<Geometry>(job.width, job.height);
+        state = &_state.emplace<State<real, link>>();
+        state->superconductor = std::make_unique<BasicSuperconductor<real, link>>(job.width, job.height);
+        if (job.mask) {
+            _geometry->setGeometry(*job.mask);
+        }
+        state->solver = std::make_unique<BasicSolver<real, link>>(*state->superconductor, *_geometry,
+                                                                    job.parameters);
+    } else if (key != _geometryKey) {
+        // Same grid, other shape: keep all buffers and only re-derive the boundaries
+        if (job.mask) {
+            _geometry->setGeometry(*job.mask);
+        } else {
+            *_geometry = Geometry(job.width, job.height);
+        }
+        state->solver->updateGeometry();
+    }
+    _geometryKey = key;
+    return *state;
+}
+
+template<typename real, typename link>
+void Simulation::_writeVortices(double time, double gridSpacing, BasicVorticity<real, link> &vorticity,
+                                std::ostream &vortices, std::ostream &fluxoids) const {
+    vorticity.update();
+    for (const Vortex &vortex : vorticity.vortices()) {
+        vortices << time << ',' << (static_cast<double>(vortex.x) + 0.5) * gridSpacing << ','
+                 << (static_cast<double>(vortex.y) + 0.5) * gridSpacing << ',' << vortex.charge << '\n';
+    }
+    if (!vorticity.fluxoids().empty()) {
+        fluxoids << time;
+        for (int fluxoid : vorticity.fluxoids()) {
+            fluxoids << ',' << fluxoid;
+        }
+        fluxoids << '\n';
+    }
+}
+
+template<typename real, typename link>
+void Simulation::_writeTransport(double time, BasicTransport<real, link> &transport, std::ostream &file) const {
+    file << time;
+    auto write = [&file](const RunningStatistics &statistics) {
+        file << ',' << statistics.mean() << ',' << statistics.variance() << ',' << statistics.minimum() << ','
+             << statistics.maximum();
+    };
+    for (std::size_t i = 0; i < transport.cutLines(); i++) {
+        write(transport.current(i));
+    }
+    for (std::size_t i = 0; i < transport.probes(); i++) {
+        write(transport.currentDensityX(i));
+        write(transport.currentDensityY(i));
+    }
+    for (std::size_t i = 0; i < transport.voltageProbes(); i++) {
+        write(transport.voltage(i));
+    }
+    file << '\n';
+    transport.reset();
+}
+
+std::string Simulation::_snapshotPath(const Job &job, long index) const {
+    return job.output + "_psi_" + std::to_string(index) + ".txt";
+}
+
+std::ofstream Simulation::_openOutput(const Job &job, const std::string &suffix) const {
+    std::ofstream file(job.output + suffix);
+    if (!file) {
+        throw std::runtime_error("job '" + job.name + "': cannot write " + job.output + suffix + ".");
+    }
+    return file;
+}
+
+template<typename real>
+void Simulation::_writeSuperfluidDensity(const std::string &path, const ComplexField<real> &psi) const {
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot write " + path + ".");
+    }
+    for (std::size_t row = 0; row < psi.height(); row++) {
+        std::size_t y = psi.height() - 1 - row;
+        for (std::size_t x = 0; x < psi.width(); x++) {
+            file << (x > 0 ? " " : "") << std::norm(psi(x, y));
+        }
+        file << '\n';
+    }
+}
+
+void Simulation::_writeProfile(const Job &job) const {
+    // Write to a temporary and rename, so that a reader never sees a half-written report
+    std::string path = job.output + "_profile.json";
+    {
+        std::ofstream file(path + ".tmp");
+        if (!file) {
+            throw std::runtime_error("Cannot write " + path + ".");
+        }
+        instrumentation::writeReport(file);
+    }
+    std::rename((path + ".tmp").c_str(), path.c_str());
+}
+
+void Simulation::_writeTrace(const Job &job) const {
+    std::string path = job.output + "_trace.json";
+    std::ofstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot write " + path + ".");
+    }
+    instrumentation::writeChromeTrace(file);
+}
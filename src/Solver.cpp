@@ -0,0 +1,6 @@
+#include "../include/Solver.h"
+
+template class BasicSolver<float>;
+template class BasicSolver<double>;
+template class BasicSolver<float, Phase>;
+template class BasicSolver<double, Phase>;
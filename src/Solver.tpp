@@ -0,0 +1,408 @@
+#include "../include/Instrumentation.h"
+#include "../include/KernelCost.h"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+template<typename real, typename link, typename grid>
+link BasicSolver<real, link, grid>::_unitLink() {
+    if constexpr (std::is_same_v<link, Phase>) {
+        return Phase();
+    } else {
+        return link(1);
+    }
+}
+
+template<typename real, typename link, typename grid>
+BasicSolver<real, link, grid>::BasicSolver(superconductor_type &superconductor, const Geometry &geometry,
+                               const SolverParameters &parameters) :
+        _superconductor(superconductor), _geometry(geometry), _parameters(parameters),
+        _width(superconductor.width()), _height(superconductor.height()), _time(0.0), _steps(0),
+        _cellWeight(superconductor.width(), superconductor.height()),
+        _linkWeightX(superconductor.width() - 1, superconductor.height()),
+        _linkWeightY(superconductor.width(), superconductor.height() - 1), _activeCells(0.0),
+        _nextOrderParameter(superconductor.width(), superconductor.height()), _handOverBuffer(nullptr),
+        _magneticField(superconductor.width() - 1, superconductor.height() - 1), _appliedLinksValid(false),
+        _appliedField(0.0) {
+    if (geometry.width() != static_cast<int>(_width) || geometry.height() != static_cast<int>(_height)) {
+        throw std::invalid_argument("Geometry and superconductor dimensions must match.");
+    }
+    validateParameters(parameters);
+    updateGeometry();
+    _reserveTileScratch();
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::validateParameters(const SolverParameters &parameters) {
+    if (!(parameters.kappa > 0.0)) {
+        throw std::invalid_argument("kappa must be positive.");
+    }
+    if (!(parameters.gridSpacing > 0.0)) {
+        throw std::invalid_argument("Grid spacing must be positive.");
+    }
+    if (!(parameters.timeStep > 0.0)) {
+        throw std::invalid_argument("Time step must be positive.");
+    }
+    if (!(parameters.noise >= 0.0)) {
+        throw std::invalid_argument("Noise must not be negative.");
+    }
+    if (parameters.temporalBlocking < 1) {
+        throw std::invalid_argument("Temporal blocking must be at least 1 step.");
+    }
+
+    double limit = stabilityLimit(parameters);
+    if (parameters.timeStep > limit) {
+        throw std::invalid_argument("Time step exceeds the stability limit of " + std::to_string(limit) + ".");
+    }
+}
+
+template<typename real, typename link, typename grid>
+double BasicSolver<real, link, grid>::stabilityLimit(const SolverParameters &parameters) {
+    // Forward Euler on the 5-point Laplacian is stable for dt <= h^2 / 4; the vector potential diffuses kappa^2
+    // times faster than the order parameter.
+    double h2 = parameters.gridSpacing * parameters.gridSpacing;
+    double diffusivity = parameters.screening ? std::max(1.0, parameters.kappa * parameters.kappa) : 1.0;
+    return h2 / (4.0 * diffusivity);
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::setParameters(const SolverParameters &parameters) {
+    validateParameters(parameters);
+    _parameters = parameters;
+    _appliedLinksValid = false;
+    _reserveTileScratch();
+}
+
+template<typename real, typename link, typename grid>
+const SolverParameters &BasicSolver<real, link, grid>::parameters() const {
+    return _parameters;
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::updateGeometry() {
+    SQUID_TIMED_SCOPE("geometry", _width * _height, 0);
+    _activeCells = 0.0;
+    for (std::size_t x = 0; x < _width; x++) {
+        for (std::size_t y = 0; y < _height; y++) {
+            bool active = _geometry.inSuperconductor(static_cast<int>(x), static_cast<int>(y));
+            _cellWeight(x, y) = active ? 1.0 : 0.0;
+            _activeCells += _cellWeight(x, y);
+        }
+    }
+    for (std::size_t x = 0; x + 1 < _width; x++) {
+        for (std::size_t y = 0; y < _height; y++) {
+            _linkWeightX(x, y) = _cellWeight(x, y) * _cellWeight(x + 1, y);
+        }
+    }
+    for (std::size_t x = 0; x < _width; x++) {
+        for (std::size_t y = 0; y + 1 < _height; y++) {
+            _linkWeightY(x, y) = _cellWeight(x, y) * _cellWeight(x, y + 1);
+        }
+    }
+    if (_leads) {
+        _updateLeads();
+    }
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::setLeads(const Mask &source, const Mask &drain,
+                                             const MultigridParameters &multigrid) {
+    if (source.width() != _width || source.height() != _height || drain.width() != _width
+        || drain.height() != _height) {
+        throw std::invalid_argument("Lead and grid dimensions must match.");
+    }
+    const auto W = static_cast<int>(_width);
+    const auto H = static_cast<int>(_height);
+    _leads = std::make_unique<Leads>(Leads{source, drain, multigrid, nullptr, RealField(W, H), RealField(W, H),
+                                           RealField(W, H), 0});
+    try {
+        _updateLeads();
+    } catch (const std::invalid_argument &) {
+        _leads.reset();
+        throw;
+    }
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::removeLeads() {
+    _leads.reset();
+}
+
+template<typename real, typename link, typename grid>
+const RealField &BasicSolver<real, link, grid>::scalarPotential() const {
+    if (!_leads) {
+        throw std::logic_error("There is no scalar potential without leads.");
+    }
+    return _leads->potential;
+}
+
+template<typename real, typename link, typename grid>
+int BasicSolver<real, link, grid>::potentialCycles() const {
+    return _leads ? _leads->cycles : 0;
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::initialize() {
+    field_type &psi = _superconductor.orderParameter();
+    std::complex<real> *p = psi.data();
+    const real *cw = _cellWeight.data();
+    for (std::size_t i = 0; i < psi.size(); i++) {
+        p[i] = cw[i];
+    }
+    _nextOrderParameter.fill(0.0);
+    _handOverBuffer = nullptr;
+    _superconductor.linkingVariableX().fill(_unitLink());
+    _superconductor.linkingVariableY().fill(_unitLink());
+    _updateFluxCells();
+    _appliedLinksValid = false;
+    if (_leads) {
+        _leads->potential.fill(0.0);
+        _leads->cycles = 0;
+    }
+    _time = 0.0;
+    _steps = 0;
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::step(double appliedField, double appliedCurrent) {
+    if (_parameters.screening) {
+        if (_leads) {
+            throw std::invalid_argument("Leads need a run without screening.");
+        }
+        _updateFluxCells();
+        _updateOrderParameter();
+        _addThermalNoise();
+        _updateLinkingVariables(appliedField, appliedCurrent);
+    } else if (_leads) {
+        _updateAppliedLinks(appliedField);
+        _updateScalarPotential(appliedCurrent);
+        _updateOrderParameter();
+        _addThermalNoise();
+        _applyScalarPotential();
+    } else {
+        if (appliedCurrent != 0.0) {
+            throw std::invalid_argument("A transport current needs screening or leads.");
+        }
+        _updateAppliedLinks(appliedField);
+        _updateOrderParameter();
+        _addThermalNoise();
+    }
+
+    _swapOrderParameter();
+    _time += _parameters.timeStep;
+    _steps++;
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::advance(double appliedField, double appliedCurrent, int steps) {
+    const int block = _parameters.temporalBlocking;
+    const bool blocked = block > 1 && !_parameters.screening && !_leads && _parameters.noise == 0.0;
+    if (blocked && appliedCurrent != 0.0) {
+        throw std::invalid_argument("A transport current needs screening or leads.");
+    }
+    for (; blocked && steps >= block; steps -= block) {
+        _updateAppliedLinks(appliedField);
+        _reserveTileScratch();
+        {
+            SQUID_TIMED_SCOPE(cost::orderParameter.name, block * _width * _height,
+                              _width * _height * cost::orderParameter.bytesPerCell);
+            kernels::solver<real, link>().orderParameterSteps(_kernelArguments(0.0, 0.0),
+                                                              {block, _tileWidth, _tileHeight, _tileScratch.data()});
+        }
+        _swapOrderParameter();
+        // The clock adds up the steps one by one, as step() does
+        for (int n = 0; n < block; n++) {
+            _time += _parameters.timeStep;
+        }
+        _steps += block;
+    }
+    for (; steps > 0; steps--) {
+        step(appliedField, appliedCurrent);
+    }
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::handOver(field_type *buffer) {
+    if (buffer != nullptr && (buffer->width() != _width || buffer->height() != _height)) {
+        throw std::invalid_argument("The buffer must have the dimensions of the superconductor.");
+    }
+    _handOverBuffer = buffer;
+}
+
+template<typename real, typename link, typename grid>
+std::optional<double> BasicSolver<real, link, grid>::appliedLinkField() const {
+    if (_parameters.screening || !_appliedLinksValid) {
+        return std::nullopt;
+    }
+    return _appliedField;
+}
+
+template<typename real, typename link, typename grid>
+double BasicSolver<real, link, grid>::time() const {
+    return _time;
+}
+
+template<typename real, typename link, typename grid>
+const typename BasicSolver<real, link, grid>::magnetic_field_type &
+BasicSolver<real, link, grid>::magneticField() const {
+    return _magneticField;
+}
+
+template<typename real, typename link, typename grid>
+double BasicSolver<real, link, grid>::meanSuperfluidDensity() const {
+    SQUID_TIMED_SCOPE("observables", _width * _height,
+                      _width * _height * sizeof(std::complex<real>) + _width * _height / 8);
+    if (_activeCells == 0.0) {
+        return 0.0;
+    }
+    return reductions::maskedSquaredNorm(_superconductor.orderParameter().data(), _geometry.superconductor().data(),
+                                         _width * _height) / _activeCells;
+}
+
+template<typename real, typename link, typename grid>
+double BasicSolver<real, link, grid>::meanMagneticField() const {
+    SQUID_TIMED_SCOPE("observables", _magneticField.size(), _magneticField.size() * sizeof(real));
+    return reductions::sum(_magneticField.data(), _magneticField.size()) / static_cast<double>(_magneticField.size());
+}
+
+template<typename real, typename link, typename grid>
+kernels::SolverArguments<real, link> BasicSolver<real, link, grid>::_kernelArguments(double appliedField,
+                                                                            double appliedCurrent) {
+    return {_width, _height, _parameters.gridSpacing, _parameters.timeStep, _parameters.kappa,
+            appliedField, appliedCurrent,
+            _cellWeight.data(), _linkWeightX.data(), _linkWeightY.data(),
+            _superconductor.orderParameter().data(), _nextOrderParameter.data(),
+            _superconductor.linkingVariableX().data(), _superconductor.linkingVariableY().data(),
+            _superconductor.fluxCellPhasor().data(), _magneticField.data(),
+            std::sqrt(_parameters.noise * _parameters.timeStep) / _parameters.gridSpacing, _parameters.seed, _steps};
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::_reserveTileScratch() {
+    const auto block = static_cast<std::size_t>(_parameters.temporalBlocking);
+    if (block < 2) {
+        return;
+    }
+#ifdef _OPENMP
+    const auto threads = static_cast<std::size_t>(omp_get_max_threads());
+#else
+    const std::size_t threads = 1;
+#endif
+    const std::size_t scratch = threads * 3 * (block - 1) * (_tileHeight + 2 * (block - 1));
+    if (_tileScratch.size() < scratch) {
+        _tileScratch.resize(scratch);
+    }
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::_swapOrderParameter() {
+    // Swapping moves the storage, the scratch buffer keeps its zero edges
+    std::swap(_superconductor.orderParameter(), _nextOrderParameter);
+    if (_handOverBuffer != nullptr) {
+        std::swap(*_handOverBuffer, _nextOrderParameter);
+        _handOverBuffer = nullptr;
+    }
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::_updateFluxCells() {
+    SQUID_TIMED_SCOPE(cost::fluxCells.name, _magneticField.size(),
+                      _magneticField.size() * cost::fluxCells.bytesPerCell);
+    kernels::solver<real, link>().fluxCells(_kernelArguments(0.0, 0.0));
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::_updateAppliedLinks(double appliedField) {
+    if (_appliedLinksValid && appliedField == _appliedField) {
+        return;
+    }
+    {
+        SQUID_TIMED_SCOPE("applied links", _width * _height, _width * _height * 2 * sizeof(link));
+        gauge::uniformField(appliedField, _parameters.gauge, _parameters.gridSpacing, _width, _height,
+                            _superconductor.linkingVariableX().data(), _superconductor.linkingVariableY().data());
+    }
+    _updateFluxCells();
+    _appliedLinksValid = true;
+    _appliedField = appliedField;
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::_updateOrderParameter() {
+    SQUID_TIMED_SCOPE(cost::orderParameter.name, _width * _height,
+                      _width * _height * cost::orderParameter.bytesPerCell);
+    kernels::solver<real, link>().orderParameter(_kernelArguments(0.0, 0.0));
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::_addThermalNoise() {
+    if (_parameters.noise == 0.0) {
+        return;
+    }
+    SQUID_TIMED_SCOPE(cost::thermalNoise.name, _width * _height,
+                      _width * _height * cost::thermalNoise.bytesPerCell);
+    kernels::solver<real, link>().thermalNoise(_kernelArguments(0.0, 0.0));
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::_updateLeads() {
+    Leads &leads = *_leads;
+    double sourcePoints = 0.0;
+    double drainPoints = 0.0;
+    for (std::size_t x = 0; x < _width; x++) {
+        for (std::size_t y = 0; y < _height; y++) {
+            sourcePoints += leads.source(x, y) ? _cellWeight(x, y) : 0.0;
+            drainPoints += leads.drain(x, y) ? _cellWeight(x, y) : 0.0;
+        }
+    }
+    if (sourcePoints == 0.0 || drainPoints == 0.0) {
+        throw std::invalid_argument("Both leads need points in the superconductor.");
+    }
+    for (std::size_t x = 0; x < _width; x++) {
+        for (std::size_t y = 0; y < _height; y++) {
+            const double in = leads.source(x, y) ? 1.0 / sourcePoints : 0.0;
+            const double out = leads.drain(x, y) ? 1.0 / drainPoints : 0.0;
+            leads.injection(x, y) = _cellWeight(x, y) * (in - out);
+        }
+    }
+    leads.multigrid = std::make_unique<Multigrid>(_geometry.superconductor(), leads.parameters);
+    leads.potential.fill(0.0);
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::_updateScalarPotential(double appliedCurrent) {
+    Leads &leads = *_leads;
+    {
+        SQUID_TIMED_SCOPE(cost::supercurrentDivergence.name, _width * _height,
+                          _width * _height * cost::supercurrentDivergence.bytesPerCell);
+        kernels::solver<real, link>().supercurrentDivergence(_kernelArguments(0.0, 0.0), leads.divergence.data());
+    }
+
+    // L phi = I - h div(Js): the current of the leads less the supercurrent leaving every point
+    const std::size_t n = leads.divergence.size();
+    double *source = leads.divergence.data();
+    const double *injection = leads.injection.data();
+    for (std::size_t i = 0; i < n; i++) {
+        source[i] = appliedCurrent * injection[i] - source[i];
+    }
+    leads.cycles = leads.multigrid->solve(leads.potential, leads.divergence);
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::_applyScalarPotential() {
+    SQUID_TIMED_SCOPE(cost::scalarPotential.name, _width * _height,
+                      _width * _height * cost::scalarPotential.bytesPerCell);
+    kernels::solver<real, link>().scalarPotential(_kernelArguments(0.0, 0.0), _leads->potential.data());
+}
+
+template<typename real, typename link, typename grid>
+void BasicSolver<real, link, grid>::_updateLinkingVariables(double appliedField, double appliedCurrent) {
+    SQUID_TIMED_SCOPE(cost::linkingVariables.name, _width * _height,
+                      _width * _height * cost::linkingVariables.bytesPerCell);
+    kernels::solver<real, link>().linkingVariables(_kernelArguments(appliedField, appliedCurrent));
+}
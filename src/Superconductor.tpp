@@ -0,0 +1,123 @@
+template<typename real, typename link, typename grid>
+BasicSuperconductor<real, link, grid>::BasicSuperconductor(int width, int height) : _width(width), _height(height),
+                _orderParameter(width, height), _linkingVariableX(width - 1, height),
+                _linkingVariableY(width, height - 1), _fluxCellPhasor(width - 1, height - 1) {
+    if (width < 2 || height < 2) {
+        throw std::invalid_argument("Width and height must be at least 2.");
+    }
+}
+
+template<typename real, typename link, typename grid>
+BasicSuperconductor<real, link, grid>::~BasicSuperconductor() {
+}
+
+template<typename real, typename link, typename grid>
+BasicSuperconductor<real, link, grid>::BasicSuperconductor(const BasicSuperconductor& other) : _width(other._width),
+        _height(other._height),
+        _orderParameter(other._width, other._height),
+        _linkingVariableX(other._width - 1, other._height),
+        _linkingVariableY(other._width, other._height - 1),
+        _fluxCellPhasor(other._width - 1, other._height - 1) {
+    _orderParameter = other._orderParameter;
+    _linkingVariableX = other._linkingVariableX;
+    _linkingVariableY = other._linkingVariableY;
+    _fluxCellPhasor = other._fluxCellPhasor;
+}
+
+template<typename real, typename link, typename grid>
+BasicSuperconductor<real, link, grid>&
+BasicSuperconductor<real, link, grid>::operator=(const BasicSuperconductor& other) {
+    _width = other._width;
+    _height = other._height;
+    _orderParameter = other._orderParameter;
+    _linkingVariableX = other._linkingVariableX;
+    _linkingVariableY = other._linkingVariableY;
+    _fluxCellPhasor = other._fluxCellPhasor;
+    return *this;
+}
+
+template<typename real, typename link, typename grid>
+BasicSuperconductor<real, link, grid>::BasicSuperconductor(BasicSuperconductor&& other) noexcept : _width(other._width),
+        _height(other._height),
+        _orderParameter(std::move(other._orderParameter)),
+        _linkingVariableX(std::move(other._linkingVariableX)),
+        _linkingVariableY(std::move(other._linkingVariableY)),
+        _fluxCellPhasor(std::move(other._fluxCellPhasor)) {
+    // Invalidate other
+    other._width = 0;
+    other._height = 0;
+}
+
+template<typename real, typename link, typename grid>
+BasicSuperconductor<real, link, grid>&
+BasicSuperconductor<real, link, grid>::operator=(BasicSuperconductor&& other) noexcept {
+    _width = other._width;
+    _height = other._height;
+    _orderParameter = std::move(other._orderParameter);
+    _linkingVariableX = std::move(other._linkingVariableX);
+    _linkingVariableY = std::move(other._linkingVariableY);
+    _fluxCellPhasor = std::move(other._fluxCellPhasor);
+
+    // Invalidate other
+    other._width = 0;
+    other._height = 0;
+
+    return *this;
+}
+
+template<typename real, typename link, typename grid>
+typename BasicSuperconductor<real, link, grid>::field_type
+BasicSuperconductor<real, link, grid>::orderParameter() const {
+    return _orderParameter;
+}
+
+template<typename real, typename link, typename grid>
+typename BasicSuperconductor<real, link, grid>::field_type &BasicSuperconductor<real, link, grid>::orderParameter() {
+    return _orderParameter;
+}
+
+template<typename real, typename link, typename grid>
+typename BasicSuperconductor<real, link, grid>::x_link_field_type
+BasicSuperconductor<real, link, grid>::linkingVariableX() const {
+    return _linkingVariableX;
+}
+
+template<typename real, typename link, typename grid>
+typename BasicSuperconductor<real, link, grid>::x_link_field_type &
+BasicSuperconductor<real, link, grid>::linkingVariableX() {
+    return _linkingVariableX;
+}
+
+template<typename real, typename link, typename grid>
+typename BasicSuperconductor<real, link, grid>::y_link_field_type
+BasicSuperconductor<real, link, grid>::linkingVariableY() const {
+    return _linkingVariableY;
+}
+
+template<typename real, typename link, typename grid>
+typename BasicSuperconductor<real, link, grid>::y_link_field_type &
+BasicSuperconductor<real, link, grid>::linkingVariableY() {
+    return _linkingVariableY;
+}
+
+template<typename real, typename link, typename grid>
+typename BasicSuperconductor<real, link, grid>::plaquette_field_type
+BasicSuperconductor<real, link, grid>::fluxCellPhasor() const {
+    return _fluxCellPhasor;
+}
+
+template<typename real, typename link, typename grid>
+typename BasicSuperconductor<real, link, grid>::plaquette_field_type &
+BasicSuperconductor<real, link, grid>::fluxCellPhasor() {
+    return _fluxCellPhasor;
+}
+
+template<typename real, typename link, typename grid>
+std::size_t BasicSuperconductor<real, link, grid>::width() const {
+    return _width;
+}
+
+template<typename real, typename link, typename grid>
+std::size_t BasicSuperconductor<real, link, grid>::height() const {
+    return _height;
+}
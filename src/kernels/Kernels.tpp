@@ -0,0 +1,1266 @@
+// Kernel bodies, compiled once per instruction set. The including file defines SQUID_KERNEL_VARIANT, the namespace
+// and InstructionSet enumerator of the variant, and is compiled with the matching -m flags.
+//
+// Everything here must stay in the variant namespace: an inline function or template shared with other translation
+// units, std::complex arithmetic included, would be emitted as a weak symbol compiled for this instruction set, and
+// the linker may pick it for callers on CPUs that lack it. Complex numbers are therefore handled as pairs of reals,
+// which std::complex guarantees is their layout, and only C math functions are called.
+
+#include "../../include/Kernels.h"
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifndef SQUID_KERNEL_VARIANT
+#error "Define SQUID_KERNEL_VARIANT before including Kernels.tpp"
+#endif
+
+namespace kernels::SQUID_KERNEL_VARIANT {
+    namespace {
+        typedef std::complex<double> complex;
+
+        /**
+         * @brief Number of links the solver kernels process at a time along a column; bounds their stack buffers.
+         */
+        constexpr std::size_t linkChunk = 256;
+
+        template<typename real>
+        inline const real* pairs(const std::complex<real>* z) {
+            return reinterpret_cast<const real*>(z);
+        }
+
+        template<typename real>
+        inline real* pairs(std::complex<real>* z) {
+            return reinterpret_cast<real*>(z);
+        }
+
+        // Transcendentals in the storage precision: a float result is no more accurate than the float it is stored
+        // in, and the float functions are about twice as fast. The std:: float overloads are inline, hence ::
+        inline double arcTangent(double y, double x) {
+            return std::atan2(y, x);
+        }
+
+        inline float arcTangent(float y, float x) {
+            return ::atan2f(y, x);
+        }
+
+        inline double cosine(double angle) {
+            return std::cos(angle);
+        }
+
+        inline float cosine(float angle) {
+            return ::cosf(angle);
+        }
+
+        inline double sine(double angle) {
+            return std::sin(angle);
+        }
+
+        inline float sine(float angle) {
+            return ::sinf(angle);
+        }
+
+        template<typename T>
+        void fill(T* out, T value, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = value;
+            }
+        }
+
+        template<typename T>
+        void add(const T* a, const T* b, T* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = a[i] + b[i];
+            }
+        }
+
+        template<typename T>
+        void subtract(const T* a, const T* b, T* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = a[i] - b[i];
+            }
+        }
+
+        template<typename T>
+        void multiply(const T* a, const T* b, T* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = a[i] * b[i];
+            }
+        }
+
+        template<typename T>
+        void addScalar(const T* a, T value, T* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = a[i] + value;
+            }
+        }
+
+        template<typename T>
+        void subtractScalar(const T* a, T value, T* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = a[i] - value;
+            }
+        }
+
+        template<typename T>
+        void multiplyScalar(const T* a, T value, T* out, std::size_t n) {
+            for (std::size_t i = 0; i < n; i++) {
+                out[i] = a[i] * value;
+            }
+        }
+
+        // The masked kernels take the mask a word of 64 elements at a time. Words of a geometry mask are mostly all
+        // set or all clear, those are a plain loop or skipped; the others select per element, which vectorizes as a
+        // blend. Bits beyond n are 0, so a full word is always 64 elements.
+
+        template<typename T>
+        void fillMasked(T* out, const std::uint64_t* mask, T value, std::size_t n) {
+            for (std::size_t base = 0; base < n; base += 64) {
+                const std::uint64_t word = mask[base / 64];
+                const std::size_t m = n - base < 64 ? n - base : 64;
+                T* o = out + base;
+                if (word == ~std::uint64_t(0)) {
+                    for (std::size_t k = 0; k < 64; k++) {
+                        o[k] = value;
+                    }
+                } else if (word != 0) {
+                    for (std::size_t k = 0; k < m; k++) {
+                        o[k] = (word >> k) & 1u ? value : o[k];
+                    }
+                }
+            }
+        }
+
+        template<typename T>
+        void copyMasked(const T* a, const std::uint64_t* mask, T* out, std::size_t n) {
+            for (std::size_t base = 0; base < n; base += 64) {
+                const std::uint64_t word = mask[base / 64];
+                const std::size_t m = n - base < 64 ? n - base : 64;
+                const T* pa = a + base;
+                T* o = out + base;
+                if (word == ~std::uint64_t(0)) {
+                    for (std::size_t k = 0; k < 64; k++) {
+                        o[k] = pa[k];
+                    }
+                } else if (word != 0) {
+                    for (std::size_t k = 0; k < m; k++) {
+                        o[k] = (word >> k) & 1u ? pa[k] : o[k];
+                    }
+                }
+            }
+        }
+
+        template<typename T>
+        void multiplyScalarMasked(T* out, const std::uint64_t* mask, T value, std::size_t n) {
+            for (std::size_t base = 0; base < n; base += 64) {
+                const std::uint64_t word = mask[base / 64];
+                const std::size_t m = n - base < 64 ? n - base : 64;
+                T* o = out + base;
+                if (word == ~std::uint64_t(0)) {
+                    for (std::size_t k = 0; k < 64; k++) {
+                        o[k] *= value;
+                    }
+                } else if (word != 0) {
+                    for (std::size_t k = 0; k < m; k++) {
+                        o[k] = (word >> k) & 1u ? o[k] * value : o[k];
+                    }
+                }
+            }
+        }
+
+        // Complex addition and subtraction are element-wise on the pairs; these reuse the real kernels on 2n doubles.
+
+        void fillComplex(complex* out, complex value, std::size_t n) {
+            const double* v = pairs(&value);
+            const double re = v[0];
+            const double im = v[1];
+            double* o = pairs(out);
+            for (std::size_t i = 0; i < n; i++) {
+                o[2 * i] = re;
+                o[2 * i + 1] = im;
+            }
+        }
+
+        void addComplex(const complex* a, const complex* b, complex* out, std::size_t n) {
+            add<double>(pairs(a), pairs(b), pairs(out), 2 * n);
+        }
+
+        void subtractComplex(const complex* a, const complex* b, complex* out, std::size_t n) {
+            subtract<double>(pairs(a), pairs(b), pairs(out), 2 * n);
+        }
+
+        void multiplyComplex(const complex* a, const complex* b, complex* out, std::size_t n) {
+            const double* pa = pairs(a);
+            const double* pb = pairs(b);
+            double* o = pairs(out);
+            for (std::size_t i = 0; i < n; i++) {
+                const double ar = pa[2 * i];
+                const double ai = pa[2 * i + 1];
+                const double br = pb[2 * i];
+                const double bi = pb[2 * i + 1];
+                o[2 * i] = ar * br - ai * bi;
+                o[2 * i + 1] = ar * bi + ai * br;
+            }
+        }
+
+        void addComplexScalar(const complex* a, complex value, complex* out, std::size_t n) {
+            const double* v = pairs(&value);
+            const double re = v[0];
+            const double im = v[1];
+            const double* pa = pairs(a);
+            double* o = pairs(out);
+            for (std::size_t i = 0; i < n; i++) {
+                o[2 * i] = pa[2 * i] + re;
+                o[2 * i + 1] = pa[2 * i + 1] + im;
+            }
+        }
+
+        void subtractComplexScalar(const complex* a, complex value, complex* out, std::size_t n) {
+            const double* v = pairs(&value);
+            const double re = v[0];
+            const double im = v[1];
+            const double* pa = pairs(a);
+            double* o = pairs(out);
+            for (std::size_t i = 0; i < n; i++) {
+                o[2 * i] = pa[2 * i] - re;
+                o[2 * i + 1] = pa[2 * i + 1] - im;
+            }
+        }
+
+        void multiplyComplexScalar(const complex* a, complex value, complex* out, std::size_t n) {
+            const double* v = pairs(&value);
+            const double re = v[0];
+            const double im = v[1];
+            const double* pa = pairs(a);
+            double* o = pairs(out);
+            for (std::size_t i = 0; i < n; i++) {
+                const double ar = pa[2 * i];
+                const double ai = pa[2 * i + 1];
+                o[2 * i] = ar * re - ai * im;
+                o[2 * i + 1] = ar * im + ai * re;
+            }
+        }
+
+        void fillComplexMasked(complex* out, const std::uint64_t* mask, complex value, std::size_t n) {
+            const double* v = pairs(&value);
+            const double re = v[0];
+            const double im = v[1];
+            double* o = pairs(out);
+            for (std::size_t base = 0; base < n; base += 64) {
+                const std::uint64_t word = mask[base / 64];
+                const std::size_t m = n - base < 64 ? n - base : 64;
+                double* ob = o + 2 * base;
+                if (word == ~std::uint64_t(0)) {
+                    for (std::size_t k = 0; k < 64; k++) {
+                        ob[2 * k] = re;
+                        ob[2 * k + 1] = im;
+                    }
+                } else if (word != 0) {
+                    for (std::size_t k = 0; k < m; k++) {
+                        const bool set = (word >> k) & 1u;
+                        ob[2 * k] = set ? re : ob[2 * k];
+                        ob[2 * k + 1] = set ? im : ob[2 * k + 1];
+                    }
+                }
+            }
+        }
+
+        void copyComplexMasked(const complex* a, const std::uint64_t* mask, complex* out, std::size_t n) {
+            const double* pa = pairs(a);
+            double* o = pairs(out);
+            for (std::size_t base = 0; base < n; base += 64) {
+                const std::uint64_t word = mask[base / 64];
+                const std::size_t m = n - base < 64 ? n - base : 64;
+                const double* ab = pa + 2 * base;
+                double* ob = o + 2 * base;
+                if (word == ~std::uint64_t(0)) {
+                    for (std::size_t k = 0; k < 128; k++) {
+                        ob[k] = ab[k];
+                    }
+                } else if (word != 0) {
+                    for (std::size_t k = 0; k < m; k++) {
+                        const bool set = (word >> k) & 1u;
+                        ob[2 * k] = set ? ab[2 * k] : ob[2 * k];
+                        ob[2 * k + 1] = set ? ab[2 * k + 1] : ob[2 * k + 1];
+                    }
+                }
+            }
+        }
+
+        void multiplyComplexScalarMasked(complex* out, const std::uint64_t* mask, complex value, std::size_t n) {
+            const double* v = pairs(&value);
+            const double re = v[0];
+            const double im = v[1];
+            double* o = pairs(out);
+            for (std::size_t base = 0; base < n; base += 64) {
+                const std::uint64_t word = mask[base / 64];
+                const std::size_t m = n - base < 64 ? n - base : 64;
+                double* ob = o + 2 * base;
+                if (word == 0) {
+                    continue;
+                }
+                for (std::size_t k = 0; k < m; k++) {
+                    const bool set = (word >> k) & 1u;
+                    const double ar = ob[2 * k];
+                    const double ai = ob[2 * k + 1];
+                    ob[2 * k] = set ? ar * re - ai * im : ar;
+                    ob[2 * k + 1] = set ? ar * im + ai * re : ai;
+                }
+            }
+        }
+
+        void maskNot(const std::uint64_t* a, std::uint64_t* out, std::size_t n) {
+            const std::size_t words = (n + 63) / 64;
+            for (std::size_t i = 0; i < words; i++) {
+                out[i] = ~a[i];
+            }
+            if (n % 64 != 0) {
+                out[words - 1] &= (std::uint64_t(1) << (n % 64)) - 1;
+            }
+        }
+
+        void maskOr(const std::uint64_t* a, const std::uint64_t* b, std::uint64_t* out, std::size_t n) {
+            const std::size_t words = (n + 63) / 64;
+            for (std::size_t i = 0; i < words; i++) {
+                out[i] = a[i] | b[i];
+            }
+        }
+
+        // Reductions accumulate value i into lane i % reductionLanes, in order, and leave combining the lanes to the
+        // caller. The lanes are independent, so the vectorizer keeps them in registers without reassociating anything.
+
+        void reduceSum(const double* a, std::size_t n, double* lanes) {
+            double lane[reductionLanes] = {};
+            std::size_t i = 0;
+            for (; i + reductionLanes <= n; i += reductionLanes) {
+                for (std::size_t j = 0; j < reductionLanes; j++) {
+                    lane[j] += a[i + j];
+                }
+            }
+            for (std::size_t j = 0; i + j < n; j++) {
+                lane[j] += a[i + j];
+            }
+            for (std::size_t j = 0; j < reductionLanes; j++) {
+                lanes[j] = lane[j];
+            }
+        }
+
+        void reduceDot(const double* a, const double* b, std::size_t n, double* lanes) {
+            double lane[reductionLanes] = {};
+            std::size_t i = 0;
+            for (; i + reductionLanes <= n; i += reductionLanes) {
+                for (std::size_t j = 0; j < reductionLanes; j++) {
+                    lane[j] += a[i + j] * b[i + j];
+                }
+            }
+            for (std::size_t j = 0; i + j < n; j++) {
+                lane[j] += a[i + j] * b[i + j];
+            }
+            for (std::size_t j = 0; j < reductionLanes; j++) {
+                lanes[j] = lane[j];
+            }
+        }
+
+        void reduceCrossDot(const double* a, const double* b, std::size_t n, double* lanes) {
+            double lane[reductionLanes] = {};
+            std::size_t i = 0;
+            for (; i + reductionLanes <= n; i += reductionLanes) {
+                for (std::size_t j = 0; j < reductionLanes; j++) {
+                    lane[j] += a[i + j] * b[i + (j ^ 1)];
+                }
+            }
+            for (std::size_t j = 0; i + j < n; j++) {
+                lane[j] += a[i + j] * b[i + (j ^ 1)];
+            }
+            for (std::size_t j = 0; j < reductionLanes; j++) {
+                lanes[j] = lane[j];
+            }
+        }
+
+        /**
+         * @brief Sums the values, or their squares, of the n elements from element first on whose bit in the mask is
+         * set. An element is width values; first is a multiple of 64, so that every mask word covers 64 elements.
+         */
+        template<std::size_t width, bool squares>
+        void reduceMasked(const double* a, const std::uint64_t* mask, std::size_t first, std::size_t n,
+                          double* lanes) {
+            double lane[reductionLanes] = {};
+            const std::uint64_t* words = mask + first / 64;
+            const std::size_t full = n / 64;
+            for (std::size_t w = 0; w < full; w++) {
+                // Geometry masks are mostly whole words in or out of the region
+                const std::uint64_t word = words[w];
+                const double* values = a + w * 64 * width;
+                if (word == 0) {
+                    continue;
+                }
+                if (word == ~std::uint64_t(0)) {
+                    for (std::size_t i = 0; i < 64 * width; i += reductionLanes) {
+                        for (std::size_t j = 0; j < reductionLanes; j++) {
+                            lane[j] += squares ? values[i + j] * values[i + j] : values[i + j];
+                        }
+                    }
+                    continue;
+                }
+                for (std::size_t i = 0; i < 64 * width; i += reductionLanes) {
+                    for (std::size_t j = 0; j < reductionLanes; j++) {
+                        const double value = squares ? values[i + j] * values[i + j] : values[i + j];
+                        lane[j] += (word >> ((i + j) / width)) & 1 ? value : 0.0;
+                    }
+                }
+            }
+            for (std::size_t i = full * 64 * width; i < n * width; i++) {
+                const std::size_t element = i / width;
+                const double value = squares ? a[i] * a[i] : a[i];
+                lane[i % reductionLanes] += (words[element / 64] >> (element % 64)) & 1 ? value : 0.0;
+            }
+            for (std::size_t j = 0; j < reductionLanes; j++) {
+                lanes[j] = lane[j];
+            }
+        }
+
+        double reduceMaxAbs(const double* a, std::size_t n) {
+            double lane[reductionLanes] = {};
+            std::size_t i = 0;
+            for (; i + reductionLanes <= n; i += reductionLanes) {
+                for (std::size_t j = 0; j < reductionLanes; j++) {
+                    const double value = ::fabs(a[i + j]);
+                    lane[j] = value > lane[j] ? value : lane[j];
+                }
+            }
+            for (std::size_t j = 0; i + j < n; j++) {
+                const double value = ::fabs(a[i + j]);
+                lane[j] = value > lane[j] ? value : lane[j];
+            }
+            double result = 0.0;
+            for (double value : lane) {
+                result = value > result ? value : result;
+            }
+            return result;
+        }
+
+        double reduceMaxNorm(const double* a, std::size_t n) {
+            double lane[reductionLanes] = {};
+            std::size_t i = 0;
+            for (; i + reductionLanes <= n; i += reductionLanes) {
+                for (std::size_t j = 0; j < reductionLanes; j++) {
+                    const double value = a[2 * (i + j)] * a[2 * (i + j)] + a[2 * (i + j) + 1] * a[2 * (i + j) + 1];
+                    lane[j] = value > lane[j] ? value : lane[j];
+                }
+            }
+            for (std::size_t j = 0; i + j < n; j++) {
+                const double value = a[2 * (i + j)] * a[2 * (i + j)] + a[2 * (i + j) + 1] * a[2 * (i + j) + 1];
+                lane[j] = value > lane[j] ? value : lane[j];
+            }
+            double result = 0.0;
+            for (double value : lane) {
+                result = value > result ? value : result;
+            }
+            return result;
+        }
+
+        std::uint64_t popcount(const std::uint64_t* words, std::size_t n) {
+            std::uint64_t count = 0;
+            for (std::size_t i = 0; i < n; i++) {
+                count += static_cast<std::uint64_t>(__builtin_popcountll(words[i]));
+            }
+            return count;
+        }
+
+        // The solver kernels load every stored value into a double before using it, so that single precision
+        // storage still computes in double precision and only rounds when storing.
+
+        /**
+         * @brief Writes the phasors of n phase links as pairs of doubles, reconstructed as Phase::phasor does. A loop
+         * of its own, so that the table lookups become vector gathers.
+         */
+        inline void phasors(const Phase* __restrict links, double* __restrict out, std::size_t n) {
+            constexpr int shift = 32 - Phase::tableBits;
+            const double* __restrict table = Phase::table();
+            for (std::size_t k = 0; k < n; k++) {
+                const std::uint32_t phase = links[k].value;
+                const std::size_t entry = 2 * (phase >> shift);
+                // The remainder fits in a signed integer, whose conversion vectorizes on every instruction set
+                const auto remainder = static_cast<std::int32_t>(phase & ((std::uint32_t(1) << shift) - 1));
+                const double delta = static_cast<double>(remainder) * Phase::radiansPerUnit;
+                const double delta2 = delta * delta;
+                const double c = 1.0 - delta2 * (0.5 - delta2 * (1.0 / 24.0 - delta2 * (1.0 / 720.0)));
+                const double s = delta * (1.0 - delta2 * (1.0 / 6.0 - delta2 * (1.0 / 120.0)));
+                out[2 * k] = table[entry] * c - table[entry + 1] * s;
+                out[2 * k + 1] = table[entry + 1] * c + table[entry] * s;
+            }
+        }
+
+        /**
+         * @brief Accesses links k to k + n - 1 as pairs of reals. Complex links are read in place, phase links are
+         * reconstructed into the buffer of 2 n doubles.
+         */
+        template<typename real>
+        inline const real* linkPairs(const std::complex<real>* links, std::size_t k, std::size_t, double*) {
+            return pairs(links + k);
+        }
+
+        inline const double* linkPairs(const Phase* links, std::size_t k, std::size_t n, double* buffer) {
+            phasors(links + k, buffer, n);
+            return buffer;
+        }
+
+        template<typename real>
+        void fluxCells(const SolverArguments<real>& arguments) {
+            const real* __restrict ux = pairs(arguments.linkingVariableX);
+            const real* __restrict uy = pairs(arguments.linkingVariableY);
+            real* __restrict flux = pairs(arguments.fluxCellPhasor);
+            real* __restrict b = arguments.magneticField;
+            const std::size_t H = arguments.height;
+            const double inverseArea = 1.0 / (arguments.gridSpacing * arguments.gridSpacing);
+            const auto W = static_cast<long>(arguments.width);
+
+            // The plaquette phasor is exp(-i h^2 B), the product of the linking variables around the cell. The
+            // products of a column vectorize; its angles are taken in a second pass while the column is in cache.
+#pragma omp parallel for
+            for (long x = 0; x < W - 1; x++) {
+                const real* east = uy + 2 * (x + 1) * (H - 1);
+                const real* west = uy + 2 * x * (H - 1);
+                const real* south = ux + 2 * x * H;
+                real* cell = flux + 2 * x * (H - 1);
+                for (std::size_t y = 0; y + 1 < H; y++) {
+                    const double sr = south[2 * y];
+                    const double si = south[2 * y + 1];
+                    const double er = east[2 * y];
+                    const double ei = east[2 * y + 1];
+                    // ux(x, y) * uy(x + 1, y)
+                    const double ar = sr * er - si * ei;
+                    const double ai = sr * ei + si * er;
+                    // ... * conj(ux(x, y + 1))
+                    const double nr = south[2 * y + 2];
+                    const double ni = -static_cast<double>(south[2 * y + 3]);
+                    const double br = ar * nr - ai * ni;
+                    const double bi = ar * ni + ai * nr;
+                    // ... * conj(uy(x, y))
+                    const double wr = west[2 * y];
+                    const double wi = -static_cast<double>(west[2 * y + 1]);
+                    cell[2 * y] = static_cast<real>(br * wr - bi * wi);
+                    cell[2 * y + 1] = static_cast<real>(br * wi + bi * wr);
+                }
+                real* field = b + x * (H - 1);
+                for (std::size_t y = 0; y + 1 < H; y++) {
+                    const double phase = arcTangent(cell[2 * y + 1], cell[2 * y]);
+                    field[y] = static_cast<real>(-phase * inverseArea);
+                }
+            }
+        }
+
+        template<typename real>
+        void fluxCells(const SolverArguments<real, Phase>& arguments) {
+            const Phase* __restrict ux = arguments.linkingVariableX;
+            const Phase* __restrict uy = arguments.linkingVariableY;
+            Phase* __restrict flux = arguments.fluxCellPhasor;
+            real* __restrict b = arguments.magneticField;
+            const std::size_t H = arguments.height;
+            const double inverseArea = 1.0 / (arguments.gridSpacing * arguments.gridSpacing);
+            const auto W = static_cast<long>(arguments.width);
+
+            // With phases the product around the plaquette is a sum that wraps modulo one turn, and its principal
+            // angle is the sum read as a signed integer: no arctangent needed.
+#pragma omp parallel for
+            for (long x = 0; x < W - 1; x++) {
+                const Phase* east = uy + (x + 1) * (H - 1);
+                const Phase* west = uy + x * (H - 1);
+                const Phase* south = ux + x * H;
+                Phase* cell = flux + x * (H - 1);
+                real* field = b + x * (H - 1);
+                for (std::size_t y = 0; y + 1 < H; y++) {
+                    const std::uint32_t phase = south[y].value + east[y].value - south[y + 1].value - west[y].value;
+                    cell[y].value = phase;
+                    const double angle = static_cast<double>(static_cast<std::int32_t>(phase)) * Phase::radiansPerUnit;
+                    field[y] = static_cast<real>(-angle * inverseArea);
+                }
+            }
+        }
+
+        /**
+         * @brief One step of psi on rows y0 to y1 - 1 of column x, with 1 <= y0 and y1 <= height - 1. The columns of
+         * psi to the west, on and to the east of it are passed from row y0 - 1 on, the next column from row y0 on,
+         * so that they can come from any buffer: the full grid, or the ring of columns of a time-skewed tile. The
+         * arithmetic only depends on the values, not on where they are stored.
+         */
+        template<typename real, typename link>
+        inline void orderParameterColumn(const SolverArguments<real, link>& arguments, std::size_t x,
+                                         std::size_t y0, std::size_t y1, const real* __restrict westColumn,
+                                         const real* __restrict centreColumn, const real* __restrict eastColumn,
+                                         real* __restrict nextColumn) {
+            const link* __restrict ux = arguments.linkingVariableX;
+            const link* __restrict uy = arguments.linkingVariableY;
+            const real* __restrict cw = arguments.cellWeight;
+            const real* __restrict wx = arguments.linkWeightX;
+            const real* __restrict wy = arguments.linkWeightY;
+            const std::size_t H = arguments.height;
+            const double dt = arguments.timeStep;
+            const double inverseArea = 1.0 / (arguments.gridSpacing * arguments.gridSpacing);
+
+            double eastBuffer[2 * linkChunk];
+            double westBuffer[2 * linkChunk];
+            double verticalBuffer[2 * (linkChunk + 1)];
+            for (std::size_t c0 = y0; c0 < y1; c0 += linkChunk) {
+                const std::size_t n = y1 - c0 < linkChunk ? y1 - c0 : linkChunk;
+                const auto* __restrict east = linkPairs(ux, x * H + c0, n, eastBuffer);
+                const auto* __restrict west = linkPairs(ux, (x - 1) * H + c0, n, westBuffer);
+                // uy(x, y - 1) and uy(x, y) are entries k and k + 1
+                const auto* __restrict vertical = linkPairs(uy, x * (H - 1) + c0 - 1, n + 1, verticalBuffer);
+                // Row c0 + k is entry r + 1 of the columns of psi, entry r of the next column
+                const std::size_t offset = c0 - y0;
+                const real* __restrict psi = centreColumn + 2 * offset;
+                const real* __restrict psiEast = eastColumn + 2 * offset;
+                const real* __restrict psiWest = westColumn + 2 * offset;
+                real* __restrict next = nextColumn + 2 * offset;
+                for (std::size_t k = 0; k < n; k++) {
+                    const std::size_t i = x * H + c0 + k;
+                    const std::size_t j = x * (H - 1) + c0 + k;
+                    const std::size_t r = k + 1;
+                    const double pr = psi[2 * r];
+                    const double pi = psi[2 * r + 1];
+                    const double eastR = psiEast[2 * r], eastI = psiEast[2 * r + 1];
+                    const double westR = psiWest[2 * r], westI = psiWest[2 * r + 1];
+                    const double northR = psi[2 * r + 2], northI = psi[2 * r + 3];
+                    const double southR = psi[2 * r - 2], southI = psi[2 * r - 1];
+                    const double uer = east[2 * k], uei = east[2 * k + 1];
+                    const double uwr = west[2 * k], uwi = west[2 * k + 1];
+                    const double unr = vertical[2 * k + 2], uni = vertical[2 * k + 3];
+                    const double usr = vertical[2 * k], usi = vertical[2 * k + 1];
+
+                    // ux(x, y) * psi(x + 1, y) - psi
+                    const double er = uer * eastR - uei * eastI - pr;
+                    const double ei = uer * eastI + uei * eastR - pi;
+                    // conj(ux(x - 1, y)) * psi(x - 1, y) - psi
+                    const double wr = uwr * westR + uwi * westI - pr;
+                    const double wi = uwr * westI - uwi * westR - pi;
+                    // uy(x, y) * psi(x, y + 1) - psi
+                    const double nr = unr * northR - uni * northI - pr;
+                    const double ni = unr * northI + uni * northR - pi;
+                    // conj(uy(x, y - 1)) * psi(x, y - 1) - psi
+                    const double sr = usr * southR + usi * southI - pr;
+                    const double si = usr * southI - usi * southR - pi;
+
+                    const double kr = static_cast<double>(wx[i]) * er + static_cast<double>(wx[i - H]) * wr
+                                      + static_cast<double>(wy[j]) * nr + static_cast<double>(wy[j - 1]) * sr;
+                    const double ki = static_cast<double>(wx[i]) * ei + static_cast<double>(wx[i - H]) * wi
+                                      + static_cast<double>(wy[j]) * ni + static_cast<double>(wy[j - 1]) * si;
+                    const double gain = 1.0 - (pr * pr + pi * pi);
+                    const double weight = cw[i];
+                    next[2 * k] = static_cast<real>(weight * (pr + dt * (inverseArea * kr + gain * pr)));
+                    next[2 * k + 1] = static_cast<real>(weight * (pi + dt * (inverseArea * ki + gain * pi)));
+                }
+            }
+        }
+
+        template<typename real, typename link>
+        void orderParameter(const SolverArguments<real, link>& arguments) {
+            const real* psi = pairs(arguments.orderParameter);
+            real* next = pairs(arguments.nextOrderParameter);
+            const std::size_t H = arguments.height;
+            const auto W = static_cast<long>(arguments.width);
+
+            // The superconductor never touches the edge of the grid, so the edge points stay 0 and need no special
+            // casing. Bonds leaving the superconductor carry weight 0, which imposes the no-current boundary condition.
+#pragma omp parallel for
+            for (long x = 1; x < W - 1; x++) {
+                orderParameterColumn(arguments, x, 1, H - 1, psi + 2 * (x - 1) * H, psi + 2 * x * H,
+                                     psi + 2 * (x + 1) * H, next + 2 * (x * H + 1));
+            }
+        }
+
+        /**
+         * @brief Steps of psi by overlapped time-skewed tiles. Each tile of the grid is swept column by column from
+         * west to east; at every column of the sweep, step s of the tile is taken one column behind step s - 1, on
+         * the columns of step s - 1 still in a ring of three. Every step covers the tile and a margin of one column
+         * and row for each step still to come, which the steps of the neighbouring tiles take as well: the tiles do not
+         * depend on each other, and the points of every step are computed by the same arithmetic as in
+         * orderParameter(), so the result does not depend on the tiling.
+         */
+        template<typename real, typename link>
+        void orderParameterSteps(const SolverArguments<real, link>& arguments, const TemporalTiling<real>& tiling) {
+            const real* psi = pairs(arguments.orderParameter);
+            real* out = pairs(arguments.nextOrderParameter);
+            const auto W = static_cast<long>(arguments.width);
+            const auto H = static_cast<long>(arguments.height);
+            const long steps = tiling.steps;
+            const auto tileWidth = static_cast<long>(tiling.tileWidth);
+            const auto tileHeight = static_cast<long>(tiling.tileHeight);
+            const long columns = (W - 2 + tileWidth - 1) / tileWidth;
+            const long rows = (H - 2 + tileHeight - 1) / tileHeight;
+            const long window = tileHeight + 2 * (steps - 1);
+            const long ringSize = 2 * 3 * (steps - 1) * window;
+
+#pragma omp parallel for schedule(static)
+            for (long t = 0; t < columns * rows; t++) {
+                const long a = 1 + (t / rows) * tileWidth;
+                const long b = a + tileWidth < W - 1 ? a + tileWidth : W - 1;
+                const long c = 1 + (t % rows) * tileHeight;
+                const long d = c + tileHeight < H - 1 ? c + tileHeight : H - 1;
+                // The rows of the ring, those of the first step and the edge rows it reads
+                const long low = c - (steps - 1) > 0 ? c - (steps - 1) : 0;
+                const long high = d + (steps - 1) < H ? d + (steps - 1) : H;
+#ifdef _OPENMP
+                real* ring = pairs(tiling.scratch) + ringSize * omp_get_thread_num();
+#else
+                real* ring = pairs(tiling.scratch);
+#endif
+                auto slot = [&](long step, long x) {
+                    return ring + 2 * ((step - 1) * 3 + x % 3) * window;
+                };
+                // The edge rows of the grid stay 0 at every step
+                for (long step = 1; step < steps; step++) {
+                    for (long x = 0; x < 3; x++) {
+                        real* column = slot(step, x);
+                        if (low == 0) {
+                            column[0] = column[1] = 0;
+                        }
+                        if (high == H) {
+                            column[2 * (H - 1 - low)] = column[2 * (H - 1 - low) + 1] = 0;
+                        }
+                    }
+                }
+                // Column x of a step from row y on; the edge columns are 0 at every step, as in psi
+                auto source = [&](long step, long x, long y) -> const real* {
+                    if (step == 0 || x == 0 || x == W - 1) {
+                        return psi + 2 * (x * H + y);
+                    }
+                    return slot(step, x) + 2 * (y - low);
+                };
+
+                for (long sweep = a - (steps - 1); sweep < b + steps - 1; sweep++) {
+                    for (long step = 1; step <= steps; step++) {
+                        const long x = sweep - (step - 1);
+                        const long margin = steps - step;
+                        const long x0 = a - margin > 1 ? a - margin : 1;
+                        const long x1 = b + margin < W - 1 ? b + margin : W - 1;
+                        if (x < x0 || x >= x1) {
+                            continue;
+                        }
+                        const long y0 = c - margin > 1 ? c - margin : 1;
+                        const long y1 = d + margin < H - 1 ? d + margin : H - 1;
+                        real* next = step == steps ? out + 2 * (x * H + y0) : slot(step, x) + 2 * (y0 - low);
+                        orderParameterColumn(arguments, x, y0, y1, source(step - 1, x - 1, y0 - 1),
+                                             source(step - 1, x, y0 - 1), source(step - 1, x + 1, y0 - 1), next);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Philox4x32-10 (Salmon et al., SC'11): encrypts the counter in place under the key. Every output is a
+         * pure function of counter and key, which is what lets cells draw their noise in any order and on any thread.
+         */
+        inline void philox(std::uint32_t& c0, std::uint32_t& c1, std::uint32_t& c2, std::uint32_t& c3,
+                           std::uint32_t k0, std::uint32_t k1) {
+            for (int round = 0; round < 10; round++) {
+                const std::uint64_t p0 = std::uint64_t(0xD2511F53u) * c0;
+                const std::uint64_t p1 = std::uint64_t(0xCD9E8D57u) * c2;
+                const auto n0 = static_cast<std::uint32_t>(p1 >> 32) ^ c1 ^ k0;
+                const auto n2 = static_cast<std::uint32_t>(p0 >> 32) ^ c3 ^ k1;
+                c1 = static_cast<std::uint32_t>(p1);
+                c3 = static_cast<std::uint32_t>(p0);
+                c0 = n0;
+                c2 = n2;
+                k0 += 0x9E3779B9u;
+                k1 += 0xBB67AE85u;
+            }
+        }
+
+        /**
+         * @brief The natural logarithm of a positive normal double, from its exponent and the series of atanh on the
+         * mantissa, accurate to a few ulp. Unlike ::log it vectorizes, as long as it stays free of branches.
+         */
+        inline double logarithm(double u) {
+            std::uint64_t bits;
+            __builtin_memcpy(&bits, &u, sizeof(bits));
+            // Mantissa in [sqrt(1/2), sqrt(2)), where s = (m - 1) / (m + 1) stays below 0.172. Whether the fraction
+            // is at least that of sqrt(2) is the carry of an addition, which unlike a comparison needs no branch.
+            const std::uint64_t fraction = bits & 0x000FFFFFFFFFFFFFull;
+            const std::uint64_t large = (fraction + 0x00095F619980C433ull) >> 52;
+            // The exponent fits in a signed integer, whose conversion vectorizes on every instruction set
+            const auto exponent = static_cast<std::int32_t>(bits >> 52) - 1023 + static_cast<std::int32_t>(large);
+            bits = fraction | (0x3FFull - large) << 52;
+            double mantissa;
+            __builtin_memcpy(&mantissa, &bits, sizeof(mantissa));
+            const double s = (mantissa - 1.0) / (mantissa + 1.0);
+            const double z = s * s;
+            const double series = 1.0 + z * (1.0 / 3 + z * (1.0 / 5 + z * (1.0 / 7 + z * (1.0 / 9 + z * (1.0 / 11
+                                  + z * (1.0 / 13 + z * (1.0 / 15 + z * (1.0 / 17 + z * (1.0 / 19 + z / 21)))))))));
+            return static_cast<double>(exponent) * 0.6931471805599453 + 2.0 * s * series;
+        }
+
+        /**
+         * @brief Adds the Langevin noise of a step to the order parameter of the next one, see SolverArguments.
+         *
+         * The Philox counter of a cell is (its storage index, the step) and the key the seed. Its first two words set
+         * the Box-Muller radius, from a uniform variate in (0, 1]; its third word is the Box-Muller angle, in the
+         * units of Phase, so that the cosine and sine come from the phase table. Each stage is a loop of its own over
+         * a column chunk, so that all of them vectorize.
+         */
+        template<typename real, typename link>
+        void thermalNoise(const SolverArguments<real, link>& arguments) {
+            const real* __restrict cw = arguments.cellWeight;
+            real* __restrict next = pairs(arguments.nextOrderParameter);
+            const std::size_t H = arguments.height;
+            const double amplitude = arguments.noiseAmplitude;
+            const auto k0 = static_cast<std::uint32_t>(arguments.seed);
+            const auto k1 = static_cast<std::uint32_t>(arguments.seed >> 32);
+            const auto s0 = static_cast<std::uint32_t>(arguments.step);
+            const auto s1 = static_cast<std::uint32_t>(arguments.step >> 32);
+            const auto W = static_cast<long>(arguments.width);
+
+#pragma omp parallel for
+            for (long x = 1; x < W - 1; x++) {
+                double radius[linkChunk];
+                Phase angle[linkChunk];
+                double phasor[2 * linkChunk];
+                for (std::size_t y0 = 1; y0 + 1 < H; y0 += linkChunk) {
+                    const std::size_t n = H - 1 - y0 < linkChunk ? H - 1 - y0 : linkChunk;
+                    for (std::size_t k = 0; k < n; k++) {
+                        const std::uint64_t cell = x * H + y0 + k;
+                        std::uint32_t c0 = static_cast<std::uint32_t>(cell);
+                        std::uint32_t c1 = static_cast<std::uint32_t>(cell >> 32);
+                        std::uint32_t c2 = s0;
+                        std::uint32_t c3 = s1;
+                        philox(c0, c1, c2, c3, k0, k1);
+                        // 52 random bits as the mantissa of a double in [1, 2), 2 minus which is in (0, 1]
+                        const std::uint64_t bits = (std::uint64_t(c0) << 20 ^ c1 >> 12) | 0x3FF0000000000000ull;
+                        double uniform;
+                        __builtin_memcpy(&uniform, &bits, sizeof(uniform));
+                        radius[k] = amplitude * std::sqrt(-2.0 * logarithm(2.0 - uniform));
+                        angle[k].value = c2;
+                    }
+                    phasors(angle, phasor, n);
+                    for (std::size_t k = 0; k < n; k++) {
+                        const std::size_t i = x * H + y0 + k;
+                        const double weight = static_cast<double>(cw[i]) * radius[k];
+                        next[2 * i] = static_cast<real>(next[2 * i] + weight * phasor[2 * k]);
+                        next[2 * i + 1] = static_cast<real>(next[2 * i + 1] + weight * phasor[2 * k + 1]);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Writes the supercurrent leaving every grid point times the grid spacing, see SolverKernels. Over a bond
+         * from i to j with effective link v, the one to j or the conjugate of the one from j, it is Im(conj(psi_i) v
+         * psi_j).
+         */
+        template<typename real, typename link>
+        void supercurrentDivergence(const SolverArguments<real, link>& arguments, double* divergence) {
+            const real* __restrict psi = pairs(arguments.orderParameter);
+            const link* __restrict ux = arguments.linkingVariableX;
+            const link* __restrict uy = arguments.linkingVariableY;
+            const real* __restrict wx = arguments.linkWeightX;
+            const real* __restrict wy = arguments.linkWeightY;
+            double* __restrict out = divergence;
+            const std::size_t H = arguments.height;
+            const auto W = static_cast<long>(arguments.width);
+
+#pragma omp parallel for
+            for (long x = 0; x < W; x++) {
+                out[x * H] = 0.0;
+                out[x * H + H - 1] = 0.0;
+                if (x == 0 || x == W - 1) {
+                    for (std::size_t y = 1; y + 1 < H; y++) {
+                        out[x * H + y] = 0.0;
+                    }
+                    continue;
+                }
+                double eastBuffer[2 * linkChunk];
+                double westBuffer[2 * linkChunk];
+                double verticalBuffer[2 * (linkChunk + 1)];
+                for (std::size_t y0 = 1; y0 + 1 < H; y0 += linkChunk) {
+                    const std::size_t n = H - 1 - y0 < linkChunk ? H - 1 - y0 : linkChunk;
+                    const auto* __restrict east = linkPairs(ux, x * H + y0, n, eastBuffer);
+                    const auto* __restrict west = linkPairs(ux, (x - 1) * H + y0, n, westBuffer);
+                    const auto* __restrict vertical = linkPairs(uy, x * (H - 1) + y0 - 1, n + 1, verticalBuffer);
+                    for (std::size_t k = 0; k < n; k++) {
+                        const std::size_t i = x * H + y0 + k;
+                        const std::size_t j = x * (H - 1) + y0 + k;
+                        const double pr = psi[2 * i];
+                        const double pi = psi[2 * i + 1];
+                        const double eastR = psi[2 * (i + H)], eastI = psi[2 * (i + H) + 1];
+                        const double westR = psi[2 * (i - H)], westI = psi[2 * (i - H) + 1];
+                        const double northR = psi[2 * (i + 1)], northI = psi[2 * (i + 1) + 1];
+                        const double southR = psi[2 * (i - 1)], southI = psi[2 * (i - 1) + 1];
+                        const double uer = east[2 * k], uei = east[2 * k + 1];
+                        const double uwr = west[2 * k], uwi = west[2 * k + 1];
+                        const double unr = vertical[2 * k + 2], uni = vertical[2 * k + 3];
+                        const double usr = vertical[2 * k], usi = vertical[2 * k + 1];
+
+                        // ux(x, y) * psi(x + 1, y), conj(ux(x - 1, y)) * psi(x - 1, y) and likewise along y
+                        const double er = uer * eastR - uei * eastI, ei = uer * eastI + uei * eastR;
+                        const double wr = uwr * westR + uwi * westI, wi = uwr * westI - uwi * westR;
+                        const double nr = unr * northR - uni * northI, ni = unr * northI + uni * northR;
+                        const double sr = usr * southR + usi * southI, si = usr * southI - usi * southR;
+
+                        // Im(conj(psi) z) = pr zi - pi zr
+                        out[i] = static_cast<double>(wx[i]) * (pr * ei - pi * er)
+                                 + static_cast<double>(wx[i - H]) * (pr * wi - pi * wr)
+                                 + static_cast<double>(wy[j]) * (pr * ni - pi * nr)
+                                 + static_cast<double>(wy[j - 1]) * (pr * si - pi * sr);
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief Rotates the next order parameter by exp(-i phi dt), see SolverKernels.
+         */
+        template<typename real, typename link>
+        void scalarPotential(const SolverArguments<real, link>& arguments, const double* potential) {
+            real* __restrict next = pairs(arguments.nextOrderParameter);
+            const double* __restrict phi = potential;
+            const std::size_t n = arguments.width * arguments.height;
+            const double dt = arguments.timeStep;
+
+#pragma omp parallel for
+            for (std::size_t i = 0; i < n; i++) {
+                const double angle = -dt * phi[i];
+                const double c = cosine(angle);
+                const double s = sine(angle);
+                const double re = next[2 * i];
+                const double im = next[2 * i + 1];
+                next[2 * i] = static_cast<real>(re * c - im * s);
+                next[2 * i + 1] = static_cast<real>(re * s + im * c);
+            }
+        }
+
+        /**
+         * @brief A red-black Gauss-Seidel sweep of one colour, see MultigridKernels.
+         */
+        inline void multigridSmooth(const MultigridArguments& arguments, int colour) {
+            const double* __restrict cx = arguments.conductanceX;
+            const double* __restrict cy = arguments.conductanceY;
+            const double* __restrict inverseDiagonal = arguments.inverseDiagonal;
+            const double* __restrict b = arguments.source;
+            double* __restrict phi = arguments.potential;
+            const std::size_t H = arguments.height;
+            const auto W = static_cast<long>(arguments.width);
+
+#pragma omp parallel for if(arguments.width * arguments.height >= multigridParallelPoints)
+            for (long x = 1; x < W - 1; x++) {
+                // The first y in the interior with (x + y) % 2 == colour
+                const std::size_t first = 1 + ((x + 1 + colour) & 1);
+                for (std::size_t y = first; y + 1 < H; y += 2) {
+                    const std::size_t i = x * H + y;
+                    const double sum = b[i] + cx[i] * phi[i + H] + cx[i - H] * phi[i - H] + cy[i] * phi[i + 1]
+                                       + cy[i - 1] * phi[i - 1];
+                    phi[i] = inverseDiagonal[i] * sum;
+                }
+            }
+        }
+
+        /**
+         * @brief The residual of the scalar potential, see MultigridKernels.
+         */
+        inline void multigridResidual(const MultigridArguments& arguments) {
+            const double* __restrict cx = arguments.conductanceX;
+            const double* __restrict cy = arguments.conductanceY;
+            const double* __restrict inverseDiagonal = arguments.inverseDiagonal;
+            const double* __restrict b = arguments.source;
+            const double* __restrict phi = arguments.potential;
+            double* __restrict r = arguments.residual;
+            const std::size_t H = arguments.height;
+            const auto W = static_cast<long>(arguments.width);
+
+#pragma omp parallel for if(arguments.width * arguments.height >= multigridParallelPoints)
+            for (long x = 0; x < W; x++) {
+                r[x * H] = 0.0;
+                r[x * H + H - 1] = 0.0;
+                if (x == 0 || x == W - 1) {
+                    for (std::size_t y = 1; y + 1 < H; y++) {
+                        r[x * H + y] = 0.0;
+                    }
+                    continue;
+                }
+                for (std::size_t y = 1; y + 1 < H; y++) {
+                    const std::size_t i = x * H + y;
+                    const double diagonal = cx[i] + cx[i - H] + cy[i] + cy[i - 1];
+                    const double flow = cx[i] * phi[i + H] + cx[i - H] * phi[i - H] + cy[i] * phi[i + 1]
+                                        + cy[i - 1] * phi[i - 1] - diagonal * phi[i];
+                    r[i] = inverseDiagonal[i] == 0.0 ? 0.0 : b[i] + flow;
+                }
+            }
+        }
+
+        /**
+         * @brief Rotates n links by exp(i angle). Split from the angle computation so that the latter vectorizes.
+         *
+         * In single precision the links are also scaled back to modulus 1. The angles of a step are small enough for
+         * cosf to round to exactly 1, so without it every rotation would lengthen the link by a factor 1 + angle^2/2.
+         */
+        template<typename real>
+        inline void rotate(std::complex<real>* __restrict links, const real* __restrict angle, std::size_t n) {
+            real* __restrict link = pairs(links);
+            for (std::size_t k = 0; k < n; k++) {
+                const double c = cosine(angle[k]);
+                const double s = sine(angle[k]);
+                const double re = link[2 * k];
+                const double im = link[2 * k + 1];
+                double rotatedRe = re * c - im * s;
+                double rotatedIm = re * s + im * c;
+                if constexpr (std::is_same_v<real, float>) {
+                    const double scale = 1.0 / std::sqrt(rotatedRe * rotatedRe + rotatedIm * rotatedIm);
+                    rotatedRe *= scale;
+                    rotatedIm *= scale;
+                }
+                link[2 * k] = static_cast<real>(rotatedRe);
+                link[2 * k + 1] = static_cast<real>(rotatedIm);
+            }
+        }
+
+        /**
+         * @brief Rotates n phase links by their angles, rounded to the nearest representable phase. Exact apart from
+         * that rounding, and free of transcendentals.
+         */
+        inline void rotate(Phase* __restrict links, const double* __restrict angle, std::size_t n) {
+            constexpr double unitsPerRadian = 1.0 / Phase::radiansPerUnit;
+            for (std::size_t k = 0; k < n; k++) {
+                // An angle of a step is far below a turn, the 64-bit conversion only guards against overflow
+                const double units = std::nearbyint(angle[k] * unitsPerRadian);
+                links[k].value += static_cast<std::uint32_t>(static_cast<std::int64_t>(units));
+            }
+        }
+
+        template<typename real, typename link>
+        void linkingVariables(const SolverArguments<real, link>& arguments) {
+            const real* __restrict psi = pairs(arguments.orderParameter);
+            link* __restrict ux = arguments.linkingVariableX;
+            link* __restrict uy = arguments.linkingVariableY;
+            const real* __restrict wx = arguments.linkWeightX;
+            const real* __restrict wy = arguments.linkWeightY;
+            const real* __restrict b = arguments.magneticField;
+            const std::size_t H = arguments.height;
+            const double h = arguments.gridSpacing;
+            const double dt = arguments.timeStep;
+            const double kappa2 = arguments.kappa * arguments.kappa;
+            const auto W = static_cast<long>(arguments.width);
+            // Angles are only rounded to the storage precision of complex links, phase links are rotated exactly
+            typedef std::conditional_t<std::is_same_v<link, Phase>, double, real> angle_type;
+
+            // The transport current I enters through Ampere's law on the outer edge: kappa^2 (B_top - B_bottom) = I.
+            // Along the left and right edges the field is interpolated linearly between the two.
+            const double fieldJump = arguments.appliedCurrent / kappa2;
+            const double fieldTop = arguments.appliedField + 0.5 * fieldJump;
+            const double fieldBottom = arguments.appliedField - 0.5 * fieldJump;
+
+            // dA/dt = Js - kappa^2 curl curl A, with curl curl A = (dB/dy, -dB/dx); the link is rotated by -h dA and
+            // Js = Im(conj(psi_i) U psi_j) / h.
+#pragma omp parallel for
+            for (long x = 0; x < W - 1; x++) {
+                angle_type angle[linkChunk];
+                double linkBuffer[2 * linkChunk];
+                for (std::size_t y0 = 0; y0 < H; y0 += linkChunk) {
+                    const std::size_t n = H - y0 < linkChunk ? H - y0 : linkChunk;
+                    const auto* __restrict u = linkPairs(ux, x * H + y0, n, linkBuffer);
+                    for (std::size_t k = 0; k < n; k++) {
+                        const std::size_t y = y0 + k;
+                        const std::size_t i = x * H + y;
+                        // Im(t q) with t = conj(p) u
+                        const double pr = psi[2 * i];
+                        const double pi = -static_cast<double>(psi[2 * i + 1]);
+                        const double ur = u[2 * k];
+                        const double ui = u[2 * k + 1];
+                        const double qr = psi[2 * (i + H)];
+                        const double qi = psi[2 * (i + H) + 1];
+                        const double tr = pr * ur - pi * ui;
+                        const double ti = pr * ui + pi * ur;
+                        const double supercurrent = static_cast<double>(wx[i]) * (tr * qi + ti * qr) / h;
+                        const double north = y + 1 < H ? static_cast<double>(b[x * (H - 1) + y]) : fieldTop;
+                        const double south = y > 0 ? static_cast<double>(b[x * (H - 1) + y - 1]) : fieldBottom;
+                        angle[k] = static_cast<angle_type>(-h * (dt * (supercurrent - kappa2 * (north - south) / h)));
+                    }
+                    rotate(ux + x * H + y0, angle, n);
+                }
+            }
+
+#pragma omp parallel for
+            for (long x = 0; x < W; x++) {
+                angle_type angle[linkChunk];
+                double linkBuffer[2 * linkChunk];
+                for (std::size_t y0 = 0; y0 + 1 < H; y0 += linkChunk) {
+                    const std::size_t n = H - 1 - y0 < linkChunk ? H - 1 - y0 : linkChunk;
+                    const auto* __restrict u = linkPairs(uy, x * (H - 1) + y0, n, linkBuffer);
+                    for (std::size_t k = 0; k < n; k++) {
+                        const std::size_t y = y0 + k;
+                        const std::size_t i = x * (H - 1) + y;
+                        const std::size_t p = x * H + y;
+                        const double edgeField = fieldBottom
+                                                 + fieldJump * (static_cast<double>(y) + 0.5)
+                                                   / static_cast<double>(H - 1);
+                        const double pr = psi[2 * p];
+                        const double pi = -static_cast<double>(psi[2 * p + 1]);
+                        const double ur = u[2 * k];
+                        const double ui = u[2 * k + 1];
+                        const double qr = psi[2 * (p + 1)];
+                        const double qi = psi[2 * (p + 1) + 1];
+                        const double tr = pr * ur - pi * ui;
+                        const double ti = pr * ui + pi * ur;
+                        const double supercurrent = static_cast<double>(wy[i]) * (tr * qi + ti * qr) / h;
+                        const double east = x + 1 < W ? static_cast<double>(b[i]) : edgeField;
+                        const double west = x > 0 ? static_cast<double>(b[i - (H - 1)]) : edgeField;
+                        angle[k] = static_cast<angle_type>(-h * (dt * (supercurrent + kappa2 * (east - west) / h)));
+                    }
+                    rotate(uy + x * (H - 1) + y0, angle, n);
+                }
+            }
+        }
+
+        /**
+         * @brief Whether arg(z) is in (0, pi], for z != 0.
+         */
+        inline bool upperHalf(double re, double im) {
+            return (im > 0.0) | ((im == 0.0) & (re < 0.0));
+        }
+
+        /**
+         * @brief Whether arg(z) is in (-pi, 0], for z != 0.
+         */
+        inline bool lowerHalf(double re, double im) {
+            return (im < 0.0) | ((im == 0.0) & (re > 0.0));
+        }
+
+        /**
+         * @brief The number of turns c in arg(z) + arg(t) = arg(z t) + 2 pi c, from the half-planes of z, t and z t
+         * alone: the sum of two angles in (0, pi] exceeds pi exactly if their product lies in the lower half-plane.
+         */
+        inline int turns(double zr, double zi, double tr, double ti, double pr, double pi) {
+            return static_cast<int>(upperHalf(zr, zi) & upperHalf(tr, ti) & lowerHalf(pr, pi))
+                   - static_cast<int>(lowerHalf(zr, zi) & lowerHalf(tr, ti) & upperHalf(pr, pi));
+        }
+
+        template<typename real, typename link>
+        void windingNumbers(const SolverArguments<real, link>& arguments, int* winding) {
+            const real* __restrict psi = pairs(arguments.orderParameter);
+            const link* __restrict ux = arguments.linkingVariableX;
+            const link* __restrict uy = arguments.linkingVariableY;
+            const real* __restrict wx = arguments.linkWeightX;
+            const std::size_t H = arguments.height;
+            const auto W = static_cast<long>(arguments.width);
+
+            // Around a plaquette a, b, c, d the gauge-invariant phase differences are the angles of the bond products
+            // t = conj(psi_i) U_ij psi_j, and the winding number is (sum of their angles - angle of the flux cell
+            // phasor) / 2 pi. The product of the four t is the flux cell phasor times a positive real, so the winding
+            // number is the number of turns picked up while multiplying them together: no angle has to be evaluated.
+#pragma omp parallel for
+            for (long x = 0; x < W - 1; x++) {
+                double southBuffer[2 * (linkChunk + 1)];
+                double westBuffer[2 * linkChunk];
+                double eastBuffer[2 * linkChunk];
+                for (std::size_t y0 = 0; y0 + 1 < H; y0 += linkChunk) {
+                    const std::size_t n = H - 1 - y0 < linkChunk ? H - 1 - y0 : linkChunk;
+                    // ux(x, y) and ux(x, y + 1) are entries k and k + 1
+                    const auto* __restrict south = linkPairs(ux, x * H + y0, n + 1, southBuffer);
+                    const auto* __restrict west = linkPairs(uy, x * (H - 1) + y0, n, westBuffer);
+                    const auto* __restrict east = linkPairs(uy, (x + 1) * (H - 1) + y0, n, eastBuffer);
+                    const real* left = psi + 2 * (x * H + y0);
+                    const real* right = psi + 2 * ((x + 1) * H + y0);
+                    const real* weight = wx + x * H + y0;
+                    int* cell = winding + x * (H - 1) + y0;
+                    for (std::size_t k = 0; k < n; k++) {
+                        const double ar = left[2 * k], ai = left[2 * k + 1];
+                        const double br = right[2 * k], bi = right[2 * k + 1];
+                        const double cr = right[2 * k + 2], ci = right[2 * k + 3];
+                        const double dr = left[2 * k + 2], di = left[2 * k + 3];
+
+                        // conj(a) ux(x, y) b
+                        const double sr = south[2 * k] * br - south[2 * k + 1] * bi;
+                        const double si = south[2 * k] * bi + south[2 * k + 1] * br;
+                        const double t1r = ar * sr + ai * si;
+                        const double t1i = ar * si - ai * sr;
+                        // conj(b) uy(x + 1, y) c
+                        const double er = east[2 * k] * cr - east[2 * k + 1] * ci;
+                        const double ei = east[2 * k] * ci + east[2 * k + 1] * cr;
+                        const double t2r = br * er + bi * ei;
+                        const double t2i = br * ei - bi * er;
+                        // conj(c) conj(ux(x, y + 1)) d
+                        const double nr = south[2 * k + 2] * dr + south[2 * k + 3] * di;
+                        const double ni = south[2 * k + 2] * di - south[2 * k + 3] * dr;
+                        const double t3r = cr * nr + ci * ni;
+                        const double t3i = cr * ni - ci * nr;
+                        // conj(d) conj(uy(x, y)) a
+                        const double wr = west[2 * k] * ar + west[2 * k + 1] * ai;
+                        const double wi = west[2 * k] * ai - west[2 * k + 1] * ar;
+                        const double t4r = dr * wr + di * wi;
+                        const double t4i = dr * wi - di * wr;
+
+                        const double p2r = t1r * t2r - t1i * t2i;
+                        const double p2i = t1r * t2i + t1i * t2r;
+                        const double p3r = p2r * t3r - p2i * t3i;
+                        const double p3i = p2r * t3i + p2i * t3r;
+                        const double p4r = p3r * t4r - p3i * t4i;
+                        const double p4i = p3r * t4i + p3i * t4r;
+                        const int count = turns(t1r, t1i, t2r, t2i, p2r, p2i) + turns(p2r, p2i, t3r, t3i, p3r, p3i)
+                                          + turns(p3r, p3i, t4r, t4i, p4r, p4i);
+
+                        // Only plaquettes with all four corners in the superconductor
+                        const int inside = static_cast<int>(weight[k] != 0) & static_cast<int>(weight[k + 1] != 0);
+                        cell[k] = inside * count;
+                    }
+                }
+            }
+        }
+
+        /**
+         * @brief The chains of multiplyAdd: enough vectors of the widest width to cover the latency of two multiply-add
+         * units, while staying in registers.
+         */
+#ifdef __AVX512F__
+        constexpr std::size_t multiplyAddChains = 64;
+#else
+        constexpr std::size_t multiplyAddChains = 32;
+#endif
+
+        double multiplyAdd(long iterations) {
+            double accumulator[multiplyAddChains];
+            for (std::size_t j = 0; j < multiplyAddChains; j++) {
+                accumulator[j] = static_cast<double>(j);
+            }
+            for (long k = 0; k < iterations; k++) {
+                for (std::size_t j = 0; j < multiplyAddChains; j++) {
+                    accumulator[j] = accumulator[j] * 0.999999 + 1e-7;
+                }
+            }
+            double sum = 0.0;
+            for (std::size_t j = 0; j < multiplyAddChains; j++) {
+                sum += accumulator[j];
+            }
+            return sum;
+        }
+    }
+
+    extern const KernelTable table;
+
+    const KernelTable table{
+            InstructionSet::SQUID_KERNEL_VARIANT,
+            {fillComplex, addComplex, subtractComplex, multiplyComplex,
+             addComplexScalar, subtractComplexScalar, multiplyComplexScalar,
+             fillComplexMasked, copyComplexMasked, multiplyComplexScalarMasked},
+            {fill<double>, add<double>, subtract<double>, multiply<double>,
+             addScalar<double>, subtractScalar<double>, multiplyScalar<double>,
+             fillMasked<double>, copyMasked<double>, multiplyScalarMasked<double>},
+            maskNot, maskOr,
+            {reduceSum, reduceDot, reduceCrossDot, reduceMasked<1, false>, reduceMasked<2, false>,
+             reduceMasked<1, true>, reduceMasked<2, true>, reduceMaxAbs, reduceMaxNorm, popcount},
+            {multigridSmooth, multigridResidual},
+            {fluxCells<double>, orderParameter<double, complex>, linkingVariables<double, complex>,
+             windingNumbers<double, complex>, thermalNoise<double, complex>,
+             supercurrentDivergence<double, complex>, scalarPotential<double, complex>,
+             orderParameterSteps<double, complex>},
+            {fluxCells<float>, orderParameter<float, std::complex<float>>,
+             linkingVariables<float, std::complex<float>>, windingNumbers<float, std::complex<float>>,
+             thermalNoise<float, std::complex<float>>, supercurrentDivergence<float, std::complex<float>>,
+             scalarPotential<float, std::complex<float>>, orderParameterSteps<float, std::complex<float>>},
+            {fluxCells<double>, orderParameter<double, Phase>, linkingVariables<double, Phase>,
+             windingNumbers<double, Phase>, thermalNoise<double, Phase>, supercurrentDivergence<double, Phase>,
+             scalarPotential<double, Phase>, orderParameterSteps<double, Phase>},
+            {fluxCells<float>, orderParameter<float, Phase>, linkingVariables<float, Phase>,
+             windingNumbers<float, Phase>, thermalNoise<float, Phase>, supercurrentDivergence<float, Phase>,
+             scalarPotential<float, Phase>, orderParameterSteps<float, Phase>},
+            multiplyAddChains, multiplyAdd};
+}
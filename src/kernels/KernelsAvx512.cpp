@@ -0,0 +1,2 @@
+#define SQUID_KERNEL_VARIANT avx512
+#include "Kernels.tpp"
@@ -0,0 +1,2 @@
+#define SQUID_KERNEL_VARIANT scalar
+#include "Kernels.tpp"
@@ -0,0 +1,2 @@
+#define SQUID_KERNEL_VARIANT sse42
+#include "Kernels.tpp"
@@ -4,6 +4,42 @@
 
 #include "../googletest/include/gtest/gtest.h"
 #include "../include/AbstractField.h"
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+    /**
+     * @brief A field of irregular values, large enough to be reduced in several blocks.
+     */
+    template<typename scalar>
+    ScalarField<scalar> irregularField(int width, int height, double seed) {
+        ScalarField<scalar> field(width, height);
+        for (int x = 0; x < width; x++) {
+            for (int y = 0; y < height; y++) {
+                const double value = std::sin(seed + 0.37 * x + 1.13 * y) * (1.0 + 1e-3 * x);
+                if constexpr (std::is_same_v<scalar, complex> || std::is_same_v<scalar, std::complex<float>>) {
+                    field(x, y) = scalar(value, std::cos(seed * y + 0.71 * x));
+                } else {
+                    field(x, y) = static_cast<scalar>(value);
+                }
+            }
+        }
+        return field;
+    }
+
+    Mask irregularMask(int width, int height) {
+        Mask mask(width, height);
+        for (int x = 0; x < width; x++) {
+            for (int y = 0; y < height; y++) {
+                mask(x, y) = (x * 7 + y * 3) % 5 < 2;
+            }
+        }
+        return mask;
+    }
+}
 
 TEST(Field, Constructor) {
     Field field(10, 20);
@@ -117,6 +153,28 @@ TEST(Mask, OrOperator) {
 
 }
 
+TEST(Mask, InPlaceOperators) {
+    // 10x10 does not fill the last word, its padding bits must stay clear
+    Mask mask1(10, 10);
+    mask1.fill(false);
+    mask1(0, 0) = true;
+    Mask mask2(10, 10);
+    mask2.fill(false);
+    mask2(9, 9) = true;
+    mask1 |= mask2;
+    EXPECT_EQ(mask1(0, 0), true);
+    EXPECT_EQ(mask1(9, 9), true);
+    EXPECT_EQ(mask1.count(), 2);
+
+    mask1.invert();
+    EXPECT_EQ(mask1(0, 0), false);
+    EXPECT_EQ(mask1(5, 5), true);
+    EXPECT_EQ(mask1.count(), 98);
+
+    Mask mask3(5, 5);
+    EXPECT_THROW(mask1 |= mask3, std::invalid_argument);
+}
+
 TEST(Field, DimensionCheckingInput) {
     Field field(10, 20);
     EXPECT_THROW(field(10, 20), std::out_of_range);
@@ -187,6 +245,175 @@ TEST(Field, FieldMultiplication) {
     EXPECT_THROW(field1 * field3, std::invalid_argument);
 }
 
+TEST(Field, InPlaceOperators) {
+    Field field1(10, 10);
+    field1.fill(complex(1.0, 1.0));
+    Field field2(10, 10);
+    field2.fill(complex(2.0, 2.0));
+    field1 += field2;
+    EXPECT_EQ(field1(0, 0), complex(3.0, 3.0));
+    field1 -= complex(1.0, 1.0);
+    EXPECT_EQ(field1(9, 9), complex(2.0, 2.0));
+    field1 *= field2;
+    EXPECT_EQ(field1(0, 0), complex(0.0, 8.0));
+    field1 *= complex(0.0, 0.5);
+    EXPECT_EQ(field1(0, 0), complex(-4.0, 0.0));
+    field1 += complex(1.0, 0.0);
+    field1 -= field2;
+    EXPECT_EQ(field1(5, 5), complex(-5.0, -2.0));
+
+    Field field3(5, 5);
+    EXPECT_THROW(field1 += field3, std::invalid_argument);
+    EXPECT_THROW(field1 *= field3, std::invalid_argument);
+}
+
+TEST(Field, MaskedOperations) {
+    const int width = 70;
+    const int height = 3;
+    Field field = irregularField<complex>(width, height, 0.3);
+    const Field original = field;
+    const Field other = irregularField<complex>(width, height, 1.7);
+    Mask region(width, height);
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) {
+            region(x, y) = (x + 2 * y) % 3 == 0;
+        }
+    }
+
+    field.where(region, complex(0.5, 0.0));
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) {
+            EXPECT_EQ(field(x, y), region(x, y) ? complex(0.5, 0.0) : original(x, y));
+        }
+    }
+
+    field = original;
+    field.assignMasked(region, other);
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) {
+            EXPECT_EQ(field(x, y), region(x, y) ? other(x, y) : original(x, y));
+        }
+    }
+
+    field = original;
+    field.scaleMasked(region, complex(0.0, 2.0));
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) {
+            const complex expected = region(x, y) ? original(x, y) * complex(0.0, 2.0) : original(x, y);
+            EXPECT_LT(std::abs(field(x, y) - expected), 1e-15);
+        }
+    }
+
+    RealField density(width, height);
+    density.fill(2.0);
+    density.scaleMasked(region, 0.25);
+    EXPECT_DOUBLE_EQ(density.sum(), 2.0 * width * height - 1.5 * static_cast<double>(region.count()));
+
+    Mask small(5, 5);
+    EXPECT_THROW(field.where(small, complex(0.0, 0.0)), std::invalid_argument);
+    EXPECT_THROW(field.assignMasked(region, Field(5, 5)), std::invalid_argument);
+}
+
+TEST(Field, Reductions) {
+    const int width = 300;
+    const int height = 310;
+    Field a = irregularField<complex>(width, height, 0.3);
+    Field b = irregularField<complex>(width, height, 1.7);
+    Mask mask = irregularMask(width, height);
+
+    std::complex<long double> sum = 0.0L;
+    std::complex<long double> maskedSum = 0.0L;
+    std::complex<long double> dot = 0.0L;
+    long double squares = 0.0L;
+    long double maskedSquares = 0.0L;
+    double largest = 0.0;
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) {
+            const std::complex<long double> value(a(x, y).real(), a(x, y).imag());
+            sum += value;
+            dot += std::conj(value) * std::complex<long double>(b(x, y).real(), b(x, y).imag());
+            squares += std::norm(value);
+            largest = std::max(largest, std::abs(a(x, y)));
+            if (mask(x, y)) {
+                maskedSum += value;
+                maskedSquares += std::norm(value);
+            }
+        }
+    }
+
+    EXPECT_NEAR(a.sum().real(), static_cast<double>(sum.real()), 1e-10);
+    EXPECT_NEAR(a.sum().imag(), static_cast<double>(sum.imag()), 1e-10);
+    EXPECT_NEAR(a.sum(mask).real(), static_cast<double>(maskedSum.real()), 1e-10);
+    EXPECT_NEAR(a.dot(b).real(), static_cast<double>(dot.real()), 1e-10);
+    EXPECT_NEAR(a.dot(b).imag(), static_cast<double>(dot.imag()), 1e-10);
+    EXPECT_NEAR(a.squaredNorm(), static_cast<double>(squares), 1e-9);
+    EXPECT_NEAR(a.squaredNorm(mask), static_cast<double>(maskedSquares), 1e-9);
+    EXPECT_NEAR(a.norm2(), std::sqrt(static_cast<double>(squares)), 1e-10);
+    EXPECT_NEAR(a.maxAbs(), largest, 1e-15);
+
+    // A full region adds the same values in the same order
+    Mask all(width, height);
+    all.fill(true);
+    EXPECT_EQ(a.sum(all), a.sum());
+    EXPECT_EQ(a.squaredNorm(all), a.squaredNorm());
+    EXPECT_THROW(a.sum(Mask(width, 1)), std::invalid_argument);
+    EXPECT_THROW(a.dot(Field(1, height)), std::invalid_argument);
+
+    // Real fields and fields without kernels follow the same order
+    RealField real = irregularField<double>(width, height, 0.9);
+    ScalarField<float> single(width, height);
+    for (int x = 0; x < width; x++) {
+        for (int y = 0; y < height; y++) {
+            single(x, y) = static_cast<float>(real(x, y));
+            real(x, y) = single(x, y);
+        }
+    }
+    EXPECT_EQ(single.sum(), real.sum());
+    EXPECT_EQ(single.sum(mask), real.sum(mask));
+    EXPECT_DOUBLE_EQ(single.squaredNorm(mask), real.squaredNorm(mask));
+    EXPECT_EQ(single.maxAbs(), real.maxAbs());
+}
+
+TEST(Field, ReductionsIndependentOfThreads) {
+#ifdef _OPENMP
+    const int width = 1024;
+    const int height = 520;
+    Field a = irregularField<complex>(width, height, 0.5);
+    Field b = irregularField<complex>(width, height, 2.5);
+    ComplexField<float> single = irregularField<std::complex<float>>(width, height, 0.5);
+    RealField real = irregularField<double>(width, height, 1.5);
+    Mask mask = irregularMask(width, height);
+
+    const int threads = omp_get_max_threads();
+    std::vector<double> results[2];
+    for (int run = 0; run < 2; run++) {
+        omp_set_num_threads(run == 0 ? 1 : 64);
+        results[run] = {a.sum().real(), a.sum(mask).imag(), a.dot(b).real(), a.dot(b).imag(), a.squaredNorm(),
+                        a.squaredNorm(mask), single.sum().real(), single.squaredNorm(mask), real.sum(),
+                        real.sum(mask), real.dot(real), real.maxAbs()};
+    }
+    omp_set_num_threads(threads);
+    for (std::size_t i = 0; i < results[0].size(); i++) {
+        EXPECT_EQ(results[0][i], results[1][i]) << "reduction " << i;
+    }
+#else
+    GTEST_SKIP() << "Built without OpenMP";
+#endif
+}
+
+TEST(Mask, Count) {
+    Mask mask = irregularMask(300, 310);
+    std::size_t count = 0;
+    for (int x = 0; x < 300; x++) {
+        for (int y = 0; y < 310; y++) {
+            count += mask(x, y);
+        }
+    }
+    EXPECT_EQ(mask.count(), count);
+    mask.fill(true);
+    EXPECT_EQ(mask.count(), 300 * 310);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,216 @@
+#include "../googletest/include/gtest/gtest.h"
+#include "../include/AdaptiveMesh.h"
+#include <cmath>
+
+namespace {
+    /**
+     * @brief The largest difference of two states.
+     */
+    double difference(const ComplexField<double> &a, const ComplexField<double> &b) {
+        double error = 0.0;
+        for (std::size_t i = 0; i < a.size(); i++) {
+            error = std::max(error, std::abs(a.data()[i] - b.data()[i]));
+        }
+        return error;
+    }
+}
+
+TEST(AdaptiveMesh, SingleLevelMatchesSolver) {
+    // One level of patches takes the steps of the uniform grid, with the ghost points in place of the neighbours
+    SolverParameters parameters;
+    parameters.screening = false;
+    parameters.timeStep = 0.5 * Solver::stabilityLimit(parameters);
+    Geometry geometry(48, 40);
+    geometry.setGeometry(Geometry::squidMask(48, 40));
+    RefinementParameters refinement;
+    refinement.levels = 1;
+    refinement.patchSize = 8;
+
+    for (Gauge gauge : {Gauge::landau, Gauge::symmetric}) {
+        parameters.gauge = gauge;
+        Superconductor superconductor(48, 40);
+        Solver solver(superconductor, geometry, parameters);
+        solver.initialize();
+        AdaptiveMesh mesh(geometry, parameters, refinement);
+        EXPECT_EQ(mesh.timeStep(), parameters.timeStep);
+        for (int n = 0; n < 200; n++) {
+            solver.step(0.3, 0.0);
+            mesh.step(0.3);
+        }
+        ComplexField<double> psi(48, 40);
+        mesh.composite(psi);
+        EXPECT_LT(difference(psi, superconductor.orderParameter()), 1e-10);
+        EXPECT_DOUBLE_EQ(mesh.time(), solver.time());
+    }
+}
+
+TEST(AdaptiveMesh, RefinesConstrictions) {
+    // The weak links are a third of the width of the arms
+    SolverParameters parameters;
+    parameters.screening = false;
+    Geometry geometry(512, 256);
+    geometry.setGeometry(Geometry::squidMask(512, 256));
+    AdaptiveMesh mesh(geometry, parameters);
+    ASSERT_EQ(mesh.levels(), 3u);
+
+    // The centre of the left weak link, the middle of the lower arm and the vacuum in a corner
+    const int constriction = (512 / 4 + 7 * 512 / 16) / 2;
+    EXPECT_EQ(mesh.coverage(constriction, 256 - 1 - 256 / 4), 2);
+    EXPECT_EQ(mesh.coverage(256, 256 / 4 + 8), 0);
+    EXPECT_EQ(mesh.coverage(2, 2), -1);
+
+    const std::size_t uniform = 512 * 256;
+    EXPECT_LE(5 * mesh.cells(), uniform);
+    EXPECT_LE(5 * mesh.cellUpdates(), 16 * uniform);
+}
+
+TEST(AdaptiveMesh, QuiescentAcrossInterfaces) {
+    // Without a field the uniform state is stationary on every level, ghosts and injection included
+    SolverParameters parameters;
+    parameters.screening = false;
+    Geometry geometry(128, 64);
+    geometry.setGeometry(Geometry::squidMask(128, 64));
+    RefinementParameters refinement;
+    refinement.patchSize = 8;
+    AdaptiveMesh mesh(geometry, parameters, refinement);
+    ASSERT_GT(mesh.patches(2), 0u);
+    for (int n = 0; n < 20; n++) {
+        mesh.step(0.0);
+    }
+    ComplexField<double> psi(128, 64);
+    mesh.composite(psi);
+    for (int x = 0; x < 128; x++) {
+        for (int y = 0; y < 64; y++) {
+            ASSERT_NEAR(std::abs(psi(x, y)), geometry.inSuperconductor(x, y) ? 1.0 : 0.0, 1e-12);
+        }
+    }
+}
+
+TEST(AdaptiveMesh, GaugeCovariant) {
+    // A state and its gauge transform to the symmetric gauge evolve alike, ghost points and new patches included
+    SolverParameters parameters;
+    parameters.screening = false;
+    Geometry geometry(128, 64);
+    geometry.setGeometry(Geometry::squidMask(128, 64));
+    RefinementParameters refinement;
+    refinement.patchSize = 8;
+    refinement.regridInterval = 2;
+    const double field = 0.2;
+
+    AdaptiveMesh relaxation(geometry, parameters, refinement);
+    for (int n = 0; n < 50; n++) {
+        relaxation.step(field);
+    }
+    ComplexField<double> landau(128, 64);
+    relaxation.composite(landau);
+
+    // A_symmetric = A_landau + grad chi, with chi = B (x - xc) (y + yc) / 2
+    ComplexField<double> symmetric(128, 64);
+    const double h = parameters.gridSpacing;
+    for (int x = 0; x < 128; x++) {
+        for (int y = 0; y < 64; y++) {
+            const double chi = 0.5 * field * (x * h - 63.5 * h) * (y * h + 31.5 * h);
+            symmetric(x, y) = std::polar(1.0, chi) * landau(x, y);
+        }
+    }
+
+    AdaptiveMesh landauMesh(geometry, parameters, refinement);
+    landauMesh.load(landau, field);
+    parameters.gauge = Gauge::symmetric;
+    AdaptiveMesh symmetricMesh(geometry, parameters, refinement);
+    symmetricMesh.load(symmetric, field);
+    for (int n = 0; n < 20; n++) {
+        landauMesh.step(field);
+        symmetricMesh.step(field);
+    }
+    ASSERT_EQ(landauMesh.patches(2), symmetricMesh.patches(2));
+    landauMesh.composite(landau);
+    symmetricMesh.composite(symmetric);
+    double error = 0.0;
+    for (std::size_t i = 0; i < landau.size(); i++) {
+        error = std::max(error, std::abs(std::abs(landau.data()[i]) - std::abs(symmetric.data()[i])));
+    }
+    EXPECT_LT(error, 1e-9);
+}
+
+TEST(AdaptiveMesh, MatchesUniformGrid) {
+    // Field entry into a SQUID, against the uniform grid of the finest spacing. The phases may drift apart, |psi|
+    // differs where the coarse level samples the edges of the superconductor
+    SolverParameters parameters;
+    parameters.screening = false;
+    parameters.timeStep = 0.5 * Solver::stabilityLimit(parameters);
+    Geometry geometry(128, 64);
+    geometry.setGeometry(Geometry::squidMask(128, 64));
+    RefinementParameters refinement;
+    refinement.levels = 2;
+    refinement.patchSize = 8;
+
+    Superconductor superconductor(128, 64);
+    Solver solver(superconductor, geometry, parameters);
+    solver.initialize();
+    AdaptiveMesh mesh(geometry, parameters, refinement);
+    for (int n = 0; n < 1000; n++) {
+        mesh.step(0.05);
+        for (int k = 0; k < 4; k++) {
+            solver.step(0.05, 0.0);
+        }
+    }
+    ComplexField<double> psi(128, 64);
+    mesh.composite(psi);
+    const ComplexField<double> &uniform = superconductor.orderParameter();
+    double error = 0.0;
+    for (std::size_t i = 0; i < psi.size(); i++) {
+        error = std::max(error, std::abs(std::abs(psi.data()[i]) - std::abs(uniform.data()[i])));
+    }
+    EXPECT_LT(error, 0.06);
+}
+
+TEST(AdaptiveMesh, RefinesVortexCores) {
+    // A vortex in the wide lower arm, where the geometry alone leaves the mesh coarse
+    SolverParameters parameters;
+    parameters.screening = false;
+    Geometry geometry(512, 256);
+    geometry.setGeometry(Geometry::squidMask(512, 256));
+    AdaptiveMesh mesh(geometry, parameters);
+    const int cx = 256;
+    const int cy = 256 / 4 + 16;
+    ASSERT_EQ(mesh.coverage(cx, cy), 0);
+
+    ComplexField<double> psi(512, 256);
+    for (int x = 0; x < 512; x++) {
+        for (int y = 0; y < 256; y++) {
+            const double dx = (x - cx) * parameters.gridSpacing;
+            const double dy = (y - cy) * parameters.gridSpacing;
+            const double r = std::hypot(dx, dy);
+            psi(x, y) = geometry.inSuperconductor(x, y) ? std::polar(std::tanh(r / std::sqrt(2.0)), std::atan2(dy, dx))
+                                                        : std::complex<double>(0.0);
+        }
+    }
+    mesh.load(psi, 0.0);
+    EXPECT_EQ(mesh.coverage(cx, cy), 2);
+    EXPECT_EQ(mesh.coverage(24, 64), -1);
+
+    // The finest patches carry the loaded state
+    ComplexField<double> loaded(512, 256);
+    mesh.composite(loaded);
+    EXPECT_EQ(loaded(cx + 1, cy + 1), psi(cx + 1, cy + 1));
+}
+
+TEST(AdaptiveMesh, InvalidParameters) {
+    SolverParameters parameters;
+    Geometry geometry(64, 64);
+    EXPECT_THROW(AdaptiveMesh(geometry, parameters), std::invalid_argument);
+    parameters.screening = false;
+    parameters.noise = 0.01;
+    EXPECT_THROW(AdaptiveMesh(geometry, parameters), std::invalid_argument);
+    parameters.noise = 0.0;
+    EXPECT_THROW(AdaptiveMesh(geometry, parameters, {0, 16, 6.0, 0.25, 10}), std::invalid_argument);
+    EXPECT_THROW(AdaptiveMesh(geometry, parameters, {3, 2, 6.0, 0.25, 10}), std::invalid_argument);
+    EXPECT_THROW(AdaptiveMesh(geometry, parameters, {3, 16, 6.0, 0.0, 10}), std::invalid_argument);
+    EXPECT_THROW(AdaptiveMesh(geometry, parameters, {6, 16, 6.0, 0.25, 10}), std::invalid_argument);
+
+    AdaptiveMesh mesh(geometry, parameters);
+    ComplexField<double> wrong(63, 64);
+    EXPECT_THROW(mesh.composite(wrong), std::invalid_argument);
+    EXPECT_THROW(mesh.load(wrong, 0.0), std::invalid_argument);
+}
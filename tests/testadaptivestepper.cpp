@@ -0,0 +1,147 @@
+#include "../googletest/include/gtest/gtest.h"
+#include "../include/AdaptiveStepper.h"
+#include <cmath>
+#include <vector>
+
+TEST(AdaptiveStepper, GrowsInQuiescentState) {
+    // The field-free Meissner state is stationary, so the time step grows to the stability limit
+    SolverParameters parameters;
+    parameters.timeStep = 1e-4;
+    Geometry geometry(24, 24);
+    Superconductor superconductor(24, 24);
+    Solver solver(superconductor, geometry, parameters);
+    solver.initialize();
+    AdaptiveStepper stepper(solver, AdaptiveParameters());
+
+    double time = 0.0;
+    for (int n = 0; n < 10; n++) {
+        AdaptiveStep step = stepper.step(0.0, 0.0);
+        EXPECT_EQ(step.rejections, 0);
+        time += step.timeStep;
+    }
+    EXPECT_DOUBLE_EQ(stepper.timeStep(), Solver::stabilityLimit(parameters));
+    EXPECT_DOUBLE_EQ(solver.time(), time);
+    EXPECT_EQ(stepper.accepted(), 10);
+    EXPECT_NEAR(solver.meanSuperfluidDensity(), 1.0, 1e-12);
+}
+
+TEST(AdaptiveStepper, ShrinksOnFieldEntry) {
+    // A field switched on at the stability limit makes the first attempts too coarse
+    SolverParameters parameters;
+    parameters.screening = false;
+    parameters.timeStep = Solver::stabilityLimit(parameters);
+    Geometry geometry(24, 24);
+    Superconductor superconductor(24, 24);
+    Solver solver(superconductor, geometry, parameters);
+    solver.initialize();
+    AdaptiveParameters adaptive;
+    adaptive.tolerance = 1e-4;
+    AdaptiveStepper stepper(solver, adaptive);
+
+    AdaptiveStep first = stepper.step(0.5, 0.0);
+    EXPECT_GT(first.rejections, 0);
+    EXPECT_LT(first.timeStep, parameters.timeStep);
+    EXPECT_LE(first.error, adaptive.tolerance);
+    EXPECT_EQ(stepper.rejected(), first.rejections);
+    EXPECT_DOUBLE_EQ(solver.time(), first.timeStep);
+
+    // A bound shortens the step without shrinking the next
+    const double timeStep = stepper.timeStep();
+    AdaptiveStep bounded = stepper.step(0.5, 0.0, 0.25 * timeStep);
+    EXPECT_DOUBLE_EQ(bounded.timeStep, 0.25 * timeStep);
+    EXPECT_GE(stepper.timeStep(), timeStep);
+}
+
+TEST(AdaptiveStepper, RejectedAttemptsLeaveNoTrace) {
+    // Replaying the accepted steps as pairs of half steps on a second solver gives the same bits, links included
+    SolverParameters parameters;
+    parameters.timeStep = Solver::stabilityLimit(parameters);
+    Geometry geometry(20, 16);
+    Superconductor superconductor(20, 16);
+    Solver solver(superconductor, geometry, parameters);
+    solver.initialize();
+    AdaptiveParameters adaptive;
+    adaptive.tolerance = 2e-6;
+    AdaptiveStepper stepper(solver, adaptive);
+
+    std::vector<double> timeSteps;
+    for (int n = 0; n < 20; n++) {
+        timeSteps.push_back(stepper.step(0.4, 0.1).timeStep);
+    }
+    ASSERT_GT(stepper.rejected(), 0);
+
+    Superconductor replay(20, 16);
+    Solver replaySolver(replay, geometry, parameters);
+    replaySolver.initialize();
+    for (double timeStep : timeSteps) {
+        SolverParameters half = parameters;
+        half.timeStep = 0.5 * timeStep;
+        replaySolver.setParameters(half);
+        replaySolver.step(0.4, 0.1);
+        replaySolver.step(0.4, 0.1);
+    }
+    for (std::size_t x = 0; x < 20; x++) {
+        for (std::size_t y = 0; y < 16; y++) {
+            ASSERT_EQ(superconductor.orderParameter()(x, y), replay.orderParameter()(x, y));
+        }
+    }
+    for (std::size_t x = 0; x + 1 < 20; x++) {
+        for (std::size_t y = 0; y < 16; y++) {
+            ASSERT_EQ(superconductor.linkingVariableX()(x, y), replay.linkingVariableX()(x, y));
+        }
+    }
+}
+
+TEST(AdaptiveStepper, MatchesFineFixedStep) {
+    // Vortex entry without screening, against a fixed step a tenth of the stability limit
+    SolverParameters parameters;
+    parameters.screening = false;
+    parameters.timeStep = 0.1 * Solver::stabilityLimit(parameters);
+    const double field = 0.5;
+    const double duration = 20.0;
+    Geometry geometry(32, 32);
+
+    Superconductor fixed(32, 32);
+    Solver fixedSolver(fixed, geometry, parameters);
+    fixedSolver.initialize();
+    const auto steps = std::lround(duration / parameters.timeStep);
+    for (long n = 0; n < steps; n++) {
+        fixedSolver.step(field, 0.0);
+    }
+
+    Superconductor adapted(32, 32);
+    Solver adaptedSolver(adapted, geometry, parameters);
+    adaptedSolver.initialize();
+    AdaptiveParameters adaptive;
+    adaptive.tolerance = 1e-4;
+    AdaptiveStepper stepper(adaptedSolver, adaptive);
+    while (adaptedSolver.time() < duration - 1e-9) {
+        stepper.step(field, 0.0, duration - adaptedSolver.time());
+    }
+    EXPECT_NEAR(adaptedSolver.time(), duration, 1e-9);
+    EXPECT_LT(2 * stepper.accepted(), static_cast<std::size_t>(steps) / 2);
+
+    double error = 0.0;
+    for (std::size_t x = 0; x < 32; x++) {
+        for (std::size_t y = 0; y < 32; y++) {
+            error = std::max(error, std::abs(fixed.orderParameter()(x, y) - adapted.orderParameter()(x, y)));
+        }
+    }
+    EXPECT_LT(error, 0.02);
+}
+
+TEST(AdaptiveStepper, InvalidParameters) {
+    SolverParameters parameters;
+    Geometry geometry(10, 10);
+    Superconductor superconductor(10, 10);
+    Solver solver(superconductor, geometry, parameters);
+    EXPECT_THROW(AdaptiveStepper(solver, {0.0, 1e-6, 0.0}), std::invalid_argument);
+    EXPECT_THROW(AdaptiveStepper(solver, {1e-3, 0.0, 0.0}), std::invalid_argument);
+    EXPECT_THROW(AdaptiveStepper(solver, {1e-3, 1e-2, 1e-3}), std::invalid_argument);
+
+    parameters.noise = 0.01;
+    solver.setParameters(parameters);
+    solver.initialize();
+    AdaptiveStepper stepper(solver, AdaptiveParameters());
+    EXPECT_THROW(stepper.step(0.0, 0.0), std::invalid_argument);
+}
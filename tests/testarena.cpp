@@ -0,0 +1,163 @@
+#include "../googletest/include/gtest/gtest.h"
+#include "../include/Arena.h"
+#include "../include/Solver.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+
+// Every heap allocation of the test binary is counted, whichever form of operator new makes it.
+namespace {
+    std::atomic<std::size_t> allocationCount(0);
+
+    void *allocateCounted(std::size_t size, std::size_t alignment) {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        size = size == 0 ? 1 : size;
+        void *pointer = alignment <= alignof(std::max_align_t)
+                        ? std::malloc(size)
+                        : std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+        if (pointer == nullptr) {
+            throw std::bad_alloc();
+        }
+        return pointer;
+    }
+}
+
+void *operator new(std::size_t size) {
+    return allocateCounted(size, alignof(std::max_align_t));
+}
+
+void *operator new[](std::size_t size) {
+    return allocateCounted(size, alignof(std::max_align_t));
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment) {
+    return allocateCounted(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) {
+    return allocateCounted(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept {
+    std::free(pointer);
+}
+
+TEST(Arena, ReusesStorageInScope) {
+    const arena::Statistics before = arena::statistics();
+    {
+        arena::Scope scratch;
+        for (int i = 0; i < 5; i++) {
+            RealField a(40, 30);
+            Field b(40, 30);
+        }
+        const arena::Statistics inside = arena::statistics();
+        EXPECT_EQ(inside.allocations - before.allocations, 2);
+        EXPECT_EQ(inside.reuses - before.reuses, 8);
+        EXPECT_EQ(inside.cachedBlocks, 2);
+        EXPECT_EQ(inside.cachedBytes, 40 * 30 * (sizeof(double) + sizeof(complex)));
+
+        // Nested scopes keep the cache of the outer one
+        {
+            arena::Scope nested;
+            RealField c(40, 30);
+            EXPECT_EQ(arena::statistics().cachedBlocks, 1);
+        }
+        EXPECT_EQ(arena::statistics().cachedBlocks, 2);
+    }
+    EXPECT_EQ(arena::statistics().cachedBlocks, 0);
+    EXPECT_EQ(arena::statistics().cachedBytes, 0);
+
+    // Outside of a scope storage goes back to the heap right away
+    {
+        RealField d(40, 30);
+    }
+    EXPECT_EQ(arena::statistics().cachedBlocks, 0);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(RealField(3, 3).data()) % arena::alignment, 0);
+}
+
+TEST(Arena, SteadyStepLoopDoesNotAllocate) {
+    const int size = 64;
+    Geometry geometry(size, size);
+    geometry.setGeometry(Geometry::squidMask(size, size));
+    Superconductor superconductor(size, size);
+    Solver solver(superconductor, geometry, SolverParameters());
+    solver.initialize();
+    Field &psi = superconductor.orderParameter();
+
+    // A step followed by the kind of bookkeeping analysis code does on field temporaries
+    auto iteration = [&]() {
+        solver.step(0.01, 0.0);
+        Field damped = psi * complex(0.999, 0.0);
+        damped += psi;
+        damped.scaleMasked(geometry.superconductor(), complex(0.5, 0.0));
+        damped.where(geometry.exteriorVacuum(), complex(0.0, 0.0));
+        psi.assignMasked(geometry.superconductor(), damped);
+        RealField density(size, size);
+        density.fill(1.0);
+        density.scaleMasked(geometry.interiorVacuum(), 0.0);
+        return density.sum();
+    };
+
+    arena::Scope scratch;
+    iteration();
+    const std::size_t start = allocationCount.load(std::memory_order_relaxed);
+    double total = 0.0;
+    for (int n = 0; n < 20; n++) {
+        total += iteration();
+    }
+    const std::size_t allocations = allocationCount.load(std::memory_order_relaxed) - start;
+    EXPECT_EQ(allocations, 0);
+    EXPECT_GT(total, 0.0);
+    EXPECT_EQ(arena::statistics().cachedBlocks, 2);
+}
+
+TEST(Arena, FieldRampDoesNotAllocate) {
+    // Without screening the links are rebuilt from the gauge whenever the applied field changes, here in every step
+    const int size = 64;
+    Geometry geometry(size, size);
+    geometry.setGeometry(Geometry::squidMask(size, size));
+    Superconductor superconductor(size, size);
+    SolverParameters parameters;
+    parameters.screening = false;
+    parameters.temporalBlocking = 4;
+    Solver solver(superconductor, geometry, parameters);
+    solver.initialize();
+
+    const std::size_t start = allocationCount.load(std::memory_order_relaxed);
+    for (int n = 0; n < 20; n++) {
+        solver.step(0.01 * n, 0.0);
+        solver.advance(0.01 * n + 0.005, 0.0, 5);
+    }
+    const std::size_t allocations = allocationCount.load(std::memory_order_relaxed) - start;
+    EXPECT_EQ(allocations, 0);
+    EXPECT_GT(solver.meanSuperfluidDensity(), 0.0);
+}
@@ -0,0 +1,84 @@
+#include "../googletest/include/gtest/gtest.h"
+#include "../include/FixedField.h"
+
+typedef FixedField<complex, 8, 6> SmallField;
+
+TEST(FixedField, Constructor) {
+    SmallField field;
+    static_assert(SmallField::fixedWidth == 8 && SmallField::fixedHeight == 6);
+    static_assert(SmallField::index(2, 3) == 15);
+    EXPECT_EQ(field.width(), 8);
+    EXPECT_EQ(field.height(), 6);
+    EXPECT_EQ(field.size(), 48);
+    EXPECT_EQ(field(7, 5), complex(0.0, 0.0));
+    EXPECT_THROW(field(8, 0), std::out_of_range);
+
+    // The elements live inside the object
+    EXPECT_GE(sizeof(SmallField), 48 * sizeof(complex));
+}
+
+TEST(FixedField, Operators) {
+    SmallField a;
+    SmallField b;
+    a.fill(complex(1.0, 2.0));
+    b.fill(complex(0.5, -1.0));
+    a(3, 4) = complex(2.0, 0.0);
+
+    EXPECT_EQ((a + b)(0, 0), complex(1.5, 1.0));
+    EXPECT_EQ((a - b)(3, 4), complex(1.5, 1.0));
+    EXPECT_EQ((a * b)(0, 0), complex(1.0, 2.0) * complex(0.5, -1.0));
+    EXPECT_EQ((a + complex(1.0, 0.0))(3, 4), complex(3.0, 0.0));
+    EXPECT_EQ((a - complex(1.0, 0.0))(0, 0), complex(0.0, 2.0));
+    EXPECT_EQ((a * 2.0)(3, 4), complex(4.0, 0.0));
+
+    FixedField<double, 3, 2> c;
+    FixedField<double, 3, 2> d;
+    c.fill(1.5);
+    d.fill(-2.0);
+    EXPECT_EQ((c * d)(2, 1), -3.0);
+    EXPECT_EQ((c - d)(0, 0), 3.5);
+}
+
+TEST(FixedField, ScalarFieldInteroperability) {
+    Field dynamic(8, 6);
+    dynamic.fill(complex(1.0, 1.0));
+    dynamic(1, 2) = complex(3.0, 0.0);
+    SmallField fixed(dynamic);
+    EXPECT_EQ(fixed(1, 2), complex(3.0, 0.0));
+
+    // Both orders: the FixedField operators take a ScalarField, the ScalarField ones convert the FixedField
+    SmallField sum = fixed + dynamic;
+    Field product = dynamic * fixed;
+    EXPECT_EQ(sum(1, 2), complex(6.0, 0.0));
+    EXPECT_EQ(product(1, 2), complex(9.0, 0.0));
+    EXPECT_EQ(product(0, 0), complex(0.0, 2.0));
+
+    Field copy = fixed;
+    EXPECT_EQ(copy.width(), 8);
+    EXPECT_EQ(copy(1, 2), complex(3.0, 0.0));
+
+    Field wrongSize(6, 8);
+    EXPECT_THROW(SmallField{wrongSize}, std::invalid_argument);
+    EXPECT_THROW(fixed - wrongSize, std::invalid_argument);
+}
+
+TEST(FixedField, ForEachInterior) {
+    FixedField<double, 5, 4> field;
+    for (std::size_t x = 0; x < 5; x++) {
+        for (std::size_t y = 0; y < 4; y++) {
+            field(x, y) = static_cast<double>(x * x + 3 * y);
+        }
+    }
+
+    // The 5-point Laplacian of x^2 + 3y is 2 everywhere
+    FixedField<double, 5, 4> laplacian;
+    int calls = 0;
+    field.forEachInterior([&](std::size_t x, std::size_t y) {
+        laplacian(x, y) = field(x + 1, y) + field(x - 1, y) + field(x, y + 1) + field(x, y - 1) - 4.0 * field(x, y);
+        calls++;
+    });
+    EXPECT_EQ(calls, 3 * 2);
+    EXPECT_DOUBLE_EQ(laplacian(2, 2), 2.0);
+    EXPECT_DOUBLE_EQ(laplacian(3, 1), 2.0);
+    EXPECT_DOUBLE_EQ(laplacian(0, 0), 0.0);
+}
@@ -0,0 +1,101 @@
+#include "../googletest/include/gtest/gtest.h"
+#include "../include/Gauge.h"
+#include "../include/Solver.h"
+
+namespace {
+    SolverParameters withoutScreening(Gauge gauge) {
+        SolverParameters parameters;
+        parameters.screening = false;
+        parameters.gauge = gauge;
+        return parameters;
+    }
+
+    template<typename link>
+    double maximumFieldError(Gauge gauge, double field) {
+        Geometry geometry(20, 16);
+        BasicSuperconductor<double, link> superconductor(20, 16);
+        BasicSolver<double, link> solver(superconductor, geometry, withoutScreening(gauge));
+        solver.initialize();
+        solver.step(field, 0.0);
+        const RealField &b = solver.magneticField();
+        double error = 0.0;
+        for (std::size_t i = 0; i < b.size(); i++) {
+            error = std::max(error, std::abs(b.data()[i] - field));
+        }
+        return error;
+    }
+}
+
+TEST(Gauge, UniformFieldPlaquettes) {
+    for (Gauge gauge : {Gauge::landau, Gauge::symmetric}) {
+        EXPECT_LT(maximumFieldError<std::complex<double>>(gauge, 0.3), 1e-12);
+        EXPECT_LT(maximumFieldError<std::complex<double>>(gauge, -1.1), 1e-12);
+        // Phases are quantized to 2 pi / 2^32 per link
+        EXPECT_LT(maximumFieldError<Phase>(gauge, 0.3), 1e-7);
+    }
+}
+
+TEST(Gauge, ClosedFormMatchesQuadrature) {
+    const double h = 0.5;
+    for (Gauge gauge : {Gauge::landau, Gauge::symmetric}) {
+        Field expectedX(11, 9);
+        Field expectedY(12, 8);
+        Field linkX(11, 9);
+        Field linkY(12, 8);
+        gauge::linkingVariables(gauge::uniformField(0.7, gauge, 12, 9, h), h, expectedX, expectedY);
+        gauge::uniformField(0.7, gauge, h, linkX, linkY);
+        for (std::size_t i = 0; i < linkX.size(); i++) {
+            EXPECT_NEAR(std::abs(linkX.data()[i] - expectedX.data()[i]), 0.0, 1e-12);
+        }
+        for (std::size_t i = 0; i < linkY.size(); i++) {
+            EXPECT_NEAR(std::abs(linkY.data()[i] - expectedY.data()[i]), 0.0, 1e-12);
+        }
+    }
+
+    // Links that do not fit together
+    Field linkX(11, 9);
+    Field linkY(11, 8);
+    EXPECT_THROW(gauge::uniformField(0.7, Gauge::landau, h, linkX, linkY), std::invalid_argument);
+}
+
+TEST(Gauge, LinksAreCached) {
+    Geometry geometry(16, 16);
+    Superconductor superconductor(16, 16);
+    Solver solver(superconductor, geometry, withoutScreening(Gauge::landau));
+    solver.initialize();
+    solver.step(0.2, 0.0);
+    const complex expected = superconductor.linkingVariableX()(3, 5);
+
+    // A link the solver would not have written survives steps at the same field, and is rebuilt once it changes
+    superconductor.linkingVariableX()(3, 5) = complex(1.0, 0.0);
+    solver.step(0.2, 0.0);
+    EXPECT_EQ(superconductor.linkingVariableX()(3, 5), complex(1.0, 0.0));
+    solver.step(0.25, 0.0);
+    solver.step(0.2, 0.0);
+    EXPECT_EQ(superconductor.linkingVariableX()(3, 5), expected);
+
+    superconductor.linkingVariableX()(3, 5) = complex(1.0, 0.0);
+    solver.initialize();
+    solver.step(0.2, 0.0);
+    EXPECT_EQ(superconductor.linkingVariableX()(3, 5), expected);
+
+    EXPECT_THROW(solver.step(0.2, 0.1), std::invalid_argument);
+}
+
+TEST(Gauge, NoScreeningWithoutField) {
+    // Without a field the links stay 1 either way, and the order parameter evolves the same
+    Geometry geometry(24, 24);
+    Superconductor screened(24, 24);
+    Superconductor unscreened(24, 24);
+    Solver solver(screened, geometry, SolverParameters());
+    Solver unscreenedSolver(unscreened, geometry, withoutScreening(Gauge::symmetric));
+    solver.initialize();
+    unscreenedSolver.initialize();
+    screened.orderParameter()(8, 8) = 0.5;
+    unscreened.orderParameter()(8, 8) = 0.5;
+    for (int n = 0; n < 200; n++) {
+        solver.step(0.0, 0.0);
+        unscreenedSolver.step(0.0, 0.0);
+    }
+    EXPECT_DOUBLE_EQ(unscreenedSolver.meanSuperfluidDensity(), solver.meanSuperfluidDensity());
+}
@@ -32,4 +32,32 @@ TEST(Geometry, VacuumRecognition) {
     EXPECT_EQ(geometry.onExteriorVacuum(1,1), false);
     EXPECT_EQ(geometry.onInteriorVacuum(1,1), false);
     EXPECT_EQ(geometry.onExteriorVacuum(0,0), true);
-}
\ No newline at end of file
+}
+
+TEST(Geometry, SquidMask) {
+    Geometry geometry(64, 32);
+    geometry.setGeometry(Geometry::squidMask(64, 32));
+
+    // Two holes on either side of the central bar
+    EXPECT_EQ(geometry.onInteriorVacuum(20, 15), true);
+    EXPECT_EQ(geometry.onInteriorVacuum(43, 15), true);
+    EXPECT_EQ(geometry.inSuperconductor(32, 15), true);
+    EXPECT_EQ(geometry.onExteriorVacuum(2, 15), true);
+    EXPECT_THROW(Geometry::squidMask(8, 8), std::invalid_argument);
+}
+
+TEST(Geometry, Holes) {
+    Geometry geometry(64, 32);
+    EXPECT_EQ(geometry.holeCount(), 0);
+    EXPECT_EQ(geometry.inHole(5, 5), -1);
+
+    geometry.setGeometry(Geometry::squidMask(64, 32));
+    ASSERT_EQ(geometry.holeCount(), 2);
+    EXPECT_EQ(geometry.inHole(20, 15), 0);
+    EXPECT_EQ(geometry.inHole(43, 15), 1);
+    EXPECT_EQ(geometry.inHole(32, 15), -1);
+    EXPECT_EQ(geometry.inHole(2, 15), -1);
+    EXPECT_TRUE(geometry.hole(1)(43, 15));
+    EXPECT_FALSE(geometry.hole(1)(20, 15));
+    EXPECT_THROW(geometry.hole(2), std::out_of_range);
+}
@@ -0,0 +1,72 @@
+#include "../googletest/include/gtest/gtest.h"
+#include "../include/Instrumentation.h"
+#include <sstream>
+#include <thread>
+
+TEST(Instrumentation, RegisterPhase) {
+    int phase = instrumentation::registerPhase("test_register");
+    EXPECT_EQ(instrumentation::registerPhase("test_register"), phase);
+    EXPECT_NE(instrumentation::registerPhase("test_register_other"), phase);
+}
+
+TEST(Instrumentation, ReportSumsThreads) {
+    instrumentation::reset();
+    int phase = instrumentation::registerPhase("test_report");
+    instrumentation::record(phase, 1000, 10, 100);
+    std::thread worker([phase]() { instrumentation::record(phase, 3000, 30, 300); });
+    worker.join();
+
+    std::ostringstream report;
+    instrumentation::writeReport(report);
+    std::string text = report.str();
+    EXPECT_NE(text.find("\"name\": \"test_report\", \"time_s\": 4e-06, \"calls\": 2, \"cells\": 40, \"bytes\": 400"),
+              std::string::npos);
+
+    instrumentation::reset();
+    std::ostringstream empty;
+    instrumentation::writeReport(empty);
+    EXPECT_NE(empty.str().find("\"name\": \"test_report\", \"time_s\": 0, \"calls\": 0"), std::string::npos);
+}
+
+TEST(Instrumentation, ReusesRecordsOfFinishedThreads) {
+    int phase = instrumentation::registerPhase("test_reuse");
+    instrumentation::record(phase, 0, 0, 0);
+    auto threads = []() {
+        std::ostringstream report;
+        instrumentation::writeReport(report);
+        std::string text = report.str();
+        return std::stoi(text.substr(text.find("\"threads\": ") + 11));
+    };
+    const int running = threads();
+
+    // A thread per job, as the analysis pools of a batch start them: each takes over the record of the one before
+    instrumentation::reset();
+    instrumentation::enableTracing(4);
+    for (int job = 0; job < 3; job++) {
+        std::thread worker([phase]() { instrumentation::ScopedTimer timer(phase, 1, 8); });
+        worker.join();
+        EXPECT_EQ(threads(), running);
+    }
+    instrumentation::disableTracing();
+
+    std::ostringstream report;
+    instrumentation::writeReport(report);
+    EXPECT_NE(report.str().find("\"name\": \"test_reuse\", \"time_s\": "), std::string::npos);
+    EXPECT_NE(report.str().find("\"calls\": 3, \"cells\": 3, \"bytes\": 24"), std::string::npos);
+}
+
+TEST(Instrumentation, ChromeTrace) {
+    instrumentation::reset();
+    instrumentation::enableTracing(2);
+    int phase = instrumentation::registerPhase("test_trace");
+    for (int i = 0; i < 3; i++) {
+        instrumentation::ScopedTimer timer(phase, 1, 1);
+    }
+    instrumentation::disableTracing();
+
+    std::ostringstream trace;
+    instrumentation::writeChromeTrace(trace);
+    std::string text = trace.str();
+    EXPECT_NE(text.find("\"name\": \"test_trace\", \"ph\": \"X\""), std::string::npos);
+    EXPECT_NE(text.find("\"dropped_events\": 1"), std::string::npos);
+}
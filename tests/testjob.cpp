@@ -0,0 +1,253 @@
+#include "../googletest/include/gtest/gtest.h"
+#include "../include/Job.h"
+#include <sstream>
+
+TEST(Schedule, Interpolation) {
+    Schedule schedule({{0.0, 0.0}, {10.0, 1.0}, {20.0, 1.0}});
+    EXPECT_DOUBLE_EQ(schedule(-1.0), 0.0);
+    EXPECT_DOUBLE_EQ(schedule(5.0), 0.5);
+    EXPECT_DOUBLE_EQ(schedule(15.0), 1.0);
+    EXPECT_DOUBLE_EQ(schedule(30.0), 1.0);
+    EXPECT_DOUBLE_EQ(Schedule(0.3)(100.0), 0.3);
+    EXPECT_THROW(Schedule({{1.0, 0.0}, {1.0, 1.0}}), std::invalid_argument);
+}
+
+TEST(Job, Parse) {
+    std::istringstream in("# sweep\n"
+                          "[job first]\n"
+                          "width = 20   # grid points\n"
+                          "height = 10\n"
+                          "kappa = 1.5\n"
+                          "noise = 0.02\n"
+                          "seed = 0x2a\n"
+                          "temporal_blocking = 4\n"
+                          "refine = true\n"
+                          "refinement_levels = 2\n"
+                          "patch_size = 8\n"
+                          "feature_width = 4\n"
+                          "refinement_gradient = 0.5\n"
+                          "regrid_interval = 0\n"
+                          "field = 0:0, 10:0.5\n"
+                          "output = out/first\n"
+                          "\n"
+                          "[job second]\n"
+                          "threads = 4\n"
+                          "precision = single\n"
+                          "links = phase\n"
+                          "coarse_levels = 2\n"
+                          "coarse_duration = 50\n"
+                          "adaptive = true\n"
+                          "tolerance = 1e-4\n"
+                          "min_time_step = 1e-5\n"
+                          "max_time_step = 0.02\n"
+                          "screening = false\n"
+                          "gauge = symmetric\n"
+                          "vortices = yes\n"
+                          "cut = x 9 0 10\n"
+                          "cut = y 4 1 19\n"
+                          "probe = 10 5\n"
+                          "voltage = 2 5 17 5\n"
+                          "source = 1 1 2 9\n"
+                          "drain = 18 1 19 9\n"
+                          "cycle = w\n"
+                          "potential_tolerance = 1e-8\n");
+    std::vector<Job> jobs = parseJobs(in, "test");
+
+    ASSERT_EQ(jobs.size(), 2);
+    EXPECT_EQ(jobs[0].name, "first");
+    EXPECT_EQ(jobs[0].width, 20);
+    EXPECT_EQ(jobs[0].height, 10);
+    EXPECT_DOUBLE_EQ(jobs[0].parameters.kappa, 1.5);
+    EXPECT_DOUBLE_EQ(jobs[0].parameters.noise, 0.02);
+    EXPECT_EQ(jobs[0].parameters.seed, 42);
+    EXPECT_DOUBLE_EQ(jobs[1].parameters.noise, 0.0);
+    EXPECT_EQ(jobs[0].parameters.temporalBlocking, 4);
+    EXPECT_EQ(jobs[1].parameters.temporalBlocking, 1);
+    EXPECT_DOUBLE_EQ(jobs[0].field(5.0), 0.25);
+    EXPECT_EQ(jobs[0].output, "out/first");
+    EXPECT_EQ(jobs[1].name, "second");
+    EXPECT_EQ(jobs[1].threads, 4);
+    EXPECT_FALSE(jobs[0].singlePrecision);
+    EXPECT_TRUE(jobs[1].singlePrecision);
+    EXPECT_FALSE(jobs[0].phaseLinks);
+    EXPECT_TRUE(jobs[1].phaseLinks);
+    EXPECT_EQ(jobs[0].nested.levels, 0);
+    EXPECT_EQ(jobs[1].nested.levels, 2);
+    EXPECT_DOUBLE_EQ(jobs[1].nested.duration, 50.0);
+    EXPECT_FALSE(jobs[0].adaptive);
+    EXPECT_TRUE(jobs[1].adaptive);
+    EXPECT_DOUBLE_EQ(jobs[1].adaptiveParameters.tolerance, 1e-4);
+    EXPECT_DOUBLE_EQ(jobs[1].adaptiveParameters.minimumTimeStep, 1e-5);
+    EXPECT_DOUBLE_EQ(jobs[1].adaptiveParameters.maximumTimeStep, 0.02);
+    EXPECT_TRUE(jobs[0].refine);
+    EXPECT_FALSE(jobs[1].refine);
+    EXPECT_EQ(jobs[0].refinement.levels, 2);
+    EXPECT_EQ(jobs[0].refinement.patchSize, 8);
+    EXPECT_DOUBLE_EQ(jobs[0].refinement.featureWidth, 4.0);
+    EXPECT_DOUBLE_EQ(jobs[0].refinement.gradient, 0.5);
+    EXPECT_EQ(jobs[0].refinement.regridInterval, 0);
+    EXPECT_EQ(jobs[1].refinement.levels, 3);
+    EXPECT_TRUE(jobs[0].parameters.screening);
+    EXPECT_FALSE(jobs[1].parameters.screening);
+    EXPECT_EQ(jobs[0].parameters.gauge, Gauge::landau);
+    EXPECT_EQ(jobs[1].parameters.gauge, Gauge::symmetric);
+    EXPECT_FALSE(jobs[0].vortices);
+    EXPECT_TRUE(jobs[1].vortices);
+    ASSERT_EQ(jobs[1].cutLines.size(), 2);
+    EXPECT_TRUE(jobs[1].cutLines[0].vertical);
+    EXPECT_EQ(jobs[1].cutLines[0].position, 9);
+    EXPECT_EQ(jobs[1].cutLines[0].end, 10);
+    EXPECT_FALSE(jobs[1].cutLines[1].vertical);
+    EXPECT_EQ(jobs[1].cutLines[1].begin, 1);
+    ASSERT_EQ(jobs[1].probes.size(), 1);
+    EXPECT_EQ(jobs[1].probes[0].x, 10);
+    ASSERT_EQ(jobs[1].voltageProbes.size(), 1);
+    EXPECT_EQ(jobs[1].voltageProbes[0].second.x, 17);
+    EXPECT_TRUE(jobs[0].cutLines.empty());
+    EXPECT_FALSE(jobs[0].sourceLead);
+    ASSERT_TRUE(jobs[1].sourceLead && jobs[1].drainLead);
+    EXPECT_EQ(jobs[1].sourceLead->x1, 2);
+    EXPECT_EQ(jobs[1].drainLead->x0, 18);
+    EXPECT_EQ(jobs[1].drainLead->y1, 9);
+    EXPECT_EQ(jobs[1].multigrid.cycle, Cycle::w);
+    EXPECT_DOUBLE_EQ(jobs[1].multigrid.tolerance, 1e-8);
+}
+
+TEST(Job, ParseErrors) {
+    std::istringstream unknownKey("[job a]\nwidht = 10\n");
+    EXPECT_THROW(parseJobs(unknownKey, "test"), std::invalid_argument);
+    std::istringstream noSection("width = 10\n");
+    EXPECT_THROW(parseJobs(noSection, "test"), std::invalid_argument);
+    std::istringstream badNumber("[job a]\nkappa = 2x\n");
+    EXPECT_THROW(parseJobs(badNumber, "test"), std::invalid_argument);
+    std::istringstream badPrecision("[job a]\nprecision = half\n");
+    EXPECT_THROW(parseJobs(badPrecision, "test"), std::invalid_argument);
+    std::istringstream badLinks("[job a]\nlinks = polar\n");
+    EXPECT_THROW(parseJobs(badLinks, "test"), std::invalid_argument);
+    std::istringstream badGauge("[job a]\ngauge = coulomb\n");
+    EXPECT_THROW(parseJobs(badGauge, "test"), std::invalid_argument);
+    std::istringstream badCut("[job a]\ncut = z 1 2 3\n");
+    EXPECT_THROW(parseJobs(badCut, "test"), std::invalid_argument);
+    std::istringstream shortProbe("[job a]\nprobe = 4\n");
+    EXPECT_THROW(parseJobs(shortProbe, "test"), std::invalid_argument);
+    std::istringstream badCycle("[job a]\ncycle = x\n");
+    EXPECT_THROW(parseJobs(badCycle, "test"), std::invalid_argument);
+    std::istringstream shortLead("[job a]\nsource = 1 1 2\n");
+    EXPECT_THROW(parseJobs(shortLead, "test"), std::invalid_argument);
+    std::istringstream negativeSeed("[job a]\nseed = -1\n");
+    EXPECT_THROW(parseJobs(negativeSeed, "test"), std::invalid_argument);
+}
+
+TEST(Job, Validation) {
+    Job job;
+    job.width = 20;
+    job.height = 20;
+    job.duration = 1.0;
+    job.output = "out";
+    EXPECT_NO_THROW(validateJob(job));
+    EXPECT_EQ(job.steps(), 100);
+
+    job.parameters.timeStep = 0.5;
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.parameters.timeStep = 0.01;
+    job.output = "";
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.output = "out";
+    job.geometry = "does/not/exist.txt";
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.geometry = "square";
+    job.nested.levels = -1;
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.nested = {2, 0.0};
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.nested = NestedIteration();
+    job.parameters.temporalBlocking = 0;
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.parameters.temporalBlocking = 1;
+
+    // Adaptive time steps need sensible bounds and no noise
+    job.adaptive = true;
+    EXPECT_NO_THROW(validateJob(job));
+    job.adaptiveParameters.tolerance = 0.0;
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.adaptiveParameters = {1e-3, 1e-2, 1e-3};
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.adaptiveParameters = AdaptiveParameters();
+    job.parameters.noise = 0.01;
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.parameters.noise = 0.0;
+    job.adaptive = false;
+
+    // Without screening the time step is not limited by kappa, but a current cannot be applied
+    job.parameters.screening = false;
+    job.parameters.kappa = 10.0;
+    EXPECT_NO_THROW(validateJob(job));
+    job.current = Schedule({{0.0, 0.0}, {1.0, 0.5}});
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+
+    // Unless it enters through leads, which must both be on the superconductor
+    job.sourceLead = Rectangle{1, 1, 2, 19};
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.drainLead = Rectangle{18, 1, 19, 19};
+    EXPECT_NO_THROW(validateJob(job));
+    EXPECT_EQ(job.leadMask(*job.sourceLead).count(), 18);
+    job.drainLead = Rectangle{18, 1, 21, 19};
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.drainLead = Rectangle{19, 0, 20, 20};
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.drainLead = Rectangle{18, 1, 19, 19};
+    job.multigrid.tolerance = 0.0;
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.multigrid = MultigridParameters();
+    job.parameters.screening = true;
+    job.parameters.kappa = 2.0;
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.parameters.screening = false;
+    job.parameters.kappa = 10.0;
+    job.sourceLead.reset();
+    job.drainLead.reset();
+    job.current = Schedule();
+
+    // Probes must be in the superconductor and cuts in the grid
+    job.probes.push_back({10, 10});
+    EXPECT_NO_THROW(validateJob(job));
+    job.probes.push_back({0, 10});
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.probes.pop_back();
+    job.cutLines.push_back({true, 19, 0, 20});
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.probes.clear();
+    job.cutLines.clear();
+
+    // An adaptive mesh runs without screening, on levels that fit the geometry
+    job.refine = true;
+    EXPECT_NO_THROW(validateJob(job));
+    job.refinement.levels = 5;
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.refinement = RefinementParameters();
+    job.probes.push_back({10, 10});
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.probes.clear();
+    job.singlePrecision = true;
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+    job.singlePrecision = false;
+    job.parameters.screening = true;
+    job.parameters.kappa = 2.0;
+    EXPECT_THROW(validateJob(job), std::invalid_argument);
+}
+
+TEST(Job, ReadMask) {
+    std::istringstream in("....\n"
+                          ".##.\n"
+                          ".#..\n"
+                          "....\n");
+    Mask mask = readMask(in);
+    EXPECT_EQ(mask.width(), 4);
+    EXPECT_EQ(mask.height(), 4);
+    EXPECT_EQ(mask(1, 1), true);
+    EXPECT_EQ(mask(2, 1), false);
+    EXPECT_EQ(mask(2, 2), true);
+
+    std::istringstream ragged("...\n....\n");
+    EXPECT_THROW(readMask(ragged), std::invalid_argument);
+}
@@ -0,0 +1,446 @@
+#include "../googletest/include/gtest/gtest.h"
+#include "../include/Kernels.h"
+#include "../include/Noise.h"
+#include <cmath>
+#include <sstream>
+#include <vector>
+
+namespace {
+    typedef std::complex<double> complex;
+
+    constexpr kernels::InstructionSet allInstructionSets[] = {
+            kernels::InstructionSet::scalar, kernels::InstructionSet::sse42, kernels::InstructionSet::avx2,
+            kernels::InstructionSet::avx512};
+
+    /**
+     * @brief Reproducible values of modulus around 1, so that products neither vanish nor blow up.
+     */
+    std::vector<complex> phasors(std::size_t n, double seed) {
+        std::vector<complex> values(n);
+        for (std::size_t i = 0; i < n; i++) {
+            values[i] = std::polar(0.8 + 0.2 * std::sin(seed * i), std::cos(seed + 0.37 * i) * 3.0);
+        }
+        return values;
+    }
+
+    /**
+     * @brief phasors() rounded to a storage precision.
+     */
+    template<typename real>
+    std::vector<std::complex<real>> phasors(std::size_t n, double seed) {
+        std::vector<complex> values = phasors(n, seed);
+        return std::vector<std::complex<real>>(values.begin(), values.end());
+    }
+
+    /**
+     * @brief Unit-modulus phasors, stored as a link type.
+     */
+    template<typename link>
+    std::vector<link> links(std::size_t n, double seed) {
+        std::vector<complex> values = phasors(n, seed);
+        std::vector<link> result(n);
+        for (std::size_t i = 0; i < n; i++) {
+            if constexpr (std::is_same_v<link, Phase>) {
+                result[i] = Phase::of(values[i]);
+            } else {
+                result[i] = link(values[i] / std::abs(values[i]));
+            }
+        }
+        return result;
+    }
+
+    /**
+     * @brief A link as a phasor, to compare link types.
+     */
+    template<typename link>
+    complex phasor(const link &value) {
+        if constexpr (std::is_same_v<link, Phase>) {
+            return value.phasor();
+        } else {
+            return complex(value);
+        }
+    }
+
+    /**
+     * @brief A solver state on a grid with odd dimensions, to exercise the remainder loops of every vector width.
+     */
+    template<typename real, typename link = std::complex<real>>
+    struct State {
+        static constexpr std::size_t width = 37;
+        static constexpr std::size_t height = 29;
+        std::vector<real> cellWeight = std::vector<real>(width * height, 0);
+        std::vector<real> linkWeightX = std::vector<real>((width - 1) * height, 0);
+        std::vector<real> linkWeightY = std::vector<real>(width * (height - 1), 0);
+        std::vector<std::complex<real>> psi = phasors<real>(width * height, 0.3);
+        std::vector<std::complex<real>> next = std::vector<std::complex<real>>(width * height);
+        std::vector<link> ux = links<link>((width - 1) * height, 0.7);
+        std::vector<link> uy = links<link>(width * (height - 1), 1.1);
+        std::vector<link> flux = std::vector<link>((width - 1) * (height - 1));
+        std::vector<real> field = std::vector<real>((width - 1) * (height - 1));
+
+        State() {
+            for (std::size_t x = 1; x + 1 < width; x++) {
+                for (std::size_t y = 1; y + 1 < height; y++) {
+                    cellWeight[x * height + y] = (x * y) % 7 == 3 ? 0 : 1;
+                }
+            }
+            for (std::size_t x = 0; x + 1 < width; x++) {
+                for (std::size_t y = 0; y < height; y++) {
+                    linkWeightX[x * height + y] = cellWeight[x * height + y] * cellWeight[(x + 1) * height + y];
+                }
+            }
+            for (std::size_t x = 0; x < width; x++) {
+                for (std::size_t y = 0; y + 1 < height; y++) {
+                    linkWeightY[x * (height - 1) + y] = cellWeight[x * height + y] * cellWeight[x * height + y + 1];
+                }
+            }
+        }
+
+        kernels::SolverArguments<real, link> arguments() {
+            return {width, height, 0.5, 0.01, 2.0, 0.3, 0.1, cellWeight.data(), linkWeightX.data(),
+                    linkWeightY.data(), psi.data(), next.data(), ux.data(), uy.data(), flux.data(), field.data()};
+        }
+
+        void step(const kernels::SolverKernels<real, link> &kernels) {
+            kernels.fluxCells(arguments());
+            kernels.orderParameter(arguments());
+            kernels.linkingVariables(arguments());
+        }
+    };
+
+    template<typename T>
+    double maximumDifference(const std::vector<T> &a, const std::vector<T> &b) {
+        double difference = 0.0;
+        for (std::size_t i = 0; i < a.size(); i++) {
+            difference = std::max(difference, static_cast<double>(std::abs(a[i] - b[i])));
+        }
+        return difference;
+    }
+}
+
+TEST(Kernels, Select) {
+    std::ostringstream warnings;
+    EXPECT_EQ(kernels::select("scalar", warnings), kernels::InstructionSet::scalar);
+    EXPECT_TRUE(warnings.str().empty());
+
+    kernels::InstructionSet widest = kernels::select(nullptr, warnings);
+    EXPECT_TRUE(kernels::supported(widest));
+    EXPECT_TRUE(warnings.str().empty());
+
+    EXPECT_EQ(kernels::select("neon", warnings), widest);
+    EXPECT_FALSE(warnings.str().empty());
+
+    // A request beyond the CPU falls back to the widest supported set, never to a wider one
+    std::ostringstream fallback;
+    kernels::InstructionSet avx2 = kernels::select("avx2", fallback);
+    EXPECT_LE(avx2, kernels::InstructionSet::avx2);
+    EXPECT_EQ(fallback.str().empty(), kernels::supported(kernels::InstructionSet::avx2));
+
+    EXPECT_TRUE(kernels::supported(kernels::active().instructionSet));
+    EXPECT_STREQ(kernels::name(kernels::InstructionSet::sse42), "sse4.2");
+}
+
+TEST(Kernels, ElementwiseVariantsAgree) {
+    const std::size_t n = 1031;
+    std::vector<complex> a = phasors(n, 0.5);
+    std::vector<complex> b = phasors(n, 0.9);
+    const complex value(0.25, -1.5);
+    const kernels::KernelTable &reference = kernels::table(kernels::InstructionSet::scalar);
+
+    std::vector<complex> expectedProduct(n), expectedSum(n), expectedScaled(n);
+    reference.complexField.multiply(a.data(), b.data(), expectedProduct.data(), n);
+    reference.complexField.add(a.data(), b.data(), expectedSum.data(), n);
+    reference.complexField.multiplyScalar(a.data(), value, expectedScaled.data(), n);
+    EXPECT_LT(std::abs(expectedProduct[17] - a[17] * b[17]), 1e-15);
+    EXPECT_EQ(expectedSum[17], a[17] + b[17]);
+
+    for (kernels::InstructionSet instructionSet : allInstructionSets) {
+        if (!kernels::supported(instructionSet)) {
+            continue;
+        }
+        SCOPED_TRACE(kernels::name(instructionSet));
+        const kernels::KernelTable &table = kernels::table(instructionSet);
+        EXPECT_EQ(table.instructionSet, instructionSet);
+
+        std::vector<complex> product(n), sum(n), scaled(n);
+        table.complexField.multiply(a.data(), b.data(), product.data(), n);
+        table.complexField.add(a.data(), b.data(), sum.data(), n);
+        table.complexField.multiplyScalar(a.data(), value, scaled.data(), n);
+        EXPECT_LT(maximumDifference(product, expectedProduct), 1e-14);
+        EXPECT_EQ(maximumDifference(sum, expectedSum), 0.0);
+        EXPECT_LT(maximumDifference(scaled, expectedScaled), 1e-14);
+
+        // n is not a multiple of the word size, the padding bits must stay 0
+        const std::size_t words = (n + 63) / 64;
+        std::vector<std::uint64_t> mask(words, 0x9249249249249249u), inverse(words), either(words);
+        mask.back() &= (std::uint64_t(1) << (n % 64)) - 1;
+        table.maskNot(mask.data(), inverse.data(), n);
+        table.maskOr(mask.data(), inverse.data(), either.data(), n);
+        for (std::size_t i = 0; i + 1 < words; i++) {
+            ASSERT_EQ(inverse[i], ~mask[i]);
+            ASSERT_EQ(either[i], ~std::uint64_t(0));
+        }
+        EXPECT_EQ(either.back(), (std::uint64_t(1) << (n % 64)) - 1);
+
+        // The masked kernels touch exactly the set bits; the mask has full, empty and mixed words
+        mask[1] = ~std::uint64_t(0);
+        mask[2] = 0;
+        std::vector<complex> filled = b, copied = b, scaledMasked = b;
+        table.complexField.fillMasked(filled.data(), mask.data(), value, n);
+        table.complexField.copyMasked(a.data(), mask.data(), copied.data(), n);
+        table.complexField.multiplyScalarMasked(scaledMasked.data(), mask.data(), value, n);
+        for (std::size_t i = 0; i < n; i++) {
+            const bool set = (mask[i / 64] >> (i % 64)) & 1u;
+            ASSERT_EQ(filled[i], set ? value : b[i]);
+            ASSERT_EQ(copied[i], set ? a[i] : b[i]);
+            ASSERT_LT(std::abs(scaledMasked[i] - (set ? b[i] * value : b[i])), 1e-14);
+        }
+
+        std::vector<double> real(n), expectedReal(n);
+        for (std::size_t i = 0; i < n; i++) {
+            real[i] = expectedReal[i] = a[i].real();
+            if ((mask[i / 64] >> (i % 64)) & 1u) {
+                expectedReal[i] *= -2.5;
+            }
+        }
+        table.realField.multiplyScalarMasked(real.data(), mask.data(), -2.5, n);
+        EXPECT_EQ(real, expectedReal);
+    }
+}
+
+TEST(Kernels, ReductionVariantsAgree) {
+    // Odd lengths exercise the tail, which must land in the same lanes as the vectorized part
+    const std::size_t n = 1031;
+    std::vector<complex> a = phasors(n, 0.5);
+    std::vector<complex> b = phasors(n, 0.9);
+    const auto *x = reinterpret_cast<const double *>(a.data());
+    const auto *y = reinterpret_cast<const double *>(b.data());
+    const std::size_t words = (n + 63) / 64;
+    std::vector<std::uint64_t> mask(words, 0x9249249249249249u);
+    mask.back() &= (std::uint64_t(1) << (n % 64)) - 1;
+
+    const kernels::ReductionKernels &reference = kernels::table(kernels::InstructionSet::scalar).reductions;
+    double expectedSum[kernels::reductionLanes], expectedDot[kernels::reductionLanes];
+    double expectedMasked[kernels::reductionLanes];
+    reference.sum(x, 2 * n - 1, expectedSum);
+    reference.dot(x, y, 2 * n, expectedDot);
+    reference.maskedSumComplex(x, mask.data(), 0, n, expectedMasked);
+    double lane = 0.0;
+    for (std::size_t i = 3; i < 2 * n - 1; i += kernels::reductionLanes) {
+        lane += x[i];
+    }
+    EXPECT_EQ(expectedSum[3], lane);
+    std::uint64_t bits = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        bits += (mask[i / 64] >> (i % 64)) & 1;
+    }
+    EXPECT_EQ(reference.popcount(mask.data(), words), bits);
+    EXPECT_NEAR(reference.maxNorm(x, n), 1.0, 1e-9);
+
+    for (kernels::InstructionSet instructionSet : allInstructionSets) {
+        if (!kernels::supported(instructionSet)) {
+            continue;
+        }
+        SCOPED_TRACE(kernels::name(instructionSet));
+        const kernels::ReductionKernels &table = kernels::table(instructionSet).reductions;
+        double sum[kernels::reductionLanes], dot[kernels::reductionLanes], masked[kernels::reductionLanes];
+        table.sum(x, 2 * n - 1, sum);
+        table.dot(x, y, 2 * n, dot);
+        table.maskedSumComplex(x, mask.data(), 0, n, masked);
+        for (std::size_t j = 0; j < kernels::reductionLanes; j++) {
+            EXPECT_EQ(sum[j], expectedSum[j]);
+            EXPECT_NEAR(dot[j], expectedDot[j], 1e-12);
+            EXPECT_EQ(masked[j], expectedMasked[j]);
+        }
+        EXPECT_EQ(table.maxAbs(x, 2 * n), reference.maxAbs(x, 2 * n));
+        EXPECT_EQ(table.popcount(mask.data(), words), reference.popcount(mask.data(), words));
+    }
+}
+
+TEST(Kernels, SolverVariantsAgree) {
+    State<double> expected;
+    const kernels::KernelTable &reference = kernels::table(kernels::InstructionSet::scalar);
+    for (int n = 0; n < 10; n++) {
+        expected.step(reference.doublePrecision);
+        std::swap(expected.psi, expected.next);
+    }
+
+    for (kernels::InstructionSet instructionSet : allInstructionSets) {
+        if (!kernels::supported(instructionSet)) {
+            continue;
+        }
+        SCOPED_TRACE(kernels::name(instructionSet));
+        State<double> state;
+        for (int n = 0; n < 10; n++) {
+            state.step(kernels::table(instructionSet).doublePrecision);
+            std::swap(state.psi, state.next);
+        }
+        EXPECT_LT(maximumDifference(state.psi, expected.psi), 1e-12);
+        EXPECT_LT(maximumDifference(state.ux, expected.ux), 1e-12);
+        EXPECT_LT(maximumDifference(state.uy, expected.uy), 1e-12);
+        EXPECT_LT(maximumDifference(state.field, expected.field), 1e-10);
+    }
+}
+
+TEST(Kernels, ScalarPotentialVariantsAgree) {
+    // The divergence against a direct sum over the bonds, and one multigrid smooth and residual per colour
+    State<double> reference;
+    const std::size_t W = State<double>::width;
+    const std::size_t H = State<double>::height;
+    std::vector<double> expected(W * H, 0.0);
+    for (std::size_t x = 1; x + 1 < W; x++) {
+        for (std::size_t y = 1; y + 1 < H; y++) {
+            const std::size_t i = x * H + y;
+            const std::size_t j = x * (H - 1) + y;
+            const complex bonds[] = {
+                    reference.linkWeightX[i] * reference.ux[i] * reference.psi[i + H],
+                    reference.linkWeightX[i - H] * std::conj(reference.ux[i - H]) * reference.psi[i - H],
+                    reference.linkWeightY[j] * reference.uy[j] * reference.psi[i + 1],
+                    reference.linkWeightY[j - 1] * std::conj(reference.uy[j - 1]) * reference.psi[i - 1]};
+            for (const complex &bond : bonds) {
+                expected[i] += std::imag(std::conj(reference.psi[i]) * bond);
+            }
+        }
+    }
+    std::vector<double> potential(W * H);
+    for (std::size_t i = 0; i < W * H; i++) {
+        potential[i] = std::sin(0.1 * i);
+    }
+
+    std::vector<double> conductanceX(reference.cellWeight.size());
+    std::vector<double> conductanceY(reference.cellWeight.size());
+    std::vector<double> inverseDiagonal(reference.cellWeight.size(), 0.0);
+    for (std::size_t x = 1; x + 1 < W; x++) {
+        for (std::size_t y = 1; y + 1 < H; y++) {
+            const std::size_t i = x * H + y;
+            conductanceX[i] = x + 2 < W ? reference.cellWeight[i] * reference.cellWeight[i + H] : 0.0;
+            conductanceY[i] = y + 2 < H ? reference.cellWeight[i] * reference.cellWeight[i + 1] : 0.0;
+        }
+    }
+    for (std::size_t x = 1; x + 1 < W; x++) {
+        for (std::size_t y = 1; y + 1 < H; y++) {
+            const std::size_t i = x * H + y;
+            const double diagonal = conductanceX[i] + conductanceX[i - H] + conductanceY[i] + conductanceY[i - 1];
+            inverseDiagonal[i] = diagonal > 0.0 ? 1.0 / diagonal : 0.0;
+        }
+    }
+    auto multigrid = [&](const kernels::MultigridKernels &table) {
+        std::vector<double> phi = potential;
+        std::vector<double> residual(W * H);
+        const kernels::MultigridArguments arguments{W, H, conductanceX.data(), conductanceY.data(),
+                                                    inverseDiagonal.data(), expected.data(), phi.data(),
+                                                    residual.data()};
+        table.smooth(arguments, 0);
+        table.smooth(arguments, 1);
+        table.residual(arguments);
+        return residual;
+    };
+    const std::vector<double> expectedResidual = multigrid(kernels::table(kernels::InstructionSet::scalar).multigrid);
+
+    for (kernels::InstructionSet instructionSet : allInstructionSets) {
+        if (!kernels::supported(instructionSet)) {
+            continue;
+        }
+        SCOPED_TRACE(kernels::name(instructionSet));
+        const kernels::KernelTable &table = kernels::table(instructionSet);
+        State<double> state;
+        std::vector<double> divergence(W * H, 1.0);
+        table.doublePrecision.supercurrentDivergence(state.arguments(), divergence.data());
+        EXPECT_LT(maximumDifference(divergence, expected), 1e-12);
+
+        state.next = state.psi;
+        table.doublePrecision.scalarPotential(state.arguments(), potential.data());
+        double difference = 0.0;
+        for (std::size_t i = 0; i < W * H; i++) {
+            const complex rotated = state.psi[i] * std::polar(1.0, -0.01 * potential[i]);
+            difference = std::max(difference, std::abs(state.next[i] - rotated));
+        }
+        EXPECT_LT(difference, 1e-12);
+        EXPECT_LT(maximumDifference(multigrid(table.multigrid), expectedResidual), 1e-12);
+    }
+}
+
+TEST(Kernels, NoiseMatchesReference) {
+    State<double> reference;
+    for (kernels::InstructionSet instructionSet : allInstructionSets) {
+        if (!kernels::supported(instructionSet)) {
+            continue;
+        }
+        SCOPED_TRACE(kernels::name(instructionSet));
+        State<double> state;
+        kernels::SolverArguments<double> arguments = state.arguments();
+        arguments.noiseAmplitude = 0.5;
+        arguments.seed = 0x123456789abcdefull;
+        arguments.step = 77;
+        kernels::table(instructionSet).doublePrecision.thermalNoise(arguments);
+
+        double difference = 0.0;
+        for (std::size_t i = 0; i < state.psi.size(); i++) {
+            const complex expected = reference.cellWeight[i] * 0.5 * noise::gaussian(arguments.seed, 77, i);
+            difference = std::max(difference, std::abs(state.next[i] - expected));
+        }
+        EXPECT_LT(difference, 1e-12);
+    }
+}
+
+TEST(Kernels, SinglePrecisionTracksDouble) {
+    State<double> expected;
+    State<float> state;
+    for (int n = 0; n < 10; n++) {
+        expected.step(kernels::active().doublePrecision);
+        state.step(kernels::active().singlePrecision);
+        std::swap(expected.psi, expected.next);
+        std::swap(state.psi, state.next);
+    }
+
+    // Computing in double, the stored state is off by a few float roundings per step rather than drifting away
+    auto difference = [](const auto &single, const auto &reference) {
+        double maximum = 0.0;
+        for (std::size_t i = 0; i < reference.size(); i++) {
+            maximum = std::max(maximum, std::abs(std::complex<double>(single[i]) - std::complex<double>(reference[i])));
+        }
+        return maximum;
+    };
+    EXPECT_LT(difference(state.psi, expected.psi), 1e-5);
+    EXPECT_LT(difference(state.ux, expected.ux), 1e-5);
+    EXPECT_LT(difference(state.uy, expected.uy), 1e-5);
+    EXPECT_LT(difference(state.field, expected.field), 1e-4);
+}
+
+TEST(Kernels, PhaseLinksTrackComplexLinks) {
+    State<double> expected;
+    State<double, Phase> state;
+    for (int n = 0; n < 10; n++) {
+        expected.step(kernels::active().doublePrecision);
+        state.step(kernels::active().doublePrecisionPhases);
+        std::swap(expected.psi, expected.next);
+        std::swap(state.psi, state.next);
+    }
+
+    // Quantizing every link update to 2 pi / 2^32 costs a few 1e-9 radians over ten steps
+    auto difference = [](const auto &phases, const auto &reference) {
+        double maximum = 0.0;
+        for (std::size_t i = 0; i < reference.size(); i++) {
+            maximum = std::max(maximum, std::abs(phasor(phases[i]) - reference[i]));
+        }
+        return maximum;
+    };
+    EXPECT_LT(maximumDifference(state.psi, expected.psi), 1e-7);
+    EXPECT_LT(difference(state.ux, expected.ux), 1e-7);
+    EXPECT_LT(difference(state.uy, expected.uy), 1e-7);
+    EXPECT_LT(maximumDifference(state.field, expected.field), 1e-6);
+
+    for (kernels::InstructionSet instructionSet : allInstructionSets) {
+        if (!kernels::supported(instructionSet)) {
+            continue;
+        }
+        SCOPED_TRACE(kernels::name(instructionSet));
+        State<float, Phase> single;
+        for (int n = 0; n < 10; n++) {
+            single.step(kernels::table(instructionSet).singlePrecisionPhases);
+            std::swap(single.psi, single.next);
+        }
+        EXPECT_LT(difference(single.ux, expected.ux), 1e-5);
+        EXPECT_LT(difference(single.uy, expected.uy), 1e-5);
+    }
+}
@@ -0,0 +1,196 @@
+#include "../googletest/include/gtest/gtest.h"
+#include "../include/Geometry.h"
+#include "../include/Multigrid.h"
+#include <cmath>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace {
+    Mask interior(int width, int height) {
+        Mask mask(width, height);
+        for (int x = 1; x + 1 < width; x++) {
+            for (int y = 1; y + 1 < height; y++) {
+                mask(x, y) = true;
+            }
+        }
+        return mask;
+    }
+
+    /**
+     * @brief A dipole: a unit source at one point and a unit sink at another.
+     */
+    RealField dipole(int width, int height, std::size_t x0, std::size_t y0, std::size_t x1, std::size_t y1) {
+        RealField source(width, height);
+        source.fill(0.0);
+        source(x0, y0) = 1.0;
+        source(x1, y1) = -1.0;
+        return source;
+    }
+
+    /**
+     * @brief The largest difference between L phi and the source, relative to the largest source.
+     */
+    double defect(Multigrid &multigrid, const RealField &potential, const RealField &source) {
+        RealField applied(potential.width(), potential.height());
+        multigrid.apply(potential, applied);
+        double error = 0.0;
+        for (std::size_t i = 0; i < source.size(); i++) {
+            error = std::max(error, std::abs(applied.data()[i] - source.data()[i]));
+        }
+        return error / source.maxAbs();
+    }
+}
+
+TEST(Multigrid, SolvesSquare) {
+    for (Cycle cycle : {Cycle::v, Cycle::w, Cycle::f}) {
+        MultigridParameters parameters;
+        parameters.cycle = cycle;
+        parameters.tolerance = 1e-6;
+        Multigrid multigrid(interior(65, 65), parameters);
+        EXPECT_GE(multigrid.levels(), 4u);
+
+        RealField source = dipole(65, 65, 10, 20, 50, 40);
+        RealField potential(65, 65);
+        potential.fill(0.0);
+        const int cycles = multigrid.solve(potential, source);
+        EXPECT_LE(cycles, 12);
+        EXPECT_LE(multigrid.residual(), parameters.tolerance);
+        EXPECT_LT(defect(multigrid, potential, source), 1e-5);
+        EXPECT_GT(potential(10, 20), potential(50, 40));
+        EXPECT_EQ(potential(0, 30), 0.0);
+    }
+}
+
+TEST(Multigrid, SolvesSquid) {
+    // The bars between the holes and the slots do not leak corrections
+    Mask mask = Geometry::squidMask(96, 64);
+    MultigridParameters parameters;
+    parameters.tolerance = 1e-6;
+    Multigrid multigrid(mask, parameters);
+    RealField source(96, 64);
+    source.fill(0.0);
+    // Into the left arm of the loop and out of the right
+    for (int y = 1; y < 63; y++) {
+        if (mask(12, y)) {
+            source(12, y) = 1.0;
+        }
+        if (mask(83, y)) {
+            source(83, y) = -1.0;
+        }
+    }
+    ASSERT_GT(source.maxAbs(), 0.0);
+    RealField potential(96, 64);
+    potential.fill(0.0);
+    EXPECT_LE(multigrid.solve(potential, source), 10);
+    EXPECT_LT(defect(multigrid, potential, source), 1e-5);
+
+    double mean = 0.0;
+    for (std::size_t i = 0; i < potential.size(); i++) {
+        mean += potential.data()[i];
+    }
+    EXPECT_NEAR(mean, 0.0, 1e-9);
+}
+
+TEST(Multigrid, CyclesIndependentOfSize) {
+    int first = 0;
+    for (int n : {33, 65, 129, 257}) {
+        Multigrid multigrid(interior(n, n));
+        RealField source = dipole(n, n, n / 4, n / 3, 3 * n / 4, 2 * n / 3);
+        RealField potential(n, n);
+        potential.fill(0.0);
+        const int cycles = multigrid.solve(potential, source);
+        if (first == 0) {
+            first = cycles;
+        }
+        EXPECT_LE(cycles, first + 2) << n;
+    }
+}
+
+TEST(Multigrid, WarmStart) {
+    Multigrid multigrid(interior(65, 65));
+    RealField source = dipole(65, 65, 10, 20, 50, 40);
+    RealField potential(65, 65);
+    potential.fill(0.0);
+    const int cold = multigrid.solve(potential, source);
+    source(11, 20) = 0.01;
+    source(50, 41) = -0.01;
+    EXPECT_LT(multigrid.solve(potential, source), cold);
+    EXPECT_EQ(multigrid.solve(potential, source), 0);
+}
+
+TEST(Multigrid, DisconnectedParts) {
+    // Two strips, with a source of nonzero mean on each: only its zero-mean part can be solved for
+    Mask mask(40, 20);
+    for (int x = 1; x < 39; x++) {
+        for (int y : {2, 3, 4, 5, 12, 13, 14}) {
+            mask(x, y) = true;
+        }
+    }
+    MultigridParameters parameters;
+    parameters.tolerance = 1e-6;
+    Multigrid multigrid(mask, parameters);
+    RealField source(40, 20);
+    source.fill(0.0);
+    source(5, 3) = 1.0;
+    source(30, 13) = 2.0;
+    source(10, 14) = -1.0;
+    RealField potential(40, 20);
+    potential.fill(0.0);
+    multigrid.solve(potential, source);
+    EXPECT_LE(multigrid.residual(), 1e-6);
+
+    double lower = 0.0;
+    double upper = 0.0;
+    for (int x = 0; x < 40; x++) {
+        for (int y = 0; y < 20; y++) {
+            (y < 10 ? lower : upper) += potential(x, y);
+        }
+    }
+    EXPECT_NEAR(lower, 0.0, 1e-9);
+    EXPECT_NEAR(upper, 0.0, 1e-9);
+    EXPECT_GT(potential(30, 13), potential(10, 14));
+}
+
+TEST(Multigrid, IndependentOfThreads) {
+#ifdef _OPENMP
+    // Large enough for the parallel updates, transfers and blocked projections on the finer levels
+    const int width = 300;
+    const int height = 200;
+    Mask mask = Geometry::squidMask(width, height);
+    RealField source = dipole(width, height, 50, 100, 250, 60);
+
+    const int threads = omp_get_max_threads();
+    RealField results[2] = {RealField(width, height), RealField(width, height)};
+    int cycles[2];
+    for (int run = 0; run < 2; run++) {
+        omp_set_num_threads(run == 0 ? 1 : 64);
+        Multigrid multigrid(mask);
+        results[run].fill(0.0);
+        cycles[run] = multigrid.solve(results[run], source);
+    }
+    omp_set_num_threads(threads);
+    EXPECT_GT(cycles[0], 0);
+    EXPECT_EQ(cycles[0], cycles[1]);
+    int differences = 0;
+    for (std::size_t i = 0; i < results[0].size(); i++) {
+        differences += results[0].data()[i] != results[1].data()[i];
+    }
+    EXPECT_EQ(differences, 0);
+#else
+    GTEST_SKIP() << "Built without OpenMP";
+#endif
+}
+
+TEST(Multigrid, ZeroSource) {
+    Multigrid multigrid(interior(20, 20));
+    RealField source(20, 20);
+    source.fill(0.0);
+    RealField potential(20, 20);
+    potential.fill(1.0);
+    EXPECT_EQ(multigrid.solve(potential, source), 0);
+    EXPECT_EQ(potential.maxAbs(), 0.0);
+    RealField wrong(21, 20);
+    EXPECT_THROW(multigrid.solve(wrong, source), std::invalid_argument);
+}
@@ -0,0 +1,189 @@
+#include "../googletest/include/gtest/gtest.h"
+#include "../include/Gauge.h"
+#include "../include/Multiresolution.h"
+#include <cmath>
+
+namespace {
+    /**
+     * @brief The counterclockwise angle around plaquette (x, y), in [-pi, pi].
+     */
+    double plaquetteAngle(const Superconductor &superconductor, std::size_t x, std::size_t y) {
+        Superconductor &state = const_cast<Superconductor &>(superconductor);
+        const Field &ux = state.linkingVariableX();
+        const Field &uy = state.linkingVariableY();
+        return std::arg(ux(x, y) * uy(x + 1, y) * std::conj(ux(x, y + 1)) * std::conj(uy(x, y)));
+    }
+
+    /**
+     * @brief A coarse state in the Landau gauge of a field, with a vortex-like phase winding around its centre.
+     */
+    Superconductor windingState(int width, int height, double field, double gridSpacing) {
+        Superconductor superconductor(width, height);
+        gauge::uniformField(field, Gauge::landau, gridSpacing, superconductor.linkingVariableX(),
+                            superconductor.linkingVariableY());
+        for (int x = 1; x + 1 < width; x++) {
+            for (int y = 1; y + 1 < height; y++) {
+                const double dx = x - 0.5 * width + 0.3;
+                const double dy = y - 0.5 * height + 0.2;
+                const double r = std::hypot(dx, dy);
+                superconductor.orderParameter()(x, y) = std::polar(std::tanh(r), std::atan2(dy, dx));
+            }
+        }
+        return superconductor;
+    }
+
+    /**
+     * @brief Multiplies psi by exp(i chi) and the links by exp(i (chi_i - chi_j)), for a smooth but large chi.
+     */
+    void transform(Superconductor &superconductor) {
+        auto chi = [](std::size_t x, std::size_t y) {
+            return 2.7 * std::sin(0.9 * x) + 1.9 * std::cos(1.3 * y) + 0.4 * x * y;
+        };
+        const std::size_t width = superconductor.width();
+        const std::size_t height = superconductor.height();
+        for (std::size_t x = 0; x < width; x++) {
+            for (std::size_t y = 0; y < height; y++) {
+                superconductor.orderParameter()(x, y) *= std::polar(1.0, chi(x, y));
+                if (x + 1 < width) {
+                    superconductor.linkingVariableX()(x, y) *= std::polar(1.0, chi(x, y) - chi(x + 1, y));
+                }
+                if (y + 1 < height) {
+                    superconductor.linkingVariableY()(x, y) *= std::polar(1.0, chi(x, y) - chi(x, y + 1));
+                }
+            }
+        }
+    }
+}
+
+TEST(Multiresolution, Coarsen) {
+    Geometry square(20, 13);
+    Geometry coarse = multiresolution::coarsen(square);
+    ASSERT_EQ(coarse.width(), 11);
+    ASSERT_EQ(coarse.height(), 7);
+    EXPECT_FALSE(coarse.inSuperconductor(0, 3));
+    EXPECT_FALSE(coarse.inSuperconductor(10, 3));
+    EXPECT_FALSE(coarse.inSuperconductor(5, 6));
+    EXPECT_TRUE(coarse.inSuperconductor(1, 1));
+    EXPECT_TRUE(coarse.inSuperconductor(9, 5));
+
+    // Both holes of the SQUID are wider than two grid points
+    Geometry squid(128, 64);
+    squid.setGeometry(Geometry::squidMask(128, 64));
+    EXPECT_EQ(multiresolution::coarsen(squid).holeCount(), 2);
+}
+
+TEST(Multiresolution, ProlongateUniform) {
+    Geometry geometry(24, 17);
+    Superconductor coarse(13, 9);
+    Superconductor fine(24, 17);
+    coarse.orderParameter().fill(1.0);
+    multiresolution::prolongate(coarse, fine, geometry);
+
+    for (int x = 0; x < 24; x++) {
+        for (int y = 0; y < 17; y++) {
+            const complex expected = geometry.inSuperconductor(x, y) ? 1.0 : 0.0;
+            EXPECT_NEAR(std::abs(fine.orderParameter()(x, y) - expected), 0.0, 1e-15);
+        }
+    }
+    EXPECT_NEAR(std::abs(fine.linkingVariableX()(11, 7) - 1.0), 0.0, 1e-15);
+    EXPECT_NEAR(std::abs(fine.linkingVariableY()(22, 15) - 1.0), 0.0, 1e-15);
+
+    Superconductor wrong(12, 9);
+    EXPECT_THROW(multiresolution::prolongate(wrong, fine, geometry), std::invalid_argument);
+}
+
+TEST(Multiresolution, ProlongationSplitsFlux) {
+    // Odd and even widths, and a field with over a turn of phase on the coarse links far from y = 0
+    for (int width : {30, 31}) {
+        const double h = 0.5;
+        const double field = 0.6;
+        Geometry geometry(width, 22);
+        Superconductor coarse = windingState(width / 2 + 1, 12, field, 2.0 * h);
+        Superconductor fine(width, 22);
+        multiresolution::prolongate(coarse, fine, geometry);
+
+        double error = 0.0;
+        for (int x = 0; x + 1 < width; x++) {
+            for (int y = 0; y + 1 < 22; y++) {
+                error = std::max(error, std::abs(std::remainder(plaquetteAngle(fine, x, y) + field * h * h,
+                                                                2.0 * M_PI)));
+            }
+        }
+        EXPECT_LT(error, 1e-12) << "width " << width;
+    }
+}
+
+TEST(Multiresolution, ProlongationIsGaugeCovariant) {
+    Geometry geometry(30, 22);
+    Superconductor coarse = windingState(16, 12, 0.4, 1.0);
+    Superconductor transformed = coarse;
+    transform(transformed);
+    Superconductor fine(30, 22);
+    Superconductor fineTransformed(30, 22);
+    multiresolution::prolongate(coarse, fine, geometry);
+    multiresolution::prolongate(transformed, fineTransformed, geometry);
+
+    // The modulus of psi and the bond products conj(psi_i) U_ij psi_j are gauge invariant
+    const Field &psi = fine.orderParameter();
+    const Field &other = fineTransformed.orderParameter();
+    double error = 0.0;
+    for (std::size_t x = 0; x + 1 < 30; x++) {
+        for (std::size_t y = 0; y + 1 < 22; y++) {
+            error = std::max(error, std::abs(std::abs(psi(x, y)) - std::abs(other(x, y))));
+            const complex bondX = std::conj(psi(x, y)) * fine.linkingVariableX()(x, y) * psi(x + 1, y);
+            const complex otherX = std::conj(other(x, y)) * fineTransformed.linkingVariableX()(x, y) * other(x + 1, y);
+            const complex bondY = std::conj(psi(x, y)) * fine.linkingVariableY()(x, y) * psi(x, y + 1);
+            const complex otherY = std::conj(other(x, y)) * fineTransformed.linkingVariableY()(x, y) * other(x, y + 1);
+            error = std::max(error, std::max(std::abs(bondX - otherX), std::abs(bondY - otherY)));
+        }
+    }
+    EXPECT_LT(error, 1e-12);
+    EXPECT_GT(std::abs(psi(15, 11)), 0.1);
+}
+
+TEST(Multiresolution, ToAppliedGauge) {
+    Superconductor state = windingState(20, 14, 0.5, 0.5);
+    Superconductor original = state;
+    multiresolution::toAppliedGauge(state, 0.5, Gauge::symmetric, 0.5);
+
+    Field expectedX(19, 14);
+    Field expectedY(20, 13);
+    gauge::uniformField(0.5, Gauge::symmetric, 0.5, expectedX, expectedY);
+    double error = 0.0;
+    for (std::size_t x = 0; x + 1 < 20; x++) {
+        for (std::size_t y = 0; y < 14; y++) {
+            error = std::max(error, std::abs(state.linkingVariableX()(x, y) - expectedX(x, y)));
+            const complex bond = std::conj(state.orderParameter()(x, y)) * state.linkingVariableX()(x, y)
+                                 * state.orderParameter()(x + 1, y);
+            const complex expected = std::conj(original.orderParameter()(x, y)) * original.linkingVariableX()(x, y)
+                                     * original.orderParameter()(x + 1, y);
+            error = std::max(error, std::abs(bond - expected));
+        }
+    }
+    EXPECT_LT(error, 1e-12);
+}
+
+TEST(Multiresolution, StartsNearEquilibrium) {
+    // Without screening, at a field that lets vortices in
+    SolverParameters parameters;
+    parameters.screening = false;
+    const double field = 0.4;
+    Geometry geometry(49, 49);
+
+    auto relax = [&](int levels, double duration) {
+        Superconductor superconductor(49, 49);
+        Solver solver(superconductor, geometry, parameters);
+        solver.initialize();
+        multiresolution::initialize(superconductor, geometry, parameters, NestedIteration{levels, 200.0}, field,
+                                    0.0);
+        const auto steps = std::lround(duration / parameters.timeStep);
+        for (long n = 0; n < steps; n++) {
+            solver.step(field, 0.0);
+        }
+        return solver.meanSuperfluidDensity();
+    };
+    const double equilibrium = relax(0, 400.0);
+    const double uniform = relax(0, 20.0);
+    const double nested = relax(2, 20.0);
+    EXPECT_LT(std::abs(nested - equilibrium), 0.25 * std::abs(uniform - equilibrium));
+}
@@ -0,0 +1,44 @@
+#include "../googletest/include/gtest/gtest.h"
+#include "../include/Noise.h"
+#include <cmath>
+
+TEST(Noise, PhiloxKnownAnswers) {
+    // The known-answer tests of the Random123 reference implementation
+    typedef std::array<std::uint32_t, 4> Words;
+    EXPECT_EQ(noise::philox({0, 0, 0, 0}, {0, 0}), (Words{0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8}));
+    EXPECT_EQ(noise::philox({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff}, {0xffffffff, 0xffffffff}),
+              (Words{0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd}));
+    EXPECT_EQ(noise::philox({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344}, {0xa4093822, 0x299f31d0}),
+              (Words{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+}
+
+TEST(Noise, GaussianMoments) {
+    const int n = 200000;
+    double sum = 0.0;
+    double squares = 0.0;
+    double fourth = 0.0;
+    double cross = 0.0;
+    for (int cell = 0; cell < n; cell++) {
+        std::complex<double> z = noise::gaussian(42, 7, cell);
+        ASSERT_TRUE(std::isfinite(z.real()) && std::isfinite(z.imag()));
+        sum += z.real() + z.imag();
+        squares += z.real() * z.real() + z.imag() * z.imag();
+        fourth += std::pow(z.real(), 4) + std::pow(z.imag(), 4);
+        cross += z.real() * z.imag();
+    }
+    EXPECT_NEAR(sum / (2 * n), 0.0, 0.01);
+    EXPECT_NEAR(squares / (2 * n), 1.0, 0.01);
+    EXPECT_NEAR(fourth / (2 * n), 3.0, 0.05);
+    EXPECT_NEAR(cross / n, 0.0, 0.01);
+}
+
+TEST(Noise, Streams) {
+    const std::complex<double> z = noise::gaussian(1, 2, 3);
+    EXPECT_EQ(noise::gaussian(1, 2, 3), z);
+    EXPECT_NE(noise::gaussian(0, 2, 3), z);
+    EXPECT_NE(noise::gaussian(1, 3, 3), z);
+    EXPECT_NE(noise::gaussian(1, 2, 4), z);
+    // The high words of the step and cell are part of the counter
+    EXPECT_NE(noise::gaussian(1, 2 + (std::uint64_t(1) << 32), 3), z);
+    EXPECT_NE(noise::gaussian(1, 2, 3 + (std::uint64_t(1) << 32)), z);
+}
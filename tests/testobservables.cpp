@@ -0,0 +1,220 @@
+#include "../googletest/include/gtest/gtest.h"
+#include "../include/Observables.h"
+#include "../include/Solver.h"
+
+namespace {
+    /**
+     * @brief Imprints a vortex of a given charge on psi around a point, with the links of a vanishing field.
+     */
+    template<typename real, typename link>
+    void imprintVortex(BasicSuperconductor<real, link> &superconductor, double cx, double cy, int charge) {
+        ComplexField<real> &psi = superconductor.orderParameter();
+        for (std::size_t x = 0; x < psi.width(); x++) {
+            for (std::size_t y = 0; y < psi.height(); y++) {
+                const double angle = charge * std::atan2(static_cast<double>(y) - cy, static_cast<double>(x) - cx);
+                psi(x, y) *= std::complex<real>(std::polar(1.0, angle));
+            }
+        }
+    }
+}
+
+TEST(Vorticity, Vortices) {
+    Geometry geometry(24, 20);
+    Superconductor superconductor(24, 20);
+    Solver solver(superconductor, geometry, SolverParameters());
+    solver.initialize();
+    Vorticity vorticity(superconductor, geometry);
+
+    vorticity.update();
+    EXPECT_TRUE(vorticity.vortices().empty());
+
+    imprintVortex(superconductor, 7.5, 9.5, 1);
+    imprintVortex(superconductor, 16.5, 6.5, -1);
+    vorticity.update();
+    std::vector<Vortex> vortices = vorticity.vortices();
+    ASSERT_EQ(vortices.size(), 2);
+    EXPECT_EQ(vortices[0].x, 7);
+    EXPECT_EQ(vortices[0].y, 9);
+    EXPECT_EQ(vortices[0].charge, 1);
+    EXPECT_EQ(vortices[1].x, 16);
+    EXPECT_EQ(vortices[1].y, 6);
+    EXPECT_EQ(vortices[1].charge, -1);
+    EXPECT_EQ(vorticity.windingNumbers()(7, 9), 1);
+}
+
+TEST(Vorticity, GaugeInvariance) {
+    // A gauge transformation psi -> psi e^(i chi), U_ij -> e^(i chi_i) U_ij e^(-i chi_j) moves no vortex
+    Geometry geometry(24, 20);
+    Superconductor superconductor(24, 20);
+    Solver solver(superconductor, geometry, SolverParameters());
+    solver.initialize();
+    imprintVortex(superconductor, 11.5, 8.5, 2);
+    auto chi = [](std::size_t x, std::size_t y) {
+        return 0.9 * std::sin(0.7 * x) + 0.3 * x * y;
+    };
+    for (std::size_t x = 0; x < 24; x++) {
+        for (std::size_t y = 0; y < 20; y++) {
+            superconductor.orderParameter()(x, y) *= std::polar(1.0, chi(x, y));
+            if (x + 1 < 24) {
+                superconductor.linkingVariableX()(x, y) = std::polar(1.0, chi(x, y) - chi(x + 1, y));
+            }
+            if (y + 1 < 20) {
+                superconductor.linkingVariableY()(x, y) = std::polar(1.0, chi(x, y) - chi(x, y + 1));
+            }
+        }
+    }
+    Vorticity vorticity(superconductor, geometry);
+    vorticity.update();
+    std::vector<Vortex> vortices = vorticity.vortices();
+    int total = 0;
+    for (const Vortex &vortex : vortices) {
+        total += vortex.charge;
+    }
+    EXPECT_EQ(total, 2);
+    EXPECT_LE(vortices.size(), 2);
+}
+
+TEST(Vorticity, Fluxoids) {
+    Geometry geometry(64, 32);
+    geometry.setGeometry(Geometry::squidMask(64, 32));
+    Superconductor superconductor(64, 32);
+    Solver solver(superconductor, geometry, SolverParameters());
+    solver.initialize();
+    Vorticity vorticity(superconductor, geometry);
+    ASSERT_EQ(vorticity.fluxoids().size(), 2);
+
+    vorticity.update();
+    EXPECT_EQ(vorticity.fluxoids()[0], 0);
+    EXPECT_EQ(vorticity.fluxoids()[1], 0);
+
+    // A phase winding once around the first hole and back around the second
+    imprintVortex(superconductor, 20.0, 15.5, 1);
+    imprintVortex(superconductor, 43.0, 15.5, -1);
+    vorticity.update();
+    EXPECT_EQ(vorticity.fluxoids()[0], 1);
+    EXPECT_EQ(vorticity.fluxoids()[1], -1);
+    EXPECT_TRUE(vorticity.vortices().empty());
+}
+
+TEST(Vorticity, FieldPenetration) {
+    // Vortices entering a square in a field carry flux along it, whichever storage
+    Geometry geometry(40, 40);
+    Superconductor superconductor(40, 40);
+    BasicSuperconductor<float, Phase> compressed(40, 40);
+    SolverParameters parameters;
+    parameters.screening = false;
+    Solver solver(superconductor, geometry, parameters);
+    BasicSolver<float, Phase> compressedSolver(compressed, geometry, parameters);
+    solver.initialize();
+    compressedSolver.initialize();
+    for (int n = 0; n < 4000; n++) {
+        solver.step(0.6, 0.0);
+        compressedSolver.step(0.6, 0.0);
+    }
+
+    Vorticity vorticity(superconductor, geometry);
+    BasicVorticity<float, Phase> compressedVorticity(compressed, geometry);
+    vorticity.update();
+    compressedVorticity.update();
+    int total = 0;
+    for (const Vortex &vortex : vorticity.vortices()) {
+        EXPECT_EQ(vortex.charge, 1);
+        total += vortex.charge;
+    }
+    EXPECT_GT(total, 0);
+    EXPECT_EQ(compressedVorticity.vortices().size(), vorticity.vortices().size());
+}
+
+TEST(RunningStatistics, Moments) {
+    RunningStatistics statistics;
+    EXPECT_EQ(statistics.count(), 0);
+    EXPECT_TRUE(std::isnan(statistics.mean()));
+
+    // A large offset would cancel the variance in a sum of squares
+    for (double value : {4.0, 7.0, 13.0, 16.0}) {
+        statistics.add(1e9 + value);
+    }
+    EXPECT_EQ(statistics.count(), 4);
+    EXPECT_DOUBLE_EQ(statistics.mean(), 1e9 + 10.0);
+    EXPECT_NEAR(statistics.variance(), 22.5, 1e-6);
+    EXPECT_DOUBLE_EQ(statistics.minimum(), 1e9 + 4.0);
+    EXPECT_DOUBLE_EQ(statistics.maximum(), 1e9 + 16.0);
+
+    statistics.reset();
+    statistics.add(-2.0);
+    EXPECT_DOUBLE_EQ(statistics.mean(), -2.0);
+    EXPECT_DOUBLE_EQ(statistics.variance(), 0.0);
+    EXPECT_DOUBLE_EQ(statistics.minimum(), -2.0);
+}
+
+TEST(Transport, Supercurrent) {
+    // A uniform phase gradient k carries Js_x = sin(k h') / h on every bond, with k h' the phase step per bond
+    Geometry geometry(20, 12);
+    Superconductor superconductor(20, 12);
+    Solver solver(superconductor, geometry, SolverParameters());
+    solver.initialize();
+    const double step = 0.3;
+    const double h = SolverParameters().gridSpacing;
+    for (std::size_t x = 0; x < 20; x++) {
+        for (std::size_t y = 0; y < 12; y++) {
+            superconductor.orderParameter()(x, y) = std::polar(1.0, step * x);
+        }
+    }
+
+    Transport transport(superconductor, geometry, h);
+    EXPECT_EQ(transport.addCutLine({true, 5, 0, 12}), 0);
+    EXPECT_EQ(transport.addCutLine({false, 5, 2, 10}), 1);
+    EXPECT_EQ(transport.addProbe({8, 6}), 0);
+    EXPECT_THROW(transport.addProbe({0, 6}), std::invalid_argument);
+    EXPECT_THROW(transport.addCutLine({true, 19, 0, 12}), std::invalid_argument);
+    transport.update(0.0);
+
+    // The outer rows are vacuum in the default square
+    EXPECT_NEAR(transport.current(0).mean(), 10 * std::sin(step), 1e-12);
+    EXPECT_NEAR(transport.current(1).mean(), 0.0, 1e-12);
+    EXPECT_NEAR(transport.currentDensityX(0).mean(), std::sin(step) / h, 1e-12);
+    EXPECT_NEAR(transport.currentDensityY(0).mean(), 0.0, 1e-12);
+
+    // Gauge invariance: psi -> psi e^(i chi), U_ij -> e^(i chi_i) U_ij e^(-i chi_j)
+    auto chi = [](std::size_t x, std::size_t y) {
+        return 0.8 * std::cos(0.5 * y) + 0.2 * x * y;
+    };
+    for (std::size_t x = 0; x < 20; x++) {
+        for (std::size_t y = 0; y < 12; y++) {
+            superconductor.orderParameter()(x, y) *= std::polar(1.0, chi(x, y));
+            if (x + 1 < 20) {
+                superconductor.linkingVariableX()(x, y) = std::polar(1.0, chi(x, y) - chi(x + 1, y));
+            }
+            if (y + 1 < 12) {
+                superconductor.linkingVariableY()(x, y) = std::polar(1.0, chi(x, y) - chi(x, y + 1));
+            }
+        }
+    }
+    transport.reset();
+    transport.update(1.0);
+    EXPECT_EQ(transport.current(0).count(), 1);
+    EXPECT_NEAR(transport.current(0).mean(), 10 * std::sin(step), 1e-12);
+    EXPECT_NEAR(transport.currentDensityX(0).mean(), std::sin(step) / h, 1e-12);
+    EXPECT_NEAR(transport.currentDensityY(0).mean(), 0.0, 1e-12);
+}
+
+TEST(Transport, Voltage) {
+    // The phase at the second probe advances by 2 radians per sample, past pi, at a rate of 20
+    Geometry geometry(20, 12);
+    BasicSuperconductor<float, Phase> superconductor(20, 12);
+    BasicSolver<float, Phase> solver(superconductor, geometry, SolverParameters());
+    solver.initialize();
+    BasicTransport<float, Phase> transport(superconductor, geometry, 0.5);
+    EXPECT_EQ(transport.addVoltageProbe({15, 8}, {3, 2}), 0);
+    EXPECT_THROW(transport.addVoltageProbe({3, 0}, {15, 8}), std::invalid_argument);
+
+    const double rate = 20.0;
+    for (int n = 0; n <= 10; n++) {
+        const double time = 0.1 * n;
+        superconductor.orderParameter()(3, 2) = std::polar(0.7f, static_cast<float>(rate * time));
+        transport.update(time);
+    }
+    EXPECT_EQ(transport.voltage(0).count(), 10);
+    EXPECT_NEAR(transport.voltage(0).mean(), rate, 1e-4);
+    EXPECT_NEAR(transport.voltage(0).variance(), 0.0, 1e-6);
+}
@@ -0,0 +1,51 @@
+#include "../googletest/include/gtest/gtest.h"
+#include "../include/AbstractField.h"
+#include "../include/Phase.h"
+#include <cmath>
+
+TEST(Phase, Angle) {
+    EXPECT_EQ(Phase().angle(), 0.0);
+    EXPECT_EQ(Phase(0.0).value, 0u);
+    EXPECT_NEAR(Phase(1.25).angle(), 1.25, Phase::radiansPerUnit);
+    EXPECT_NEAR(Phase(-2.5).angle(), -2.5, Phase::radiansPerUnit);
+
+    // Angles wrap around to [-pi, pi)
+    EXPECT_NEAR(Phase(1.25 + 6.0 * M_PI).angle(), 1.25, 1e-8);
+    EXPECT_EQ(Phase(M_PI).value, 1u << 31);
+    EXPECT_EQ(Phase(M_PI).angle(), -M_PI);
+    EXPECT_EQ(Phase::of(std::polar(3.0, 0.5)), Phase(0.5));
+}
+
+TEST(Phase, Phasor) {
+    double error = 0.0;
+    for (int k = 0; k < 10000; k++) {
+        double angle = -M_PI + 2.0 * M_PI * k / 10000.0 + 1e-5;
+        Phase phase(angle);
+        error = std::max(error, std::abs(phase.phasor() - std::polar(1.0, phase.angle())));
+    }
+    EXPECT_LT(error, 1e-15);
+    EXPECT_EQ(Phase().phasor(), std::complex<double>(1.0, 0.0));
+}
+
+TEST(Phase, Product) {
+    Phase a(3.0);
+    Phase b(2.0);
+    EXPECT_NEAR((a * b).angle(), 5.0 - 2.0 * M_PI, 1e-8);
+    EXPECT_EQ(a * Phase(-3.0), Phase());
+    EXPECT_NEAR(std::abs((a * b).phasor() - a.phasor() * b.phasor()), 0.0, 1e-8);
+
+    // Never off the unit circle, however many products
+    Phase product;
+    for (int n = 0; n < 100000; n++) {
+        product = product * a;
+    }
+    EXPECT_NEAR(std::abs(product.phasor()), 1.0, 1e-15);
+}
+
+TEST(Phase, Field) {
+    PhaseField field(4, 3);
+    EXPECT_EQ(field(3, 2).phasor(), std::complex<double>(1.0, 0.0));
+    field.fill(Phase(0.75));
+    EXPECT_NEAR((field(1, 1) * field(2, 0)).angle(), 1.5, 1e-8);
+    EXPECT_EQ(sizeof(Phase) * 4, sizeof(std::complex<double>));
+}
@@ -0,0 +1,126 @@
+#include "../googletest/include/gtest/gtest.h"
+#include "../include/Pipeline.h"
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+    pipeline::Generator<int> squares(int count) {
+        for (int i = 0; i < count; i++) {
+            co_yield i * i;
+        }
+    }
+
+    pipeline::Generator<int> failing() {
+        co_yield 1;
+        throw std::runtime_error("failed");
+    }
+
+    /**
+     * @brief Appends every item to a vector, on the pool, until the channel is closed.
+     */
+    pipeline::Task collect(pipeline::Channel<int> &channel, std::vector<int> &items) {
+        while (std::optional<int> item = co_await channel.pop()) {
+            items.push_back(*item);
+        }
+    }
+
+    pipeline::Task fail(pipeline::Channel<int> &channel) {
+        co_await channel.pop();
+        channel.close();
+        throw std::runtime_error("failed");
+    }
+}
+
+TEST(Pipeline, Generator) {
+    std::vector<int> values;
+    for (int value : squares(5)) {
+        values.push_back(value);
+    }
+    EXPECT_EQ(values, (std::vector<int>{0, 1, 4, 9, 16}));
+
+    int count = 0;
+    for ([[maybe_unused]] int value : squares(0)) {
+        count++;
+    }
+    EXPECT_EQ(count, 0);
+
+    values.clear();
+    EXPECT_THROW({
+        for (int value : failing()) {
+            values.push_back(value);
+        }
+    }, std::runtime_error);
+    EXPECT_EQ(values, std::vector<int>{1});
+}
+
+TEST(Pipeline, ChannelKeepsOrder) {
+    // A queue much shorter than the sequence makes the producer wait for the task over and over
+    pipeline::ThreadPool pool(3);
+    pipeline::Channel<int> channel(2, pool);
+    std::vector<int> items;
+    pipeline::Task task = collect(channel, items);
+    task.start(pool);
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_TRUE(channel.push(i));
+    }
+    channel.close();
+    task.wait();
+    ASSERT_EQ(items.size(), 1000);
+    for (int i = 0; i < 1000; i++) {
+        EXPECT_EQ(items[i], i);
+    }
+    EXPECT_FALSE(channel.push(1000));
+}
+
+TEST(Pipeline, TaskFailure) {
+    pipeline::ThreadPool pool(1);
+    pipeline::Channel<int> channel(1, pool);
+    pipeline::Task task = fail(channel);
+    EXPECT_THROW(task.wait(), std::logic_error);
+    task.start(pool);
+    EXPECT_THROW(task.start(pool), std::logic_error);
+
+    // The failed task closes its channel, which releases the producer instead of leaving it waiting
+    EXPECT_TRUE(channel.push(1));
+    while (channel.push(2)) {
+    }
+    EXPECT_THROW(task.wait(), std::runtime_error);
+}
+
+TEST(Pipeline, BufferPool) {
+    int made = 0;
+    pipeline::BufferPool<std::vector<double>> buffers(2, [&made] {
+        made++;
+        return std::make_unique<std::vector<double>>(16, 0.0);
+    });
+    EXPECT_EQ(made, 2);
+    EXPECT_EQ(buffers.available(), 2);
+
+    auto first = buffers.acquire();
+    (*first)[0] = 1.0;
+    {
+        // Copies share the buffer, it returns once the last one is gone
+        auto copy = first;
+        auto second = buffers.acquire();
+        EXPECT_EQ(buffers.available(), 0);
+        EXPECT_NE(&*copy, &*second);
+        first = {};
+        EXPECT_EQ(buffers.available(), 0);
+        EXPECT_EQ((*copy)[0], 1.0);
+    }
+    EXPECT_EQ(buffers.available(), 2);
+
+    // acquire() waits for a buffer released on another thread
+    auto a = buffers.acquire();
+    auto b = buffers.acquire();
+    std::thread release([held = std::move(a)]() mutable {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        held = {};
+    });
+    auto c = buffers.acquire();
+    EXPECT_TRUE(c);
+    release.join();
+    EXPECT_EQ(made, 2);
+}
@@ -0,0 +1,375 @@
+#include "../googletest/include/gtest/gtest.h"
+#include "../include/FixedField.h"
+#include "../include/Solver.h"
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+TEST(Solver, Initialize) {
+    Geometry geometry(10, 10);
+    Superconductor superconductor(10, 10);
+    Solver solver(superconductor, geometry, SolverParameters());
+    solver.initialize();
+
+    EXPECT_EQ(superconductor.orderParameter()(5, 5), complex(1.0, 0.0));
+    EXPECT_EQ(superconductor.orderParameter()(0, 0), complex(0.0, 0.0));
+    EXPECT_EQ(superconductor.linkingVariableX()(0, 0), complex(1.0, 0.0));
+    EXPECT_EQ(superconductor.fluxCellPhasor()(4, 4), complex(1.0, 0.0));
+    EXPECT_DOUBLE_EQ(solver.meanSuperfluidDensity(), 1.0);
+    EXPECT_DOUBLE_EQ(solver.time(), 0.0);
+}
+
+TEST(Solver, RelaxesToEquilibrium) {
+    Geometry geometry(12, 8);
+    Superconductor superconductor(12, 8);
+    Solver solver(superconductor, geometry, SolverParameters());
+    solver.initialize();
+    for (std::size_t x = 1; x < 11; x++) {
+        for (std::size_t y = 1; y < 7; y++) {
+            superconductor.orderParameter()(x, y) = complex(0.3, 0.4);
+        }
+    }
+
+    for (int n = 0; n < 2000; n++) {
+        solver.step(0.0, 0.0);
+    }
+    EXPECT_NEAR(solver.meanSuperfluidDensity(), 1.0, 1e-6);
+    EXPECT_EQ(superconductor.orderParameter()(0, 0), complex(0.0, 0.0));
+    EXPECT_NEAR(solver.time(), 20.0, 1e-9);
+}
+
+TEST(Solver, MeissnerScreening) {
+    Geometry geometry(24, 24);
+    Superconductor superconductor(24, 24);
+    SolverParameters parameters;
+    parameters.kappa = 1.0;
+    parameters.timeStep = 0.02;
+    Solver solver(superconductor, geometry, parameters);
+    solver.initialize();
+
+    for (int n = 0; n < 5000; n++) {
+        solver.step(0.2, 0.0);
+    }
+
+    // The field penetrates from the edge and is screened in the centre
+    EXPECT_NEAR(solver.magneticField()(0, 0), 0.2, 0.02);
+    EXPECT_LT(solver.magneticField()(11, 11), 0.1);
+    EXPECT_GT(solver.meanSuperfluidDensity(), 0.5);
+}
+
+TEST(Solver, InvalidParameters) {
+    Geometry geometry(10, 10);
+    Superconductor superconductor(10, 10);
+    SolverParameters parameters;
+    parameters.timeStep = 1.0;
+    EXPECT_THROW(Solver(superconductor, geometry, parameters), std::invalid_argument);
+    parameters.timeStep = 0.01;
+    parameters.kappa = -1.0;
+    EXPECT_THROW(Solver(superconductor, geometry, parameters), std::invalid_argument);
+    parameters.kappa = 2.0;
+    parameters.noise = -0.1;
+    EXPECT_THROW(Solver(superconductor, geometry, parameters), std::invalid_argument);
+
+    Geometry other(12, 10);
+    EXPECT_THROW(Solver(superconductor, other, SolverParameters()), std::invalid_argument);
+}
+
+TEST(Solver, SinglePrecision) {
+    Geometry geometry(24, 24);
+    Superconductor superconductor(24, 24);
+    BasicSuperconductor<float> singleSuperconductor(24, 24);
+    Solver solver(superconductor, geometry, SolverParameters());
+    BasicSolver<float> singleSolver(singleSuperconductor, geometry, SolverParameters());
+    solver.initialize();
+    singleSolver.initialize();
+
+    for (int n = 0; n < 2000; n++) {
+        solver.step(0.2, 0.5);
+        singleSolver.step(0.2, 0.5);
+    }
+
+    // The observables are accumulated in double precision either way
+    EXPECT_NEAR(singleSolver.meanSuperfluidDensity(), solver.meanSuperfluidDensity(), 1e-5);
+    EXPECT_NEAR(singleSolver.meanMagneticField(), solver.meanMagneticField(), 1e-5);
+    EXPECT_NEAR(std::abs(singleSuperconductor.linkingVariableX()(10, 10)), 1.0f, 1e-6f);
+}
+
+TEST(Solver, PhaseLinks) {
+    Geometry geometry(24, 24);
+    Superconductor superconductor(24, 24);
+    BasicSuperconductor<double, Phase> phaseSuperconductor(24, 24);
+    Solver solver(superconductor, geometry, SolverParameters());
+    BasicSolver<double, Phase> phaseSolver(phaseSuperconductor, geometry, SolverParameters());
+    solver.initialize();
+    phaseSolver.initialize();
+
+    for (int n = 0; n < 2000; n++) {
+        solver.step(0.2, 0.5);
+        phaseSolver.step(0.2, 0.5);
+    }
+
+    EXPECT_NEAR(phaseSolver.meanSuperfluidDensity(), solver.meanSuperfluidDensity(), 1e-6);
+    EXPECT_NEAR(phaseSolver.meanMagneticField(), solver.meanMagneticField(), 1e-6);
+    EXPECT_NEAR(std::arg(superconductor.linkingVariableX()(10, 10)),
+                phaseSuperconductor.linkingVariableX()(10, 10).angle(), 1e-6);
+}
+
+TEST(Solver, NoiseVariance) {
+    Geometry geometry(202, 202);
+    Superconductor superconductor(202, 202);
+    SolverParameters parameters;
+    parameters.noise = 0.5;
+    parameters.seed = 3;
+    Solver solver(superconductor, geometry, parameters);
+    solver.initialize();
+    superconductor.orderParameter().fill(0.0);
+
+    // psi = 0 is a stationary state, after one step all that is left is the noise
+    solver.step(0.0, 0.0);
+    const double variance = parameters.noise * parameters.timeStep / (parameters.gridSpacing * parameters.gridSpacing);
+    EXPECT_NEAR(solver.meanSuperfluidDensity(), 2.0 * variance, 0.02 * 2.0 * variance);
+    EXPECT_EQ(superconductor.orderParameter()(0, 0), complex(0.0, 0.0));
+
+    // Without noise it stays there
+    parameters.noise = 0.0;
+    solver.setParameters(parameters);
+    superconductor.orderParameter().fill(0.0);
+    solver.step(0.0, 0.0);
+    EXPECT_EQ(solver.meanSuperfluidDensity(), 0.0);
+}
+
+TEST(Solver, NoiseIndependentOfThreads) {
+#ifdef _OPENMP
+    Geometry geometry(40, 300);
+    SolverParameters parameters;
+    parameters.noise = 0.05;
+    parameters.seed = 11;
+
+    const int threads = omp_get_max_threads();
+    ComplexField<double> results[2] = {ComplexField<double>(40, 300), ComplexField<double>(40, 300)};
+    for (int run = 0; run < 2; run++) {
+        omp_set_num_threads(run == 0 ? 1 : 64);
+        Superconductor superconductor(40, 300);
+        Solver solver(superconductor, geometry, parameters);
+        solver.initialize();
+        for (int n = 0; n < 20; n++) {
+            solver.step(0.1, 0.0);
+        }
+        results[run] = superconductor.orderParameter();
+    }
+    omp_set_num_threads(threads);
+    int differences = 0;
+    for (std::size_t x = 0; x < 40; x++) {
+        for (std::size_t y = 0; y < 300; y++) {
+            differences += results[0](x, y) != results[1](x, y);
+        }
+    }
+    EXPECT_EQ(differences, 0);
+#else
+    GTEST_SKIP() << "Built without OpenMP";
+#endif
+}
+
+TEST(Solver, Leads) {
+    // Below the critical current the normal current injected at the leads turns into supercurrent
+    const std::size_t W = 48;
+    const std::size_t H = 12;
+    Geometry geometry(W, H);
+    Superconductor superconductor(W, H);
+    SolverParameters parameters;
+    parameters.screening = false;
+    Solver solver(superconductor, geometry, parameters);
+    Mask source(W, H);
+    Mask drain(W, H);
+    for (std::size_t y = 0; y < H; y++) {
+        source(1, y) = true;
+        drain(W - 2, y) = true;
+    }
+    EXPECT_THROW(solver.scalarPotential(), std::logic_error);
+    solver.setLeads(source, drain);
+    solver.initialize();
+
+    const double current = 0.5;
+    for (int n = 0; n < 20000; n++) {
+        solver.step(0.0, current);
+    }
+    double supercurrent = 0.0;
+    for (std::size_t y = 0; y < H; y++) {
+        supercurrent += std::imag(std::conj(superconductor.orderParameter()(W / 2, y))
+                                  * superconductor.orderParameter()(W / 2 + 1, y));
+    }
+    EXPECT_NEAR(supercurrent, current, 1e-3 * current);
+    const RealField &potential = solver.scalarPotential();
+    EXPECT_LT(std::abs(potential(W / 2, H / 2) - potential(W / 2 + 1, H / 2)), 1e-4);
+    EXPECT_LE(solver.potentialCycles(), 1);
+
+    // Far above it the strip turns normal, and the leads see its resistance
+    const double normalCurrent = 8.0;
+    for (int n = 0; n < 5000; n++) {
+        solver.step(0.0, normalCurrent);
+    }
+    EXPECT_LT(solver.meanSuperfluidDensity(), 0.1);
+    const double drop = potential(2, H / 2) - potential(W - 3, H / 2);
+    EXPECT_GT(drop, 0.9 * normalCurrent * static_cast<double>(W - 5) / static_cast<double>(H - 2));
+
+    parameters.screening = true;
+    solver.setParameters(parameters);
+    EXPECT_THROW(solver.step(0.0, current), std::invalid_argument);
+    solver.removeLeads();
+    EXPECT_NO_THROW(solver.step(0.0, current));
+    EXPECT_EQ(solver.potentialCycles(), 0);
+
+    parameters.screening = false;
+    solver.setParameters(parameters);
+    EXPECT_THROW(solver.step(0.0, current), std::invalid_argument);
+    Mask vacuum(W, H);
+    vacuum(0, 0) = true;
+    EXPECT_THROW(solver.setLeads(vacuum, drain), std::invalid_argument);
+}
+
+namespace {
+    /**
+     * @brief Whether blocks of steps reproduce single steps to the bit, on a SQUID with a vortex entering it.
+     */
+    template<typename real, typename link>
+    bool blockedMatchesSteps(int width, int height, int block, int steps) {
+        Geometry geometry(width, height);
+        geometry.setGeometry(Geometry::squidMask(width, height));
+        SolverParameters parameters;
+        parameters.screening = false;
+        parameters.timeStep = 0.9 * Solver::stabilityLimit(parameters);
+        BasicSuperconductor<real, link> single(width, height);
+        BasicSuperconductor<real, link> blocked(width, height);
+        BasicSolver<real, link> singleSolver(single, geometry, parameters);
+        parameters.temporalBlocking = block;
+        BasicSolver<real, link> blockedSolver(blocked, geometry, parameters);
+        singleSolver.initialize();
+        blockedSolver.initialize();
+
+        for (int n = 0; n < steps; n++) {
+            singleSolver.step(0.3, 0.0);
+        }
+        blockedSolver.advance(0.3, 0.0, steps);
+        if (singleSolver.time() != blockedSolver.time()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < single.orderParameter().size(); i++) {
+            if (single.orderParameter().data()[i] != blocked.orderParameter().data()[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template<std::size_t W, std::size_t H, typename link>
+    bool fixedMatchesDynamic(bool screening, int block) {
+        Geometry geometry(W, H);
+        geometry.setGeometry(Geometry::squidMask(W, H));
+        SolverParameters parameters;
+        parameters.screening = screening;
+        parameters.temporalBlocking = block;
+        BasicSuperconductor<double, link, FixedGrid<W, H>> fixed(W, H);
+        BasicSuperconductor<double, link> dynamic(W, H);
+        BasicSolver<double, link, FixedGrid<W, H>> fixedSolver(fixed, geometry, parameters);
+        BasicSolver<double, link> dynamicSolver(dynamic, geometry, parameters);
+        fixedSolver.initialize();
+        dynamicSolver.initialize();
+
+        fixedSolver.advance(0.3, 0.0, 20);
+        dynamicSolver.advance(0.3, 0.0, 20);
+        if (fixedSolver.meanSuperfluidDensity() != dynamicSolver.meanSuperfluidDensity()
+            || fixedSolver.meanMagneticField() != dynamicSolver.meanMagneticField()) {
+            return false;
+        }
+        for (std::size_t i = 0; i < W * H; i++) {
+            if (fixed.orderParameter().data()[i] != dynamic.orderParameter().data()[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+TEST(Solver, TemporalBlocking) {
+    // Grids of one tile, of tiles cut short at both edges, and narrower than the margins of a block
+    for (int block : {2, 3, 8}) {
+        EXPECT_TRUE((blockedMatchesSteps<double, complex>(48, 40, block, 3 * block + 1))) << block;
+        EXPECT_TRUE((blockedMatchesSteps<double, complex>(300, 600, block, 2 * block))) << block;
+        EXPECT_TRUE((blockedMatchesSteps<double, complex>(16, 16, block, 4 * block))) << block;
+    }
+    EXPECT_TRUE((blockedMatchesSteps<float, std::complex<float>>(300, 600, 4, 12)));
+    EXPECT_TRUE((blockedMatchesSteps<double, Phase>(300, 600, 4, 12)));
+    EXPECT_TRUE((blockedMatchesSteps<float, Phase>(131, 260, 5, 11)));
+}
+
+TEST(Solver, FixedGrid) {
+    // The state is held inside the superconductor, and evolves as on fields of runtime dimensions
+    EXPECT_GE(sizeof(BasicSuperconductor<double, complex, FixedGrid<32, 32>>), 32 * 32 * sizeof(complex));
+    EXPECT_TRUE((fixedMatchesDynamic<32, 32, complex>(true, 1)));
+    EXPECT_TRUE((fixedMatchesDynamic<48, 40, complex>(false, 4)));
+    EXPECT_TRUE((fixedMatchesDynamic<40, 32, Phase>(false, 1)));
+    EXPECT_THROW((BasicSuperconductor<double, complex, FixedGrid<32, 32>>(32, 16)), std::invalid_argument);
+}
+
+TEST(Solver, TemporalBlockingFallsBack) {
+    // With noise the steps are taken one by one, and match those of step() all the same
+    Geometry geometry(40, 30);
+    SolverParameters parameters;
+    parameters.screening = false;
+    parameters.noise = 0.05;
+    parameters.seed = 5;
+    Superconductor single(40, 30);
+    Superconductor blocked(40, 30);
+    Solver singleSolver(single, geometry, parameters);
+    parameters.temporalBlocking = 4;
+    Solver blockedSolver(blocked, geometry, parameters);
+    singleSolver.initialize();
+    blockedSolver.initialize();
+    for (int n = 0; n < 10; n++) {
+        singleSolver.step(0.1, 0.0);
+    }
+    blockedSolver.advance(0.1, 0.0, 10);
+    EXPECT_EQ(single.orderParameter()(20, 15), blocked.orderParameter()(20, 15));
+    EXPECT_THROW(blockedSolver.advance(0.1, 0.5, 8), std::invalid_argument);
+
+    parameters.temporalBlocking = 0;
+    EXPECT_THROW(Solver(single, geometry, parameters), std::invalid_argument);
+}
+
+TEST(Solver, HandOver) {
+    // A block of steps and a single step hand over the state before them, and go on as without a hand-over
+    Geometry geometry(40, 30);
+    SolverParameters parameters;
+    parameters.screening = false;
+    parameters.temporalBlocking = 4;
+    Superconductor handed(40, 30);
+    Superconductor reference(40, 30);
+    Solver handedSolver(handed, geometry, parameters);
+    Solver referenceSolver(reference, geometry, parameters);
+    handedSolver.initialize();
+    referenceSolver.initialize();
+    EXPECT_FALSE(handedSolver.appliedLinkField());
+    handedSolver.advance(0.1, 0.0, 3);
+    referenceSolver.advance(0.1, 0.0, 3);
+    EXPECT_EQ(handedSolver.appliedLinkField(), 0.1);
+
+    ComplexField<double> buffer(40, 30);
+    for (int steps : {4, 1}) {
+        const ComplexField<double> before = handed.orderParameter();
+        handedSolver.handOver(&buffer);
+        handedSolver.advance(0.1, 0.0, steps);
+        referenceSolver.advance(0.1, 0.0, steps);
+        EXPECT_EQ(buffer(20, 15), before(20, 15)) << steps;
+        EXPECT_EQ(handed.orderParameter()(20, 15), reference.orderParameter()(20, 15)) << steps;
+    }
+    handedSolver.advance(0.1, 0.0, 2);
+    referenceSolver.advance(0.1, 0.0, 2);
+    EXPECT_EQ(handed.orderParameter()(20, 15), reference.orderParameter()(20, 15));
+
+    ComplexField<double> small(10, 10);
+    EXPECT_THROW(handedSolver.handOver(&small), std::invalid_argument);
+    parameters.screening = true;
+    handedSolver.setParameters(parameters);
+    EXPECT_FALSE(handedSolver.appliedLinkField());
+}
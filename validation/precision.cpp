@@ -0,0 +1,198 @@
+#include "../include/Geometry.h"
+#include "../include/Solver.h"
+#include "../include/Superconductor.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * Validation of the compressed solver states: single precision and phase links. Ramps the transport current through
+ * the reference geometries with each of them and with the double precision complex reference, and compares the
+ * critical currents and the superfluid density trajectories below them.
+ *
+ * The critical current is taken as the current at which the mean superfluid density first rises during the ramp:
+ * below it the density only falls as the current breaks pairs, the first vortex or phase slip makes it recover.
+ *
+ * Usage: Run_precision_validation [--quick] [--tolerance <fraction>]
+ */
+
+namespace {
+    struct Reference {
+        const char *name;
+        int width;
+        int height;
+        std::function<Mask(int, int)> mask;
+    };
+
+    struct Ramp {
+        double maximumCurrent;
+        double duration;
+        double sampleInterval;
+    };
+
+    struct Sample {
+        double current;
+        double superfluidDensity;
+    };
+
+    /**
+     * @brief A rise of the density by more than this between samples marks the critical current.
+     */
+    constexpr double riseThreshold = 1e-4;
+
+    std::vector<Reference> references(bool quick) {
+        const int width = quick ? 48 : 96;
+        const int height = quick ? 32 : 64;
+        return {
+                {"square", width, height, [](int width, int height) {
+                    Mask mask(width, height);
+                    mask.fill(true);
+                    for (int x = 0; x < width; x++) {
+                        mask(x, 0) = false;
+                        mask(x, height - 1) = false;
+                    }
+                    for (int y = 0; y < height; y++) {
+                        mask(0, y) = false;
+                        mask(width - 1, y) = false;
+                    }
+                    return mask;
+                }},
+                {"squid", width, height, Geometry::squidMask},
+        };
+    }
+
+    template<typename real, typename link = std::complex<real>>
+    std::vector<Sample> trajectory(const Reference &reference, const Ramp &ramp) {
+        Geometry geometry(reference.width, reference.height);
+        geometry.setGeometry(reference.mask(reference.width, reference.height));
+        BasicSuperconductor<real, link> superconductor(reference.width, reference.height);
+        BasicSolver<real, link> solver(superconductor, geometry, SolverParameters());
+        solver.initialize();
+
+        const double timeStep = solver.parameters().timeStep;
+        const auto steps = static_cast<long>(std::ceil(ramp.duration / timeStep - 1e-9));
+        const auto stepsPerSample = static_cast<long>(std::round(ramp.sampleInterval / timeStep));
+        std::vector<Sample> samples;
+        for (long n = 0; n <= steps; n++) {
+            const double current = ramp.maximumCurrent * solver.time() / ramp.duration;
+            if (n % stepsPerSample == 0) {
+                samples.push_back({current, solver.meanSuperfluidDensity()});
+            }
+            solver.step(0.0, current);
+        }
+        return samples;
+    }
+
+    /**
+     * @brief Index of the first sample at or above the critical current, or the number of samples if it is not
+     * reached.
+     */
+    std::size_t criticalSample(const std::vector<Sample> &samples) {
+        for (std::size_t i = 1; i < samples.size(); i++) {
+            if (samples[i].superfluidDensity > samples[i - 1].superfluidDensity + riseThreshold) {
+                return i;
+            }
+        }
+        return samples.size();
+    }
+
+    /**
+     * @brief A compressed state, validated against the reference.
+     */
+    struct Variant {
+        const char *name;
+        std::function<std::vector<Sample>(const Reference &, const Ramp &)> trajectory;
+    };
+
+    std::string formatCurrent(const std::vector<Sample> &samples, std::size_t critical) {
+        std::ostringstream text;
+        if (critical < samples.size()) {
+            text << std::fixed << std::setprecision(3) << samples[critical].current;
+        } else {
+            text << "not reached";
+        }
+        return text.str();
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    bool quick = false;
+    double tolerance = 0.02;
+    for (int i = 1; i < argc; i++) {
+        std::string argument = argv[i];
+        if (argument == "--quick") {
+            quick = true;
+        } else if (argument == "--tolerance" && i + 1 < argc) {
+            tolerance = std::atof(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--quick] [--tolerance <fraction>]" << std::endl;
+            return 2;
+        }
+    }
+
+#ifdef _OPENMP
+    // Reductions in a fixed order, so that a failure reproduces
+    omp_set_num_threads(1);
+#endif
+
+    const Ramp ramp = quick ? Ramp{5.0, 200.0, 0.5} : Ramp{10.0, 1000.0, 0.5};
+    const double currentStep = ramp.maximumCurrent * ramp.sampleInterval / ramp.duration;
+    bool passed = true;
+
+    const Variant variants[] = {
+            {"single", trajectory<float>},
+            {"phase links", trajectory<double, Phase>},
+    };
+
+    std::cout << std::left << std::setw(10) << "geometry" << std::setw(10) << "grid" << std::setw(14) << "variant"
+              << std::setw(14) << "Ic double" << std::setw(14) << "Ic variant" << std::setw(22) << "max density diff"
+              << "result" << std::endl;
+    for (const Reference &reference : references(quick)) {
+        std::vector<Sample> expected = trajectory<double>(reference, ramp);
+        std::size_t expectedCritical = criticalSample(expected);
+        for (const Variant &variant : variants) {
+            std::vector<Sample> compressed = variant.trajectory(reference, ramp);
+            std::size_t compressedCritical = criticalSample(compressed);
+
+            // Beyond the critical current the dynamics amplify any difference, compare the trajectories below it only
+            double densityDifference = 0.0;
+            for (std::size_t i = 0; i < std::min(expectedCritical, compressedCritical); i++) {
+                densityDifference = std::max(densityDifference, std::abs(compressed[i].superfluidDensity
+                                                                         - expected[i].superfluidDensity));
+            }
+
+            bool agrees;
+            if (expectedCritical == expected.size() || compressedCritical == compressed.size()) {
+                agrees = expectedCritical == expected.size() && compressedCritical == compressed.size();
+            } else {
+                // The critical current is only resolved to one sample of the ramp
+                double difference = std::abs(compressed[compressedCritical].current
+                                             - expected[expectedCritical].current);
+                agrees = difference <= std::max(tolerance * expected[expectedCritical].current, currentStep);
+            }
+            passed = passed && agrees;
+
+            std::ostringstream grid;
+            grid << reference.width << "x" << reference.height;
+            std::ostringstream density;
+            density << std::scientific << std::setprecision(2) << densityDifference;
+            std::cout << std::left << std::setw(10) << reference.name << std::setw(10) << grid.str() << std::setw(14)
+                      << variant.name << std::setw(14) << formatCurrent(expected, expectedCritical) << std::setw(14)
+                      << formatCurrent(compressed, compressedCritical) << std::setw(22) << density.str()
+                      << (agrees ? "PASS" : "FAIL") << std::endl;
+        }
+    }
+    std::cout << (passed ? "Compressed states agree with double precision." : "Precision validation FAILED.")
+              << std::endl;
+    return passed ? 0 : 1;
+}